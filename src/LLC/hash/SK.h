@@ -19,7 +19,7 @@ ________________________________________________________________________________
 #include <LLC/hash/SK/skein.h>
 #include <LLC/hash/SK/KeccakHash.h>
 
-#include <LLD/cache/template_lru.h>
+#include <Util/templates/serialize.h>
 
 /** Namespace LLC (Lower Level Crypto) **/
 namespace LLC
@@ -27,12 +27,6 @@ namespace LLC
 
 	static uint8_t pblank[1];
 
-	/* LRU cache of hashed values  */
-	extern LLD::TemplateLRU<std::vector<uint8_t>, uint64_t> cache64;
-	extern LLD::TemplateLRU<std::vector<uint8_t>, uint256_t> cache256;
-	extern LLD::TemplateLRU<std::vector<uint8_t>, uint512_t> cache512;
-	extern LLD::TemplateLRU<std::vector<uint8_t>, uint1024_t> cache1024;
-
 
     /** SK32
      *
@@ -89,27 +83,17 @@ namespace LLC
 	template<typename T1>
 	inline uint64_t SK64(const T1 pbegin, const T1 pend)
 	{
-		/* Copy the data into a vector of bytes so we can cache the hashed value */
-		std::vector<uint8_t> vData(pbegin, pend);
+		uint64_t hashSkein = 0;
+		Skein_256_Ctxt_t ctxSkein;
+		Skein_256_Init  (&ctxSkein, 64);
+		Skein_256_Update(&ctxSkein, (pbegin == pend ? pblank : (uint8_t*)&pbegin[0]), (pend - pbegin) * sizeof(pbegin[0]));
+		Skein_256_Final (&ctxSkein, (uint8_t *)&hashSkein);
 
-		/* Check the cache for this data */
 		uint64_t hashKeccak = 0;
-		if(!cache64.Get(vData, hashKeccak))
-		{
-			uint64_t hashSkein = 0;
-			Skein_256_Ctxt_t ctxSkein;
-			Skein_256_Init  (&ctxSkein, 64);
-			Skein_256_Update(&ctxSkein, (pbegin == pend ? pblank : (uint8_t*)&pbegin[0]), (pend - pbegin) * sizeof(pbegin[0]));
-			Skein_256_Final (&ctxSkein, (uint8_t *)&hashSkein);
-
-			Keccak_HashInstance ctxKeccak;
-			Keccak_HashInitialize(&ctxKeccak, 1344, 256, 64, 0x06);
-			Keccak_HashUpdate(&ctxKeccak, (uint8_t *)&hashSkein, 64);
-			Keccak_HashFinal(&ctxKeccak, (uint8_t *)&hashKeccak);
-
-			/* Cache the hashed value */
-			cache64.Put(vData, hashKeccak);
-		}
+		Keccak_HashInstance ctxKeccak;
+		Keccak_HashInitialize(&ctxKeccak, 1344, 256, 64, 0x06);
+		Keccak_HashUpdate(&ctxKeccak, (uint8_t *)&hashSkein, 64);
+		Keccak_HashFinal(&ctxKeccak, (uint8_t *)&hashKeccak);
 
 		return hashKeccak;
 	}
@@ -122,26 +106,7 @@ namespace LLC
      **/
 	inline uint64_t SK64(const std::vector<uint8_t>& vch)
 	{
-		/* Check the cache for this data */
-		uint64_t hashKeccak = 0;
-		if(!cache64.Get(vch, hashKeccak))
-		{
-			uint64_t hashSkein = 0;
-			Skein_256_Ctxt_t ctxSkein;
-			Skein_256_Init(&ctxSkein, 64);
-			Skein_256_Update(&ctxSkein, (uint8_t *)&vch[0], vch.size());
-			Skein_256_Final(&ctxSkein, (uint8_t *)&hashSkein);
-
-			Keccak_HashInstance ctxKeccak;
-			Keccak_HashInitialize(&ctxKeccak, 1344, 256, 64, 0x06);
-			Keccak_HashUpdate(&ctxKeccak, (uint8_t *)&hashSkein, 64);
-			Keccak_HashFinal(&ctxKeccak, (uint8_t *)&hashKeccak);
-
-			/* Cache the hashed value */
-			cache64.Put(vch, hashKeccak);
-		}
-
-		return hashKeccak;
+		return SK64(vch.begin(), vch.end());
 	}
 
 
@@ -150,26 +115,20 @@ namespace LLC
      *  256-bit hashing template for Address Generation .
      *
      **/
-	inline uint256_t SK256(const std::vector<uint8_t>& vch)
+	template<typename T1>
+	inline uint256_t SK256(const T1 pbegin, const T1 pend)
 	{
-		/* Check the cache for this data */
-		uint256_t hashKeccak;
-		if(!cache256.Get(vch, hashKeccak))
-		{
-			uint256_t hashSkein = 0;
-			Skein_256_Ctxt_t ctxSkein;
-			Skein_256_Init(&ctxSkein, 256);
-			Skein_256_Update(&ctxSkein, (uint8_t *)&vch[0], vch.size());
-			Skein_256_Final(&ctxSkein, (uint8_t *)&hashSkein);
-
-			Keccak_HashInstance ctxKeccak;
-			Keccak_HashInitialize_SHA3_256(&ctxKeccak);
-			Keccak_HashUpdate(&ctxKeccak, (uint8_t *)&hashSkein, 256);
-			Keccak_HashFinal(&ctxKeccak, (uint8_t *)&hashKeccak);
+		uint256_t hashSkein;
+		Skein_256_Ctxt_t ctxSkein;
+		Skein_256_Init  (&ctxSkein, 256);
+		Skein_256_Update(&ctxSkein, (pbegin == pend ? pblank : (uint8_t*)&pbegin[0]), (pend - pbegin) * sizeof(pbegin[0]));
+		Skein_256_Final (&ctxSkein, (uint8_t *)&hashSkein);
 
-			/* Cache the hashed value */
-			cache256.Put(vch, hashKeccak);
-		}
+		uint256_t hashKeccak;
+		Keccak_HashInstance ctxKeccak;
+		Keccak_HashInitialize_SHA3_256(&ctxKeccak);
+		Keccak_HashUpdate(&ctxKeccak, (uint8_t *)&hashSkein, 256);
+		Keccak_HashFinal(&ctxKeccak, (uint8_t *)&hashKeccak);
 
 		return hashKeccak;
 	}
@@ -177,35 +136,12 @@ namespace LLC
 
 	/** SK256
      *
-     *  256-bit hashing template for Address Generation.
+     *  256-bit hashing template for Address Generation .
      *
      **/
-	template<typename T1>
-	inline uint256_t SK256(const T1 pbegin, const T1 pend)
+	inline uint256_t SK256(const std::vector<uint8_t>& vch)
 	{
-		/* Copy the data into a vector of bytes so we can cache the hashed value */
-		std::vector<uint8_t> vData(pbegin, pend);
-
-		/* Check the cache for this data */
-		uint256_t hashKeccak;
-		if(!cache256.Get(vData, hashKeccak))
-		{
-			uint256_t hashSkein;
-			Skein_256_Ctxt_t ctxSkein;
-			Skein_256_Init  (&ctxSkein, 256);
-			Skein_256_Update(&ctxSkein, (pbegin == pend ? pblank : (uint8_t*)&pbegin[0]), (pend - pbegin) * sizeof(pbegin[0]));
-			Skein_256_Final (&ctxSkein, (uint8_t *)&hashSkein);
-
-			Keccak_HashInstance ctxKeccak;
-			Keccak_HashInitialize_SHA3_256(&ctxKeccak);
-			Keccak_HashUpdate(&ctxKeccak, (uint8_t *)&hashSkein, 256);
-			Keccak_HashFinal(&ctxKeccak, (uint8_t *)&hashKeccak);
-
-			/* Cache the hashed value */
-			cache256.Put(vData, hashKeccak);
-		}
-
-		return hashKeccak;
+		return SK256(vch.begin(), vch.end());
 	}
 
 
@@ -232,24 +168,17 @@ namespace LLC
      **/
     inline uint512_t SK512(const std::vector<uint8_t>& vch)
 	{
-		/* Check the cache for this data */
-		uint512_t hashKeccak;
-		if(!cache512.Get(vch, hashKeccak))
-		{
-			uint512_t hashSkein;
-			Skein_512_Ctxt_t ctxSkein;
-			Skein_512_Init(&ctxSkein, 512);
-			Skein_512_Update(&ctxSkein, (uint8_t *)&vch[0], vch.size());
-			Skein_512_Final(&ctxSkein, (uint8_t *)&hashSkein);
-
-			Keccak_HashInstance ctxKeccak;
-			Keccak_HashInitialize_SHA3_512(&ctxKeccak);
-			Keccak_HashUpdate(&ctxKeccak, (uint8_t *)&hashSkein, 512);
-			Keccak_HashFinal(&ctxKeccak, (uint8_t *)&hashKeccak);
+		uint512_t hashSkein;
+		Skein_512_Ctxt_t ctxSkein;
+		Skein_512_Init(&ctxSkein, 512);
+		Skein_512_Update(&ctxSkein, (vch.empty() ? pblank : (uint8_t *)&vch[0]), vch.size());
+		Skein_512_Final(&ctxSkein, (uint8_t *)&hashSkein);
 
-			/* Cache the hashed value */
-			cache512.Put(vch, hashKeccak);
-		}
+		uint512_t hashKeccak;
+		Keccak_HashInstance ctxKeccak;
+		Keccak_HashInitialize_SHA3_512(&ctxKeccak);
+		Keccak_HashUpdate(&ctxKeccak, (uint8_t *)&hashSkein, 512);
+		Keccak_HashFinal(&ctxKeccak, (uint8_t *)&hashKeccak);
 
 		return hashKeccak;
 	}
@@ -288,27 +217,17 @@ namespace LLC
 	template<typename T1>
 	inline uint512_t SK512(const T1 pbegin, const T1 pend)
 	{
-		/* Copy the data into a vector of bytes so we can cache the hashed value */
-		std::vector<uint8_t> vData(pbegin, pend);
+		uint512_t hashSkein;
+		Skein_512_Ctxt_t ctxSkein;
+		Skein_512_Init  (&ctxSkein, 512);
+		Skein_512_Update(&ctxSkein, (pbegin == pend ? pblank : (uint8_t*)&pbegin[0]), (pend - pbegin) * sizeof(pbegin[0]));
+		Skein_512_Final (&ctxSkein, (uint8_t *)&hashSkein);
 
-		/* Check the cache for this data */
 		uint512_t hashKeccak;
-		if(!cache512.Get(vData, hashKeccak))
-		{
-			uint512_t hashSkein;
-			Skein_512_Ctxt_t ctxSkein;
-			Skein_512_Init  (&ctxSkein, 512);
-			Skein_512_Update(&ctxSkein, (pbegin == pend ? pblank : (uint8_t*)&pbegin[0]), (pend - pbegin) * sizeof(pbegin[0]));
-			Skein_512_Final (&ctxSkein, (uint8_t *)&hashSkein);
-
-			Keccak_HashInstance ctxKeccak;
-			Keccak_HashInitialize_SHA3_512(&ctxKeccak);
-			Keccak_HashUpdate(&ctxKeccak, (uint8_t *)&hashSkein, 512);
-			Keccak_HashFinal(&ctxKeccak, (uint8_t *)&hashKeccak);
-
-			/* Cache the hashed value */
-			cache512.Put(vData, hashKeccak);
-		}
+		Keccak_HashInstance ctxKeccak;
+		Keccak_HashInitialize_SHA3_512(&ctxKeccak);
+		Keccak_HashUpdate(&ctxKeccak, (uint8_t *)&hashSkein, 512);
+		Keccak_HashFinal(&ctxKeccak, (uint8_t *)&hashKeccak);
 
 		return hashKeccak;
 	}
@@ -400,30 +319,144 @@ namespace LLC
 	template<typename T1>
 	inline uint1024_t SK1024(const T1 pbegin, const T1 pend)
 	{
-		/* Copy the data into a vector of bytes so we can cache the hashed value */
-		std::vector<uint8_t> vData(pbegin, pend);
+		uint1024_t hashSkein;
+		Skein1024_Ctxt_t ctxSkein;
+		Skein1024_Init(&ctxSkein, 1024);
+		Skein1024_Update(&ctxSkein, (pbegin == pend ? pblank : (uint8_t*)&pbegin[0]), (pend - pbegin) * sizeof(pbegin[0]));
+		Skein1024_Final(&ctxSkein, (uint8_t *)&hashSkein);
 
-		/* Check the cache for this data */
 		uint1024_t hashKeccak;
-		if(!cache1024.Get(vData, hashKeccak))
+		Keccak_HashInstance ctxKeccak;
+		Keccak_HashInitialize(&ctxKeccak, 576, 1024, 1024, 0x05);
+		Keccak_HashUpdate(&ctxKeccak, (uint8_t *)&hashSkein, 1024);
+		Keccak_HashFinal(&ctxKeccak, (uint8_t *)&hashKeccak);
+
+		return hashKeccak;
+	}
+
+
+	/** SKStream
+	 *
+	 *  Hashes bytes as they are serialized, without copying them into a buffer first.
+	 *  The Skein state is updated on each write and Keccak is run over it in GetHash,
+	 *  so the hash is the same as the SK function of the same width over the bytes.
+	 *
+	 *  Use SK64Stream, SK256Stream, SK512Stream or SK1024Stream.
+	 *
+	 **/
+	template<typename SkeinContext, typename HashType, uint32_t BITS>
+	class SKStream
+	{
+		/** The Skein state of the bytes written. **/
+		SkeinContext ctxSkein;
+
+
+		/** The serialization type. **/
+		uint32_t nSerType;
+
+
+		/** The serialization version. **/
+		uint32_t nSerVersion;
+
+
+		/* Skein functions for each width of state. */
+		static void init(Skein_256_Ctxt_t* ctx) { Skein_256_Init(ctx, BITS); }
+		static void init(Skein_512_Ctxt_t* ctx) { Skein_512_Init(ctx, BITS); }
+		static void init(Skein1024_Ctxt_t* ctx) { Skein1024_Init(ctx, BITS); }
+
+		static void update(Skein_256_Ctxt_t* ctx, const uint8_t* pch, size_t nSize) { Skein_256_Update(ctx, pch, nSize); }
+		static void update(Skein_512_Ctxt_t* ctx, const uint8_t* pch, size_t nSize) { Skein_512_Update(ctx, pch, nSize); }
+		static void update(Skein1024_Ctxt_t* ctx, const uint8_t* pch, size_t nSize) { Skein1024_Update(ctx, pch, nSize); }
+
+		static void finalize(Skein_256_Ctxt_t* ctx, uint8_t* pch) { Skein_256_Final(ctx, pch); }
+		static void finalize(Skein_512_Ctxt_t* ctx, uint8_t* pch) { Skein_512_Final(ctx, pch); }
+		static void finalize(Skein1024_Ctxt_t* ctx, uint8_t* pch) { Skein1024_Final(ctx, pch); }
+
+	public:
+
+		/** Constructor. **/
+		SKStream(const uint32_t nSerTypeIn, const uint32_t nSerVersionIn)
+		: ctxSkein    ( )
+		, nSerType    (nSerTypeIn)
+		, nSerVersion (nSerVersionIn)
+		{
+			init(&ctxSkein);
+		}
+
+
+		/** write
+		 *
+		 *  Add bytes to the hash.
+		 *
+		 *  @param[in] pch The bytes to add.
+		 *  @param[in] nSize The number of bytes.
+		 *
+		 **/
+		SKStream& write(const char* pch, const uint64_t nSize)
+		{
+			update(&ctxSkein, (const uint8_t*)pch, nSize);
+
+			return *this;
+		}
+
+
+		/** Operator Overload <<
+		 *
+		 *  Serialize an object into the hash.
+		 *
+		 **/
+		template<typename Type>
+		SKStream& operator<<(const Type& obj)
 		{
-			uint1024_t hashSkein;
-			Skein1024_Ctxt_t ctxSkein;
-			Skein1024_Init(&ctxSkein, 1024);
-			Skein1024_Update(&ctxSkein, (pbegin == pend ? pblank : (uint8_t*)&pbegin[0]), (pend - pbegin) * sizeof(pbegin[0]));
-			Skein1024_Final(&ctxSkein, (uint8_t *)&hashSkein);
+			::Serialize(*this, obj, nSerType, nSerVersion);
 
+			return *this;
+		}
+
+
+		/** GetHash
+		 *
+		 *  Get the hash of the bytes written.
+		 *
+		 **/
+		HashType GetHash()
+		{
+			HashType hashSkein = 0;
+			finalize(&ctxSkein, (uint8_t *)&hashSkein);
+
+			HashType hashKeccak = 0;
 			Keccak_HashInstance ctxKeccak;
-			Keccak_HashInitialize(&ctxKeccak, 576, 1024, 1024, 0x05);
-			Keccak_HashUpdate(&ctxKeccak, (uint8_t *)&hashSkein, 1024);
+			switch(BITS)
+			{
+				case 64:
+					Keccak_HashInitialize(&ctxKeccak, 1344, 256, 64, 0x06);
+					break;
+
+				case 256:
+					Keccak_HashInitialize_SHA3_256(&ctxKeccak);
+					break;
+
+				case 512:
+					Keccak_HashInitialize_SHA3_512(&ctxKeccak);
+					break;
+
+				default:
+					Keccak_HashInitialize(&ctxKeccak, 576, 1024, 1024, 0x05);
+					break;
+			}
+			Keccak_HashUpdate(&ctxKeccak, (uint8_t *)&hashSkein, BITS);
 			Keccak_HashFinal(&ctxKeccak, (uint8_t *)&hashKeccak);
 
-			/* Cache the hashed value */
-			cache1024.Put(vData, hashKeccak);
+			return hashKeccak;
 		}
+	};
 
-		return hashKeccak;
-	}
+
+	/** Streaming versions of SK64, SK256, SK512 and SK1024. **/
+	typedef SKStream<Skein_256_Ctxt_t, uint64_t,   64>   SK64Stream;
+	typedef SKStream<Skein_256_Ctxt_t, uint256_t,  256>  SK256Stream;
+	typedef SKStream<Skein_512_Ctxt_t, uint512_t,  512>  SK512Stream;
+	typedef SKStream<Skein1024_Ctxt_t, uint1024_t, 1024> SK1024Stream;
 }
 
 #endif
@@ -0,0 +1,396 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+____________________________________________________________________________________________*/
+
+#include <LLD/cache/binary_2q.h>
+#include <LLD/templates/key.h>
+#include <LLD/hash/xxh3.h>
+
+#include <Util/include/mutex.h>
+
+#include <algorithm>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace LLD
+{
+    /* The memory of a hashmap entry of a node, its hash table node and bucket. */
+    const uint32_t MAP_ENTRY_SIZE = 48;
+
+
+    /* The memory of a ghost key, its queue entry, hash set node and bucket. */
+    const uint32_t GHOST_ENTRY_SIZE = 48;
+
+
+    /*  Node to hold the binary data of a queue. */
+    struct Binary2QNode
+    {
+        /** Linked list pointers. **/
+        Binary2QNode* pprev;
+        Binary2QNode* pnext;
+
+        /** The 64-bit hash of the key. **/
+        uint64_t hashKey;
+
+        /** The binary data of the key, to tell apart keys with the same hash. **/
+        std::vector<uint8_t> vKey;
+
+        /** The data in the binary node. **/
+        std::vector<uint8_t> vData;
+
+        /** True if the node is in the hot queue, false if in probation. **/
+        bool fHot;
+
+        /** Default constructor **/
+        Binary2QNode(const uint64_t hashKeyIn, const std::vector<uint8_t>& vKeyIn, const std::vector<uint8_t>& vDataIn, const bool fHotIn)
+        : pprev   (nullptr)
+        , pnext   (nullptr)
+        , hashKey (hashKeyIn)
+        , vKey    (vKeyIn)
+        , vData   (vDataIn)
+        , fHot    (fHotIn)
+        {
+        }
+
+        /** The memory this node accounts for in the cache. **/
+        uint32_t Size() const
+        {
+            return static_cast<uint32_t>(sizeof(Binary2QNode) + MAP_ENTRY_SIZE + vKey.size() + vData.size());
+        }
+    };
+
+
+    /*  Double linked list of nodes, most recent in front. */
+    struct Binary2QList
+    {
+        /** Keep track of the first and last object in linked list. **/
+        Binary2QNode* pfirst;
+        Binary2QNode* plast;
+
+        /** The memory of the nodes in the list. **/
+        uint32_t nSize;
+
+        /** Default constructor **/
+        Binary2QList()
+        : pfirst (nullptr)
+        , plast  (nullptr)
+        , nSize  (0)
+        {
+        }
+
+        /** Link a node to the front of the list. **/
+        void push_front(Binary2QNode* pthis)
+        {
+            pthis->pprev = nullptr;
+            pthis->pnext = pfirst;
+
+            if(pfirst)
+                pfirst->pprev = pthis;
+            else
+                plast = pthis;
+
+            pfirst = pthis;
+            nSize += pthis->Size();
+        }
+
+        /** Unlink a node from the list. **/
+        void remove(Binary2QNode* pthis)
+        {
+            if(pthis->pprev)
+                pthis->pprev->pnext = pthis->pnext;
+            else
+                pfirst = pthis->pnext;
+
+            if(pthis->pnext)
+                pthis->pnext->pprev = pthis->pprev;
+            else
+                plast = pthis->pprev;
+
+            pthis->pprev = nullptr;
+            pthis->pnext = nullptr;
+
+            nSize -= pthis->Size();
+        }
+    };
+
+
+    /*  One independently locked shard of the cache. */
+    struct Binary2QShard
+    {
+        /** Mutex for thread concurrency. **/
+        std::mutex MUTEX;
+
+        /** Map of the current holding data by hash of key. **/
+        std::unordered_map<uint64_t, Binary2QNode*> mapNodes;
+
+        /** The probation queue, first in first out. **/
+        Binary2QList lstProbation;
+
+        /** The hot queue, least recently used evicted first. **/
+        Binary2QList lstHot;
+
+        /** The hashes of the keys most recently evicted from probation. **/
+        std::deque<uint64_t> queueGhost;
+        std::unordered_set<uint64_t> setGhost;
+
+        /** The memory used by the shard. **/
+        uint64_t Size() const
+        {
+            return lstProbation.nSize + lstHot.nSize + queueGhost.size() * GHOST_ENTRY_SIZE;
+        }
+    };
+
+
+    /** Cache Size Constructor **/
+    Binary2Q::Binary2Q(const uint32_t nCacheSizeIn, const uint32_t nShardsIn)
+    : MAX_SHARD_SIZE     (nCacheSizeIn / std::max(nShardsIn, 1u))
+    , MAX_PROBATION_SIZE (MAX_SHARD_SIZE / 4)
+    , vShards            ( )
+    , nHits              (0)
+    , nMisses            (0)
+    , nEvictions         (0)
+    {
+        for(uint32_t n = 0; n < std::max(nShardsIn, 1u); ++n)
+            vShards.push_back(new Binary2QShard());
+    }
+
+
+    /** Class Destructor. **/
+    Binary2Q::~Binary2Q()
+    {
+        for(auto& pshard : vShards)
+        {
+            {
+                LOCK(pshard->MUTEX);
+
+                /* Free every node in the shard. */
+                for(auto& item : pshard->mapNodes)
+                    delete item.second;
+            }
+
+            delete pshard;
+        }
+    }
+
+
+    /*  Check if data exists. */
+    bool Binary2Q::Has(const std::vector<uint8_t>& vKey) const
+    {
+        const uint64_t hashKey = XXH64(&vKey[0], vKey.size(), 0);
+
+        Binary2QShard* pshard = shard(hashKey);
+        LOCK(pshard->MUTEX);
+
+        /* Check the key is cached. */
+        auto it = pshard->mapNodes.find(hashKey);
+        if(it == pshard->mapNodes.end())
+            return false;
+
+        return it->second->vKey == vKey;
+    }
+
+
+    /*  Get the data by index */
+    bool Binary2Q::Get(const std::vector<uint8_t>& vKey, std::vector<uint8_t>& vData)
+    {
+        const uint64_t hashKey = XXH64(&vKey[0], vKey.size(), 0);
+
+        Binary2QShard* pshard = shard(hashKey);
+        LOCK(pshard->MUTEX);
+
+        /* Check the key is cached. */
+        auto it = pshard->mapNodes.find(hashKey);
+        if(it == pshard->mapNodes.end() || it->second->vKey != vKey)
+        {
+            ++nMisses;
+            return false;
+        }
+
+        /* Get the data. */
+        Binary2QNode* pthis = it->second;
+        vData = pthis->vData;
+        ++nHits;
+
+        /* Hot records move to front, probation keeps its order so a burst of reads doesn't promote a record. */
+        if(pthis->fHot && pthis != pshard->lstHot.pfirst)
+        {
+            pshard->lstHot.remove(pthis);
+            pshard->lstHot.push_front(pthis);
+        }
+
+        return true;
+    }
+
+
+    /*  Add data in the Pool. */
+    void Binary2Q::Put(const SectorKey& key, const std::vector<uint8_t>& vKey, const std::vector<uint8_t>& vData, bool fReserve)
+    {
+        const uint64_t hashKey = XXH64(&vKey[0], vKey.size(), 0);
+
+        Binary2QShard* pshard = shard(hashKey);
+        LOCK(pshard->MUTEX);
+
+        /* Replace the data of a cached key in place. */
+        auto it = pshard->mapNodes.find(hashKey);
+        if(it != pshard->mapNodes.end())
+        {
+            Binary2QNode* pthis = it->second;
+            Binary2QList& lst   = pthis->fHot ? pshard->lstHot : pshard->lstProbation;
+
+            /* A write is a use of the record, so hot records move to front. Probation keeps its order. */
+            if(pthis->fHot)
+                lst.remove(pthis);
+            else
+                lst.nSize -= pthis->Size();
+
+            pthis->vKey  = vKey;
+            pthis->vData = vData;
+
+            if(pthis->fHot)
+                lst.push_front(pthis);
+            else
+                lst.nSize += pthis->Size();
+        }
+        else
+        {
+            /* A key evicted from probation not long ago is in use, promote it. */
+            const bool fHot = (pshard->setGhost.erase(hashKey) > 0);
+
+            Binary2QNode* pthis = new Binary2QNode(hashKey, vKey, vData, fHot);
+            pshard->mapNodes[hashKey] = pthis;
+
+            if(fHot)
+                pshard->lstHot.push_front(pthis);
+            else
+                pshard->lstProbation.push_front(pthis);
+        }
+
+        /* Remove the last nodes if cache too large. */
+        evict(pshard);
+    }
+
+
+    /*  Reserve this item in the cache permanently if true, unreserve if false. */
+    void Binary2Q::Reserve(const std::vector<uint8_t>& vKey, bool fReserve)
+    {
+    }
+
+
+    /*  Force Remove Object by Index. */
+    bool Binary2Q::Remove(const std::vector<uint8_t>& vKey)
+    {
+        const uint64_t hashKey = XXH64(&vKey[0], vKey.size(), 0);
+
+        Binary2QShard* pshard = shard(hashKey);
+        LOCK(pshard->MUTEX);
+
+        /* Check the key is cached. */
+        auto it = pshard->mapNodes.find(hashKey);
+        if(it == pshard->mapNodes.end() || it->second->vKey != vKey)
+            return false;
+
+        /* Unlink from its queue. */
+        Binary2QNode* pthis = it->second;
+        if(pthis->fHot)
+            pshard->lstHot.remove(pthis);
+        else
+            pshard->lstProbation.remove(pthis);
+
+        /* Free the memory. */
+        pshard->mapNodes.erase(it);
+        delete pthis;
+
+        return true;
+    }
+
+
+    /*  Change the maximum size of the cache, evicting records if it shrinks. */
+    void Binary2Q::Resize(const uint32_t nCacheSizeIn)
+    {
+        MAX_SHARD_SIZE     = nCacheSizeIn / static_cast<uint32_t>(vShards.size());
+        MAX_PROBATION_SIZE = MAX_SHARD_SIZE.load() / 4;
+
+        /* Evict each shard down to its new size. */
+        for(auto& pshard : vShards)
+        {
+            LOCK(pshard->MUTEX);
+            evict(pshard);
+        }
+    }
+
+
+    /*  Get the statistics of the cache. */
+    CacheStats Binary2Q::Stats() const
+    {
+        CacheStats stats;
+        stats.nHits      = nHits.load();
+        stats.nMisses    = nMisses.load();
+        stats.nEvictions = nEvictions.load();
+        stats.nMaxBytes  = uint64_t(MAX_SHARD_SIZE.load()) * vShards.size();
+
+        /* Add up the memory of the shards. */
+        for(const auto& pshard : vShards)
+        {
+            LOCK(pshard->MUTEX);
+            stats.nBytes += pshard->Size();
+        }
+
+        return stats;
+    }
+
+
+    /*  Find the shard holding a key. */
+    Binary2QShard* Binary2Q::shard(const uint64_t hashKey) const
+    {
+        return vShards[(hashKey >> 32) % vShards.size()];
+    }
+
+
+    /*  Evict records from a shard until it fits its size. */
+    void Binary2Q::evict(Binary2QShard* pshard)
+    {
+        while(pshard->Size() > MAX_SHARD_SIZE.load())
+        {
+            /* Evict from probation while it is over its share, or if there are no hot records. */
+            Binary2QNode* pnode = nullptr;
+            if(pshard->lstProbation.plast && (pshard->lstProbation.nSize > MAX_PROBATION_SIZE.load() || !pshard->lstHot.plast))
+            {
+                pnode = pshard->lstProbation.plast;
+                pshard->lstProbation.remove(pnode);
+
+                /* Remember the key to promote it if it comes back. */
+                pshard->queueGhost.push_back(pnode->hashKey);
+                pshard->setGhost.insert(pnode->hashKey);
+
+                /* Remember twice as many evicted keys as there are records cached, a hash costs far less than a record. */
+                const uint64_t nGhosts = std::max<uint64_t>(pshard->mapNodes.size() * 2, 64);
+                while(pshard->queueGhost.size() > nGhosts)
+                {
+                    pshard->setGhost.erase(pshard->queueGhost.front());
+                    pshard->queueGhost.pop_front();
+                }
+            }
+            else if(pshard->lstHot.plast)
+            {
+                pnode = pshard->lstHot.plast;
+                pshard->lstHot.remove(pnode);
+            }
+            else
+                break;
+
+            pshard->mapNodes.erase(pnode->hashKey);
+            delete pnode;
+
+            ++nEvictions;
+        }
+    }
+}
@@ -81,12 +81,15 @@ namespace LLD
     BinaryLRU::BinaryLRU(const uint32_t nCacheSizeIn)
     : MAX_CACHE_SIZE    (nCacheSizeIn)
     , MAX_CACHE_BUCKETS (nCacheSizeIn / 128)
-    , nCurrentSize      (MAX_CACHE_BUCKETS * 16)
+    , nCurrentSize      (MAX_CACHE_BUCKETS * (sizeof(BinaryNode*) + sizeof(uint64_t)))
     , MUTEX             ( )
     , hashmap           (MAX_CACHE_BUCKETS, nullptr)
     , indexes           (MAX_CACHE_BUCKETS, 0)
     , pfirst            (nullptr)
     , plast             (nullptr)
+    , nHits             (0)
+    , nMisses           (0)
+    , nEvictions        (0)
     {
     }
 
@@ -145,12 +148,16 @@ namespace LLD
         /* Check for data. */
         uint64_t& nIndex  = indexes[bucket(vKey)];
         if(nIndex == 0)
+        {
+            ++nMisses;
             return false;
+        }
 
         /* Get the binary node. */
         BinaryNode* pthis = hashmap[slot(nIndex)];
         if(pthis == nullptr)
         {
+            ++nMisses;
             nIndex = 0; //reset by reference
             return false;
         }
@@ -158,16 +165,21 @@ namespace LLD
         /* Check for null state. */
         if(pthis->IsNull())
         {
+            ++nMisses;
             nIndex = 0; //reset by reference
             return false;
         }
 
         /* Check the keys are correct. */
         if(pthis->hashKey != XXH64(&vKey[0], vKey.size(), 0))
+        {
+            ++nMisses;
             return false;
+        }
 
         /* Get the data. */
         vData = pthis->vData;
+        ++nHits;
 
         /* Move to front of double linked list. */
         move_to_front(pthis);
@@ -233,36 +245,11 @@ namespace LLD
             nCurrentSize += sizeof(*hashmap[nSlot]);
         }
 
-        /* Remove the last node if cache too large. */
-        while(nCurrentSize > MAX_CACHE_SIZE)
-        {
-            /* Get last pointer. */
-            BinaryNode* pnode = plast;
-            if(!pnode || pnode->IsNull())
-                break;
-
-            /* Set the new links. */
-            plast = plast->pprev;
-            if (plast)
-                plast->pnext = nullptr;
-
-            /* Reset the memory linking. */
-            pnode->pprev = nullptr;
-            pnode->pnext = nullptr;
-
-            /* Reduce memory size. */
-            nCurrentSize -= static_cast<uint32_t>(pnode->vData.size());
-
-            /* Calculate the buckets for the node being deleted */
-            uint32_t  nBucket = pnode->Bucket(MAX_CACHE_BUCKETS);
-            uint64_t& nRemove = indexes[nBucket];
-
-            /* Reset the slot. */
-            hashmap[slot(nRemove)]->SetNull();
-            nRemove                = 0;
-        }
-
+        /* Account for the new data before making room for it. */
         nCurrentSize += static_cast<uint32_t>(vData.size());
+
+        /* Remove the last node if cache too large. */
+        evict();
     }
 
 
@@ -290,21 +277,91 @@ namespace LLD
             return false;
         }
 
-        /* Remove from the linked list. */
+        /* Check the node holds this key and not one it collided with. */
         BinaryNode* pthis = hashmap[nSlot];
-        remove_node(pthis);
+        if(pthis->IsNull() || pthis->hashKey != XXH64(&vKey[0], vKey.size(), 0))
+            return false;
 
-        /* Set to null state. */
-        hashmap[nSlot]->SetNull();
+        /* Remove from the linked list. */
+        remove_node(pthis);
 
-        /* Free the memory. */
-        nCurrentSize  -= static_cast<uint32_t>(pthis->vData.size() + 48);
+        /* Free the memory, the node itself is kept for reuse by its slot. */
+        nCurrentSize  -= static_cast<uint32_t>(pthis->vData.size());
         nIndex         = 0; //reset by reference
 
+        /* Set to null state. */
+        pthis->SetNull();
+
         return true;
     }
 
 
+    /*  Change the maximum size of the cache, evicting records if it shrinks. */
+    void BinaryLRU::Resize(const uint32_t nCacheSizeIn)
+    {
+        LOCK(MUTEX);
+
+        MAX_CACHE_SIZE = nCacheSizeIn;
+        evict();
+    }
+
+
+    /*  Get the statistics of the cache. */
+    CacheStats BinaryLRU::Stats() const
+    {
+        LOCK(MUTEX);
+
+        CacheStats stats;
+        stats.nHits      = nHits.load();
+        stats.nMisses    = nMisses.load();
+        stats.nEvictions = nEvictions.load();
+        stats.nBytes     = nCurrentSize;
+        stats.nMaxBytes  = MAX_CACHE_SIZE;
+
+        return stats;
+    }
+
+
+    /*  Remove the least recently used nodes until the cache fits its size. */
+    void BinaryLRU::evict()
+    {
+        while(nCurrentSize > MAX_CACHE_SIZE)
+        {
+            /* Get last pointer. */
+            BinaryNode* pnode = plast;
+            if(!pnode || pnode->IsNull())
+                break;
+
+            /* Set the new links. */
+            plast = plast->pprev;
+            if (plast)
+                plast->pnext = nullptr;
+            else
+                pfirst = nullptr;
+
+            /* Reset the memory linking. */
+            pnode->pprev = nullptr;
+            pnode->pnext = nullptr;
+
+            /* Reduce memory size. */
+            nCurrentSize -= static_cast<uint32_t>(pnode->vData.size());
+
+            /* Calculate the buckets for the node being deleted */
+            uint32_t  nBucket = pnode->Bucket(MAX_CACHE_BUCKETS);
+            uint64_t& nRemove = indexes[nBucket];
+
+            /* Reset the index unless another key has taken its bucket since. */
+            if(nRemove != 0 && hashmap[slot(nRemove)] == pnode)
+                nRemove = 0;
+
+            /* Reset the node. */
+            pnode->SetNull();
+
+            ++nEvictions;
+        }
+    }
+
+
     /*  Find a bucket for checksum key management. */
     uint32_t BinaryLRU::slot(const uint64_t nIndex) const
     {
@@ -0,0 +1,180 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLD/cache/bloom.h>
+#include <LLD/hash/xxh3.h>
+
+#include <algorithm>
+#include <istream>
+#include <ostream>
+
+namespace LLD
+{
+
+    /* Default Constructor. */
+    BloomFilter::BloomFilter()
+    : vBits   (1)
+    , nHashes (1)
+    {
+    }
+
+
+    /* Capacity Constructor. */
+    BloomFilter::BloomFilter(const uint64_t nElements, const uint8_t nBitsPerElement, const uint8_t nHashesIn)
+    : vBits   (std::max(uint64_t(1), (nElements * nBitsPerElement + 63) / 64))
+    , nHashes (nHashesIn > 0 ? nHashesIn : OptimalHashes(nBitsPerElement))
+    {
+    }
+
+
+    /* Copy Constructor */
+    BloomFilter::BloomFilter(const BloomFilter& filter)
+    : vBits   (filter.vBits.size())
+    , nHashes (filter.nHashes)
+    {
+        for(uint64_t i = 0; i < vBits.size(); ++i)
+            vBits[i].store(filter.vBits[i].load());
+    }
+
+
+    /* Move Constructor */
+    BloomFilter::BloomFilter(BloomFilter&& filter) noexcept
+    : vBits   (std::move(filter.vBits))
+    , nHashes (filter.nHashes)
+    {
+    }
+
+
+    /* Copy Assignment Operator */
+    BloomFilter& BloomFilter::operator=(const BloomFilter& filter)
+    {
+        std::vector< std::atomic<uint64_t> >(filter.vBits.size()).swap(vBits);
+        for(uint64_t i = 0; i < vBits.size(); ++i)
+            vBits[i].store(filter.vBits[i].load());
+
+        nHashes = filter.nHashes;
+
+        return *this;
+    }
+
+
+    /* Move Assignment Operator */
+    BloomFilter& BloomFilter::operator=(BloomFilter&& filter) noexcept
+    {
+        vBits   = std::move(filter.vBits);
+        nHashes = filter.nHashes;
+
+        return *this;
+    }
+
+
+    /* Get the number of hash functions with the lowest false positive rate. */
+    uint8_t BloomFilter::OptimalHashes(const uint8_t nBitsPerElement)
+    {
+        /* k = m/n * ln 2, rounded down so 8 bits per element keeps its 5 hashes. */
+        return static_cast<uint8_t>(std::max(1u, (nBitsPerElement * 693u) / 1000u));
+    }
+
+
+    /* Add a key to the filter. */
+    void BloomFilter::Insert(const std::vector<uint8_t>& vKey)
+    {
+        /* Use double hashing to derive each bit position from two base hashes. */
+        const uint64_t nBits  = vBits.size() * 64;
+        const uint64_t nHash1 = XXH64(&vKey[0], vKey.size(), 0);
+        const uint64_t nHash2 = XXH64(&vKey[0], vKey.size(), nHash1) | 1;
+
+        for(uint8_t i = 0; i < nHashes; ++i)
+        {
+            const uint64_t nBit = (nHash1 + i * nHash2) % nBits;
+            vBits[nBit / 64].fetch_or(uint64_t(1) << (nBit % 64), std::memory_order_relaxed);
+        }
+    }
+
+
+    /* Check if a key may be in the filter. */
+    bool BloomFilter::Contains(const std::vector<uint8_t>& vKey) const
+    {
+        /* Use double hashing to derive each bit position from two base hashes. */
+        const uint64_t nBits  = vBits.size() * 64;
+        const uint64_t nHash1 = XXH64(&vKey[0], vKey.size(), 0);
+        const uint64_t nHash2 = XXH64(&vKey[0], vKey.size(), nHash1) | 1;
+
+        for(uint8_t i = 0; i < nHashes; ++i)
+        {
+            const uint64_t nBit = (nHash1 + i * nHash2) % nBits;
+            if(!(vBits[nBit / 64].load(std::memory_order_relaxed) & (uint64_t(1) << (nBit % 64))))
+                return false;
+        }
+
+        return true;
+    }
+
+
+    /* Reset all bits in the filter. */
+    void BloomFilter::Clear()
+    {
+        for(auto& nWord : vBits)
+            nWord.store(0);
+    }
+
+
+    /* Get the size of the bit array in bytes. */
+    uint64_t BloomFilter::Bytes() const
+    {
+        return vBits.size() * 8;
+    }
+
+
+    /* Write the raw filter data to a binary stream. */
+    bool BloomFilter::Write(std::ostream& stream) const
+    {
+        /* Write the header so reads can validate the filter dimensions. */
+        const uint64_t nWords = vBits.size();
+        stream.write((char*)&nHashes, sizeof(nHashes));
+        stream.write((char*)&nWords,  sizeof(nWords));
+
+        /* Write the bit array. */
+        for(const auto& nWord : vBits)
+        {
+            const uint64_t nValue = nWord.load();
+            stream.write((char*)&nValue, sizeof(nValue));
+        }
+
+        return static_cast<bool>(stream);
+    }
+
+
+    /* Read the raw filter data from a binary stream. */
+    bool BloomFilter::Read(std::istream& stream)
+    {
+        /* Read the header. */
+        uint8_t  nHashesIn = 0;
+        uint64_t nWords    = 0;
+        stream.read((char*)&nHashesIn, sizeof(nHashesIn));
+        stream.read((char*)&nWords,    sizeof(nWords));
+
+        /* Check that the dimensions match this filter. */
+        if(!stream || nHashesIn != nHashes || nWords != vBits.size())
+            return false;
+
+        /* Read the bit array. */
+        std::vector<uint64_t> vWords(nWords, 0);
+        stream.read((char*)&vWords[0], Bytes());
+
+        for(uint64_t i = 0; i < nWords; ++i)
+            vBits[i].store(vWords[i]);
+
+        return static_cast<bool>(stream);
+    }
+}
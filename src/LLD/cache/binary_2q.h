@@ -0,0 +1,213 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+____________________________________________________________________________________________*/
+
+#pragma once
+#ifndef NEXUS_LLD_CACHE_BINARY_2Q_H
+#define NEXUS_LLD_CACHE_BINARY_2Q_H
+
+#include <LLD/cache/stats.h>
+
+#include <atomic>
+#include <mutex>
+#include <cstdint>
+#include <vector>
+
+
+namespace LLD
+{
+    class SectorKey;
+
+
+    /** Binary2QShard
+     *
+     *  One independently locked shard of the cache, holding its queues and hashmap.
+     *
+     **/
+    struct Binary2QShard;
+
+
+    /** Binary2Q
+    *
+    *   2Q - Two Queue cache, split into shards by the hash of the key.
+    *   This class is responsible for holding data that is partially processed.
+    *   This class has no types, all objects are in binary forms.
+    *
+    *   Each shard has its own lock, so lookups of different keys rarely contend.
+    *   New records enter a FIFO probation queue holding a quarter of the shard.
+    *   Records evicted from probation are remembered by hash in a ghost queue,
+    *   and only a record that is added again while remembered is promoted to the
+    *   hot LRU queue. A scan of records read once only cycles through probation,
+    *   leaving the hot records in place.
+    *
+    **/
+    class Binary2Q
+    {
+        /* The Maximum Size of each shard. */
+        std::atomic<uint32_t> MAX_SHARD_SIZE;
+
+
+        /* The Maximum Size of the probation queue of each shard. */
+        std::atomic<uint32_t> MAX_PROBATION_SIZE;
+
+
+        /* The shards of the cache. */
+        std::vector<Binary2QShard*> vShards;
+
+
+        /* The statistics counters. */
+        std::atomic<uint64_t> nHits;
+        std::atomic<uint64_t> nMisses;
+        std::atomic<uint64_t> nEvictions;
+
+
+    public:
+
+
+        /** Default Constructor. **/
+        Binary2Q()                                 = delete;
+
+
+        /** Copy Constructor. **/
+        Binary2Q(const Binary2Q& cache)            = delete;
+
+
+        /** Move Constructor. **/
+        Binary2Q(Binary2Q&& cache)                 = delete;
+
+
+        /** Copy assignment. **/
+        Binary2Q& operator=(const Binary2Q& cache) = delete;
+
+
+        /** Move assignment. **/
+        Binary2Q& operator=(Binary2Q&& cache)      = delete;
+
+
+        /** Class Destructor. **/
+        ~Binary2Q();
+
+
+        /** Cache Size Constructor
+         *
+         *  @param[in] nCacheSizeIn The maximum size of this Cache Pool
+         *  @param[in] nShardsIn The total shards to split the cache into.
+         *
+         **/
+        Binary2Q(const uint32_t nCacheSizeIn, const uint32_t nShardsIn = 16);
+
+
+        /** Has
+         *
+         *  Check if data exists.
+         *
+         *  @param[in] vKey The binary data of the key.
+         *
+         *  @return True/False whether pool contains data by index.
+         *
+         **/
+        bool Has(const std::vector<uint8_t>& vKey) const;
+
+
+        /** Get
+         *
+         *  Get the data by index
+         *
+         *  @param[in] vKey The binary data of the key.
+         *  @param[out] vData The binary data of the cached record.
+         *
+         *  @return True if object was found, false if none found by index.
+         *
+         **/
+        bool Get(const std::vector<uint8_t>& vKey, std::vector<uint8_t>& vData);
+
+
+        /** Put
+         *
+         *  Add data in the Pool
+         *
+         *  @param[in] key The sector key of the record.
+         *  @param[in] vKey The key in binary form.
+         *  @param[in] vData The input data in binary form.
+         *  @param[in] fReserve Flag for if item should be saved from cache eviction.
+         *
+         **/
+        void Put(const SectorKey& key, const std::vector<uint8_t>& vKey, const std::vector<uint8_t>& vData, bool fReserve = false);
+
+
+        /** Reserve
+         *
+         *  Reserve this item in the cache permanently if true, unreserve if false
+         *
+         *  @param[in] vKey The key to flag as reserved true/false
+         *  @param[in] fReserve If this object is to be reserved for disk.
+         *
+         **/
+        void Reserve(const std::vector<uint8_t>& vKey, bool fReserve = true);
+
+
+        /** Remove
+         *
+         *  Force Remove Object by Index
+         *
+         *  @param[in] vKey Binary Data of the Key
+         *
+         *  @return True on successful removal, false if it fails
+         *
+         **/
+        bool Remove(const std::vector<uint8_t>& vKey);
+
+
+        /** Resize
+         *
+         *  Change the maximum size of the cache, evicting records if it shrinks.
+         *
+         *  @param[in] nCacheSizeIn The new maximum size in bytes.
+         *
+         **/
+        void Resize(const uint32_t nCacheSizeIn);
+
+
+        /** Stats
+         *
+         *  Get the statistics of the cache.
+         *
+         *  @return The hits, misses, evictions and bytes of all shards.
+         *
+         **/
+        CacheStats Stats() const;
+
+
+    private:
+
+        /** Shard
+         *
+         *  Find the shard holding a key.
+         *
+         *  @param[in] hashKey The hash of the key.
+         *
+         **/
+        Binary2QShard* shard(const uint64_t hashKey) const;
+
+
+        /** Evict
+         *
+         *  Evict records from a shard until it fits its size.
+         *  Must be called holding the shard's lock.
+         *
+         *  @param[in] pshard The shard to evict from.
+         *
+         **/
+        void evict(Binary2QShard* pshard);
+    };
+}
+
+#endif
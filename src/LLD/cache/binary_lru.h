@@ -14,6 +14,9 @@ ________________________________________________________________________________
 #ifndef NEXUS_LLD_CACHE_BINARY_LRU_H
 #define NEXUS_LLD_CACHE_BINARY_LRU_H
 
+#include <LLD/cache/stats.h>
+
+#include <atomic>
 #include <mutex>
 #include <cstdint>
 #include <vector>
@@ -74,6 +77,12 @@ namespace LLD
         BinaryNode* plast;
 
 
+        /* The statistics counters. */
+        std::atomic<uint64_t> nHits;
+        std::atomic<uint64_t> nMisses;
+        std::atomic<uint64_t> nEvictions;
+
+
     public:
 
 
@@ -169,8 +178,38 @@ namespace LLD
         bool Remove(const std::vector<uint8_t>& vKey);
 
 
+        /** Resize
+         *
+         *  Change the maximum size of the cache, evicting records if it shrinks.
+         *  The buckets are fixed when the cache is created, so growing it adds collisions.
+         *
+         *  @param[in] nCacheSizeIn The new maximum size in bytes.
+         *
+         **/
+        void Resize(const uint32_t nCacheSizeIn);
+
+
+        /** Stats
+         *
+         *  Get the statistics of the cache.
+         *
+         *  @return The hits, misses, evictions and bytes of the cache.
+         *
+         **/
+        CacheStats Stats() const;
+
+
     private:
 
+        /** Evict
+         *
+         *  Remove the least recently used nodes until the cache fits its size.
+         *  Must be called holding MUTEX.
+         *
+         **/
+        void evict();
+
+
         /** RemoveNode
          *
          *  Remove a node from the double linked list.
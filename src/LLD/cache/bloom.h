@@ -0,0 +1,157 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#pragma once
+#ifndef NEXUS_LLD_CACHE_BLOOM_H
+#define NEXUS_LLD_CACHE_BLOOM_H
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include <iosfwd>
+
+namespace LLD
+{
+
+    /** BloomFilter
+     *
+     *  Probabilistic set membership used to skip disk probes for keys that are not
+     *  in a given keychain file. A negative answer is always correct, a positive
+     *  answer may be a false positive at the rate determined by bits per element.
+     *
+     *  Bits are set and tested atomically so concurrent inserts and lookups are
+     *  safe, but copying or reading a filter must not race with inserts.
+     *
+     **/
+    class BloomFilter
+    {
+        /* The bit array of the filter. */
+        std::vector< std::atomic<uint64_t> > vBits;
+
+
+        /* The total number of hash functions per element. */
+        uint8_t nHashes;
+
+
+    public:
+
+
+        /** Default Constructor. **/
+        BloomFilter();
+
+
+        /** Capacity Constructor
+         *
+         *  @param[in] nElements The expected number of elements in the filter.
+         *  @param[in] nBitsPerElement The bits of filter space per element.
+         *  @param[in] nHashesIn The number of hash functions per element, or 0 to use the
+         *                       optimal number for the bits per element.
+         *
+         **/
+        BloomFilter(const uint64_t nElements, const uint8_t nBitsPerElement = 8, const uint8_t nHashesIn = 0);
+
+
+        /** Copy Constructor **/
+        BloomFilter(const BloomFilter& filter);
+
+
+        /** Move Constructor **/
+        BloomFilter(BloomFilter&& filter) noexcept;
+
+
+        /** Copy Assignment Operator **/
+        BloomFilter& operator=(const BloomFilter& filter);
+
+
+        /** Move Assignment Operator **/
+        BloomFilter& operator=(BloomFilter&& filter) noexcept;
+
+
+        /** OptimalHashes
+         *
+         *  Get the number of hash functions with the lowest false positive rate for
+         *  the bits per element, which is the bits times ln 2.
+         *
+         *  @param[in] nBitsPerElement The bits of filter space per element.
+         *
+         *  @return The number of hash functions, at least one.
+         *
+         **/
+        static uint8_t OptimalHashes(const uint8_t nBitsPerElement);
+
+
+        /** Insert
+         *
+         *  Add a key to the filter.
+         *
+         *  @param[in] vKey The binary data of the key.
+         *
+         **/
+        void Insert(const std::vector<uint8_t>& vKey);
+
+
+        /** Contains
+         *
+         *  Check if a key may be in the filter.
+         *
+         *  @param[in] vKey The binary data of the key.
+         *
+         *  @return False if the key is definitely not in the filter.
+         *
+         **/
+        bool Contains(const std::vector<uint8_t>& vKey) const;
+
+
+        /** Clear
+         *
+         *  Reset all bits in the filter.
+         *
+         **/
+        void Clear();
+
+
+        /** Bytes
+         *
+         *  Get the size of the bit array in bytes.
+         *
+         **/
+        uint64_t Bytes() const;
+
+
+        /** Write
+         *
+         *  Write the raw filter data to a binary stream.
+         *
+         *  @param[in] stream The stream to write to.
+         *
+         *  @return True if the write succeeded.
+         *
+         **/
+        bool Write(std::ostream& stream) const;
+
+
+        /** Read
+         *
+         *  Read the raw filter data from a binary stream. The filter must have been
+         *  constructed with the same capacity it was written with.
+         *
+         *  @param[in] stream The stream to read from.
+         *
+         *  @return True if the read succeeded.
+         *
+         **/
+        bool Read(std::istream& stream);
+    };
+}
+
+#endif
@@ -0,0 +1,82 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+____________________________________________________________________________________________*/
+
+#pragma once
+#ifndef NEXUS_LLD_CACHE_STATS_H
+#define NEXUS_LLD_CACHE_STATS_H
+
+#include <cstdint>
+
+namespace LLD
+{
+
+    /** CacheStats
+     *
+     *  Statistics of a cache pool, counted since it was created.
+     *
+     **/
+    struct CacheStats
+    {
+        /** Lookups found in the cache. **/
+        uint64_t nHits;
+
+
+        /** Lookups not found in the cache. **/
+        uint64_t nMisses;
+
+
+        /** Records evicted to keep the cache in its size. **/
+        uint64_t nEvictions;
+
+
+        /** The memory used by the cache, including keys and node overhead. **/
+        uint64_t nBytes;
+
+
+        /** The maximum memory the cache may use. **/
+        uint64_t nMaxBytes;
+
+
+        /** Microseconds spent reading records from disk on cache misses, set by the database. **/
+        uint64_t nMissTime;
+
+
+        /** Default Constructor. **/
+        CacheStats()
+        : nHits      (0)
+        , nMisses    (0)
+        , nEvictions (0)
+        , nBytes     (0)
+        , nMaxBytes  (0)
+        , nMissTime  (0)
+        {
+        }
+
+
+        /** HitRate
+         *
+         *  Get the ratio of lookups found in the cache.
+         *
+         *  @return The hit rate from 0 to 1, 0 if there were no lookups.
+         *
+         **/
+        double HitRate() const
+        {
+            if(nHits + nMisses == 0)
+                return 0.0;
+
+            return double(nHits) / (nHits + nMisses);
+        }
+    };
+}
+
+#endif
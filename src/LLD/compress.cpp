@@ -0,0 +1,68 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLD/include/compress.h>
+#include <LLD/compress/lz4.h>
+
+#include <algorithm>
+
+namespace LLD
+{
+
+    /* Compress a sector record with LZ4, behind the compressed record header. */
+    bool CompressRecord(const std::vector<uint8_t>& vData, std::vector<uint8_t>& vRecord)
+    {
+        /* Small records don't have enough in them to be worth compressing. */
+        if(vData.size() < MIN_COMPRESS_SIZE || vData.size() > LZ4_MAX_INPUT_SIZE)
+            return false;
+
+        /* Write the header, the uncompressed size is little-endian. */
+        const uint32_t nSize = static_cast<uint32_t>(vData.size());
+
+        vRecord.resize(COMPRESSED_HEADER_SIZE + LZ4_compressBound(nSize));
+        vRecord[0] = COMPRESSED_RECORD;
+        std::copy((uint8_t*)&nSize, (uint8_t*)&nSize + 4, &vRecord[1]);
+
+        /* Compress the record, keeping it only if it got smaller. */
+        const int nCompressed = LZ4_compress_default((const char*)&vData[0], (char*)&vRecord[COMPRESSED_HEADER_SIZE],
+            nSize, static_cast<int>(vRecord.size() - COMPRESSED_HEADER_SIZE));
+
+        if(nCompressed <= 0 || COMPRESSED_HEADER_SIZE + nCompressed >= vData.size())
+            return false;
+
+        vRecord.resize(COMPRESSED_HEADER_SIZE + nCompressed);
+
+        return true;
+    }
+
+
+    /* Decompress a sector record written by CompressRecord. */
+    bool DecompressRecord(const uint8_t* pRecord, const uint64_t nSize, std::vector<uint8_t>& vData)
+    {
+        if(!IsCompressed(pRecord, nSize))
+            return false;
+
+        /* Read the uncompressed size, LZ4 can't expand data more than 255 times. */
+        uint32_t nOriginal = 0;
+        std::copy(pRecord + 1, pRecord + 5, (uint8_t*)&nOriginal);
+        if(nOriginal > LZ4_MAX_INPUT_SIZE || nOriginal > (nSize - COMPRESSED_HEADER_SIZE) * 255)
+            return false;
+
+        /* Decompress the record, checking that it fills the whole size. */
+        vData.resize(nOriginal);
+        const int nDecompressed = LZ4_decompress_safe((const char*)pRecord + COMPRESSED_HEADER_SIZE, (char*)vData.data(),
+            static_cast<int>(nSize - COMPRESSED_HEADER_SIZE), static_cast<int>(nOriginal));
+
+        return nDecompressed >= 0 && static_cast<uint32_t>(nDecompressed) == nOriginal;
+    }
+}
@@ -12,9 +12,15 @@
 ____________________________________________________________________________________________*/
 
 #include <LLD/include/global.h>
+#include <LLD/templates/journal.h>
 
 #include <TAO/Ledger/include/enum.h> //for internal flags
 
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <thread>
+
 namespace LLD
 {
     /* The LLD global instance pointers. */
@@ -29,49 +35,211 @@ namespace LLD
     LegacyDB*     Legacy;
 
 
+    /* The write-ahead log shared by all instances, null until recovery is done. */
+    Journal*      pJournal = nullptr;
+
+
+    /* Held from writing the log through applying the transactions, so checkpoints see whole commits.
+       This also makes commits run one at a time, which the single transaction of each database needs. */
+    std::mutex COMMIT_MUTEX;
+
+
+    /* The background keychain compaction thread. */
+    std::thread COMPACT_THREAD;
+
+
+    /* Set while the compaction thread is running. */
+    std::atomic<bool> fCompacting(false);
+
+
+    /* The background cache balancing thread. */
+    std::thread CACHE_THREAD;
+
+
+    /* Set to stop the cache balancing thread. */
+    std::atomic<bool> fCacheStop(false);
+
+
+    /* The memory shared by the contract, register, ledger and legacy caches, in bytes. */
+    uint64_t nCacheBudget = 0;
+
+
+    /* The smallest cache of each database, a quarter of its starting share. Contract, register, ledger, legacy. */
+    uint64_t nCacheFloor[4] = { 0, 0, 0, 0 };
+
+
+    /* The miss time of each database at the last balance. Contract, register, ledger, legacy. */
+    uint64_t nCacheMissTime[4] = { 0, 0, 0, 0 };
+
+
+    /* Get the path of the write-ahead log. */
+    std::string JournalPath()
+    {
+        return debug::safe_printstr(config::GetDataDir(), "journal.wal");
+    }
+
+
+    /* Replay a database's entry of a write-ahead log record if the name matches. */
+    template<typename DatabaseType>
+    bool Replay(DatabaseType* pDatabase, const std::string& strName, const std::vector<uint8_t>& vJournal)
+    {
+        /* Check that this entry belongs to this database. */
+        if(!pDatabase || pDatabase->GetName() != strName)
+            return false;
+
+        /* Apply the journal if it reached commit. */
+        if(pDatabase->TxnRecovery(vJournal))
+            pDatabase->TxnCommit();
+
+        pDatabase->TxnRelease();
+
+        return true;
+    }
+
+
+    /* Compact a database's keychain if the name matches, an empty name matches all databases. */
+    template<typename DatabaseType>
+    void CompactDB(DatabaseType* pDatabase, const std::string& strName)
+    {
+        if(!pDatabase || config::fShutdown.load())
+            return;
+
+        /* Match the name without its leading underscore, so _LEDGER is ledger. */
+        std::string strDatabase = pDatabase->GetName().substr(pDatabase->GetName().find_first_not_of('_'));
+        std::transform(strDatabase.begin(), strDatabase.end(), strDatabase.begin(), ::tolower);
+
+        if(!strName.empty() && strName != strDatabase)
+            return;
+
+        if(!pDatabase->Compact())
+            debug::error(FUNCTION, "failed to compact ", strDatabase, " keychain");
+    }
+
+
+    /* Move the cache budget toward the databases that spent the most time reading records their caches missed. */
+    void BalanceCaches()
+    {
+        const CacheStats stats[4] =
+        {
+            Contract->GetCacheStats(),
+            Register->GetCacheStats(),
+            Ledger->GetCacheStats(),
+            Legacy->GetCacheStats()
+        };
+
+        /* The cost of each cache is its miss time since the last balance. */
+        uint64_t nCost[4];
+        uint64_t nTotalCost = 0;
+        for(uint32_t n = 0; n < 4; ++n)
+        {
+            nCost[n]          = stats[n].nMissTime - nCacheMissTime[n];
+            nCacheMissTime[n] = stats[n].nMissTime;
+
+            nTotalCost += nCost[n];
+        }
+
+        /* Keep the caches as they are if nothing missed. */
+        if(nTotalCost == 0)
+            return;
+
+        /* Split the budget over the floors by cost, moving half way there so one busy interval doesn't empty a cache. */
+        uint64_t nSpare = nCacheBudget;
+        for(uint32_t n = 0; n < 4; ++n)
+            nSpare -= nCacheFloor[n];
+
+        uint32_t nSize[4];
+        for(uint32_t n = 0; n < 4; ++n)
+        {
+            const uint64_t nTarget = nCacheFloor[n] + static_cast<uint64_t>((double(nSpare) * nCost[n]) / nTotalCost);
+            nSize[n] = static_cast<uint32_t>(std::min<uint64_t>((stats[n].nMaxBytes + nTarget) / 2, std::numeric_limits<uint32_t>::max()));
+        }
+
+        Contract->SetCacheSize(nSize[0]);
+        Register->SetCacheSize(nSize[1]);
+        Ledger->SetCacheSize(nSize[2]);
+        Legacy->SetCacheSize(nSize[3]);
+
+        debug::log(2, FUNCTION, "Cache budget ", nCacheBudget / 1024, " Kb | ",
+            "Contract ", nSize[0] / 1024, " Kb | Register ", nSize[1] / 1024, " Kb | ",
+            "Ledger ", nSize[2] / 1024, " Kb | Legacy ", nSize[3] / 1024, " Kb");
+    }
+
+
     /*  Initialize the global LLD instances. */
     void Initialize()
     {
         debug::log(0, FUNCTION, "Initializing LLD");
 
+        /* Use memory mapped reads for sector and keychain files if enabled. */
+        uint8_t nFlagsMMAP = 0;
+        if(config::GetBoolArg("-lldmmap", false))
+        {
+            if(MemoryMap::Supported())
+                nFlagsMMAP = FLAGS::MMAP;
+            else
+                debug::log(0, FUNCTION, "-lldmmap is not supported on this platform, using file streams");
+        }
+
+        /* Reclaim the space of erased and resized records in the register and ledger databases if enabled. */
+        const uint8_t nFlagsCollect = config::GetBoolArg("-sectorgc", false) ? FLAGS::COLLECT : 0;
+
+        /* Compress the records of the ledger database if enabled. */
+        const uint8_t nFlagsCompress = config::GetBoolArg("-lldcompress", false) ? FLAGS::COMPRESS : 0;
+
+        /* The contract, register, ledger and legacy caches share one budget, split by their own sizes to start. */
+        const uint64_t nCacheShares[4] =
+        {
+            static_cast<uint64_t>(config::GetArg("-contractcache", 1)),
+            static_cast<uint64_t>(config::GetArg("-registercache", 2)),
+            static_cast<uint64_t>(config::GetArg("-ledgercache", 2)),
+            static_cast<uint64_t>(config::GetArg("-legacycache", 1))
+        };
+
+        /* The budget defaults to the sum of the cache sizes, in MB. */
+        const uint64_t nTotalShares = std::max<uint64_t>(nCacheShares[0] + nCacheShares[1] + nCacheShares[2] + nCacheShares[3], 1);
+        nCacheBudget = config::GetArg("-lldcache", nTotalShares) * 1024 * 1024;
+
+        uint32_t nCacheSize[4];
+        for(uint32_t n = 0; n < 4; ++n)
+        {
+            nCacheSize[n]  = static_cast<uint32_t>(std::min<uint64_t>((nCacheBudget * nCacheShares[n]) / nTotalShares, std::numeric_limits<uint32_t>::max()));
+            nCacheFloor[n] = nCacheSize[n] / 4;
+        }
+
         /* Create the contract database instance. */
-        uint32_t nContractCacheSize = config::GetArg("-contractcache", 1);
         Contract = new ContractDB(
-                        FLAGS::CREATE | FLAGS::FORCE,
+                        FLAGS::CREATE | FLAGS::FORCE | nFlagsMMAP,
                         77773,
-                        nContractCacheSize * 1024 * 1024);
+                        nCacheSize[0]);
 
         /* Create the contract database instance. */
-        uint32_t nRegisterCacheSize = config::GetArg("-registercache", 2);
         Register = new RegisterDB(
-                        FLAGS::CREATE | FLAGS::FORCE,
+                        FLAGS::CREATE | FLAGS::FORCE | nFlagsMMAP | nFlagsCollect,
                         77773,
-                        nRegisterCacheSize * 1024 * 1024);
+                        nCacheSize[1]);
 
         /* Create the ledger database instance. */
-        uint32_t nLedgerCacheSize = config::GetArg("-ledgercache", 2);
         Ledger    = new LedgerDB(
-                        FLAGS::CREATE | FLAGS::FORCE,
+                        FLAGS::CREATE | FLAGS::FORCE | nFlagsMMAP | nFlagsCollect | nFlagsCompress,
                         config::fClient.load() ? 77773 : (256 * 256 * 64),
-                        nLedgerCacheSize * 1024 * 1024);
+                        nCacheSize[2]);
 
 
         /* Create the legacy database instance. */
-        uint32_t nLegacyCacheSize = config::GetArg("-legacycache", 1);
         Legacy = new LegacyDB(
-                        FLAGS::CREATE | FLAGS::FORCE,
+                        FLAGS::CREATE | FLAGS::FORCE | nFlagsMMAP,
                         config::fClient.load() ? 77773 : 256 * 256 * 64,
-                        nLegacyCacheSize * 1024 * 1024);
+                        nCacheSize[3]);
 
 
         /* Create the trust database instance. */
         Trust  = new TrustDB(
-                        FLAGS::CREATE | FLAGS::FORCE);
+                        FLAGS::CREATE | FLAGS::FORCE | nFlagsMMAP);
 
 
         /* Create the local database instance. */
         Local    = new LocalDB(
-                        FLAGS::CREATE | FLAGS::FORCE);
+                        FLAGS::CREATE | FLAGS::FORCE | nFlagsMMAP);
         
 
         if(config::fClient.load())
@@ -84,6 +252,34 @@ namespace LLD
 
         /* Handle database recovery mode. */
         TxnRecovery();
+
+        /* Open the write-ahead log once recovery has replayed and cleared it. */
+        uint64_t nCheckpointSize = config::GetArg("-lldcheckpoint", 64);
+        pJournal = new Journal(JournalPath(), nCheckpointSize * 1024 * 1024, Checkpoint);
+
+        /* Compact the keychains in the background if requested. */
+        if(config::GetBoolArg("-compactlld", false))
+            Compact();
+
+        /* Rebalance the cache budget every -lldcacheinterval seconds. */
+        fCacheStop = false;
+        CACHE_THREAD = std::thread([]()
+        {
+            const uint64_t nInterval = config::GetArg("-lldcacheinterval", 60);
+
+            runtime::timer timer;
+            timer.Start();
+
+            while(!fCacheStop.load() && !config::fShutdown.load())
+            {
+                runtime::sleep(100);
+                if(timer.Elapsed() < nInterval)
+                    continue;
+
+                BalanceCaches();
+                timer.Reset();
+            }
+        });
     }
 
 
@@ -92,6 +288,25 @@ namespace LLD
     {
         debug::log(0, FUNCTION, "Shutting down LLD");
 
+        /* Wait for a running compaction, it stops early on shutdown. */
+        if(COMPACT_THREAD.joinable())
+            COMPACT_THREAD.join();
+
+        /* Stop balancing the caches before the databases are deleted. */
+        fCacheStop = true;
+        if(CACHE_THREAD.joinable())
+            CACHE_THREAD.join();
+
+        /* Sync the databases and close the write-ahead log. */
+        if(pJournal)
+        {
+            debug::log(2, FUNCTION, "Shutting down Journal");
+            Checkpoint();
+
+            delete pJournal;
+            pJournal = nullptr;
+        }
+
         /* Cleanup the contract database. */
         if(Contract)
         {
@@ -148,6 +363,39 @@ namespace LLD
     }
 
 
+    /* Compact the keychains of the global instances in the background. */
+    bool Compact(const std::string& strName)
+    {
+        /* Only run one compaction at a time. */
+        if(fCompacting.exchange(true))
+            return debug::error(FUNCTION, "keychain compaction is already running");
+
+        /* Clean up the thread of the last compaction. */
+        if(COMPACT_THREAD.joinable())
+            COMPACT_THREAD.join();
+
+        COMPACT_THREAD = std::thread([strName]()
+        {
+            runtime::timer timer;
+            timer.Start();
+
+            CompactDB(Contract, strName);
+            CompactDB(Register, strName);
+            CompactDB(Ledger,   strName);
+            CompactDB(Local,    strName);
+            CompactDB(Client,   strName);
+            CompactDB(Trust,    strName);
+            CompactDB(Legacy,   strName);
+
+            debug::log(0, FUNCTION, "keychain compaction finished in ", timer.Elapsed(), " seconds");
+
+            fCompacting = false;
+        });
+
+        return true;
+    }
+
+
     /* Check the transactions for recovery. */
     void TxnRecovery()
     {
@@ -218,6 +466,87 @@ namespace LLD
 
         /* Abort all the transactions. */
         TxnAbort();
+
+        /* Replay the write-ahead log in the order the records were committed. */
+        std::vector< std::vector<uint8_t> > vRecords;
+        if(Journal::Read(JournalPath(), vRecords) && !vRecords.empty())
+        {
+            debug::log(0, FUNCTION, "write-ahead log detected with ", vRecords.size(), " records, recovering...");
+
+            for(const auto& vRecord : vRecords)
+            {
+                /* Each record holds the journal of every database for one commit. */
+                const DataStream ssRecord(vRecord, SER_LLD, DATABASE_VERSION);
+                while(!ssRecord.End())
+                {
+                    std::string strName;
+                    std::vector<uint8_t> vJournal;
+                    ssRecord >> strName >> vJournal;
+
+                    /* Find the database the entry belongs to. */
+                    if(!Replay(Contract, strName, vJournal)
+                    && !Replay(Register, strName, vJournal)
+                    && !Replay(Ledger,   strName, vJournal)
+                    && !Replay(Local,    strName, vJournal)
+                    && !Replay(Client,   strName, vJournal)
+                    && !Replay(Trust,    strName, vJournal)
+                    && !Replay(Legacy,   strName, vJournal))
+                        debug::error(FUNCTION, "no database for write-ahead log entry ", strName);
+                }
+            }
+
+            /* Make the replayed data durable before the log is cleared. */
+            if(!Checkpoint())
+                debug::error(FUNCTION, "failed to sync databases after write-ahead log recovery");
+        }
+
+        /* Clear the write-ahead log. */
+        if(!pJournal)
+        {
+            std::ofstream stream(JournalPath(), std::ios::trunc);
+            stream.close();
+        }
+    }
+
+
+    /* Sync all LLD instances to disk and clear the write-ahead log. */
+    bool Checkpoint()
+    {
+        LOCK(COMMIT_MUTEX);
+
+        /* Sync the contract DB. */
+        if(Contract && !Contract->Sync())
+            return false;
+
+        /* Sync the register DB. */
+        if(Register && !Register->Sync())
+            return false;
+
+        /* Sync the ledger DB. */
+        if(Ledger && !Ledger->Sync())
+            return false;
+
+        /* Sync the local DB. */
+        if(Local && !Local->Sync())
+            return false;
+
+        /* Sync the client DB. */
+        if(Client && !Client->Sync())
+            return false;
+
+        /* Sync the trust DB. */
+        if(Trust && !Trust->Sync())
+            return false;
+
+        /* Sync the legacy DB. */
+        if(Legacy && !Legacy->Sync())
+            return false;
+
+        /* All committed data is on disk, the log can start over. */
+        if(pJournal && !pJournal->Clear())
+            return false;
+
+        return true;
     }
 
 
@@ -320,7 +649,7 @@ namespace LLD
 
 
     /* Global handler for all LLD instances. */
-    void TxnCommit(const uint8_t nFlags)
+    bool TxnCommit(const uint8_t nFlags)
     {
         /* Commit the contract DB transaction. */
         if(Contract)
@@ -336,35 +665,82 @@ namespace LLD
 
         /* Handle memory commits if in memory mode. */
         if(nFlags == TAO::Ledger::FLAGS::MEMPOOL)
-            return;
+            return true;
 
-        /* Set a checkpoint for contract DB. */
-        if(Contract)
-            Contract->TxnCheckpoint();
+        /* Hold off checkpoints until this commit is applied. */
+        LOCK(COMMIT_MUTEX);
 
-        /* Set a checkpoint for register DB. */
-        if(Register)
-            Register->TxnCheckpoint();
+        /* Write the journals of all databases as one log record with a single sync. */
+        if(pJournal)
+        {
+            DataStream ssJournal(SER_LLD, DATABASE_VERSION);
 
-        /* Set a checkpoint for ledger DB. */
-        if(Ledger)
-            Ledger->TxnCheckpoint();
+            /* Set a checkpoint for contract DB. */
+            if(Contract)
+                Contract->TxnCheckpoint(ssJournal);
 
-        /* Set a checkpoint for local DB. */
-        if(Local)
-            Local->TxnCheckpoint();
+            /* Set a checkpoint for register DB. */
+            if(Register)
+                Register->TxnCheckpoint(ssJournal);
 
-        /* Set a checkpoint for client DB. */
-        if(Client)
-            Client->TxnCheckpoint();
+            /* Set a checkpoint for ledger DB. */
+            if(Ledger)
+                Ledger->TxnCheckpoint(ssJournal);
 
-        /* Set a checkpoint for trust DB. */
-        if(Trust)
-            Trust->TxnCheckpoint();
+            /* Set a checkpoint for local DB. */
+            if(Local)
+                Local->TxnCheckpoint(ssJournal);
 
-        /* Set a checkpoint for legacy DB. */
-        if(Legacy)
-            Legacy->TxnCheckpoint();
+            /* Set a checkpoint for client DB. */
+            if(Client)
+                Client->TxnCheckpoint(ssJournal);
+
+            /* Set a checkpoint for trust DB. */
+            if(Trust)
+                Trust->TxnCheckpoint(ssJournal);
+
+            /* Set a checkpoint for legacy DB. */
+            if(Legacy)
+                Legacy->TxnCheckpoint(ssJournal);
+
+            /* The commit is durable once this returns, nothing can be applied if it isn't. */
+            if(!pJournal->Commit(ssJournal.Bytes()))
+            {
+                TxnAbort(nFlags);
+
+                return debug::error(FUNCTION, "failed to commit write-ahead log, transaction aborted");
+            }
+        }
+        else
+        {
+            /* Set a checkpoint for contract DB. */
+            if(Contract)
+                Contract->TxnCheckpoint();
+
+            /* Set a checkpoint for register DB. */
+            if(Register)
+                Register->TxnCheckpoint();
+
+            /* Set a checkpoint for ledger DB. */
+            if(Ledger)
+                Ledger->TxnCheckpoint();
+
+            /* Set a checkpoint for local DB. */
+            if(Local)
+                Local->TxnCheckpoint();
+
+            /* Set a checkpoint for client DB. */
+            if(Client)
+                Client->TxnCheckpoint();
+
+            /* Set a checkpoint for trust DB. */
+            if(Trust)
+                Trust->TxnCheckpoint();
+
+            /* Set a checkpoint for legacy DB. */
+            if(Legacy)
+                Legacy->TxnCheckpoint();
+        }
 
 
         /* Commit contract DB transaction. */
@@ -423,5 +799,7 @@ namespace LLD
         /* Abort the legacy DB transaction. */
         if(Legacy)
             Legacy->TxnRelease();
+
+        return true;
     }
 }
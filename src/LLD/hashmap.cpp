@@ -17,11 +17,15 @@ ________________________________________________________________________________
 #include <LLD/hash/xxh3.h>
 
 #include <Util/templates/datastream.h>
+#include <Util/include/args.h>
 #include <Util/include/filesystem.h>
 #include <Util/include/debug.h>
 #include <Util/include/hex.h>
+#include <Util/include/runtime.h>
 
+#include <algorithm>
 #include <iomanip>
+#include <limits>
 
 namespace LLD
 {
@@ -32,12 +36,22 @@ namespace LLD
     , strBaseLocation        (strBaseLocationIn)
     , fileCache              (new TemplateLRU<uint16_t, std::fstream*>(8))
     , pindex                 (nullptr)
+    , pKeychainMap           ((nFlagsIn & FLAGS::MMAP) ? new MemoryMap(strBaseLocationIn + "_hashmap.") : nullptr)
+    , pKeychainReader        (new FileReader(strBaseLocationIn + "_hashmap."))
     , hashmap                (nBucketsIn)
     , HASHMAP_TOTAL_BUCKETS  (nBucketsIn)
     , HASHMAP_MAX_KEY_SIZE   (32)
     , HASHMAP_KEY_ALLOCATION (static_cast<uint16_t>(HASHMAP_MAX_KEY_SIZE + 13))
     , nFlags                 (nFlagsIn)
     , RECORD_MUTEX           (1024)
+    , setCompact             ( )
+    , fCompacting            (false)
+    , vBloom                 ( )
+    , HASHMAP_BLOOM_BITS     (static_cast<uint8_t>(std::min(std::max(config::GetArg("-bloombits", 8), int64_t(0)), int64_t(32))))
+    , nBloomSkipped          (0)
+    , nBloomHits             (0)
+    , nBloomFalse            (0)
+    , pProbes                (nullptr)
     {
         Initialize();
     }
@@ -49,12 +63,22 @@ namespace LLD
     , strBaseLocation        (map.strBaseLocation)
     , fileCache              (map.fileCache)
     , pindex                 (map.pindex)
+    , pKeychainMap           ((map.nFlags & FLAGS::MMAP) ? new MemoryMap(map.strBaseLocation + "_hashmap.") : nullptr)
+    , pKeychainReader        (new FileReader(map.strBaseLocation + "_hashmap."))
     , hashmap                (map.hashmap)
     , HASHMAP_TOTAL_BUCKETS  (map.HASHMAP_TOTAL_BUCKETS)
     , HASHMAP_MAX_KEY_SIZE   (map.HASHMAP_MAX_KEY_SIZE)
     , HASHMAP_KEY_ALLOCATION (map.HASHMAP_KEY_ALLOCATION)
     , nFlags                 (map.nFlags)
     , RECORD_MUTEX           (map.RECORD_MUTEX.size())
+    , setCompact             ( )
+    , fCompacting            (false)
+    , vBloom                 (map.vBloom)
+    , HASHMAP_BLOOM_BITS     (map.HASHMAP_BLOOM_BITS)
+    , nBloomSkipped          (0)
+    , nBloomHits             (0)
+    , nBloomFalse            (0)
+    , pProbes                (map.pProbes)
     {
         Initialize();
     }
@@ -66,13 +90,26 @@ namespace LLD
     , strBaseLocation        (std::move(map.strBaseLocation))
     , fileCache              (std::move(map.fileCache))
     , pindex                 (std::move(map.pindex))
+    , pKeychainMap           (map.pKeychainMap)
+    , pKeychainReader        (map.pKeychainReader)
     , hashmap                (std::move(map.hashmap))
     , HASHMAP_TOTAL_BUCKETS  (std::move(map.HASHMAP_TOTAL_BUCKETS))
     , HASHMAP_MAX_KEY_SIZE   (std::move(map.HASHMAP_MAX_KEY_SIZE))
     , HASHMAP_KEY_ALLOCATION (std::move(map.HASHMAP_KEY_ALLOCATION))
     , nFlags                 (std::move(map.nFlags))
     , RECORD_MUTEX           (map.RECORD_MUTEX.size())
+    , setCompact             ( )
+    , fCompacting            (false)
+    , vBloom                 (std::move(map.vBloom))
+    , HASHMAP_BLOOM_BITS     (map.HASHMAP_BLOOM_BITS)
+    , nBloomSkipped          (0)
+    , nBloomHits             (0)
+    , nBloomFalse            (0)
+    , pProbes                (map.pProbes)
     {
+        map.pKeychainMap    = nullptr;
+        map.pKeychainReader = nullptr;
+
         Initialize();
     }
 
@@ -88,6 +125,19 @@ namespace LLD
         HASHMAP_MAX_KEY_SIZE   = map.HASHMAP_MAX_KEY_SIZE;
         HASHMAP_KEY_ALLOCATION = map.HASHMAP_KEY_ALLOCATION;
         nFlags                 = map.nFlags;
+        vBloom                 = map.vBloom;
+        HASHMAP_BLOOM_BITS     = map.HASHMAP_BLOOM_BITS;
+        pProbes                = map.pProbes;
+
+        if(pKeychainMap)
+            delete pKeychainMap;
+
+        pKeychainMap = (nFlags & FLAGS::MMAP) ? new MemoryMap(strBaseLocation + "_hashmap.") : nullptr;
+
+        if(pKeychainReader)
+            delete pKeychainReader;
+
+        pKeychainReader = new FileReader(strBaseLocation + "_hashmap.");
 
         Initialize();
 
@@ -106,6 +156,21 @@ namespace LLD
         HASHMAP_MAX_KEY_SIZE   = std::move(map.HASHMAP_MAX_KEY_SIZE);
         HASHMAP_KEY_ALLOCATION = std::move(map.HASHMAP_KEY_ALLOCATION);
         nFlags                 = std::move(map.nFlags);
+        vBloom                 = std::move(map.vBloom);
+        HASHMAP_BLOOM_BITS     = map.HASHMAP_BLOOM_BITS;
+        pProbes                = map.pProbes;
+
+        if(pKeychainMap)
+            delete pKeychainMap;
+
+        pKeychainMap     = map.pKeychainMap;
+        map.pKeychainMap = nullptr;
+
+        if(pKeychainReader)
+            delete pKeychainReader;
+
+        pKeychainReader     = map.pKeychainReader;
+        map.pKeychainReader = nullptr;
 
         Initialize();
 
@@ -116,11 +181,20 @@ namespace LLD
     /* Default Destructor */
     BinaryHashMap::~BinaryHashMap()
     {
+        /* Persist the bloom filters so they don't need to be rebuilt on next startup. */
+        bloom_save();
+
         if(fileCache)
             delete fileCache;
 
         if(pindex)
             delete pindex;
+
+        if(pKeychainMap)
+            delete pKeychainMap;
+
+        if(pKeychainReader)
+            delete pKeychainReader;
     }
 
 
@@ -162,6 +236,12 @@ namespace LLD
         if(!filesystem::exists(strBaseLocation) && filesystem::create_directories(strBaseLocation))
             debug::log(0, FUNCTION, "Generated Path ", strBaseLocation);
 
+        /* Finish a compaction swap interrupted by a crash, or clean up one that never reached it. */
+        if(!compact_finish())
+            debug::error(FUNCTION, "failed to finish compaction of ", strBaseLocation);
+
+        compact_clear();
+
         /* Build the hashmap indexes. */
         std::string index = debug::safe_printstr(strBaseLocation, "_hashmap.index");
         if(!filesystem::exists(index))
@@ -223,17 +303,25 @@ namespace LLD
 
         /* Load the stream object into the stream LRU cache. */
         fileCache->Put(0, new std::fstream(file, std::ios::in | std::ios::out | std::ios::binary));
+
+        /* Reserve a filter slot for every possible hashmap file so that adding a file never
+           moves the filters that concurrent readers are using. */
+        vBloom.reserve(std::numeric_limits<uint16_t>::max() + 1);
+
+        /* Load or rebuild the bloom filters. */
+        bloom_load();
     }
 
 
     /* Read a key index from the disk hashmaps. */
     bool BinaryHashMap::Get(const std::vector<uint8_t>& vKey, SectorKey &cKey)
     {
-        LOCK(KEY_MUTEX);
-
         /* Get the assigned bucket for the hashmap. */
         uint32_t nBucket = GetBucket(vKey);
 
+        /* Lock the stripe for this bucket so readers of other buckets don't contend. */
+        LOCK(RECORD_MUTEX[nBucket % RECORD_MUTEX.size()]);
+
         /* Get the file binary position. */
         uint32_t nFilePos = nBucket * HASHMAP_KEY_ALLOCATION;
 
@@ -246,31 +334,45 @@ namespace LLD
 
         /* Reverse iterate the linked file list from hashmap to get most recent keys first. */
         std::vector<uint8_t> vBucket(HASHMAP_KEY_ALLOCATION, 0);
+        uint32_t nProbes = 0;
         for(int16_t i = hashmap[nBucket] - 1; i >= 0; --i)
         {
-            /* Find the file stream for LRU cache. */
-            std::fstream *pstream;
-            if(!fileCache->Get(i, pstream))
+            /* Skip the disk probe if the bloom filter rules this file out. */
+            if(!bloom_check(i, vKeyCompressed))
+                continue;
+
+            ++nProbes;
+
+            /* Read the bucket from the mapped file if in MMAP mode, otherwise use a positional read. */
+            if((!pKeychainMap || !pKeychainMap->Read(i, nFilePos, &vBucket[0], vBucket.size()))
+                && !pKeychainReader->Read(i, nFilePos, &vBucket[0], vBucket.size()))
             {
-                /* Set the new stream pointer. */
-                std::string filename = debug::safe_printstr(strBaseLocation, "_hashmap.", std::setfill('0'), std::setw(5), i);
+                LOCK2(KEY_MUTEX);
 
-                pstream = new std::fstream(filename, std::ios::in | std::ios::out | std::ios::binary);
-                if(!pstream->is_open())
+                /* Find the file stream for LRU cache. */
+                std::fstream *pstream;
+                if(!fileCache->Get(i, pstream))
                 {
-                    delete pstream;
-                    continue;
-                }
+                    /* Set the new stream pointer. */
+                    std::string filename = debug::safe_printstr(strBaseLocation, "_hashmap.", std::setfill('0'), std::setw(5), i);
 
-                /* If file not found add to LRU cache. */
-                fileCache->Put(i, pstream);
-            }
+                    pstream = new std::fstream(filename, std::ios::in | std::ios::out | std::ios::binary);
+                    if(!pstream->is_open())
+                    {
+                        delete pstream;
+                        continue;
+                    }
 
-            /* Seek to the hashmap index in file. */
-            pstream->seekg(nFilePos, std::ios::beg);
+                    /* If file not found add to LRU cache. */
+                    fileCache->Put(i, pstream);
+                }
 
-            /* Read the bucket binary data from file stream */
-            pstream->read((char*) &vBucket[0], vBucket.size());
+                /* Seek to the hashmap index in file. */
+                pstream->seekg(nFilePos, std::ios::beg);
+
+                /* Read the bucket binary data from file stream */
+                pstream->read((char*) &vBucket[0], vBucket.size());
+            }
 
             /* Check if this bucket has the key */
             if(std::equal(vBucket.begin() + 13, vBucket.begin() + 13 + vKeyCompressed.size(), vKeyCompressed.begin()))
@@ -295,10 +397,25 @@ namespace LLD
                         " | Sector Start: ", cKey.nSectorStart, "\n",
                         HexStr(vKeyCompressed.begin(), vKeyCompressed.end(), true));
 
+                /* Count the bloom filter hit. */
+                if(HASHMAP_BLOOM_BITS > 0)
+                    ++nBloomHits;
+
+                if(pProbes)
+                    pProbes->Observe(nProbes);
+
                 return true;
             }
+
+            /* The bloom filter reported a key that wasn't in this file. */
+            if(HASHMAP_BLOOM_BITS > 0)
+                ++nBloomFalse;
         }
 
+        /* Count the probes of a key that wasn't found. */
+        if(pProbes)
+            pProbes->Observe(nProbes);
+
         return false;
     }
 
@@ -306,11 +423,17 @@ namespace LLD
     /* Write a key to the disk hashmaps. */
     bool BinaryHashMap::Put(const SectorKey& cKey)
     {
-        LOCK(KEY_MUTEX);
-
         /* Get the assigned bucket for the hashmap. */
         uint32_t nBucket = GetBucket(cKey.vKey);
 
+        /* Lock the bucket stripe first, then the keychain streams. */
+        LOCK(RECORD_MUTEX[nBucket % RECORD_MUTEX.size()]);
+        LOCK2(KEY_MUTEX);
+
+        /* Record the bucket for a running compaction to copy again. */
+        if(fCompacting)
+            setCompact.insert(nBucket);
+
         /* Get the file binary position. */
         uint32_t nFilePos = nBucket * HASHMAP_KEY_ALLOCATION;
 
@@ -385,6 +508,9 @@ namespace LLD
                     pstream->write((char*)&ssKey.Bytes()[0], ssKey.size());
                     pstream->flush();
 
+                    /* Add the key to this file's bloom filter. */
+                    bloom_insert(i, vKeyCompressed);
+
 
                     /* Debug Output of Sector Key Information. */
                     if(config::nVerbose >= 4)
@@ -450,6 +576,9 @@ namespace LLD
         pstream->write((char*)&ssKey.Bytes()[0], ssKey.size());
         pstream->flush();
 
+        /* Add the key to the new file's bloom filter. */
+        bloom_insert(hashmap[nBucket], vKeyCompressed);
+
         /* Seek to the index position. */
         pindex->seekp((nBucket * 2), std::ios::beg);
 
@@ -499,15 +628,49 @@ namespace LLD
     }
 
 
+    /* Sync the index and hashmap files to disk so the write-ahead log can be cleared. */
+    bool BinaryHashMap::Sync()
+    {
+        /* Push any buffered stream data to the operating system first. */
+        {
+            LOCK(KEY_MUTEX);
+            Flush();
+        }
+
+        /* Sync the index file. */
+        if(!filesystem::sync(debug::safe_printstr(strBaseLocation, "_hashmap.index")))
+            return debug::error(FUNCTION, "failed to sync hashmap index");
+
+        /* Sync every hashmap file in the linked list. */
+        for(uint32_t i = 0; ; ++i)
+        {
+            std::string file = debug::safe_printstr(strBaseLocation, "_hashmap.", std::setfill('0'), std::setw(5), i);
+            if(!filesystem::exists(file))
+                break;
+
+            if(!filesystem::sync(file))
+                return debug::error(FUNCTION, "failed to sync ", file);
+        }
+
+        return true;
+    }
+
+
     /*  Erase a key from the disk hashmaps.
      *  TODO: This should be optimized further. */
     bool BinaryHashMap::Erase(const std::vector<uint8_t> &vKey)
     {
-        LOCK(KEY_MUTEX);
-
         /* Get the assigned bucket for the hashmap. */
         uint32_t nBucket = GetBucket(vKey);
 
+        /* Lock the bucket stripe first, then the keychain streams. */
+        LOCK(RECORD_MUTEX[nBucket % RECORD_MUTEX.size()]);
+        LOCK2(KEY_MUTEX);
+
+        /* Record the bucket for a running compaction to copy again. */
+        if(fCompacting)
+            setCompact.insert(nBucket);
+
         /* Get the file binary position. */
         uint32_t nFilePos = nBucket * HASHMAP_KEY_ALLOCATION;
 
@@ -519,6 +682,10 @@ namespace LLD
         std::vector<uint8_t> vBucket(HASHMAP_KEY_ALLOCATION, 0);
         for(int16_t i = hashmap[nBucket] - 1; i >= 0; --i)
         {
+            /* Skip the disk probe if the bloom filter rules this file out. */
+            if(!bloom_check(i, vKeyCompressed))
+                continue;
+
             /* Find the file stream for LRU cache. */
             std::fstream* pstream;
             if(!fileCache->Get(i, pstream))
@@ -566,8 +733,16 @@ namespace LLD
                         " | Sector Start: ", cKey.nSectorStart,
                         " | Key: ", HexStr(vKeyCompressed.begin(), vKeyCompressed.end()));
 
+                /* Count the bloom filter hit. */
+                if(HASHMAP_BLOOM_BITS > 0)
+                    ++nBloomHits;
+
                 return true;
             }
+
+            /* The bloom filter reported a key that wasn't in this file. */
+            if(HASHMAP_BLOOM_BITS > 0)
+                ++nBloomFalse;
         }
 
         return false;
@@ -577,11 +752,17 @@ namespace LLD
     /* Restore an index in the hashmap if it is found. */
     bool BinaryHashMap::Restore(const std::vector<uint8_t> &vKey)
     {
-        LOCK(KEY_MUTEX);
-
         /* Get the assigned bucket for the hashmap. */
         uint32_t nBucket = GetBucket(vKey);
 
+        /* Lock the bucket stripe first, then the keychain streams. */
+        LOCK(RECORD_MUTEX[nBucket % RECORD_MUTEX.size()]);
+        LOCK2(KEY_MUTEX);
+
+        /* Record the bucket for a running compaction to copy again. */
+        if(fCompacting)
+            setCompact.insert(nBucket);
+
         /* Get the file binary position. */
         uint32_t nFilePos = nBucket * HASHMAP_KEY_ALLOCATION;
 
@@ -593,6 +774,10 @@ namespace LLD
         std::vector<uint8_t> vBucket(HASHMAP_KEY_ALLOCATION, 0);
         for(int16_t i = hashmap[nBucket] - 1; i >= 0; --i)
         {
+            /* Skip the disk probe if the bloom filter rules this file out. */
+            if(!bloom_check(i, vKeyCompressed))
+                continue;
+
             /* Find the file stream for LRU cache. */
             std::fstream* pstream;
             if(!fileCache->Get(i, pstream))
@@ -644,10 +829,738 @@ namespace LLD
                         " | Sector Start: ", cKey.nSectorStart,
                         " | Key: ", HexStr(vKeyCompressed.begin(), vKeyCompressed.end()));
 
+                /* Count the bloom filter hit. */
+                if(HASHMAP_BLOOM_BITS > 0)
+                    ++nBloomHits;
+
                 return true;
             }
+
+            /* The bloom filter reported a key that wasn't in this file. */
+            if(HASHMAP_BLOOM_BITS > 0)
+                ++nBloomFalse;
         }
 
         return false;
     }
+
+
+    /* Get the bloom filter statistics for the LLD meters and reset the counters. */
+    std::string BinaryHashMap::Meter()
+    {
+        /* There is nothing to count with the filters disabled. */
+        if(HASHMAP_BLOOM_BITS == 0)
+            return "Bloom Disabled";
+
+        /* Grab the counters and reset them for the next meter period. */
+        const uint64_t nSkipped = nBloomSkipped.exchange(0);
+        const uint64_t nHits    = nBloomHits.exchange(0);
+        const uint64_t nFalse   = nBloomFalse.exchange(0);
+
+        /* Calculate the false positive rate of the probes that did touch the disk. */
+        const double dFalseRate = (nHits + nFalse) > 0 ? (100.0 * nFalse) / (nHits + nFalse) : 0.0;
+
+        return debug::safe_printstr(
+            "Bloom Skipped ", nSkipped, " | ",
+            "Hits ", nHits, " | ",
+            "False Positives ", nFalse, " (", std::fixed, std::setprecision(2), dFalseRate, "%)");
+    }
+
+
+    /* Set the histogram to count the keychain files each read probes in. */
+    void BinaryHashMap::SetProbes(metrics::Histogram* pProbesIn)
+    {
+        pProbes = pProbesIn;
+    }
+
+
+    /* Rewrite the keychain so each bucket only uses as many hashmap files as it has keys. */
+    bool BinaryHashMap::Compact()
+    {
+        runtime::timer timer;
+        timer.Start();
+
+        /* Start recording the buckets written to while the keychain is copied. */
+        std::vector<uint16_t> vIndex;
+        {
+            LOCK(KEY_MUTEX);
+
+            if(fCompacting)
+                return debug::error(FUNCTION, "compaction of ", strBaseLocation, " is already running");
+
+            fCompacting = true;
+            setCompact.clear();
+
+            vIndex = hashmap;
+        }
+
+        /* Remove any files left by a compaction that was stopped. */
+        compact_clear();
+
+        /* Find the total number of hashmap files in use. */
+        uint16_t nFiles = 1;
+        for(const auto& nIndex : vIndex)
+            nFiles = std::max(nFiles, nIndex);
+
+        debug::log(0, FUNCTION, "Compacting ", nFiles, " hashmap files of ", strBaseLocation);
+
+        /* The compacted index, filters and file sizes. */
+        std::vector<uint16_t> vCompact(HASHMAP_TOTAL_BUCKETS, 0);
+        std::vector<BloomFilter> vFilters;
+        std::vector<uint64_t> vSizes;
+
+        /* Copy the keychain in chunks of buckets, reading each file in use by the chunk. */
+        const uint32_t nChunk = 4096;
+        std::vector< std::vector<uint8_t> > vInput(nFiles, std::vector<uint8_t>(nChunk * HASHMAP_KEY_ALLOCATION, 0));
+        for(uint32_t nBucket = 0; nBucket < HASHMAP_TOTAL_BUCKETS; nBucket += nChunk)
+        {
+            /* Stop early if the node is shutting down. */
+            if(config::fShutdown.load())
+            {
+                LOCK(KEY_MUTEX);
+                compact_stop();
+
+                return debug::error(FUNCTION, "compaction of ", strBaseLocation, " stopped by shutdown");
+            }
+
+            /* Find the deepest bucket in this chunk. */
+            const uint32_t nBuckets = std::min(nChunk, HASHMAP_TOTAL_BUCKETS - nBucket);
+
+            uint16_t nDepth = 0;
+            for(uint32_t i = 0; i < nBuckets; ++i)
+                nDepth = std::max(nDepth, vIndex[nBucket + i]);
+
+            /* Read the chunk from each file in use. Torn reads are fine, those buckets are copied again. */
+            for(uint16_t nFile = 0; nFile < nDepth; ++nFile)
+            {
+                if(!pKeychainReader->Read(nFile, uint64_t(nBucket) * HASHMAP_KEY_ALLOCATION, &vInput[nFile][0], nBuckets * HASHMAP_KEY_ALLOCATION))
+                {
+                    LOCK(KEY_MUTEX);
+                    compact_stop();
+
+                    return debug::error(FUNCTION, "failed to read hashmap file ", nFile, " of ", strBaseLocation);
+                }
+            }
+
+            /* Move the keys of each bucket down into the lowest files, keeping their order. */
+            std::vector< std::vector<uint8_t> > vOutput;
+            for(uint32_t i = 0; i < nBuckets; ++i)
+            {
+                uint16_t nLevel = 0;
+                for(uint16_t nFile = 0; nFile < vIndex[nBucket + i]; ++nFile)
+                {
+                    /* Skip over erased and unused buckets. */
+                    const uint8_t* pBucket = &vInput[nFile][i * HASHMAP_KEY_ALLOCATION];
+                    if(pBucket[0] == STATE::EMPTY)
+                        continue;
+
+                    /* Add the bucket to the next compacted file. */
+                    if(vOutput.size() <= nLevel)
+                        vOutput.emplace_back(nBuckets * HASHMAP_KEY_ALLOCATION, 0);
+
+                    if(vFilters.size() <= nLevel)
+                        vFilters.emplace_back(bloom_create());
+
+                    std::copy(pBucket, pBucket + HASHMAP_KEY_ALLOCATION, &vOutput[nLevel][i * HASHMAP_KEY_ALLOCATION]);
+                    vFilters[nLevel].Insert(bucket_key(pBucket));
+
+                    ++nLevel;
+                }
+
+                vCompact[nBucket + i] = nLevel;
+            }
+
+            /* Append the chunk to each compacted file it reached. */
+            for(uint16_t nFile = 0; nFile < vOutput.size(); ++nFile)
+            {
+                if(vSizes.size() <= nFile)
+                    vSizes.push_back(0);
+
+                if(!compact_append(nFile, uint64_t(nBucket) * HASHMAP_KEY_ALLOCATION, vOutput[nFile], vSizes[nFile]))
+                {
+                    LOCK(KEY_MUTEX);
+                    compact_stop();
+
+                    return debug::error(FUNCTION, "failed to write compacted file ", nFile, " of ", strBaseLocation);
+                }
+            }
+        }
+
+        /* Pad the compacted files to full size, there is always a first file. */
+        if(vSizes.empty())
+            vSizes.push_back(0);
+
+        for(uint16_t nFile = 0; nFile < vSizes.size(); ++nFile)
+        {
+            if(!compact_append(nFile, uint64_t(HASHMAP_TOTAL_BUCKETS) * HASHMAP_KEY_ALLOCATION, std::vector<uint8_t>(), vSizes[nFile]))
+            {
+                LOCK(KEY_MUTEX);
+                compact_stop();
+
+                return debug::error(FUNCTION, "failed to write compacted file ", nFile, " of ", strBaseLocation);
+            }
+        }
+
+        /* Stop all lookups and writes while the keychain is swapped. */
+        std::vector< std::unique_lock<std::mutex> > vLocks;
+        for(auto& MUTEX : RECORD_MUTEX)
+            vLocks.emplace_back(MUTEX);
+
+        LOCK(KEY_MUTEX);
+
+        /* Copy the buckets written to since they were read. */
+        std::vector<uint8_t> vBucket(HASHMAP_KEY_ALLOCATION, 0);
+        for(const auto& nBucket : setCompact)
+        {
+            /* Read the keys of the bucket oldest first. */
+            std::vector< std::vector<uint8_t> > vBuckets;
+            for(uint16_t nFile = 0; nFile < hashmap[nBucket]; ++nFile)
+            {
+                if(!pKeychainReader->Read(nFile, uint64_t(nBucket) * HASHMAP_KEY_ALLOCATION, &vBucket[0], vBucket.size()))
+                {
+                    compact_stop();
+                    return debug::error(FUNCTION, "failed to read hashmap file ", nFile, " of ", strBaseLocation);
+                }
+
+                if(vBucket[0] != STATE::EMPTY)
+                    vBuckets.push_back(vBucket);
+            }
+
+            /* Write them over the copy made earlier, clearing any files it no longer uses. */
+            const uint16_t nLevels = static_cast<uint16_t>(vBuckets.size());
+            for(uint16_t nFile = 0; nFile < std::max(nLevels, vCompact[nBucket]); ++nFile)
+            {
+                /* Create a new full size compacted file if needed. */
+                if(vSizes.size() <= nFile)
+                {
+                    vSizes.push_back(0);
+                    if(!compact_append(nFile, uint64_t(HASHMAP_TOTAL_BUCKETS) * HASHMAP_KEY_ALLOCATION, std::vector<uint8_t>(), vSizes[nFile]))
+                    {
+                        compact_stop();
+                        return debug::error(FUNCTION, "failed to write compacted file ", nFile, " of ", strBaseLocation);
+                    }
+                }
+
+                std::fstream stream(debug::safe_printstr(strBaseLocation, "_compact.", std::setfill('0'), std::setw(5), nFile),
+                    std::ios::in | std::ios::out | std::ios::binary);
+
+                const std::vector<uint8_t> vData = (nFile < nLevels) ? vBuckets[nFile] : std::vector<uint8_t>(HASHMAP_KEY_ALLOCATION, 0);
+                stream.seekp(uint64_t(nBucket) * HASHMAP_KEY_ALLOCATION, std::ios::beg);
+                stream.write((char*)&vData[0], vData.size());
+                if(!stream)
+                {
+                    compact_stop();
+                    return debug::error(FUNCTION, "failed to write compacted file ", nFile, " of ", strBaseLocation);
+                }
+
+                /* Add the key to the filter. */
+                if(nFile < nLevels)
+                {
+                    while(vFilters.size() <= nFile)
+                        vFilters.emplace_back(bloom_create());
+
+                    vFilters[nFile].Insert(bucket_key(&vData[0]));
+                }
+            }
+
+            vCompact[nBucket] = nLevels;
+        }
+
+        /* Find the number of compacted files that are in use, and remove the rest. */
+        uint16_t nCompact = 1;
+        for(const auto& nIndex : vCompact)
+            nCompact = std::max(nCompact, nIndex);
+
+        for(uint16_t nFile = nCompact; nFile < vSizes.size(); ++nFile)
+            filesystem::remove(debug::safe_printstr(strBaseLocation, "_compact.", std::setfill('0'), std::setw(5), nFile));
+
+        /* Write the compacted index. */
+        {
+            std::ofstream stream(debug::safe_printstr(strBaseLocation, "_compact.index"), std::ios::out | std::ios::binary | std::ios::trunc);
+            stream.write((char*)&vCompact[0], vCompact.size() * 2);
+            if(!stream)
+            {
+                compact_stop();
+                return debug::error(FUNCTION, "failed to write compacted index of ", strBaseLocation);
+            }
+        }
+
+        /* Make sure the compacted files are on disk before the swap is started. */
+        for(uint16_t nFile = 0; nFile < nCompact; ++nFile)
+        {
+            if(!filesystem::sync(debug::safe_printstr(strBaseLocation, "_compact.", std::setfill('0'), std::setw(5), nFile)))
+            {
+                compact_stop();
+                return debug::error(FUNCTION, "failed to sync compacted file ", nFile, " of ", strBaseLocation);
+            }
+        }
+
+        /* Mark the swap as started, holding the number of compacted files. */
+        const std::string strSwap = debug::safe_printstr(strBaseLocation, "_compact.swap");
+        {
+            std::ofstream stream(strSwap, std::ios::out | std::ios::binary | std::ios::trunc);
+            stream.write((char*)&nCompact, sizeof(nCompact));
+        }
+
+        if(!filesystem::sync(debug::safe_printstr(strBaseLocation, "_compact.index")) || !filesystem::sync(strSwap) || !filesystem::sync(strBaseLocation))
+        {
+            filesystem::remove(strSwap);
+            compact_stop();
+
+            return debug::error(FUNCTION, "failed to sync compacted index of ", strBaseLocation);
+        }
+
+        /* Close the handles of the old hashmap files. */
+        for(uint32_t nFile = 0; nFile < std::max(nFiles, *std::max_element(hashmap.begin(), hashmap.end())); ++nFile)
+        {
+            fileCache->Remove(nFile);
+            pKeychainReader->Release(nFile);
+
+            if(pKeychainMap)
+                pKeychainMap->Release(nFile);
+        }
+
+        delete pindex;
+
+        /* Swap the compacted files in. If this fails the swap is finished on next startup. */
+        if(!compact_finish())
+            debug::error(FUNCTION, "failed to swap compacted files of ", strBaseLocation, ", restart to finish");
+
+        /* Load the compacted index and filters. The filter capacity is kept so they never move. */
+        hashmap = vCompact;
+        pindex  = new std::fstream(debug::safe_printstr(strBaseLocation, "_hashmap.index"), std::ios::in | std::ios::out | std::ios::binary);
+
+        while(vFilters.size() < nCompact)
+            vFilters.emplace_back(bloom_create());
+
+        for(uint16_t nFile = 0; nFile < nCompact; ++nFile)
+        {
+            if(nFile < vBloom.size())
+                vBloom[nFile] = std::move(vFilters[nFile]);
+            else
+                vBloom.emplace_back(std::move(vFilters[nFile]));
+        }
+
+        if(vBloom.size() > nCompact)
+            vBloom.erase(vBloom.begin() + nCompact, vBloom.end());
+
+        /* Stop recording written buckets. */
+        fCompacting = false;
+        setCompact.clear();
+
+        debug::log(0, FUNCTION, "Compacted ", strBaseLocation, " from ", nFiles, " to ", nCompact, " hashmap files in ", timer.Elapsed(), " seconds");
+
+        return true;
+    }
+
+
+    /* Walk every ready key in the hashmap files, reading them in chunks of buckets. */
+    bool BinaryHashMap::Scan(const std::function<void(const uint64_t nSlot, const SectorKey& cKey)>& fnKey)
+    {
+        /* Take the files in use by each bucket, files added after this are left out. */
+        std::vector<uint16_t> vIndex;
+        {
+            LOCK(KEY_MUTEX);
+            vIndex = hashmap;
+        }
+
+        /* Read the chunk from each file in use. Torn reads are fine, Relocate checks the slot again. */
+        const uint32_t nChunk = 4096;
+        std::vector<uint8_t> vBuffer(nChunk * HASHMAP_KEY_ALLOCATION, 0);
+        for(uint32_t nBucket = 0; nBucket < HASHMAP_TOTAL_BUCKETS; nBucket += nChunk)
+        {
+            /* Stop early if the node is shutting down. */
+            if(config::fShutdown.load())
+                return false;
+
+            /* Find the deepest bucket in this chunk. */
+            const uint32_t nBuckets = std::min(nChunk, HASHMAP_TOTAL_BUCKETS - nBucket);
+
+            uint16_t nDepth = 0;
+            for(uint32_t i = 0; i < nBuckets; ++i)
+                nDepth = std::max(nDepth, vIndex[nBucket + i]);
+
+            for(uint16_t nFile = 0; nFile < nDepth; ++nFile)
+            {
+                if(!pKeychainReader->Read(nFile, uint64_t(nBucket) * HASHMAP_KEY_ALLOCATION, &vBuffer[0], nBuckets * HASHMAP_KEY_ALLOCATION))
+                    return debug::error(FUNCTION, "failed to read hashmap file ", nFile, " of ", strBaseLocation);
+
+                for(uint32_t i = 0; i < nBuckets; ++i)
+                {
+                    /* Skip over files the bucket doesn't use and keys that aren't ready. */
+                    const uint8_t* pBucket = &vBuffer[i * HASHMAP_KEY_ALLOCATION];
+                    if(nFile >= vIndex[nBucket + i] || pBucket[0] != STATE::READY)
+                        continue;
+
+                    /* Deserialize the key header. */
+                    DataStream ssKey(std::vector<uint8_t>(pBucket, pBucket + 13), SER_LLD, DATABASE_VERSION);
+                    SectorKey cKey;
+                    ssKey >> cKey;
+
+                    cKey.vKey = bucket_key(pBucket);
+                    fnKey(uint64_t(nFile) * HASHMAP_TOTAL_BUCKETS + nBucket + i, cKey);
+                }
+            }
+        }
+
+        return true;
+    }
+
+
+    /* Point a key found by Scan to a new sector location, only if its slot still holds it unchanged. */
+    bool BinaryHashMap::Relocate(const uint64_t nSlot, const SectorKey& cKey, const uint16_t nSectorFile, const uint32_t nSectorStart)
+    {
+        /* Get the file and bucket of the slot. */
+        const uint32_t nBucket = static_cast<uint32_t>(nSlot % HASHMAP_TOTAL_BUCKETS);
+        const uint16_t nFile   = static_cast<uint16_t>(nSlot / HASHMAP_TOTAL_BUCKETS);
+
+        /* Lock the bucket stripe first, then the keychain streams. */
+        LOCK(RECORD_MUTEX[nBucket % RECORD_MUTEX.size()]);
+        LOCK2(KEY_MUTEX);
+
+        /* Record the bucket for a running compaction to copy again. */
+        if(fCompacting)
+            setCompact.insert(nBucket);
+
+        /* Check that the bucket still uses the file. */
+        if(nFile >= hashmap[nBucket])
+            return false;
+
+        /* Find the file stream for LRU cache. */
+        std::fstream* pstream;
+        if(!fileCache->Get(nFile, pstream))
+        {
+            /* Set the new stream pointer. */
+            pstream = new std::fstream(
+              debug::safe_printstr(strBaseLocation, "_hashmap.", std::setfill('0'), std::setw(5), nFile),
+              std::ios::in | std::ios::out | std::ios::binary);
+
+            if(!pstream->is_open())
+            {
+                delete pstream;
+                return debug::error(FUNCTION, "couldn't open hashmap file ", nFile, " of ", strBaseLocation);
+            }
+
+            /* If file not found add to LRU cache. */
+            fileCache->Put(nFile, pstream);
+        }
+
+        /* Read the bucket binary data from file stream */
+        const uint64_t nFilePos = uint64_t(nBucket) * HASHMAP_KEY_ALLOCATION;
+
+        std::vector<uint8_t> vBucket(HASHMAP_KEY_ALLOCATION, 0);
+        pstream->seekg(nFilePos, std::ios::beg);
+        if(!pstream->read((char*) &vBucket[0], vBucket.size()))
+            return debug::error(FUNCTION, "failed to read hashmap file ", nFile, " of ", strBaseLocation);
+
+        /* Check that the slot still holds the same key at the same location. */
+        DataStream ssKey(vBucket, SER_LLD, DATABASE_VERSION);
+        SectorKey cSlot;
+        ssKey >> cSlot;
+
+        if(!cSlot.Ready() || cSlot.nSectorFile != cKey.nSectorFile || cSlot.nSectorStart != cKey.nSectorStart
+        || cSlot.nSectorSize != cKey.nSectorSize || bucket_key(&vBucket[0]) != cKey.vKey)
+            return false;
+
+        /* Write the new location over the key header. */
+        cSlot.nSectorFile  = nSectorFile;
+        cSlot.nSectorStart = nSectorStart;
+
+        DataStream ssSlot(SER_LLD, DATABASE_VERSION);
+        ssSlot << cSlot;
+
+        pstream->seekp(nFilePos, std::ios::beg);
+        pstream->write((char*)&ssSlot.Bytes()[0], ssSlot.size());
+        pstream->flush();
+
+        return true;
+    }
+
+
+    /* Append data to a compacted hashmap file, padding it with empty buckets up to a position. */
+    bool BinaryHashMap::compact_append(const uint16_t nFile, const uint64_t nPos, const std::vector<uint8_t>& vData, uint64_t& nSize)
+    {
+        std::ofstream stream(debug::safe_printstr(strBaseLocation, "_compact.", std::setfill('0'), std::setw(5), nFile),
+            std::ios::out | std::ios::binary | std::ios::app);
+
+        if(!stream)
+            return false;
+
+        /* Pad the file with empty buckets. */
+        const std::vector<uint8_t> vSpace(16384 * HASHMAP_KEY_ALLOCATION, 0);
+        while(nSize < nPos)
+        {
+            const uint64_t nPad = std::min(uint64_t(vSpace.size()), nPos - nSize);
+            stream.write((char*)&vSpace[0], nPad);
+
+            nSize += nPad;
+        }
+
+        /* Append the data. */
+        if(!vData.empty())
+        {
+            stream.write((char*)&vData[0], vData.size());
+            nSize += vData.size();
+        }
+
+        return static_cast<bool>(stream);
+    }
+
+
+    /* Stop recording written buckets and remove the compacted files. */
+    void BinaryHashMap::compact_stop()
+    {
+        fCompacting = false;
+        setCompact.clear();
+
+        compact_clear();
+    }
+
+
+    /* Remove the compacted files of a compaction that didn't reach its swap. */
+    void BinaryHashMap::compact_clear()
+    {
+        for(uint32_t nFile = 0; ; ++nFile)
+        {
+            if(!filesystem::remove(debug::safe_printstr(strBaseLocation, "_compact.", std::setfill('0'), std::setw(5), nFile)))
+                break;
+        }
+
+        filesystem::remove(debug::safe_printstr(strBaseLocation, "_compact.index"));
+    }
+
+
+    /* Rename the compacted files over the hashmap files if a swap was started. */
+    bool BinaryHashMap::compact_finish()
+    {
+        /* Check for a swap that was started. */
+        const std::string strSwap = debug::safe_printstr(strBaseLocation, "_compact.swap");
+        std::ifstream stream(strSwap, std::ios::in | std::ios::binary);
+        if(!stream)
+            return true;
+
+        uint16_t nCompact = 0;
+        stream.read((char*)&nCompact, sizeof(nCompact));
+        stream.close();
+
+        /* A marker that wasn't fully written means no files were renamed yet. */
+        if(nCompact == 0)
+            return filesystem::remove(strSwap);
+
+        /* Rename the compacted files over the hashmap files. */
+        for(uint16_t nFile = 0; nFile < nCompact; ++nFile)
+        {
+            std::string strFile = debug::safe_printstr(strBaseLocation, "_compact.", std::setfill('0'), std::setw(5), nFile);
+            if(filesystem::exists(strFile) && !filesystem::rename(strFile,
+                debug::safe_printstr(strBaseLocation, "_hashmap.", std::setfill('0'), std::setw(5), nFile)))
+                return false;
+        }
+
+        std::string strIndex = debug::safe_printstr(strBaseLocation, "_compact.index");
+        if(filesystem::exists(strIndex) && !filesystem::rename(strIndex, debug::safe_printstr(strBaseLocation, "_hashmap.index")))
+            return false;
+
+        /* Remove the hashmap files that are no longer in use, and the filters of the old files. */
+        for(uint32_t nFile = nCompact; ; ++nFile)
+        {
+            if(!filesystem::remove(debug::safe_printstr(strBaseLocation, "_hashmap.", std::setfill('0'), std::setw(5), nFile)))
+                break;
+        }
+
+        filesystem::remove(debug::safe_printstr(strBaseLocation, "_hashmap.bloom"));
+
+        /* Make the renames durable before the marker is removed. */
+        filesystem::sync(strBaseLocation);
+
+        return filesystem::remove(strSwap);
+    }
+
+
+    /* Get the compressed key held in a bucket from its original length. */
+    std::vector<uint8_t> BinaryHashMap::bucket_key(const uint8_t* pBucket) const
+    {
+        /* Find the compressed length of the key from its original length. */
+        uint16_t nLength = 0;
+        std::copy(pBucket + 1, pBucket + 3, (uint8_t*)&nLength);
+        while(nLength > HASHMAP_MAX_KEY_SIZE)
+            nLength = std::max(uint16_t(nLength >> 1), HASHMAP_MAX_KEY_SIZE);
+
+        return std::vector<uint8_t>(pBucket + 13, pBucket + 13 + nLength);
+    }
+
+
+    /* Check the bloom filter of a hashmap file for a key. */
+    bool BinaryHashMap::bloom_check(const uint16_t nFile, const std::vector<uint8_t>& vKeyCompressed)
+    {
+        /* Every file has to be probed with the filters disabled. */
+        if(HASHMAP_BLOOM_BITS == 0)
+            return true;
+
+        /* Every file below the bucket's index has a filter, see bloom_insert. The filter words are
+           atomic, so this can run under a different RECORD_MUTEX stripe than the inserts into it. */
+        if(vBloom[nFile].Contains(vKeyCompressed))
+            return true;
+
+        ++nBloomSkipped;
+        return false;
+    }
+
+
+    /* Add a key to the bloom filter of a hashmap file, creating the filter if needed. */
+    void BinaryHashMap::bloom_insert(const uint16_t nFile, const std::vector<uint8_t>& vKeyCompressed)
+    {
+        /* Check that the filters are enabled. */
+        if(HASHMAP_BLOOM_BITS == 0)
+            return;
+
+        /* Allocate filters up to this file before the bucket index is raised to include it.
+           This is only ever called holding KEY_MUTEX, and capacity is reserved up front. */
+        while(vBloom.size() <= nFile)
+            vBloom.emplace_back(bloom_create());
+
+        vBloom[nFile].Insert(vKeyCompressed);
+    }
+
+
+    /* Create an empty bloom filter for one hashmap file. */
+    BloomFilter BinaryHashMap::bloom_create() const
+    {
+        /* A file holds at most one key per bucket. */
+        return BloomFilter(HASHMAP_TOTAL_BUCKETS, HASHMAP_BLOOM_BITS);
+    }
+
+
+    /* Load the bloom filters from disk, or rebuild them from the hashmap files. */
+    void BinaryHashMap::bloom_load()
+    {
+        /* Remove any stale filters if they are disabled, so they are rebuilt once enabled again. */
+        if(HASHMAP_BLOOM_BITS == 0)
+        {
+            filesystem::remove(debug::safe_printstr(strBaseLocation, "_hashmap.bloom"));
+            return;
+        }
+
+        /* Find the total number of hashmap files in use. */
+        uint16_t nFiles = 1;
+        for(const auto& nIndex : hashmap)
+            nFiles = std::max(nFiles, nIndex);
+
+        /* Filters may already be populated by copy or move. */
+        if(vBloom.size() >= nFiles)
+            return;
+
+        /* Try to read the filters persisted on last shutdown. */
+        std::string strBloom = debug::safe_printstr(strBaseLocation, "_hashmap.bloom");
+        if(filesystem::exists(strBloom))
+        {
+            std::ifstream stream(strBloom, std::ios::in | std::ios::binary);
+
+            /* Read the total filters. */
+            uint16_t nTotal = 0;
+            stream.read((char*)&nTotal, sizeof(nTotal));
+
+            /* Read each filter, they must match the current hashmap files. */
+            bool fLoaded = (stream && nTotal == nFiles);
+            if(fLoaded)
+            {
+                vBloom.assign(nTotal, bloom_create());
+                for(auto& bloom : vBloom)
+                {
+                    if(!bloom.Read(stream))
+                    {
+                        fLoaded = false;
+                        break;
+                    }
+                }
+            }
+            stream.close();
+
+            /* Remove the file so that an unclean shutdown forces a rebuild. */
+            filesystem::remove(strBloom);
+
+            /* Debug output showing loading of bloom filters. */
+            if(fLoaded)
+            {
+                debug::log(0, FUNCTION, "Loaded ", nTotal, " Bloom Filters of ", vBloom[0].Bytes(), " bytes");
+                return;
+            }
+
+            debug::log(0, FUNCTION, "Bloom Filters are out of date, rebuilding...");
+        }
+
+        /* Rebuild the filters from the hashmap files. */
+        runtime::timer timer;
+        timer.Start();
+
+        vBloom.assign(nFiles, bloom_create());
+
+        uint64_t nTotalKeys = 0;
+        for(uint16_t nFile = 0; nFile < nFiles; ++nFile)
+        {
+            std::ifstream stream(debug::safe_printstr(strBaseLocation, "_hashmap.", std::setfill('0'), std::setw(5), nFile),
+                std::ios::in | std::ios::binary);
+
+            if(!stream)
+                continue;
+
+            /* Read the file in chunks of whole buckets. */
+            const uint32_t nChunk = 16384;
+            std::vector<uint8_t> vBuffer(nChunk * HASHMAP_KEY_ALLOCATION, 0);
+            for(uint32_t nBucket = 0; nBucket < HASHMAP_TOTAL_BUCKETS; nBucket += nChunk)
+            {
+                /* Read the next chunk of buckets. */
+                const uint32_t nBuckets = std::min(nChunk, HASHMAP_TOTAL_BUCKETS - nBucket);
+                if(!stream.read((char*)&vBuffer[0], nBuckets * HASHMAP_KEY_ALLOCATION))
+                    break;
+
+                for(uint32_t i = 0; i < nBuckets; ++i)
+                {
+                    /* Erased and unused buckets are all zero. */
+                    const uint8_t* pBucket = &vBuffer[i * HASHMAP_KEY_ALLOCATION];
+                    if(pBucket[0] == STATE::EMPTY)
+                        continue;
+
+                    /* Add the key to the filter. */
+                    vBloom[nFile].Insert(bucket_key(pBucket));
+                    ++nTotalKeys;
+                }
+            }
+        }
+
+        /* Debug output showing rebuilding of bloom filters. */
+        debug::log(0, FUNCTION, "Rebuilt ", nFiles, " Bloom Filters with ", nTotalKeys, " keys in ", timer.Elapsed(), " seconds");
+    }
+
+
+    /* Persist the bloom filters next to the hashmap index. */
+    void BinaryHashMap::bloom_save()
+    {
+        /* Check that there are filters to write. */
+        if(vBloom.empty() || HASHMAP_BLOOM_BITS == 0)
+            return;
+
+        /* Write to a temporary file to avoid leaving a partial file behind. */
+        std::string strBloom = debug::safe_printstr(strBaseLocation, "_hashmap.bloom");
+        std::ofstream stream(strBloom + ".tmp", std::ios::out | std::ios::binary | std::ios::trunc);
+        if(!stream)
+            return;
+
+        /* Write the total filters. */
+        const uint16_t nTotal = static_cast<uint16_t>(vBloom.size());
+        stream.write((char*)&nTotal, sizeof(nTotal));
+
+        /* Write each filter. */
+        for(const auto& bloom : vBloom)
+        {
+            if(!bloom.Write(stream))
+            {
+                debug::error(FUNCTION, "failed to write bloom filters");
+                return;
+            }
+        }
+        stream.close();
+
+        /* Move the completed file into place. */
+        filesystem::rename(strBloom + ".tmp", strBloom);
+    }
 }
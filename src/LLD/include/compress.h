@@ -0,0 +1,81 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#pragma once
+#ifndef NEXUS_LLD_INCLUDE_COMPRESS_H
+#define NEXUS_LLD_INCLUDE_COMPRESS_H
+
+#include <cstdint>
+#include <vector>
+
+namespace LLD
+{
+
+    /* Marks the first byte of a compressed record. An uncompressed record starts with
+       the compact size of its type string, which is never 0xff, so the two can coexist. */
+    const uint8_t COMPRESSED_RECORD = 0xff;
+
+
+    /* Size of the compressed record header, the marker and the uncompressed size. */
+    const uint32_t COMPRESSED_HEADER_SIZE = 5;
+
+
+    /* Records smaller than this are stored uncompressed. */
+    const uint32_t MIN_COMPRESS_SIZE = 128;
+
+
+    /** CompressRecord
+     *
+     *  Compress a sector record with LZ4, behind the compressed record header.
+     *
+     *  @param[in] vData The record to compress.
+     *  @param[out] vRecord The compressed record.
+     *
+     *  @return True if the record was compressed, false if it is too small or doesn't get smaller.
+     *
+     **/
+    bool CompressRecord(const std::vector<uint8_t>& vData, std::vector<uint8_t>& vRecord);
+
+
+    /** IsCompressed
+     *
+     *  Check if a sector record starts with the compressed record marker.
+     *
+     *  @param[in] pRecord The first byte of the record.
+     *  @param[in] nSize The size of the record.
+     *
+     *  @return True if the record is compressed.
+     *
+     **/
+    inline bool IsCompressed(const uint8_t* pRecord, const uint64_t nSize)
+    {
+        return nSize >= COMPRESSED_HEADER_SIZE && pRecord[0] == COMPRESSED_RECORD;
+    }
+
+
+    /** DecompressRecord
+     *
+     *  Decompress a sector record written by CompressRecord.
+     *
+     *  @param[in] pRecord The first byte of the compressed record.
+     *  @param[in] nSize The size of the compressed record.
+     *  @param[out] vData The uncompressed record.
+     *
+     *  @return True if the record was decompressed, false if it is corrupted.
+     *
+     **/
+    bool DecompressRecord(const uint8_t* pRecord, const uint64_t nSize, std::vector<uint8_t>& vData);
+
+}
+
+#endif
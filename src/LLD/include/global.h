@@ -61,6 +61,28 @@ namespace LLD
     void TxnRecovery();
 
 
+    /** Checkpoint
+     *
+     *  Sync all LLD instances to disk and clear the write-ahead log.
+     *
+     *  @return True if all instances were synced and the log was cleared.
+     *
+     **/
+    bool Checkpoint();
+
+
+    /** Compact
+     *
+     *  Compact the keychains of the global LLD instances in a background thread.
+     *
+     *  @param[in] strName The database to compact, such as ledger, or empty for all of them.
+     *
+     *  @return True if the compaction was started, false if one is already running.
+     *
+     **/
+    bool Compact(const std::string& strName = "");
+
+
     /** Txn Begin
      *
      *  Global handler for all LLD instances.
@@ -79,10 +101,13 @@ namespace LLD
 
     /** Txn Commit
      *
-     *  Global handler for all LLD instances.
+     *  Global handler for all LLD instances. If the write-ahead log can't be
+     *  written the transaction is aborted instead of committed.
+     *
+     *  @return True if the transaction was committed.
      *
      */
-    void TxnCommit(const uint8_t nFlags = 0);
+    bool TxnCommit(const uint8_t nFlags = 0);
 }
 
 #endif
@@ -0,0 +1,254 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLD/templates/journal.h>
+#include <LLD/hash/xxh3.h>
+
+#include <Util/include/debug.h>
+#include <Util/include/mutex.h>
+#include <Util/include/runtime.h>
+
+#include <chrono>
+#include <cstring>
+
+#ifndef WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace LLD
+{
+
+    /* The size of a record header, the record length followed by its checksum. */
+    const uint32_t JOURNAL_HEADER_SIZE = 12;
+
+
+    /* Journal Constructor */
+    Journal::Journal(const std::string& strPathIn, const uint64_t nCheckpointSizeIn, const std::function<bool()>& fnCheckpointIn)
+    : WRITE_MUTEX     ( )
+    , CONDITION_MUTEX ( )
+    , CONDITION       ( )
+    , strPath         (strPathIn)
+    , stream          (strPathIn, std::ios::out | std::ios::binary | std::ios::app)
+    , fd              (-1)
+    , nSize           (0)
+    , fFailed         (false)
+    , nCheckpointSize (nCheckpointSizeIn)
+    , fnCheckpoint    (fnCheckpointIn)
+    , fDestruct       (false)
+    , CheckpointThread( )
+    {
+        if(!stream.is_open())
+            debug::error(FUNCTION, "failed to open write-ahead log ", strPath, " (", strerror(errno), ")");
+
+        /* Get the size of any records left from before a restart. */
+        std::ifstream file(strPath, std::ios::in | std::ios::binary | std::ios::ate);
+        if(file.is_open())
+            nSize = static_cast<uint64_t>(file.tellg());
+
+    #ifndef WIN32
+        /* Keep a descriptor to sync and truncate the file without closing the stream. */
+        fd = open(strPath.c_str(), O_RDWR);
+    #endif
+
+        CheckpointThread = std::thread(std::bind(&Journal::Checkpoint, this));
+    }
+
+
+    /* Default Destructor */
+    Journal::~Journal()
+    {
+        fDestruct = true;
+        CONDITION.notify_all();
+
+        if(CheckpointThread.joinable())
+            CheckpointThread.join();
+
+        stream.close();
+
+    #ifndef WIN32
+        if(fd >= 0)
+            close(fd);
+    #endif
+    }
+
+
+    /* Append a record and wait until it is on disk. */
+    bool Journal::Commit(const std::vector<uint8_t>& vRecord)
+    {
+        /* Frame the record with its length and checksum. */
+        const uint32_t nLength   = static_cast<uint32_t>(vRecord.size());
+        const uint64_t nChecksum = XXH64(vRecord.data(), vRecord.size(), 0);
+
+        {
+            LOCK(WRITE_MUTEX);
+
+            /* Check that an earlier failure has been cleared by a checkpoint. */
+            if(fFailed.load())
+                return debug::error(FUNCTION, "write-ahead log failed, waiting for checkpoint");
+
+            /* Push the record to the operating system. */
+            stream.write((char*)&nLength,   sizeof(nLength));
+            stream.write((char*)&nChecksum, sizeof(nChecksum));
+            stream.write((char*)vRecord.data(), vRecord.size());
+            stream.flush();
+            if(!stream)
+            {
+                rollback();
+                return debug::error(FUNCTION, "failed to append to write-ahead log");
+            }
+
+        #ifndef WIN32
+            /* Wait for the record to reach disk. */
+            if(fd < 0 || fdatasync(fd) != 0)
+            {
+                const std::string strError = strerror(errno);
+
+                rollback();
+                return debug::error(FUNCTION, "failed to sync write-ahead log (", strError, ")");
+            }
+        #endif
+
+            nSize += JOURNAL_HEADER_SIZE + nLength;
+        }
+
+        /* Wake the checkpoint thread if the log is full. */
+        if(nSize.load() >= nCheckpointSize)
+            CONDITION.notify_all();
+
+        return true;
+    }
+
+
+    /* Read every complete record from a log in the order they were appended. */
+    bool Journal::Read(const std::string& strFile, std::vector< std::vector<uint8_t> >& vRecords)
+    {
+        std::ifstream file(strFile, std::ios::in | std::ios::binary);
+        if(!file.is_open())
+            return false;
+
+        uint64_t nPos = 0;
+        while(true)
+        {
+            /* Read the record header. */
+            uint32_t nLength   = 0;
+            uint64_t nChecksum = 0;
+            file.read((char*)&nLength,   sizeof(nLength));
+            file.read((char*)&nChecksum, sizeof(nChecksum));
+            if(!file)
+                break;
+
+            /* Read the record. */
+            std::vector<uint8_t> vRecord(nLength, 0);
+            file.read((char*)vRecord.data(), vRecord.size());
+
+            /* Stop at a record torn by a crash, it never reached its sync. */
+            if(!file || XXH64(vRecord.data(), vRecord.size(), 0) != nChecksum)
+            {
+                debug::log(0, FUNCTION, "discarding incomplete write-ahead log record at ", nPos);
+                break;
+            }
+
+            vRecords.push_back(vRecord);
+            nPos += JOURNAL_HEADER_SIZE + nLength;
+        }
+
+        return true;
+    }
+
+
+    /* Clear the log once all databases are synced to disk. */
+    bool Journal::Clear()
+    {
+        LOCK(WRITE_MUTEX);
+
+        /* Reopen the stream truncated, the file stays the same so the descriptor is still valid. */
+        stream.close();
+        stream.open(strPath, std::ios::out | std::ios::binary | std::ios::trunc);
+        if(!stream.is_open())
+            return debug::error(FUNCTION, "failed to clear write-ahead log ", strPath);
+
+    #ifndef WIN32
+        if(fd >= 0)
+            fdatasync(fd);
+    #endif
+
+        nSize   = 0;
+        fFailed = false;
+
+        return true;
+    }
+
+
+    /* Get the current size of the log file in bytes. */
+    uint64_t Journal::Size() const
+    {
+        return nSize.load();
+    }
+
+
+    /* Truncate the log back to the end of the last complete record after a failed commit. */
+    void Journal::rollback()
+    {
+        /* Drop what is left of the record, closing may still write part of it. */
+        stream.clear();
+        stream.close();
+
+    #ifndef WIN32
+        /* Cut the partial record off, records appended after it would never be replayed. */
+        if(fd >= 0 && ftruncate(fd, static_cast<off_t>(nSize.load())) == 0 && fdatasync(fd) == 0)
+        {
+            stream.open(strPath, std::ios::out | std::ios::binary | std::ios::app);
+            if(stream.is_open())
+                return;
+        }
+    #endif
+
+        /* Stop using the log until a checkpoint syncs the databases and clears it. */
+        debug::error(FUNCTION, "failed to truncate write-ahead log ", strPath, ", waiting for checkpoint");
+        fFailed = true;
+
+        CONDITION.notify_all();
+    }
+
+
+    /* Checkpoint thread. Calls the checkpoint function when the log is full or failed. */
+    void Journal::Checkpoint()
+    {
+        while(!fDestruct.load())
+        {
+            /* Wait for the log to fill up. */
+            std::unique_lock<std::mutex> CONDITION_LOCK(CONDITION_MUTEX);
+            CONDITION.wait(CONDITION_LOCK, [this]{ return fDestruct.load() || fFailed.load() || nSize.load() >= nCheckpointSize; });
+
+            if(fDestruct.load())
+                return;
+
+            /* Sync the databases and clear the log. */
+            runtime::timer timer;
+            timer.Start();
+
+            const uint64_t nBytes = nSize.load();
+            if(!fnCheckpoint())
+            {
+                debug::error(FUNCTION, "write-ahead log checkpoint failed, retrying");
+
+                /* Back off before trying again. */
+                CONDITION.wait_for(CONDITION_LOCK, std::chrono::seconds(5), [this]{ return fDestruct.load(); });
+                continue;
+            }
+
+            debug::log(2, FUNCTION, "checkpointed ", nBytes, " bytes of write-ahead log in ", timer.ElapsedMilliseconds(), " ms");
+        }
+    }
+}
@@ -17,11 +17,16 @@ ________________________________________________________________________________
 
 #include <LLD/keychain/keychain.h>
 #include <LLD/cache/template_lru.h>
+#include <LLD/cache/bloom.h>
+#include <LLD/templates/mmap.h>
+#include <LLD/templates/reader.h>
 #include <LLD/include/enum.h>
 
+#include <atomic>
 #include <cstdint>
 #include <string>
 #include <fstream>
+#include <set>
 #include <vector>
 #include <mutex>
 
@@ -41,7 +46,7 @@ namespace LLD
     {
     protected:
 
-        /** Mutex for Thread Synchronization. **/
+        /** Mutex for Thread Synchronization of the keychain streams and file list. **/
         mutable std::mutex KEY_MUTEX;
 
 
@@ -57,6 +62,14 @@ namespace LLD
         std::fstream* pindex;
 
 
+        /** Memory mapped keychain files for lookups, only used in MMAP mode. **/
+        MemoryMap* pKeychainMap;
+
+
+        /** Positional read handles for keychain lookups. **/
+        FileReader* pKeychainReader;
+
+
         /** Total elements in hashmap for quick inserts. **/
         std::vector<uint16_t> hashmap;
 
@@ -77,10 +90,36 @@ namespace LLD
         uint8_t nFlags;
 
 
-        /* The key level locking hashmap. */
+        /* The bucket striped locks, taken before KEY_MUTEX. Lookups only need the stripe. */
         mutable std::vector<std::mutex> RECORD_MUTEX;
 
 
+        /** Buckets written to while a compaction copies the keychain, guarded by KEY_MUTEX. **/
+        std::set<uint32_t> setCompact;
+
+
+        /** Flag set while a compaction is running, guarded by KEY_MUTEX. **/
+        bool fCompacting;
+
+
+        /** Bloom filters for each hashmap file to skip disk probes on misses. **/
+        std::vector<BloomFilter> vBloom;
+
+
+        /** The bits of filter space per bucket of each hashmap file, zero disables the filters. **/
+        uint8_t HASHMAP_BLOOM_BITS;
+
+
+        /** Meter counters for the bloom filters. **/
+        std::atomic<uint64_t> nBloomSkipped;
+        std::atomic<uint64_t> nBloomHits;
+        std::atomic<uint64_t> nBloomFalse;
+
+
+        /** The histogram of the files each read probes, set by the database. **/
+        metrics::Histogram* pProbes;
+
+
     public:
 
 
@@ -177,6 +216,16 @@ namespace LLD
         void Flush();
 
 
+        /** Sync
+         *
+         *  Sync the index and hashmap files to disk so the write-ahead log can be cleared.
+         *
+         *  @return True if all files were synced, false otherwise.
+         *
+         **/
+        bool Sync();
+
+
         /** Restore
          *
          *  Restore an erased key from keychain.
@@ -200,6 +249,176 @@ namespace LLD
          *
          **/
         bool Erase(const std::vector<uint8_t> &vKey);
+
+
+        /** Meter
+         *
+         *  Get the bloom filter statistics for the LLD meters and reset the counters.
+         *
+         *  @return The formatted bloom filter statistics.
+         *
+         **/
+        std::string Meter();
+
+
+        /** SetProbes
+         *
+         *  Set the histogram to count the keychain files each read probes in.
+         *
+         *  @param[in] pProbesIn The histogram.
+         *
+         **/
+        void SetProbes(metrics::Histogram* pProbesIn);
+
+
+        /** Compact
+         *
+         *  Rewrite the keychain so each bucket only uses as many hashmap files as it has keys.
+         *  The keys are copied into _compact files while lookups and writes carry on, buckets
+         *  written to meanwhile are copied again under lock, and then the files are swapped.
+         *
+         *  @return True if the keychain was compacted.
+         *
+         **/
+        bool Compact();
+
+
+        /** Scan
+         *
+         *  Walk every ready key in the hashmap files, reading them in chunks of buckets.
+         *  The slot is the hashmap file times the total buckets plus the bucket.
+         *
+         *  @param[in] fnKey The function to call with the slot and key of each ready key.
+         *
+         *  @return True if the keychain was scanned.
+         *
+         **/
+        bool Scan(const std::function<void(const uint64_t nSlot, const SectorKey& cKey)>& fnKey);
+
+
+        /** Relocate
+         *
+         *  Point a key found by Scan to a new sector location, only if its slot still holds it unchanged.
+         *
+         *  @param[in] nSlot The slot the key was found in.
+         *  @param[in] cKey The key as it was found, with its compressed key.
+         *  @param[in] nSectorFile The new sector file.
+         *  @param[in] nSectorStart The new start of the record in the sector file.
+         *
+         *  @return True if the key was moved.
+         *
+         **/
+        bool Relocate(const uint64_t nSlot, const SectorKey& cKey, const uint16_t nSectorFile, const uint32_t nSectorStart);
+
+
+    private:
+
+        /** CompactAppend
+         *
+         *  Append data to a compacted hashmap file, padding it with empty buckets up to a position.
+         *
+         *  @param[in] nFile The compacted file to append to.
+         *  @param[in] nPos The position to pad the file up to before appending.
+         *  @param[in] vData The data to append.
+         *  @param[out] nSize The size of the file, updated with the bytes written.
+         *
+         *  @return True if the data was written.
+         *
+         **/
+        bool compact_append(const uint16_t nFile, const uint64_t nPos, const std::vector<uint8_t>& vData, uint64_t& nSize);
+
+
+        /** CompactStop
+         *
+         *  Stop recording written buckets and remove the compacted files.
+         *  Must be called holding KEY_MUTEX.
+         *
+         **/
+        void compact_stop();
+
+
+        /** CompactClear
+         *
+         *  Remove the compacted files of a compaction that didn't reach its swap.
+         *
+         **/
+        void compact_clear();
+
+
+        /** CompactFinish
+         *
+         *  Rename the compacted files over the hashmap files if a swap was started, so that
+         *  a swap interrupted by a crash is completed on the next startup.
+         *
+         *  @return True if there was no swap to finish or it was finished.
+         *
+         **/
+        bool compact_finish();
+
+
+        /** BucketKey
+         *
+         *  Get the compressed key held in a bucket from its original length.
+         *
+         *  @param[in] pBucket The bucket data.
+         *
+         *  @return The compressed key.
+         *
+         **/
+        std::vector<uint8_t> bucket_key(const uint8_t* pBucket) const;
+
+
+        /** BloomCheck
+         *
+         *  Check the bloom filter of a hashmap file for a key.
+         *
+         *  @param[in] nFile The hashmap file to check.
+         *  @param[in] vKeyCompressed The compressed key to check for.
+         *
+         *  @return False if the key is definitely not in the file.
+         *
+         **/
+        bool bloom_check(const uint16_t nFile, const std::vector<uint8_t>& vKeyCompressed);
+
+
+        /** BloomInsert
+         *
+         *  Add a key to the bloom filter of a hashmap file, creating the filter if needed.
+         *
+         *  @param[in] nFile The hashmap file the key was written to.
+         *  @param[in] vKeyCompressed The compressed key to add.
+         *
+         **/
+        void bloom_insert(const uint16_t nFile, const std::vector<uint8_t>& vKeyCompressed);
+
+
+        /** BloomCreate
+         *
+         *  Create an empty bloom filter for one hashmap file, sized by the total buckets
+         *  and the bits per bucket set with -bloombits.
+         *
+         *  @return The empty bloom filter.
+         *
+         **/
+        BloomFilter bloom_create() const;
+
+
+        /** BloomLoad
+         *
+         *  Load the bloom filters from disk, or rebuild them from the hashmap files if
+         *  they are missing or don't match. The filters are only persisted on clean
+         *  shutdown, so the file is removed once loaded to force a rebuild after a crash.
+         *
+         **/
+        void bloom_load();
+
+
+        /** BloomSave
+         *
+         *  Persist the bloom filters next to the hashmap index.
+         *
+         **/
+        void bloom_save();
     };
 }
 
@@ -17,6 +17,11 @@ ________________________________________________________________________________
 
 #include <LLD/templates/key.h>
 
+#include <Util/include/metrics.h>
+
+#include <functional>
+#include <string>
+
 namespace LLD
 {
 
@@ -67,6 +72,16 @@ namespace LLD
         virtual void Flush() = 0;
 
 
+        /** Sync
+         *
+         *  Sync all keychain files to disk so the write-ahead log can be cleared.
+         *
+         *  @return True if all files were synced, false otherwise.
+         *
+         **/
+        virtual bool Sync() = 0;
+
+
         /** Restore
          *
          *  Restore an erased key from keychain.
@@ -89,6 +104,79 @@ namespace LLD
          *
          **/
         virtual bool Erase(const std::vector<uint8_t>& vKey) = 0;
+
+
+        /** Meter
+         *
+         *  Get the keychain statistics for the LLD meters.
+         *
+         *  @return The formatted statistics, empty if the keychain keeps none.
+         *
+         **/
+        virtual std::string Meter()
+        {
+            return "";
+        }
+
+
+        /** SetProbes
+         *
+         *  Set the histogram to count the keychain files each read probes in.
+         *
+         *  @param[in] pProbesIn The histogram, ignored if the keychain doesn't probe files.
+         *
+         **/
+        virtual void SetProbes(metrics::Histogram* pProbesIn)
+        {
+        }
+
+
+        /** Compact
+         *
+         *  Rewrite the keychain into as few files as its keys need while it keeps serving reads.
+         *
+         *  @return True if the keychain was compacted, false on failure or if the keychain can't be compacted.
+         *
+         **/
+        virtual bool Compact()
+        {
+            return false;
+        }
+
+
+        /** Scan
+         *
+         *  Walk every ready key of the keychain while it keeps serving reads and writes.
+         *  The keys are given with their compressed key, and a slot that identifies where
+         *  the key is stored until the keychain is next written to.
+         *
+         *  @param[in] fnKey The function to call with the slot and key of each ready key.
+         *
+         *  @return True if the keychain was scanned, false on failure or if the keychain can't be scanned.
+         *
+         **/
+        virtual bool Scan(const std::function<void(const uint64_t nSlot, const SectorKey& cKey)>& fnKey)
+        {
+            return false;
+        }
+
+
+        /** Relocate
+         *
+         *  Point a key found by Scan to a new sector location, only if it wasn't changed since.
+         *
+         *  @param[in] nSlot The slot the key was found in.
+         *  @param[in] cKey The key as it was found, with its compressed key.
+         *  @param[in] nSectorFile The new sector file.
+         *  @param[in] nSectorStart The new start of the record in the sector file.
+         *
+         *  @return True if the key was moved, false if it changed or the keychain can't relocate keys.
+         *
+         **/
+        virtual bool Relocate(const uint64_t nSlot, const SectorKey& cKey, const uint16_t nSectorFile, const uint32_t nSectorStart)
+        {
+            return false;
+        }
     };
 }
 
@@ -0,0 +1,298 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#pragma once
+#ifndef NEXUS_LLD_KEYCHAIN_ORDERED_H
+#define NEXUS_LLD_KEYCHAIN_ORDERED_H
+
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace LLD
+{
+    class FileReader;
+
+
+    /* The memory the newest keys may use before they are written out as a sorted run. */
+    const uint32_t ORDERED_MEMORY_SIZE = 1024 * 1024; //1 MB memory table
+
+
+    /* The records between the keys of a run's sparse index. */
+    const uint32_t ORDERED_SPARSE_RECORDS = 64;
+
+
+    /** OrderedKey
+     *
+     *  Get the ordered key of a sequence number under a prefix. The sequence is
+     *  appended in big-endian order so keys sort in the order of their sequence.
+     *
+     *  @param[in] vPrefix The binary data of the prefix.
+     *  @param[in] nSequence The sequence number.
+     *
+     *  @return The prefix followed by the sequence number.
+     *
+     **/
+    std::vector<uint8_t> OrderedKey(const std::vector<uint8_t>& vPrefix, const uint64_t nSequence);
+
+
+    /** OrderedSequence
+     *
+     *  Get the sequence number at the end of an ordered key.
+     *
+     *  @param[in] vKey The ordered key, at least 8 bytes long.
+     *
+     *  @return The sequence number.
+     *
+     **/
+    uint64_t OrderedSequence(const std::vector<uint8_t>& vKey);
+
+
+    /** OrderedRun
+     *
+     *  A file of records sorted by key, written out from memory or merged from other runs.
+     *
+     **/
+    struct OrderedRun
+    {
+        /** The file number of the run. **/
+        uint32_t nFile;
+
+
+        /** The size of the run in bytes. **/
+        uint64_t nSize;
+
+
+        /** True once the sparse index is built. **/
+        bool fLoaded;
+
+
+        /** The key of every ORDERED_SPARSE_RECORDS'th record and its position. **/
+        std::vector< std::pair<std::vector<uint8_t>, uint64_t> > vSparse;
+
+
+        /** Default Constructor. **/
+        OrderedRun()
+        : nFile   (0)
+        , nSize   (0)
+        , fLoaded (false)
+        , vSparse ( )
+        {
+        }
+    };
+
+
+    /** BinaryOrderedMap
+     *
+     *  An ordered keychain, holding binary keys in sorted order so ranges of keys
+     *  sharing a prefix can be read together.
+     *
+     *  It is laid out like a log-structured merge tree. New keys are kept in a memory
+     *  table and appended to a log, which is replayed if the node stops before they are
+     *  written out. Once the memory table is full it is written to a new run, a file of
+     *  records sorted by key. Runs are merged as they are written so that each is
+     *  at least twice the size of the one after it, keeping reads to a few runs.
+     *
+     *  Erased keys are written as markers that hide the key in older runs, and are only
+     *  dropped once they are merged into the oldest run.
+     *
+     **/
+    class BinaryOrderedMap
+    {
+    protected:
+
+        /** Mutex for Thread Synchronization. **/
+        mutable std::mutex KEY_MUTEX;
+
+
+        /** The string to hold the keychain location. **/
+        std::string strBaseLocation;
+
+
+        /** The newest keys, mapped to an erased flag and their value. **/
+        std::map< std::vector<uint8_t>, std::pair<bool, std::vector<uint8_t>> > mapMemory;
+
+
+        /** The memory used by the memory table. **/
+        uint64_t nMemorySize;
+
+
+        /** The log of the memory table. **/
+        std::ofstream* pLog;
+
+
+        /** The runs, oldest first. **/
+        std::vector<OrderedRun> vRuns;
+
+
+        /** The file number of the next run. **/
+        uint32_t nNextRun;
+
+
+        /** Positional read handles for the runs. **/
+        FileReader* pReader;
+
+
+    public:
+
+        /** Default Constructor. **/
+        BinaryOrderedMap()                                          = delete;
+
+
+        /** Copy Constructor. **/
+        BinaryOrderedMap(const BinaryOrderedMap& map)               = delete;
+
+
+        /** Copy assignment. **/
+        BinaryOrderedMap& operator=(const BinaryOrderedMap& map)    = delete;
+
+
+        /** The Keychain Constructor.
+         *
+         *  @param[in] strBaseLocationIn The directory of the keychain, created on first write.
+         *
+         **/
+        BinaryOrderedMap(const std::string& strBaseLocationIn);
+
+
+        /** Default Destructor **/
+        ~BinaryOrderedMap();
+
+
+        /** Put
+         *
+         *  Write a key and its value.
+         *
+         *  @param[in] vKey The binary data of the key.
+         *  @param[in] vValue The binary data of the value.
+         *
+         *  @return True if the key was written.
+         *
+         **/
+        bool Put(const std::vector<uint8_t>& vKey, const std::vector<uint8_t>& vValue);
+
+
+        /** Erase
+         *
+         *  Erase a key.
+         *
+         *  @param[in] vKey The binary data of the key.
+         *
+         *  @return True if the erase was written.
+         *
+         **/
+        bool Erase(const std::vector<uint8_t>& vKey);
+
+
+        /** ReadRange
+         *
+         *  Read the keys sharing a prefix in order, from a starting key.
+         *
+         *  @param[in] vPrefix The prefix the keys start with.
+         *  @param[in] vFrom The key to start from, which starts with the prefix.
+         *  @param[in] nLimit The maximum keys to read.
+         *  @param[out] vValues The keys and their values, in order.
+         *
+         *  @return True if any keys were read.
+         *
+         **/
+        bool ReadRange(const std::vector<uint8_t>& vPrefix, const std::vector<uint8_t>& vFrom, const uint32_t nLimit,
+            std::vector< std::pair<std::vector<uint8_t>, std::vector<uint8_t>> >& vValues);
+
+
+        /** Flush
+         *
+         *  Write the memory table out to a new run, merging runs if needed.
+         *
+         *  @return True if the memory table was written.
+         *
+         **/
+        bool Flush();
+
+
+    private:
+
+        /** Initialize
+         *
+         *  Load the list of runs and replay the log into the memory table.
+         *
+         **/
+        void Initialize();
+
+
+        /** Write
+         *
+         *  Add a key to the memory table and its log, flushing if the memory table is full.
+         *  Must be called holding KEY_MUTEX.
+         *
+         *  @param[in] vKey The binary data of the key.
+         *  @param[in] fErased True if the key is erased.
+         *  @param[in] vValue The binary data of the value.
+         *
+         *  @return True if the key was written.
+         *
+         **/
+        bool write(const std::vector<uint8_t>& vKey, const bool fErased, const std::vector<uint8_t>& vValue);
+
+
+        /** Flush
+         *
+         *  Write the memory table out to a new run. Must be called holding KEY_MUTEX.
+         *
+         **/
+        bool flush();
+
+
+        /** Merge
+         *
+         *  Merge the newest runs while a run is less than twice the size of the one after it.
+         *  Must be called holding KEY_MUTEX.
+         *
+         **/
+        bool merge();
+
+
+        /** Load
+         *
+         *  Build the sparse index of a run by reading it through.
+         *
+         *  @param[in] run The run to load.
+         *
+         **/
+        bool load(OrderedRun& run);
+
+
+        /** Save
+         *
+         *  Write the list of runs, replacing the old list in one rename.
+         *
+         **/
+        bool save();
+
+
+        /** RunFile
+         *
+         *  Get the path of a run file.
+         *
+         *  @param[in] nFile The file number of the run.
+         *
+         **/
+        std::string run_file(const uint32_t nFile) const;
+    };
+}
+
+#endif
@@ -15,17 +15,19 @@ ________________________________________________________________________________
 #ifndef NEXUS_LLD_TEMPLATES_SHARD_HASHMAP_H
 #define NEXUS_LLD_TEMPLATES_SHARD_HASHMAP_H
 
-#include <LLD/templates/key.h>
+#include <LLD/keychain/keychain.h>
 #include <LLD/cache/template_lru.h>
+#include <LLD/cache/bloom.h>
+#include <LLD/templates/reader.h>
 #include <LLD/include/enum.h>
 
+#include <atomic>
 #include <cstdint>
 #include <string>
 #include <fstream>
 #include <vector>
 #include <mutex>
 
-//TODO: Abstract base class for all keychains
 namespace LLD
 {
 
@@ -33,16 +35,38 @@ namespace LLD
      *
      *  This class is responsible for managing the keys to the sector database.
      *
-     *  It contains a Binary Hash Map with a minimum complexity of O(1).
-     *  It uses a linked file list based on index to iterate trhough files and binary Positions
-     *  when there is a collision that is found.
+     *  It is a Binary Hash Map split into shards, each with its own disk index and
+     *  linked list of hashmap files. A new file in the list only allocates space
+     *  for the buckets of one shard, so collisions cost a fraction of what they do
+     *  in BinaryHashMap, and each file has a bloom filter to skip probes on misses.
+     *
+     *  On-disk format, in the keychain directory:
+     *
+     *  _index.SSS          The disk index of shard SSS. One little-endian uint16_t
+     *                      per bucket holding the number of hashmap files in use by
+     *                      that bucket.
+     *
+     *  _hashmap.SSS.NNNNN  Hashmap file NNNNN of shard SSS. One fixed size slot per
+     *                      bucket at (bucket * 45), holding the serialized SectorKey
+     *                      header (state, key length, sector file, size and start,
+     *                      13 bytes) followed by the compressed key (up to 32 bytes).
+     *                      A slot of all zero bytes is empty or erased.
+     *
+     *  _shard.bloom        The bloom filters persisted on shutdown. Removed when
+     *                      loaded, so an unclean shutdown rebuilds them from the
+     *                      hashmap files.
+     *
+     *  A key is placed by the XXH64 of its compressed key. The shard is the hash
+     *  modulo the total shards, and the bucket is the remaining quotient modulo the
+     *  buckets per shard. Hashing the compressed key lets an existing BinaryHashMap
+     *  be migrated from its files alone, see Migrate.
      *
      **/
-    class ShardHashMap
+    class ShardHashMap : public Keychain
     {
     protected:
 
-        /** Mutex for Thread Synchronization. **/
+        /** Mutex for Thread Synchronization of the keychain streams and file lists. **/
         mutable std::mutex KEY_MUTEX;
 
 
@@ -50,19 +74,23 @@ namespace LLD
         std::string strBaseLocation;
 
 
-        /** Keychain stream object. **/
+        /** Keychain stream object by shard and file. **/
         TemplateLRU<std::pair<uint16_t, uint16_t>, std::fstream*>* fileCache;
 
 
-        /** Disk index shard LRU cache **/
-        TemplateLRU<uint16_t, std::vector<uint16_t>*>* diskShards;
+        /** Disk index stream of each shard. **/
+        std::vector<std::fstream*> vIndex;
+
 
+        /** Positional read handles of each shard's hashmap files. **/
+        std::vector<FileReader*> vReader;
 
-        /** Keychain index stream. **/
-        TemplateLRU<uint16_t, std::fstream*>* indexCache;
 
+        /** Total files in use by each bucket of each shard. **/
+        std::vector< std::vector<uint16_t> > vHashmap;
 
-        /** The Maximum buckets allowed in the hashmap. */
+
+        /** The Maximum buckets allowed in each shard. */
         uint32_t HASHMAP_TOTAL_BUCKETS;
 
 
@@ -82,24 +110,53 @@ namespace LLD
         uint8_t nFlags;
 
 
-        /* The key level locking hashmap. */
+        /** The bucket striped locks, taken before KEY_MUTEX. Lookups only need the stripe. **/
         mutable std::vector<std::mutex> RECORD_MUTEX;
 
 
+        /** Bloom filters for each hashmap file of each shard. **/
+        std::vector< std::vector<BloomFilter> > vBloom;
+
+
+        /** The bits of filter space per bucket of each hashmap file, zero disables the filters. **/
+        uint8_t HASHMAP_BLOOM_BITS;
+
+
+        /** Meter counters for the bloom filters. **/
+        std::atomic<uint64_t> nBloomSkipped;
+        std::atomic<uint64_t> nBloomHits;
+        std::atomic<uint64_t> nBloomFalse;
+
+
+        /** The histogram of the files each read probes, set by the database. **/
+        metrics::Histogram* pProbes;
+
+
     public:
 
 
-        /** The Database Constructor. To determine file location and the Bytes per Record. **/
-        ShardHashMap(const std::string& strBaseLocationIn, const uint8_t nFlagsIn = FLAGS::APPEND,
-            const uint64_t nBucketsIn = 256 * 256 * 64, const uint32_t nShardsIn = 4);
+        /** Default Constructor. **/
+        ShardHashMap() = delete;
+
+
+        /** Copy Constructor. **/
+        ShardHashMap(const ShardHashMap& map) = delete;
 
 
         /** Copy Assignment Operator **/
-        ShardHashMap& operator=(const ShardHashMap& map);
+        ShardHashMap& operator=(const ShardHashMap& map) = delete;
 
 
-        /** Copy Constructor **/
-        ShardHashMap(const ShardHashMap& map);
+        /** The Database Constructor. To determine file location and the Bytes per Record.
+         *
+         *  @param[in] strBaseLocationIn The keychain directory.
+         *  @param[in] nFlagsIn The keychain flags.
+         *  @param[in] nBucketsIn The total buckets, split evenly between the shards.
+         *  @param[in] nShardsIn The total shards.
+         *
+         **/
+        ShardHashMap(const std::string& strBaseLocationIn, const uint8_t nFlagsIn = FLAGS::APPEND,
+            const uint64_t nBucketsIn = 256 * 256 * 64, const uint32_t nShardsIn = 16);
 
 
         /** Default Destructor **/
@@ -120,30 +177,20 @@ namespace LLD
 
         /** GetBucket
          *
-         *  Calculates a bucket to be used for the hashmap allocation.
+         *  Calculates the shard and bucket to be used for the hashmap allocation.
          *
-         *  @param[in] vKey The key object to calculate with.
-         *  @param[in] nShard The shard assigned to hashmap object.
+         *  @param[in] vKeyCompressed The compressed key to calculate with.
+         *  @param[out] nShard The shard assigned to the key.
          *
-         *  @return The bucket assigned to the key.
+         *  @return The bucket assigned to the key within its shard.
          *
          **/
-        uint32_t GetBucket(const std::vector<uint8_t>& vKey, uint32_t& nShard);
-
-
-        /** LoadShardIndex
-         *
-         *  Loads a disk index containing shard data into memory.
-         *
-         *  @param[in] The shard to load index for.
-         *
-         **/
-        void LoadShardIndex(const uint32_t nShard);
+        uint32_t GetBucket(const std::vector<uint8_t>& vKeyCompressed, uint32_t& nShard);
 
 
         /** Initialize
          *
-         *  Initialize the binary hash map keychain.
+         *  Initialize the shard hash map keychain.
          *
          **/
         void Initialize();
@@ -188,6 +235,24 @@ namespace LLD
         bool Put(const SectorKey& cKey);
 
 
+        /** Flush
+         *
+         *  Flush all buffers to disk if using ACID transaction.
+         *
+         **/
+        void Flush();
+
+
+        /** Sync
+         *
+         *  Sync the index and hashmap files to disk so the write-ahead log can be cleared.
+         *
+         *  @return True if all files were synced, false otherwise.
+         *
+         **/
+        bool Sync();
+
+
         /** Restore
          *
          *  Restore an erased key from keychain.
@@ -203,7 +268,6 @@ namespace LLD
         /** Erase
          *
          *  Erase a key from the disk hashmaps.
-         *  TODO: This should be optimized further.
          *
          *  @param[in] vKey the key to erase.
          *
@@ -211,6 +275,147 @@ namespace LLD
          *
          **/
         bool Erase(const std::vector<uint8_t> &vKey);
+
+
+        /** Meter
+         *
+         *  Get the bloom filter statistics for the LLD meters and reset the counters.
+         *
+         *  @return The formatted bloom filter statistics.
+         *
+         **/
+        std::string Meter();
+
+
+        /** SetProbes
+         *
+         *  Set the histogram to count the keychain files each read probes in.
+         *
+         *  @param[in] pProbesIn The histogram.
+         *
+         **/
+        void SetProbes(metrics::Histogram* pProbesIn);
+
+
+        /** Migrate
+         *
+         *  Copy every key of a BinaryHashMap in the same directory into this keychain.
+         *  The BinaryHashMap files are left in place and are no longer used.
+         *
+         *  @param[in] nHashmapBuckets The total buckets the BinaryHashMap was created with.
+         *
+         *  @return True if all keys were migrated.
+         *
+         **/
+        bool Migrate(const uint32_t nHashmapBuckets);
+
+
+        /** Scan
+         *
+         *  Walk every ready key in the hashmap files, reading them in chunks of buckets.
+         *  The slot is the shard and hashmap file times the buckets per shard plus the bucket.
+         *
+         *  @param[in] fnKey The function to call with the slot and key of each ready key.
+         *
+         *  @return True if the keychain was scanned.
+         *
+         **/
+        bool Scan(const std::function<void(const uint64_t nSlot, const SectorKey& cKey)>& fnKey);
+
+
+        /** Relocate
+         *
+         *  Point a key found by Scan to a new sector location, only if its slot still holds it unchanged.
+         *
+         *  @param[in] nSlot The slot the key was found in.
+         *  @param[in] cKey The key as it was found, with its compressed key.
+         *  @param[in] nSectorFile The new sector file.
+         *  @param[in] nSectorStart The new start of the record in the sector file.
+         *
+         *  @return True if the key was moved.
+         *
+         **/
+        bool Relocate(const uint64_t nSlot, const SectorKey& cKey, const uint16_t nSectorFile, const uint32_t nSectorStart);
+
+
+    private:
+
+        /** HashmapFile
+         *
+         *  Get the file name of a hashmap file in a shard.
+         *
+         *  @param[in] nShard The shard of the file.
+         *  @param[in] nFile The file number in the shard.
+         *
+         **/
+        std::string hashmap_file(const uint32_t nShard, const uint32_t nFile) const;
+
+
+        /** GetStream
+         *
+         *  Get the stream of a hashmap file from the LRU, opening it if needed.
+         *  Must be called holding KEY_MUTEX.
+         *
+         *  @param[in] nShard The shard of the file.
+         *  @param[in] nFile The file number in the shard.
+         *
+         *  @return The stream, or nullptr if it couldn't be opened.
+         *
+         **/
+        std::fstream* get_stream(const uint32_t nShard, const uint16_t nFile);
+
+
+        /** BloomCheck
+         *
+         *  Check the bloom filter of a hashmap file for a key.
+         *
+         *  @param[in] nShard The shard of the file.
+         *  @param[in] nFile The hashmap file to check.
+         *  @param[in] vKeyCompressed The compressed key to check for.
+         *
+         *  @return False if the key is definitely not in the file.
+         *
+         **/
+        bool bloom_check(const uint32_t nShard, const uint16_t nFile, const std::vector<uint8_t>& vKeyCompressed);
+
+
+        /** BloomInsert
+         *
+         *  Add a key to the bloom filter of a hashmap file, creating the filter if needed.
+         *
+         *  @param[in] nShard The shard of the file.
+         *  @param[in] nFile The hashmap file to add to.
+         *  @param[in] vKeyCompressed The compressed key to add.
+         *
+         **/
+        void bloom_insert(const uint32_t nShard, const uint16_t nFile, const std::vector<uint8_t>& vKeyCompressed);
+
+
+        /** BloomCreate
+         *
+         *  Create an empty bloom filter for one hashmap file of a shard, sized by the
+         *  buckets per shard and the bits per bucket set with -bloombits.
+         *
+         *  @return The empty bloom filter.
+         *
+         **/
+        BloomFilter bloom_create() const;
+
+
+        /** BloomLoad
+         *
+         *  Load the bloom filters from disk, or rebuild them from the hashmap files.
+         *
+         **/
+        void bloom_load();
+
+
+        /** BloomSave
+         *
+         *  Persist the bloom filters next to the shard indexes.
+         *
+         **/
+        void bloom_save();
     };
 }
 
@@ -27,6 +27,7 @@ ________________________________________________________________________________
 #include <TAO/Ledger/types/mempool.h>
 #include <TAO/Ledger/types/client.h>
 
+#include <algorithm>
 #include <tuple>
 
 namespace LLD
@@ -254,6 +255,44 @@ namespace LLD
     }
 
 
+    /* Reads a list of transactions from the ledger DB, reading the ones on disk together. */
+    bool LedgerDB::ReadTx(const std::vector<uint512_t>& vHashes, std::vector<TAO::Ledger::Transaction> &vtx, const uint8_t nFlags)
+    {
+        /* Check for client mode. */
+        if(config::fClient.load())
+        {
+            vtx.resize(vHashes.size());
+            for(uint32_t n = 0; n < vHashes.size(); ++n)
+            {
+                if(!ReadTx(vHashes[n], vtx[n], nFlags))
+                    return false;
+            }
+
+            return true;
+        }
+
+        /* Read the transactions on disk. */
+        std::vector<bool> vFound;
+        MultiRead(vHashes, vtx, vFound);
+
+        for(uint32_t n = 0; n < vHashes.size(); ++n)
+        {
+            /* Special check for memory pool. */
+            if(nFlags == TAO::Ledger::FLAGS::MEMPOOL || nFlags == TAO::Ledger::FLAGS::MINER)
+            {
+                /* Get the transaction. */
+                if(TAO::Ledger::mempool.Get(vHashes[n], vtx[n]))
+                    continue;
+            }
+
+            if(!vFound[n])
+                return false;
+        }
+
+        return true;
+    }
+
+
     /* Erases a transaction from the ledger DB. */
     bool LedgerDB::EraseTx(const uint512_t& hashTx)
     {
@@ -626,6 +665,10 @@ namespace LLD
         if(config::fClient.load())
             return Client->Index(std::make_pair(hashAddress, nSequence), hashTx);
 
+        /* Keep the event in the ordered keychain to read ranges of events. */
+        if(!WriteOrdered(std::make_pair(std::string("event"), hashAddress), nSequence, hashTx))
+            return false;
+
         return Index(std::make_pair(hashAddress, nSequence), hashTx);
     }
 
@@ -646,6 +689,10 @@ namespace LLD
         if(config::fClient.load())
             return Client->Erase(std::make_pair(hashAddress, nSequence - 1));
 
+        /* Remove the event from the ordered keychain. */
+        if(!EraseOrdered(std::make_pair(std::string("event"), hashAddress), nSequence - 1))
+            return false;
+
         return Erase(std::make_pair(hashAddress, nSequence - 1));
     }
 
@@ -662,6 +709,68 @@ namespace LLD
     }
 
 
+    /* Reads a range of events in order of their sequence. */
+    bool LedgerDB::ReadEvents(const uint256_t& hashAddress, const uint32_t nSequence, const uint32_t nLimit,
+        std::vector<TAO::Ledger::Transaction> &vtx)
+    {
+        vtx.clear();
+
+        /* Check for client mode. */
+        if(config::fClient.load())
+        {
+            TAO::Ledger::Transaction tx;
+            while(vtx.size() < nLimit && ReadEvent(hashAddress, nSequence + vtx.size(), tx))
+                vtx.push_back(tx);
+
+            return !vtx.empty();
+        }
+
+        /* Only events below the current sequence are live. */
+        uint32_t nEnd = 0;
+        if(!ReadSequence(hashAddress, nEnd) || nSequence >= nEnd)
+            return false;
+
+        nEnd = std::min(nEnd, nSequence + std::min(nLimit, nEnd - nSequence));
+
+        /* Get the transaction hashes of the range in one read. */
+        std::vector< std::pair<uint64_t, uint512_t> > vEvents;
+        ReadRange(std::make_pair(std::string("event"), hashAddress), nSequence, nEnd - nSequence, vEvents);
+
+        /* Read the transactions of the range together. */
+        std::vector<uint512_t> vHashes;
+        for(const auto& event : vEvents)
+            vHashes.push_back(event.second);
+
+        std::vector<TAO::Ledger::Transaction> vRead;
+        std::vector<bool> vFound;
+        MultiRead(vHashes, vRead, vFound);
+
+        /* Add the transactions in order. */
+        uint32_t nEvent = 0;
+        for(uint32_t nThis = nSequence; nThis < nEnd; ++nThis)
+        {
+            /* Skip events of the ordered keychain that were replaced. */
+            while(nEvent < vEvents.size() && vEvents[nEvent].first < nThis)
+                ++nEvent;
+
+            TAO::Ledger::Transaction tx;
+            if(nEvent < vEvents.size() && vEvents[nEvent].first == nThis && vFound[nEvent])
+                vtx.push_back(vRead[nEvent]);
+
+            /* Events written before the ordered keychain are read by sequence and added to it. */
+            else if(ReadEvent(hashAddress, nThis, tx))
+            {
+                WriteOrdered(std::make_pair(std::string("event"), hashAddress), nThis, tx.GetHash());
+                vtx.push_back(tx);
+            }
+            else
+                break;
+        }
+
+        return !vtx.empty();
+    }
+
+
     /* Reads the last event (highest sequence number) for the sig chain / register */
     bool LedgerDB::ReadLastEvent(const uint256_t& hashAddress, uint512_t& hashLast)
     {
@@ -672,6 +781,14 @@ namespace LLD
         /* Read the transaction ID of the last event */
         if(nSequence > 0)
         {
+            /* Check the ordered keychain first, which holds the transaction ID itself. */
+            std::vector< std::pair<uint64_t, uint512_t> > vEvents;
+            if(ReadRange(std::make_pair(std::string("event"), hashAddress), nSequence - 1, 1, vEvents) && vEvents[0].first == nSequence - 1)
+            {
+                hashLast = vEvents[0].second;
+                return true;
+            }
+
             TAO::Ledger::Transaction tx;
             if(ReadEvent(hashAddress, nSequence -1, tx))
             {
@@ -0,0 +1,286 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLD/templates/mmap.h>
+
+#include <Util/include/debug.h>
+#include <Util/include/mutex.h>
+
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <thread>
+
+#ifndef WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace LLD
+{
+
+    /*  A read-only memory mapping of a single database file. */
+    struct MappedRegion
+    {
+        /** The start of the mapped memory. **/
+        uint8_t* pBegin;
+
+        /** The length of the mapping in bytes. **/
+        uint64_t nLength;
+
+
+        /** Default constructor **/
+        MappedRegion()
+        : pBegin  (nullptr)
+        , nLength (0)
+        {
+        }
+
+
+        /** Unmap the file when the last reader is done with it. **/
+        ~MappedRegion()
+        {
+        #ifndef WIN32
+            if(pBegin)
+                munmap(pBegin, nLength);
+        #endif
+        }
+
+
+        /** Map a file read-only. **/
+        bool Map(const std::string& strFile)
+        {
+        #ifndef WIN32
+            /* Open the file read only, the descriptor isn't needed after mapping. */
+            int fd = open(strFile.c_str(), O_RDONLY);
+            if(fd < 0)
+                return false;
+
+            /* Get the current size of the file. */
+            struct stat st;
+            if(fstat(fd, &st) != 0 || st.st_size == 0)
+            {
+                close(fd);
+                return false;
+            }
+
+            /* Map the whole file. */
+            void* pMap = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+            close(fd);
+
+            if(pMap == MAP_FAILED)
+                return debug::error(FUNCTION, "failed to map ", strFile, " (", strerror(errno), ")");
+
+            pBegin  = static_cast<uint8_t*>(pMap);
+            nLength = static_cast<uint64_t>(st.st_size);
+
+            return true;
+        #else
+            return false;
+        #endif
+        }
+    };
+
+
+    /* Prefix Constructor */
+    MemoryMap::MemoryMap(const std::string& strPrefixIn)
+    : MUTEX     ( )
+    , strPrefix (strPrefixIn)
+    , nEpoch    (0)
+    {
+        for(auto& pBlock : vBlocks)
+            pBlock.store(nullptr);
+
+        nReaders[0].store(0);
+        nReaders[1].store(0);
+    }
+
+
+    /* Default Destructor */
+    MemoryMap::~MemoryMap()
+    {
+        /* No reader can be left once the database is closing. */
+        for(auto& pBlock : vBlocks)
+        {
+            std::atomic<MappedRegion*>* pSlots = pBlock.load();
+            if(!pSlots)
+                continue;
+
+            for(uint32_t n = 0; n < MMAP_BLOCK_FILES; ++n)
+                delete pSlots[n].load();
+
+            delete[] pSlots;
+        }
+    }
+
+
+    /* Copy data out of a mapped file, mapping or remapping the file if needed. */
+    bool MemoryMap::Read(const uint32_t nFile, const uint64_t nPos, uint8_t* pData, const uint64_t nSize)
+    {
+        /* Files past the table are read from their streams. */
+        if(nFile >= MMAP_TOTAL_BLOCKS * MMAP_BLOCK_FILES)
+            return false;
+
+        /* Copy out of the current mapping if it covers the range. */
+        if(copy(nFile, nPos, pData, nSize))
+            return true;
+
+        /* Otherwise map the file again at its current size and retry. */
+        if(!remap(nFile, nPos + nSize))
+            return false;
+
+        return copy(nFile, nPos, pData, nSize);
+    }
+
+
+    /* Drop the mapping of a file so it is remapped on next read. */
+    void MemoryMap::Release(const uint32_t nFile)
+    {
+        if(nFile >= MMAP_TOTAL_BLOCKS * MMAP_BLOCK_FILES)
+            return;
+
+        LOCK(MUTEX);
+        retire(nFile, nullptr);
+    }
+
+
+    /* Drop the mapping of a file and truncate the file once no reader is copying from it. */
+    bool MemoryMap::Truncate(const uint32_t nFile)
+    {
+        /* Hold the mutex until the file is cut, so no reader maps it again in between. */
+        LOCK(MUTEX);
+        if(nFile < MMAP_TOTAL_BLOCKS * MMAP_BLOCK_FILES)
+            retire(nFile, nullptr);
+
+        std::ofstream stream(debug::safe_printstr(strPrefix, std::setfill('0'), std::setw(5), nFile), std::ios::out | std::ios::binary | std::ios::trunc);
+        if(!stream)
+            return false;
+
+        stream.close();
+
+        return true;
+    }
+
+
+    /* Check if memory mapped files are supported on this platform. */
+    bool MemoryMap::Supported()
+    {
+    #ifndef WIN32
+        return true;
+    #else
+        return false;
+    #endif
+    }
+
+
+    /* Get the table entry of a file's mapping. */
+    std::atomic<MappedRegion*>* MemoryMap::slot(const uint32_t nFile, const bool fCreate)
+    {
+        std::atomic<MappedRegion*>* pSlots = vBlocks[nFile / MMAP_BLOCK_FILES].load();
+        if(!pSlots && fCreate)
+        {
+            /* Allocate the block, only ever done holding MUTEX so it is never replaced. */
+            pSlots = new std::atomic<MappedRegion*>[MMAP_BLOCK_FILES];
+            for(uint32_t n = 0; n < MMAP_BLOCK_FILES; ++n)
+                pSlots[n].store(nullptr);
+
+            vBlocks[nFile / MMAP_BLOCK_FILES].store(pSlots);
+        }
+
+        if(!pSlots)
+            return nullptr;
+
+        return &pSlots[nFile % MMAP_BLOCK_FILES];
+    }
+
+
+    /* Copy data out of the current mapping of a file, registered as a reader. */
+    bool MemoryMap::copy(const uint32_t nFile, const uint64_t nPos, uint8_t* pData, const uint64_t nSize)
+    {
+        std::atomic<MappedRegion*>* pSlot = slot(nFile, false);
+        if(!pSlot)
+            return false;
+
+        /* Register in the current epoch before loading the mapping, so retire waits for this copy. If the
+           epoch moved on before the count went up, a retire may not have waited, so register in the new one. */
+        uint32_t nParity = nEpoch.load() & 1;
+        ++nReaders[nParity];
+        while((nEpoch.load() & 1) != nParity)
+        {
+            --nReaders[nParity];
+
+            nParity = nEpoch.load() & 1;
+            ++nReaders[nParity];
+        }
+
+        /* Copy the data out without holding any locks. */
+        const MappedRegion* pRegion = pSlot->load();
+        const bool fCovered = (pRegion && pRegion->nLength >= nPos + nSize);
+        if(fCovered)
+            std::copy(pRegion->pBegin + nPos, pRegion->pBegin + nPos + nSize, pData);
+
+        --nReaders[nParity];
+
+        return fCovered;
+    }
+
+
+    /* Map a file at its current size if its mapping doesn't cover a range. */
+    bool MemoryMap::remap(const uint32_t nFile, const uint64_t nEnd)
+    {
+        LOCK(MUTEX);
+
+        /* Check if another reader mapped the range first. */
+        std::atomic<MappedRegion*>* pSlot = slot(nFile, true);
+        const MappedRegion* pCurrent = pSlot->load();
+        if(pCurrent && pCurrent->nLength >= nEnd)
+            return true;
+
+        /* Map the file at its current size, this picks up any appends since the last mapping. */
+        MappedRegion* pRegion = new MappedRegion();
+        if(!pRegion->Map(debug::safe_printstr(strPrefix, std::setfill('0'), std::setw(5), nFile))
+        || pRegion->nLength < nEnd)
+        {
+            /* The data isn't on disk. */
+            delete pRegion;
+            return false;
+        }
+
+        retire(nFile, pRegion);
+
+        return true;
+    }
+
+
+    /* Replace the mapping of a file, and unmap the old one once no reader can see it. */
+    void MemoryMap::retire(const uint32_t nFile, MappedRegion* pRegion)
+    {
+        std::atomic<MappedRegion*>* pSlot = slot(nFile, pRegion != nullptr);
+        if(!pSlot)
+            return;
+
+        /* Publish the new mapping, readers from here on load it. */
+        MappedRegion* pOld = pSlot->exchange(pRegion);
+        if(!pOld)
+            return;
+
+        /* Move new readers to the other epoch, then wait out the readers that may have loaded the old mapping. */
+        const uint32_t nParity = nEpoch.fetch_add(1) & 1;
+        while(nReaders[nParity].load() != 0)
+            std::this_thread::yield();
+
+        delete pOld;
+    }
+}
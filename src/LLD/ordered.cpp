@@ -0,0 +1,686 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLD/keychain/ordered.h>
+#include <LLD/templates/reader.h>
+#include <LLD/templates/segment.h>
+#include <LLD/include/version.h>
+
+#include <Util/templates/datastream.h>
+#include <Util/include/filesystem.h>
+#include <Util/include/debug.h>
+#include <Util/include/mutex.h>
+
+#include <algorithm>
+#include <iomanip>
+
+namespace LLD
+{
+
+    /* The bytes read from a run at a time. */
+    const uint32_t ORDERED_READ_SIZE = 1024 * 64; //64 KB read buffer
+
+
+    /* The memory of a key in the memory table besides its key and value. */
+    const uint32_t ORDERED_ENTRY_SIZE = 64;
+
+
+    /* Get the ordered key of a sequence number under a prefix. */
+    std::vector<uint8_t> OrderedKey(const std::vector<uint8_t>& vPrefix, const uint64_t nSequence)
+    {
+        std::vector<uint8_t> vKey(vPrefix);
+        for(int32_t nShift = 56; nShift >= 0; nShift -= 8)
+            vKey.push_back(static_cast<uint8_t>(nSequence >> nShift));
+
+        return vKey;
+    }
+
+
+    /* Get the sequence number at the end of an ordered key. */
+    uint64_t OrderedSequence(const std::vector<uint8_t>& vKey)
+    {
+        uint64_t nSequence = 0;
+        for(uint32_t n = vKey.size() - 8; n < vKey.size(); ++n)
+            nSequence = (nSequence << 8) | vKey[n];
+
+        return nSequence;
+    }
+
+
+    /*  Serialize a record of a run or the log: the key, the erased flag and the value. */
+    void append_record(std::vector<uint8_t>& vData, const std::vector<uint8_t>& vKey, const bool fErased, const std::vector<uint8_t>& vValue)
+    {
+        DataStream ssRecord(SER_LLD, DATABASE_VERSION);
+        ssRecord << vKey << uint8_t(fErased ? 1 : 0) << vValue;
+
+        vData.insert(vData.end(), ssRecord.Bytes().begin(), ssRecord.Bytes().end());
+    }
+
+
+    /*  Read a record of a run or the log, false if it isn't all in the buffer. */
+    bool read_record(const uint8_t* pData, const uint64_t nAvailable,
+        std::vector<uint8_t>& vKey, bool& fErased, std::vector<uint8_t>& vValue, uint64_t& nLength)
+    {
+        /* Read the key. */
+        uint64_t nSize;
+        uint32_t nHeader;
+        if(!RecordHeader(pData, nAvailable, nSize, nHeader) || nHeader + nSize + 1 > nAvailable)
+            return false;
+
+        vKey.assign(pData + nHeader, pData + nHeader + nSize);
+        nLength = nHeader + nSize;
+
+        /* Read the erased flag. */
+        fErased = (pData[nLength] != 0);
+        ++nLength;
+
+        /* Read the value. */
+        if(!RecordHeader(pData + nLength, nAvailable - nLength, nSize, nHeader) || nLength + nHeader + nSize > nAvailable)
+            return false;
+
+        vValue.assign(pData + nLength + nHeader, pData + nLength + nHeader + nSize);
+        nLength += nHeader + nSize;
+
+        return true;
+    }
+
+
+    /*  Reads the records of a run in order. */
+    class OrderedCursor
+    {
+        /* The handles to read with. */
+        FileReader* pReader;
+
+        /* The path of the run, to read through a stream if positional reads are not supported. */
+        std::string strFile;
+
+        /* The run to read. */
+        uint32_t nFile;
+        uint64_t nSize;
+
+        /* The bytes read from the run and where they start. */
+        std::vector<uint8_t> vBuffer;
+        uint64_t nBufferStart;
+
+        /* The position of the next record. */
+        uint64_t nPos;
+
+    public:
+
+        /* The current record. */
+        std::vector<uint8_t> vKey;
+        bool fErased;
+        std::vector<uint8_t> vValue;
+
+        /* True while there is a current record. */
+        bool fValid;
+
+
+        /* Start reading a run at a record position. */
+        OrderedCursor(FileReader* pReaderIn, const std::string& strFileIn, const OrderedRun& run, const uint64_t nPosIn)
+        : pReader      (pReaderIn)
+        , strFile      (strFileIn)
+        , nFile        (run.nFile)
+        , nSize        (run.nSize)
+        , vBuffer      ( )
+        , nBufferStart (0)
+        , nPos         (nPosIn)
+        , vKey         ( )
+        , fErased      (false)
+        , vValue       ( )
+        , fValid       (false)
+        {
+        }
+
+
+        /* Move to the next record, false at the end of the run. */
+        bool Next()
+        {
+            fValid = false;
+
+            uint64_t nRead = ORDERED_READ_SIZE;
+            while(nPos < nSize)
+            {
+                /* Read the record from the buffer if it's all there. */
+                if(nPos >= nBufferStart && nPos < nBufferStart + vBuffer.size())
+                {
+                    const uint64_t nOffset = nPos - nBufferStart;
+
+                    uint64_t nLength;
+                    if(read_record(&vBuffer[nOffset], vBuffer.size() - nOffset, vKey, fErased, vValue, nLength))
+                    {
+                        nPos  += nLength;
+                        fValid = true;
+
+                        return true;
+                    }
+
+                    /* A record that doesn't fit the rest of the run is corrupted. */
+                    if(nOffset == 0)
+                    {
+                        if(vBuffer.size() == nSize - nPos)
+                            return debug::error(FUNCTION, "corrupted record at ", nPos, " of ", strFile);
+
+                        /* Allocate a larger buffer if full record exceeds default buffer. */
+                        nRead = vBuffer.size() * 2;
+                    }
+                }
+
+                /* Read the next part of the run. */
+                nBufferStart = nPos;
+                vBuffer.resize(std::min(nSize - nPos, nRead));
+                if(!read(&vBuffer[0], vBuffer.size()))
+                {
+                    debug::error(FUNCTION, "failed to read ", vBuffer.size(), " bytes at ", nPos, " of ", strFile);
+
+                    vBuffer.clear();
+                    return false;
+                }
+            }
+
+            return false;
+        }
+
+
+        /* The position of the next record. */
+        uint64_t Position() const
+        {
+            return nPos;
+        }
+
+
+    private:
+
+        /* Read at the buffer start, through a stream if positional reads are not supported. */
+        bool read(uint8_t* pData, const uint64_t nBytes)
+        {
+            if(pReader->Read(nFile, nBufferStart, pData, nBytes))
+                return true;
+
+            std::ifstream stream(strFile, std::ios::in | std::ios::binary);
+            stream.seekg(nBufferStart, std::ios::beg);
+
+            return !!stream.read((char*)pData, nBytes);
+        }
+    };
+
+
+    /*  Writes the records of a new run, building its sparse index. */
+    class OrderedWriter
+    {
+        /* The run file stream. */
+        std::ofstream stream;
+
+        /* The records not written yet. */
+        std::vector<uint8_t> vBuffer;
+
+        /* The records written to the run. */
+        uint64_t nRecords;
+
+    public:
+
+        /* The run being written. */
+        OrderedRun run;
+
+
+        /* Create the file of a run. */
+        OrderedWriter(const std::string& strFile, const uint32_t nFile)
+        : stream   (strFile, std::ios::out | std::ios::binary | std::ios::trunc)
+        , vBuffer  ( )
+        , nRecords (0)
+        , run      ( )
+        {
+            run.nFile   = nFile;
+            run.fLoaded = true;
+        }
+
+
+        /* Add the next record in key order. */
+        bool Add(const std::vector<uint8_t>& vKey, const bool fErased, const std::vector<uint8_t>& vValue)
+        {
+            /* Keep every few keys in memory to seek into the run. */
+            if(nRecords++ % ORDERED_SPARSE_RECORDS == 0)
+                run.vSparse.push_back(std::make_pair(vKey, run.nSize + vBuffer.size()));
+
+            append_record(vBuffer, vKey, fErased, vValue);
+            if(vBuffer.size() >= ORDERED_MEMORY_SIZE)
+                return write();
+
+            return true;
+        }
+
+
+        /* Write the records left in the buffer and close the file. */
+        bool Close()
+        {
+            if(!write())
+                return false;
+
+            stream.close();
+            return true;
+        }
+
+
+    private:
+
+        /* Write the buffered records to the file. */
+        bool write()
+        {
+            if(!stream.write((char*)vBuffer.data(), vBuffer.size()))
+                return false;
+
+            run.nSize += vBuffer.size();
+            vBuffer.clear();
+
+            return true;
+        }
+    };
+
+
+    /* The Keychain Constructor. */
+    BinaryOrderedMap::BinaryOrderedMap(const std::string& strBaseLocationIn)
+    : KEY_MUTEX       ( )
+    , strBaseLocation (strBaseLocationIn)
+    , mapMemory       ( )
+    , nMemorySize     (0)
+    , pLog            (nullptr)
+    , vRuns           ( )
+    , nNextRun        (0)
+    , pReader         (new FileReader(strBaseLocationIn + "_run."))
+    {
+        Initialize();
+    }
+
+
+    /* Default Destructor */
+    BinaryOrderedMap::~BinaryOrderedMap()
+    {
+        if(pLog)
+        {
+            pLog->close();
+            delete pLog;
+        }
+
+        delete pReader;
+    }
+
+
+    /* Write a key and its value. */
+    bool BinaryOrderedMap::Put(const std::vector<uint8_t>& vKey, const std::vector<uint8_t>& vValue)
+    {
+        LOCK(KEY_MUTEX);
+
+        return write(vKey, false, vValue);
+    }
+
+
+    /* Erase a key. */
+    bool BinaryOrderedMap::Erase(const std::vector<uint8_t>& vKey)
+    {
+        LOCK(KEY_MUTEX);
+
+        return write(vKey, true, std::vector<uint8_t>());
+    }
+
+
+    /* Read the keys sharing a prefix in order, from a starting key. */
+    bool BinaryOrderedMap::ReadRange(const std::vector<uint8_t>& vPrefix, const std::vector<uint8_t>& vFrom, const uint32_t nLimit,
+        std::vector< std::pair<std::vector<uint8_t>, std::vector<uint8_t>> >& vValues)
+    {
+        vValues.clear();
+
+        LOCK(KEY_MUTEX);
+
+        /* Start the memory table at the first key. */
+        auto it = mapMemory.lower_bound(vFrom);
+
+        /* Start each run at the first key, newest first so it hides the older runs. */
+        std::vector<OrderedCursor> vCursors;
+        for(auto run = vRuns.rbegin(); run != vRuns.rend(); ++run)
+        {
+            if(!run->fLoaded && !load(*run))
+                return false;
+
+            /* Seek to the last sparse key before the start. */
+            auto sparse = std::upper_bound(run->vSparse.begin(), run->vSparse.end(), vFrom,
+                [](const std::vector<uint8_t>& vKey, const std::pair<std::vector<uint8_t>, uint64_t>& entry)
+                {
+                    return vKey < entry.first;
+                });
+
+            const uint64_t nPos = (sparse == run->vSparse.begin()) ? 0 : (sparse - 1)->second;
+            vCursors.push_back(OrderedCursor(pReader, run_file(run->nFile), *run, nPos));
+
+            /* Skip the keys before the start. */
+            OrderedCursor& cursor = vCursors.back();
+            while(cursor.Next() && cursor.vKey < vFrom)
+                continue;
+        }
+
+        /* Merge the keys of the memory table and runs in order. */
+        while(vValues.size() < nLimit)
+        {
+            /* Find the lowest key. */
+            const std::vector<uint8_t>* pKey = (it != mapMemory.end()) ? &it->first : nullptr;
+            for(const auto& cursor : vCursors)
+                if(cursor.fValid && (!pKey || cursor.vKey < *pKey))
+                    pKey = &cursor.vKey;
+
+            /* Stop at the end of the keys with the prefix. */
+            if(!pKey || pKey->size() < vPrefix.size() || !std::equal(vPrefix.begin(), vPrefix.end(), pKey->begin()))
+                break;
+
+            const std::vector<uint8_t> vKey = *pKey;
+
+            /* The newest copy of the key is the one that counts. */
+            bool fFound = false;
+            if(it != mapMemory.end() && it->first == vKey)
+            {
+                if(!it->second.first)
+                    vValues.push_back(std::make_pair(vKey, it->second.second));
+
+                fFound = true;
+                ++it;
+            }
+
+            /* Move every run past the key. */
+            for(auto& cursor : vCursors)
+            {
+                if(!cursor.fValid || cursor.vKey != vKey)
+                    continue;
+
+                if(!fFound && !cursor.fErased)
+                    vValues.push_back(std::make_pair(vKey, cursor.vValue));
+
+                fFound = true;
+                cursor.Next();
+            }
+        }
+
+        return !vValues.empty();
+    }
+
+
+    /* Write the memory table out to a new run, merging runs if needed. */
+    bool BinaryOrderedMap::Flush()
+    {
+        LOCK(KEY_MUTEX);
+
+        return flush();
+    }
+
+
+    /* Load the list of runs and replay the log into the memory table. */
+    void BinaryOrderedMap::Initialize()
+    {
+        /* Read the list of runs. */
+        std::ifstream runs(strBaseLocation + "_runs", std::ios::in | std::ios::binary | std::ios::ate);
+        if(runs)
+        {
+            std::vector<uint8_t> vData(static_cast<uint64_t>(runs.tellg()), 0);
+            runs.seekg(0, std::ios::beg);
+            runs.read((char*)vData.data(), vData.size());
+
+            try
+            {
+                DataStream ssRuns(vData, SER_LLD, DATABASE_VERSION);
+
+                std::vector<uint32_t> vFiles;
+                ssRuns >> nNextRun >> vFiles;
+
+                /* The sparse index of a run is built on its first read. */
+                for(const auto& nFile : vFiles)
+                {
+                    OrderedRun run;
+                    run.nFile = nFile;
+
+                    std::ifstream stream(run_file(nFile), std::ios::in | std::ios::binary | std::ios::ate);
+                    if(!stream)
+                    {
+                        debug::error(FUNCTION, "missing run ", nFile, " of ", strBaseLocation);
+                        continue;
+                    }
+
+                    run.nSize = stream.tellg();
+                    vRuns.push_back(run);
+                }
+            }
+            catch(const std::exception& e)
+            {
+                debug::error(FUNCTION, "corrupted run list of ", strBaseLocation, ": ", e.what());
+            }
+        }
+
+        /* Replay the keys written since the last run. */
+        std::ifstream log(strBaseLocation + "_log", std::ios::in | std::ios::binary | std::ios::ate);
+        if(log)
+        {
+            std::vector<uint8_t> vData(static_cast<uint64_t>(log.tellg()), 0);
+            log.seekg(0, std::ios::beg);
+            log.read((char*)vData.data(), vData.size());
+
+            /* A record cut short by a crash is dropped. */
+            uint64_t nPos = 0, nLength = 0;
+            std::vector<uint8_t> vKey, vValue;
+            bool fErased = false;
+            while(nPos < vData.size() && read_record(&vData[nPos], vData.size() - nPos, vKey, fErased, vValue, nLength))
+            {
+                nMemorySize += vKey.size() + vValue.size() + ORDERED_ENTRY_SIZE;
+                mapMemory[vKey] = std::make_pair(fErased, vValue);
+
+                nPos += nLength;
+            }
+        }
+    }
+
+
+    /* Add a key to the memory table and its log, flushing if the memory table is full. */
+    bool BinaryOrderedMap::write(const std::vector<uint8_t>& vKey, const bool fErased, const std::vector<uint8_t>& vValue)
+    {
+        /* Open the log on first write. */
+        if(!pLog)
+        {
+            if(!filesystem::exists(strBaseLocation) && !filesystem::create_directories(strBaseLocation))
+                return debug::error(FUNCTION, "failed to create directory ", strBaseLocation);
+
+            pLog = new std::ofstream(strBaseLocation + "_log", std::ios::out | std::ios::binary | std::ios::app);
+            if(!pLog->is_open())
+            {
+                delete pLog;
+                pLog = nullptr;
+
+                return debug::error(FUNCTION, "failed to open log of ", strBaseLocation);
+            }
+        }
+
+        /* Append the record to the log. */
+        std::vector<uint8_t> vRecord;
+        append_record(vRecord, vKey, fErased, vValue);
+        if(!pLog->write((char*)vRecord.data(), vRecord.size()) || !pLog->flush())
+            return debug::error(FUNCTION, "failed to write log of ", strBaseLocation);
+
+        /* Add to the memory table. */
+        auto it = mapMemory.find(vKey);
+        if(it != mapMemory.end())
+            nMemorySize -= std::min<uint64_t>(nMemorySize, vKey.size() + it->second.second.size() + ORDERED_ENTRY_SIZE);
+
+        nMemorySize += vKey.size() + vValue.size() + ORDERED_ENTRY_SIZE;
+        mapMemory[vKey] = std::make_pair(fErased, vValue);
+
+        /* Write out the memory table once it is full. */
+        if(nMemorySize >= ORDERED_MEMORY_SIZE)
+            return flush();
+
+        return true;
+    }
+
+
+    /* Write the memory table out to a new run. */
+    bool BinaryOrderedMap::flush()
+    {
+        if(mapMemory.empty())
+            return true;
+
+        /* Write the keys in order, erased keys have nothing to hide if there are no runs. */
+        const uint32_t nFile = nNextRun++;
+        OrderedWriter writer(run_file(nFile), nFile);
+        for(const auto& item : mapMemory)
+        {
+            if(vRuns.empty() && item.second.first)
+                continue;
+
+            if(!writer.Add(item.first, item.second.first, item.second.second))
+                return debug::error(FUNCTION, "failed to write run ", nFile, " of ", strBaseLocation);
+        }
+
+        /* Make sure the run is on disk before it replaces the log. */
+        if(!writer.Close() || !filesystem::sync(run_file(nFile)))
+            return debug::error(FUNCTION, "failed to write run ", nFile, " of ", strBaseLocation);
+
+        vRuns.push_back(writer.run);
+        if(!save())
+            return false;
+
+        /* Start a new log, the memory table may have been replayed from it without writing. */
+        if(pLog)
+        {
+            pLog->close();
+            pLog->open(strBaseLocation + "_log", std::ios::out | std::ios::binary | std::ios::trunc);
+        }
+        else
+            std::ofstream(strBaseLocation + "_log", std::ios::out | std::ios::binary | std::ios::trunc);
+
+        mapMemory.clear();
+        nMemorySize = 0;
+
+        return merge();
+    }
+
+
+    /* Merge the newest runs while a run is less than twice the size of the one after it. */
+    bool BinaryOrderedMap::merge()
+    {
+        while(vRuns.size() >= 2 && vRuns[vRuns.size() - 2].nSize < vRuns.back().nSize * 2)
+        {
+            OrderedRun& older = vRuns[vRuns.size() - 2];
+            OrderedRun& newer = vRuns.back();
+
+            /* Erased keys are dropped once there is no older run for them to hide. */
+            const bool fOldest = (vRuns.size() == 2);
+
+            /* Read both runs from the start. */
+            OrderedCursor cursorOld(pReader, run_file(older.nFile), older, 0);
+            OrderedCursor cursorNew(pReader, run_file(newer.nFile), newer, 0);
+            cursorOld.Next();
+            cursorNew.Next();
+
+            /* Write the keys of both in order, the newer run's copy of a key replacing the older. */
+            const uint32_t nFile = nNextRun++;
+            OrderedWriter writer(run_file(nFile), nFile);
+            while(cursorOld.fValid || cursorNew.fValid)
+            {
+                OrderedCursor* pCursor = nullptr;
+                if(!cursorOld.fValid || (cursorNew.fValid && cursorNew.vKey <= cursorOld.vKey))
+                {
+                    if(cursorOld.fValid && cursorOld.vKey == cursorNew.vKey)
+                        cursorOld.Next();
+
+                    pCursor = &cursorNew;
+                }
+                else
+                    pCursor = &cursorOld;
+
+                if(!(fOldest && pCursor->fErased) && !writer.Add(pCursor->vKey, pCursor->fErased, pCursor->vValue))
+                    return debug::error(FUNCTION, "failed to write run ", nFile, " of ", strBaseLocation);
+
+                pCursor->Next();
+            }
+
+            if(!writer.Close() || !filesystem::sync(run_file(nFile)))
+                return debug::error(FUNCTION, "failed to write run ", nFile, " of ", strBaseLocation);
+
+            /* Replace the two runs with the merged run. */
+            const uint32_t nOlder = older.nFile, nNewer = newer.nFile;
+            vRuns.pop_back();
+            vRuns.back() = writer.run;
+            if(!save())
+                return false;
+
+            /* Remove the merged files. */
+            pReader->Release(nOlder);
+            pReader->Release(nNewer);
+            filesystem::remove(run_file(nOlder));
+            filesystem::remove(run_file(nNewer));
+        }
+
+        return true;
+    }
+
+
+    /* Build the sparse index of a run by reading it through. */
+    bool BinaryOrderedMap::load(OrderedRun& run)
+    {
+        run.vSparse.clear();
+
+        OrderedCursor cursor(pReader, run_file(run.nFile), run, 0);
+        for(uint64_t nRecord = 0; ; ++nRecord)
+        {
+            const uint64_t nPos = cursor.Position();
+            if(!cursor.Next())
+                break;
+
+            if(nRecord % ORDERED_SPARSE_RECORDS == 0)
+                run.vSparse.push_back(std::make_pair(cursor.vKey, nPos));
+        }
+
+        /* A run that stops short is corrupted. */
+        if(cursor.Position() != run.nSize)
+            return debug::error(FUNCTION, "corrupted run ", run.nFile, " of ", strBaseLocation);
+
+        run.fLoaded = true;
+
+        return true;
+    }
+
+
+    /* Write the list of runs, replacing the old list in one rename. */
+    bool BinaryOrderedMap::save()
+    {
+        std::vector<uint32_t> vFiles;
+        for(const auto& run : vRuns)
+            vFiles.push_back(run.nFile);
+
+        DataStream ssRuns(SER_LLD, DATABASE_VERSION);
+        ssRuns << nNextRun << vFiles;
+
+        /* Write the new list next to the old one. */
+        const std::string strRuns = strBaseLocation + "_runs";
+        {
+            std::ofstream stream(strRuns + ".tmp", std::ios::out | std::ios::binary | std::ios::trunc);
+            if(!stream.write((char*)ssRuns.Bytes().data(), ssRuns.size()))
+                return debug::error(FUNCTION, "failed to write run list of ", strBaseLocation);
+        }
+
+        if(!filesystem::sync(strRuns + ".tmp") || !filesystem::rename(strRuns + ".tmp", strRuns))
+            return debug::error(FUNCTION, "failed to replace run list of ", strBaseLocation);
+
+        return true;
+    }
+
+
+    /* Get the path of a run file. */
+    std::string BinaryOrderedMap::run_file(const uint32_t nFile) const
+    {
+        return debug::safe_printstr(strBaseLocation, "_run.", std::setfill('0'), std::setw(5), nFile);
+    }
+}
@@ -0,0 +1,181 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLD/templates/reader.h>
+
+#include <Util/include/debug.h>
+#include <Util/include/mutex.h>
+
+#include <cerrno>
+#include <iomanip>
+
+#ifndef WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace LLD
+{
+
+    /*  A read-only descriptor of a single database file. */
+    struct FileHandle
+    {
+        /** The file descriptor. **/
+        int fd;
+
+
+        /** Default constructor **/
+        FileHandle()
+        : fd (-1)
+        {
+        }
+
+
+        /** Close the file when the last reader is done with it. **/
+        ~FileHandle()
+        {
+        #ifndef WIN32
+            if(fd >= 0)
+                close(fd);
+        #endif
+        }
+
+
+        /** Open a file read-only. **/
+        bool Open(const std::string& strFile)
+        {
+        #ifndef WIN32
+            fd = open(strFile.c_str(), O_RDONLY);
+            return (fd >= 0);
+        #else
+            return false;
+        #endif
+        }
+
+
+        /** Read at a position without moving any shared file offset. **/
+        bool Read(const uint64_t nPos, uint8_t* pData, const uint64_t nSize) const
+        {
+        #ifndef WIN32
+            uint64_t nRead = 0;
+            while(nRead < nSize)
+            {
+                ssize_t nRet = pread(fd, pData + nRead, nSize - nRead, nPos + nRead);
+                if(nRet < 0 && errno == EINTR)
+                    continue;
+
+                /* Stop on errors or end of file. */
+                if(nRet <= 0)
+                    return false;
+
+                nRead += static_cast<uint64_t>(nRet);
+            }
+
+            return true;
+        #else
+            return false;
+        #endif
+        }
+
+
+        /** Get the current size of the file. **/
+        bool Size(uint64_t& nSize) const
+        {
+        #ifndef WIN32
+            struct stat info;
+            if(fstat(fd, &info) != 0)
+                return false;
+
+            nSize = static_cast<uint64_t>(info.st_size);
+            return true;
+        #else
+            return false;
+        #endif
+        }
+    };
+
+
+    /* Prefix Constructor */
+    FileReader::FileReader(const std::string& strPrefixIn)
+    : MUTEX     ( )
+    , strPrefix (strPrefixIn)
+    , vHandles  ( )
+    {
+    }
+
+
+    /* Default Destructor */
+    FileReader::~FileReader()
+    {
+    }
+
+
+    /* Read data from a file at a given position. */
+    bool FileReader::Read(const uint32_t nFile, const uint64_t nPos, uint8_t* pData, const uint64_t nSize)
+    {
+        /* Get the handle for this file. */
+        std::shared_ptr<FileHandle> pHandle = handle(nFile);
+        if(!pHandle)
+            return false;
+
+        /* Read without holding any locks. */
+        return pHandle->Read(nPos, pData, nSize);
+    }
+
+
+    /* Get the current size of a file. */
+    bool FileReader::Size(const uint32_t nFile, uint64_t& nSize)
+    {
+        /* Get the handle for this file. */
+        std::shared_ptr<FileHandle> pHandle = handle(nFile);
+        if(!pHandle)
+            return false;
+
+        return pHandle->Size(nSize);
+    }
+
+
+    /* Close the handle of a file so it is reopened on next read. */
+    void FileReader::Release(const uint32_t nFile)
+    {
+        LOCK(MUTEX);
+
+        if(nFile < vHandles.size())
+            vHandles[nFile].reset();
+    }
+
+
+    /* Get the open handle of a file, opening it if needed. */
+    std::shared_ptr<FileHandle> FileReader::handle(const uint32_t nFile)
+    {
+        LOCK(MUTEX);
+
+        /* Check for an existing handle. */
+        if(nFile < vHandles.size() && vHandles[nFile])
+            return vHandles[nFile];
+
+        /* Open the file. */
+        std::shared_ptr<FileHandle> pHandle = std::make_shared<FileHandle>();
+        if(!pHandle->Open(debug::safe_printstr(strPrefix, std::setfill('0'), std::setw(5), nFile)))
+            return nullptr;
+
+        /* Add to the handle list. */
+        if(vHandles.size() <= nFile)
+            vHandles.resize(nFile + 1);
+
+        vHandles[nFile] = pHandle;
+
+        return pHandle;
+    }
+}
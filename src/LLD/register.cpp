@@ -261,6 +261,13 @@ namespace LLD
     }
 
 
+    /* Read a state register from the register database as of an open snapshot. */
+    bool RegisterDB::ReadState(const uint256_t& hashRegister, TAO::Register::State& state, const Snapshot& snapshot)
+    {
+        return ReadSnapshot(std::make_pair(std::string("state"), hashRegister), state, snapshot);
+    }
+
+
     /* Erase a state register from the register database. */
     bool RegisterDB::EraseState(const uint256_t& hashRegister, const uint8_t nFlags)
     {
@@ -13,6 +13,7 @@ ________________________________________________________________________________
 
 #include <LLD/templates/sector.h>
 
+#include <LLD/cache/binary_2q.h>
 #include <LLD/cache/binary_lfu.h>
 #include <LLD/cache/binary_lru.h>
 
@@ -24,11 +25,91 @@ ________________________________________________________________________________
 #include <Util/include/filesystem.h>
 #include <Util/include/hex.h>
 
+#include <algorithm>
 #include <functional>
+#include <limits>
+#include <map>
 
 namespace LLD
 {
 
+    /* Build the keychain of a database of the given type. */
+    template<class KeychainType>
+    KeychainType* keychain(const std::string& strName, const std::string& strLocation, const uint8_t nFlags, const uint64_t nBuckets)
+    {
+        return new KeychainType(strLocation, nFlags, nBuckets);
+    }
+
+
+    /* Build the keychain of a database selected by its -<name>keychain argument, migrating it if needed. */
+    template<>
+    Keychain* keychain<Keychain>(const std::string& strName, const std::string& strLocation, const uint8_t nFlags, const uint64_t nBuckets)
+    {
+        /* Get the argument prefix from the database name, so _LEDGER uses -ledgerkeychain. */
+        std::string strPrefix = strName.substr(strName.find_first_not_of('_'));
+        std::transform(strPrefix.begin(), strPrefix.end(), strPrefix.begin(), ::tolower);
+
+        /* Check for an existing sharded keychain, one being migrated isn't complete yet. */
+        const std::string strMigrate = strLocation + "_shard.migrate";
+        const bool fSharded = filesystem::exists(strLocation + "_index.000") && !filesystem::exists(strMigrate);
+
+        /* Build the sharded keychain. */
+        const std::string strType = config::GetArg("-" + strPrefix + "keychain", "hashmap");
+        if(strType == "shard")
+        {
+            /* The shard count can't change once keys are placed by it. */
+            const uint32_t nShards = static_cast<uint32_t>(std::max(config::GetArg("-" + strPrefix + "shards", 16), int64_t(1)));
+            if(fSharded && (!filesystem::exists(debug::safe_printstr(strLocation, "_index.", std::setfill('0'), std::setw(3), nShards - 1))
+                || filesystem::exists(debug::safe_printstr(strLocation, "_index.", std::setfill('0'), std::setw(3), nShards))))
+                throw debug::exception(FUNCTION, strName, " keychain was created with a different -", strPrefix, "shards");
+
+            /* Migrate an existing binary hashmap the first time shards are used, or again if interrupted. */
+            const bool fMigrate = filesystem::exists(strMigrate) || (!fSharded && filesystem::exists(strLocation + "_hashmap.index"));
+            if(fMigrate)
+            {
+                /* Clear any shards left by an interrupted migration. */
+                for(uint32_t nShard = 0; nShard < nShards; ++nShard)
+                {
+                    filesystem::remove(debug::safe_printstr(strLocation, "_index.", std::setfill('0'), std::setw(3), nShard));
+                    for(uint32_t nFile = 0; ; ++nFile)
+                    {
+                        if(!filesystem::remove(debug::safe_printstr(strLocation, "_hashmap.", std::setfill('0'), std::setw(3), nShard, ".", std::setw(5), nFile)))
+                            break;
+                    }
+                }
+                filesystem::remove(strLocation + "_shard.bloom");
+
+                /* Mark the migration as started until all keys are synced. */
+                std::ofstream(strMigrate, std::ios::out | std::ios::trunc);
+            }
+
+            ShardHashMap* pKeychain = new ShardHashMap(strLocation, nFlags, nBuckets, nShards);
+            if(fMigrate)
+            {
+                if(!pKeychain->Migrate(static_cast<uint32_t>(nBuckets)))
+                {
+                    delete pKeychain;
+                    throw debug::exception(FUNCTION, "failed to migrate ", strName, " keychain to shards");
+                }
+
+                filesystem::remove(strMigrate);
+            }
+
+            return pKeychain;
+        }
+
+        /* Check the keychain type is known. */
+        if(strType != "hashmap")
+            throw debug::exception(FUNCTION, "unknown -", strPrefix, "keychain=", strType);
+
+        /* Don't silently start a new keychain next to a migrated one. */
+        if(fSharded)
+            throw debug::exception(FUNCTION, strName, " keychain is sharded, use -", strPrefix, "keychain=shard");
+
+        return new BinaryHashMap(strLocation, nFlags, nBuckets);
+    }
+
+
     /* The Database Constructor. To determine file location and the Bytes per Record. */
     template<class KeychainType, class CacheType>
     SectorDatabase<KeychainType, CacheType>::SectorDatabase(const std::string& strNameIn,
@@ -39,24 +120,44 @@ namespace LLD
     , SECTOR_MUTEX()
     , BUFFER_MUTEX()
     , TRANSACTION_MUTEX()
+    , SEGMENT_MUTEX()
     , strBaseLocation(config::GetDataDir() + strNameIn + "/datachain/")
     , strName(strNameIn)
     , runtime()
     , pTransaction(nullptr)
-    , pSectorKeys(new KeychainType((config::GetDataDir() + strName + "/keychain/"), nFlagsIn, nBucketsIn))
+    , pSectorKeys(keychain<KeychainType>(strName, (config::GetDataDir() + strName + "/keychain/"), nFlagsIn, nBucketsIn))
     , cachePool(new CacheType(nCacheIn))
     , fileCache(new TemplateLRU<uint32_t, std::fstream*>(8))
+    , pSectorMap((nFlagsIn & FLAGS::MMAP) ? new MemoryMap(strBaseLocation + "_block.") : nullptr)
+    , pSectorReader(new FileReader(strBaseLocation + "_block."))
+    , pSegments(new SegmentIndex(SECTOR_SEGMENT_RECORDS))
+    , pOrderedKeys(new BinaryOrderedMap(config::GetDataDir() + strNameIn + "/ordered/"))
+    , pSnapshots(new SnapshotLog())
     , nCurrentFile(0)
     , nCurrentFileSize(0)
+    , setSyncFiles()
     , CacheWriterThread()
     , MeterThread()
+    , CollectorThread()
+    , setCollected()
+    , nCollectFile(std::numeric_limits<uint32_t>::max())
     , vDiskBuffer()
     , nBufferBytes(0)
+    , nReads(0)
     , nBytesRead(0)
     , nBytesWrote(0)
     , nRecordsFlushed(0)
+    , nCompressedIn(0)
+    , nCompressedOut(0)
+    , nDecompressed(0)
+    , nDecompressTime(0)
+    , nMissTime(0)
+    , pSyncTime(&metrics::GetHistogram("nexus_lld_sync_microseconds", "Time to sync the files written since the last sync.",
+        metrics::LATENCY_BOUNDS, metrics::Label("db", strNameIn)))
+    , vWatches()
     , fDestruct(false)
     , fInitialized(false)
+    , fJournal(false)
     , nFlags(nFlagsIn)
     {
         /* Set readonly flag if write or append are not specified. */
@@ -66,6 +167,29 @@ namespace LLD
         /* Initialize the Database. */
         Initialize();
 
+        /* Count the keychain files each read probes for the metrics. */
+        const std::string strLabels = metrics::Label("db", strName);
+        pSectorKeys->SetProbes(&metrics::GetHistogram("nexus_lld_keychain_probes", "Keychain files read to find a key.",
+            {0, 1, 2, 3, 4, 8, 16, 32, 64}, strLabels));
+
+        /* Watch the totals and cache statistics of the database for the metrics. */
+        vWatches.push_back(metrics::Watch("nexus_lld_reads_total", "Records read.", true, strLabels,
+            [this]{ return double(nReads.load()); }));
+        vWatches.push_back(metrics::Watch("nexus_lld_read_bytes_total", "Bytes read.", true, strLabels,
+            [this]{ return double(nBytesRead.load()); }));
+        vWatches.push_back(metrics::Watch("nexus_lld_writes_total", "Records written to disk.", true, strLabels,
+            [this]{ return double(nRecordsFlushed.load()); }));
+        vWatches.push_back(metrics::Watch("nexus_lld_write_bytes_total", "Bytes written to disk.", true, strLabels,
+            [this]{ return double(nBytesWrote.load()); }));
+        vWatches.push_back(metrics::Watch("nexus_lld_cache_hits_total", "Reads found in the cache.", true, strLabels,
+            [this]{ return double(cachePool->Stats().nHits); }));
+        vWatches.push_back(metrics::Watch("nexus_lld_cache_misses_total", "Reads not found in the cache.", true, strLabels,
+            [this]{ return double(cachePool->Stats().nMisses); }));
+        vWatches.push_back(metrics::Watch("nexus_lld_cache_evictions_total", "Records evicted from the cache.", true, strLabels,
+            [this]{ return double(cachePool->Stats().nEvictions); }));
+        vWatches.push_back(metrics::Watch("nexus_lld_cache_bytes", "Memory used by the cache.", false, strLabels,
+            [this]{ return double(cachePool->Stats().nBytes); }));
+
         if(config::GetBoolArg("-runtime", false))
         {
             debug::log(0, ANSI_COLOR_GREEN FUNCTION, "executed in ",
@@ -74,6 +198,7 @@ namespace LLD
 
         CacheWriterThread = std::thread(std::bind(&SectorDatabase::CacheWriter, this));
         MeterThread = std::thread(std::bind(&SectorDatabase::Meter, this));
+        CollectorThread = std::thread(std::bind(&SectorDatabase::Collector, this));
     }
 
 
@@ -81,6 +206,10 @@ namespace LLD
     template<class KeychainType, class CacheType>
     SectorDatabase<KeychainType, CacheType>::~SectorDatabase()
     {
+        /* Stop the metrics reading the database before it is torn down. */
+        for(const auto& nId : vWatches)
+            metrics::Unwatch(nId);
+
         fDestruct = true;
         CONDITION.notify_all();
 
@@ -90,6 +219,9 @@ namespace LLD
         if(MeterThread.joinable())
             MeterThread.join();
 
+        if(CollectorThread.joinable())
+            CollectorThread.join();
+
         if(pTransaction)
             delete pTransaction;
 
@@ -99,6 +231,21 @@ namespace LLD
         if(fileCache)
             delete fileCache;
 
+        if(pSectorMap)
+            delete pSectorMap;
+
+        if(pSectorReader)
+            delete pSectorReader;
+
+        if(pSegments)
+            delete pSegments;
+
+        if(pOrderedKeys)
+            delete pOrderedKeys;
+
+        if(pSnapshots)
+            delete pSnapshots;
+
         if(pSectorKeys)
             delete pSectorKeys;
     }
@@ -154,16 +301,26 @@ namespace LLD
     bool SectorDatabase<KeychainType, CacheType>::Get(const std::vector<uint8_t>& vKey, std::vector<uint8_t>& vData)
     {
         /* Iterate if meters are enabled. */
-        nBytesRead += static_cast<uint32_t>(vKey.size() + vData.size());
+        ++nReads;
+        nBytesRead += static_cast<uint64_t>(vKey.size() + vData.size());
 
         /* Check the cache pool for key first. */
         if(cachePool->Get(vKey, vData))
             return true;
 
+        /* Time the miss for the cost of the cache. */
+        runtime::timer timer;
+        timer.Start();
+
         /* Get the key from the keychain. */
         SectorKey cKey;
         if(pSectorKeys->Get(vKey, cKey))
         {
+            /* Read from the mapped sector file if in MMAP mode, otherwise use a positional read. */
+            uint64_t nCompact = GetSizeOfCompactSize(cKey.nSectorSize);
+            vData.resize(cKey.nSectorSize - nCompact);
+            if((!pSectorMap || !pSectorMap->Read(cKey.nSectorFile, cKey.nSectorStart + nCompact, &vData[0], vData.size()))
+                && !pSectorReader->Read(cKey.nSectorFile, cKey.nSectorStart + nCompact, &vData[0], vData.size()))
             {
                 LOCK(SECTOR_MUTEX);
 
@@ -198,8 +355,13 @@ namespace LLD
 
             }
 
+            /* Decompress records written in compress mode. */
+            if(!Decompress(vData))
+                return debug::error(FUNCTION, "corrupted compressed record in sector file ", cKey.nSectorFile, " at ", cKey.nSectorStart);
+
             /* Add to cache */
             cachePool->Put(cKey, vKey, vData);
+            nMissTime += timer.ElapsedMicroseconds();
 
             /* Verbose Debug Logging. */
             if(config::nVerbose >= 5)
@@ -213,19 +375,146 @@ namespace LLD
     }
 
 
+    /*  Get a list of records from cache or from disk, reading the misses in the order of the sector files. */
+    template<class KeychainType, class CacheType>
+    bool SectorDatabase<KeychainType, CacheType>::Get(const std::vector< std::vector<uint8_t> >& vKeys,
+        std::vector< std::vector<uint8_t> >& vData, std::vector<bool>& vFound)
+    {
+        vData.clear();
+        vData.resize(vKeys.size());
+        vFound.assign(vKeys.size(), false);
+
+        /* Check the cache pool for the keys first. */
+        bool fRead = false;
+        std::vector<uint32_t> vMisses;
+        for(uint32_t n = 0; n < vKeys.size(); ++n)
+        {
+            ++nReads;
+            nBytesRead += static_cast<uint64_t>(vKeys[n].size());
+
+            if(cachePool->Get(vKeys[n], vData[n]))
+            {
+                vFound[n] = true;
+                fRead     = true;
+            }
+            else
+                vMisses.push_back(n);
+        }
+
+        /* Check for records to read. */
+        if(vMisses.empty())
+            return fRead;
+
+        /* Time the misses for the cost of the cache. */
+        runtime::timer timer;
+        timer.Start();
+
+        /* Get the sector keys of the misses from the keychain. */
+        std::vector< std::pair<SectorKey, uint32_t> > vSectors;
+        for(const auto& n : vMisses)
+        {
+            SectorKey cKey;
+            if(pSectorKeys->Get(vKeys[n], cKey) && cKey.nSectorSize > GetSizeOfCompactSize(cKey.nSectorSize))
+                vSectors.push_back(std::make_pair(cKey, n));
+        }
+
+        /* Sort the records by their place on disk. */
+        std::sort(vSectors.begin(), vSectors.end(),
+            [](const std::pair<SectorKey, uint32_t>& a, const std::pair<SectorKey, uint32_t>& b)
+            {
+                if(a.first.nSectorFile != b.first.nSectorFile)
+                    return a.first.nSectorFile < b.first.nSectorFile;
+
+                return a.first.nSectorStart < b.first.nSectorStart;
+            });
+
+        /* Read the records in runs of neighbours. */
+        std::vector<uint8_t> vBuffer;
+        for(uint32_t nFirst = 0; nFirst < vSectors.size(); )
+        {
+            const uint32_t nFile  = vSectors[nFirst].first.nSectorFile;
+            const uint64_t nStart = vSectors[nFirst].first.nSectorStart;
+
+            /* Join the records that follow within the read gap, up to the largest read. */
+            uint64_t nEnd  = nStart + vSectors[nFirst].first.nSectorSize;
+            uint32_t nLast = nFirst + 1;
+            for( ; nLast < vSectors.size(); ++nLast)
+            {
+                const SectorKey& cKey = vSectors[nLast].first;
+                if(cKey.nSectorFile != nFile || cKey.nSectorStart > nEnd + SECTOR_MULTIREAD_GAP
+                || cKey.nSectorStart + cKey.nSectorSize - nStart > SECTOR_MULTIREAD_SIZE)
+                    break;
+
+                nEnd = std::max(nEnd, uint64_t(cKey.nSectorStart + cKey.nSectorSize));
+            }
+
+            /* Read the whole run, from the mapped sector file if in MMAP mode. */
+            vBuffer.resize(nEnd - nStart);
+            if((!pSectorMap || !pSectorMap->Read(nFile, nStart, &vBuffer[0], vBuffer.size()))
+                && !ReadSector(nFile, nStart, &vBuffer[0], vBuffer.size()))
+            {
+                debug::error(FUNCTION, strName, " failed to read ", vBuffer.size(), " bytes at ", nStart, " of file ", nFile);
+
+                nFirst = nLast;
+                continue;
+            }
+            nBytesRead += static_cast<uint64_t>(vBuffer.size());
+
+            /* Get each record after its compact size. */
+            for( ; nFirst < nLast; ++nFirst)
+            {
+                const SectorKey& cKey = vSectors[nFirst].first;
+                const uint32_t n      = vSectors[nFirst].second;
+
+                const uint64_t nCompact = GetSizeOfCompactSize(cKey.nSectorSize);
+                const uint64_t nOffset  = cKey.nSectorStart - nStart + nCompact;
+                vData[n].assign(vBuffer.begin() + nOffset, vBuffer.begin() + nOffset + cKey.nSectorSize - nCompact);
+
+                /* Decompress records written in compress mode. */
+                if(!Decompress(vData[n]))
+                {
+                    debug::error(FUNCTION, "corrupted compressed record in sector file ", cKey.nSectorFile, " at ", cKey.nSectorStart);
+                    vData[n].clear();
+
+                    continue;
+                }
+
+                /* Add to cache */
+                cachePool->Put(cKey, vKeys[n], vData[n]);
+
+                vFound[n] = true;
+                fRead     = true;
+            }
+        }
+        nMissTime += timer.ElapsedMicroseconds();
+
+        return fRead;
+    }
+
+
     /*  Get a record from from disk if the sector key
      *  is already read from the keychain. */
     template<class KeychainType, class CacheType>
     bool SectorDatabase<KeychainType, CacheType>::Get(const SectorKey& cKey, std::vector<uint8_t>& vData)
     {
-        {
-            LOCK(SECTOR_MUTEX);
+        ++nReads;
+        nBytesRead += static_cast<uint64_t>(cKey.vKey.size() + vData.size());
 
-            nBytesRead += static_cast<uint32_t>(cKey.vKey.size() + vData.size());
+        /* Check the cache pool for key first. */
+        if(cachePool->Get(cKey.vKey, vData))
+            return true;
 
-            /* Check the cache pool for key first. */
-            if(cachePool->Get(cKey.vKey, vData))
-                return true;
+        /* Time the miss for the cost of the cache. */
+        runtime::timer timer;
+        timer.Start();
+
+        /* Read from the mapped sector file if in MMAP mode, otherwise use a positional read. */
+        uint64_t nCompact = GetSizeOfCompactSize(cKey.nSectorSize);
+        vData.resize(cKey.nSectorSize - nCompact);
+        if((!pSectorMap || !pSectorMap->Read(cKey.nSectorFile, cKey.nSectorStart + nCompact, &vData[0], vData.size()))
+            && !pSectorReader->Read(cKey.nSectorFile, cKey.nSectorStart + nCompact, &vData[0], vData.size()))
+        {
+            LOCK(SECTOR_MUTEX);
 
             /* Find the file stream for LRU cache. */
             std::fstream *pstream;
@@ -262,6 +551,12 @@ namespace LLD
                     " | Current File Size: ", cKey.nSectorStart, "\n", HexStr(vData.begin(), vData.end(), true));
         }
 
+        /* Decompress records written in compress mode. */
+        if(!Decompress(vData))
+            return debug::error(FUNCTION, "corrupted compressed record in sector file ", cKey.nSectorFile, " at ", cKey.nSectorStart);
+
+        nMissTime += timer.ElapsedMicroseconds();
+
         return true;
     }
 
@@ -270,24 +565,40 @@ namespace LLD
     template<class KeychainType, class CacheType>
     bool SectorDatabase<KeychainType, CacheType>::Update(const std::vector<uint8_t>& vKey, const std::vector<uint8_t>& vData)
     {
+        /* Compress the record in compress mode. */
+        std::vector<uint8_t> vCompressed;
+        return Update(vKey, vData, Compress(vData, vCompressed));
+    }
+
+
+    /*  Update a record on disk with the bytes to store for it. */
+    template<class KeychainType, class CacheType>
+    bool SectorDatabase<KeychainType, CacheType>::Update(const std::vector<uint8_t>& vKey, const std::vector<uint8_t>& vData,
+                                                         const std::vector<uint8_t>& vRecord)
+    {
+        /* Hold the sector files so the garbage collector can't move the record before it is written. */
+        LOCK(SECTOR_MUTEX);
+
         /* Check the keychain for key. */
         SectorKey key;
         if(!pSectorKeys->Get(vKey, key))
             return false;
 
         /* Get current size */
-        uint64_t nSize = vData.size() + GetSizeOfCompactSize(vData.size());
+        uint64_t nSize = vRecord.size() + GetSizeOfCompactSize(vRecord.size());
 
         /* Check data size constraints. */
         if(nSize != key.nSectorSize)
             return false;
 
+        /* Append records the garbage collector is copying, so a copy made before this write isn't kept. */
+        if(key.nSectorFile == nCollectFile)
+            return false;
+
         /* Write the data into the memory cache. */
         cachePool->Put(key, vKey, vData, false);
 
         {
-            LOCK(SECTOR_MUTEX);
-
             /* Find the file stream for LRU cache. */
             std::fstream* pstream;
             if(!fileCache->Get(key.nSectorFile, pstream))
@@ -308,17 +619,18 @@ namespace LLD
             pstream->seekp(key.nSectorStart, std::ios::beg);
 
             /* Write the size of record. */
-            WriteCompactSize(*pstream, vData.size());
+            WriteCompactSize(*pstream, vRecord.size());
 
             /* Write the data record. */
-            if(!pstream->write((char*) &vData[0], vData.size()))
-                return debug::error(FUNCTION, "only ", pstream->gcount(), "/", vData.size(), " bytes written");
+            if(!pstream->write((char*) &vRecord[0], vRecord.size()))
+                return debug::error(FUNCTION, "only ", pstream->gcount(), "/", vRecord.size(), " bytes written");
 
             pstream->flush();
+            setSyncFiles.insert(key.nSectorFile);
 
             /* Records flushed indicator. */
             ++nRecordsFlushed;
-            nBytesWrote += static_cast<uint32_t>(vData.size());
+            nBytesWrote += static_cast<uint64_t>(vRecord.size());
 
             /* Verbose output. */
             if(config::nVerbose >= 5)
@@ -330,13 +642,194 @@ namespace LLD
     }
 
 
+    /*  Get the bytes to store for a record, compressing it in compress mode. */
+    template<class KeychainType, class CacheType>
+    const std::vector<uint8_t>& SectorDatabase<KeychainType, CacheType>::Compress(const std::vector<uint8_t>& vData, std::vector<uint8_t>& vCompressed)
+    {
+        if(!(nFlags & FLAGS::COMPRESS))
+            return vData;
+
+        /* Keep records that are too small or don't compress as they are. */
+        const std::vector<uint8_t>& vRecord = CompressRecord(vData, vCompressed) ? vCompressed : vData;
+
+        /* Track the compression ratio for the meter. */
+        nCompressedIn  += vData.size();
+        nCompressedOut += vRecord.size();
+
+        return vRecord;
+    }
+
+
+    /*  Decompress a record read from disk if it is compressed. */
+    template<class KeychainType, class CacheType>
+    bool SectorDatabase<KeychainType, CacheType>::Decompress(std::vector<uint8_t>& vData)
+    {
+        /* Records are read the same whether the database is in compress mode or not. */
+        if(vData.empty() || !IsCompressed(&vData[0], vData.size()))
+            return true;
+
+        runtime::timer timer;
+        timer.Start();
+
+        std::vector<uint8_t> vRecord;
+        if(!DecompressRecord(&vData[0], vData.size(), vRecord))
+            return false;
+
+        vData.swap(vRecord);
+
+        /* Track the decode time for the meter. */
+        ++nDecompressed;
+        nDecompressTime += timer.ElapsedMicroseconds();
+
+        return true;
+    }
+
+
+    /*  Read bytes of a sector file, through a positional read or the file streams as a fallback. */
+    template<class KeychainType, class CacheType>
+    bool SectorDatabase<KeychainType, CacheType>::ReadSector(const uint32_t nFile, const uint64_t nPos, uint8_t* pData, const uint64_t nSize)
+    {
+        /* Read without locks when positional reads are supported. */
+        if(pSectorReader->Read(nFile, nPos, pData, nSize))
+            return true;
+
+        LOCK(SECTOR_MUTEX);
+
+        /* Find the file stream for LRU cache. */
+        std::fstream* pstream;
+        if(!fileCache->Get(nFile, pstream))
+        {
+            /* Set the new stream pointer. */
+            pstream = new std::fstream(debug::safe_printstr(strBaseLocation, "_block.", std::setfill('0'), std::setw(5), nFile), std::ios::in | std::ios::out | std::ios::binary);
+            if(!pstream->is_open())
+            {
+                delete pstream;
+                return false;
+            }
+
+            /* If file not found add to LRU cache. */
+            fileCache->Put(nFile, pstream);
+        }
+
+        /* Read the range. */
+        pstream->clear();
+        pstream->seekg(nPos, std::ios::beg);
+        if(!pstream->read((char*)pData, nSize))
+        {
+            pstream->clear();
+            return false;
+        }
+
+        return true;
+    }
+
+
+    /*  Add the records written to a sector file since it was last indexed to the typed segment index. */
+    template<class KeychainType, class CacheType>
+    bool SectorDatabase<KeychainType, CacheType>::IndexSegments(const uint32_t nFile)
+    {
+        LOCK(SEGMENT_MUTEX);
+
+        /* Get the size of the file, through its positional read handle if supported. */
+        uint64_t nFileSize = 0;
+        if(!pSectorReader->Size(nFile, nFileSize))
+        {
+            std::ifstream stream(debug::safe_printstr(strBaseLocation, "_block.", std::setfill('0'), std::setw(5), nFile), std::ios::in | std::ios::binary | std::ios::ate);
+            if(!stream)
+                return false;
+
+            nFileSize = stream.tellg();
+        }
+
+        /* A file smaller than its index was truncated, index it again. */
+        uint64_t nPos = pSegments->Indexed(nFile);
+        if(nFileSize < nPos)
+        {
+            pSegments->Reset(nFile);
+            nPos = 0;
+        }
+
+        /* Index the records after the indexed part of the file. */
+        uint64_t nBufferSize = 1024 * 1024; //1 MB read buffer
+        while(nPos < nFileSize)
+        {
+            std::vector<uint8_t> vData(std::min(nFileSize - nPos, nBufferSize), 0);
+            if(!ReadSector(nFile, nPos, &vData[0], vData.size()))
+                return debug::error(FUNCTION, strName, " failed to read ", vData.size(), " bytes at ", nPos, " of file ", nFile);
+
+            /* Add each whole record in the buffer. */
+            uint64_t nOffset = 0;
+            while(nOffset < vData.size())
+            {
+                /* Stop at the end of the records or a record not all in the buffer. */
+                uint64_t nSize;
+                uint32_t nHeader;
+                if(!RecordHeader(&vData[nOffset], vData.size() - nOffset, nSize, nHeader) || nSize == 0
+                || nOffset + nHeader + nSize > vData.size())
+                    break;
+
+                /* Get the type of the record, a corrupted record is indexed with no type so it is skipped. */
+                std::vector<uint8_t> vType;
+                if(!RecordType(&vData[nOffset + nHeader], nSize, vType))
+                    debug::error(FUNCTION, strName, " corrupted record at ", nPos + nOffset, " of file ", nFile);
+
+                /* Stop if the file was truncated and indexed again while reading. */
+                if(!pSegments->Add(nFile, nPos + nOffset, nPos + nOffset + nHeader + nSize, vType))
+                    return true;
+
+                nOffset += nHeader + nSize;
+            }
+
+            /* Stop at the last record if it is still being written or ends the records. */
+            if(nOffset == 0)
+            {
+                uint64_t nSize;
+                uint32_t nHeader;
+                if(vData.size() == nFileSize - nPos || (RecordHeader(&vData[0], vData.size(), nSize, nHeader) && nSize == 0))
+                    break;
+
+                /* Allocate a larger buffer if full record exceeds default buffer. */
+                nBufferSize *= 2;
+            }
+
+            nPos += nOffset;
+        }
+
+        return true;
+    }
+
+
+    /*  Save the committed record of a key before a write changes it, for open snapshots. */
+    template<class KeychainType, class CacheType>
+    void SectorDatabase<KeychainType, CacheType>::SaveSnapshot(const SnapshotWrite& write, const std::vector<uint8_t>& vKey)
+    {
+        if(!write.Saving())
+            return;
+
+        /* Read the record without adding it to the cache, keychain only entries have no record. */
+        std::vector<uint8_t> vData;
+        SectorKey cKey;
+        const bool fExists = (pSectorKeys->Get(vKey, cKey) && cKey.nSectorSize > 0 && Get(cKey, vData));
+
+        pSnapshots->Save(vKey, fExists, vData);
+    }
+
+
     /*  Force a write to disk immediately bypassing write buffers. */
     template<class KeychainType, class CacheType>
     bool SectorDatabase<KeychainType, CacheType>::Force(const std::vector<uint8_t>& vKey, const std::vector<uint8_t>& vData)
     {
-        if(nFlags & FLAGS::APPEND || !Update(vKey, vData))
+        /* Compress the record in compress mode. */
+        std::vector<uint8_t> vCompressed;
+        const std::vector<uint8_t>& vRecord = Compress(vData, vCompressed);
+
+        if(nFlags & FLAGS::APPEND || !Update(vKey, vData, vRecord))
         {
+            /* Get current size */
+            uint64_t nSize = vRecord.size() + GetSizeOfCompactSize(vRecord.size());
 
+            /* The new Sector Key, located while the sector files are held. */
+            SectorKey key;
             {
                 LOCK(SECTOR_MUTEX);
 
@@ -376,28 +869,26 @@ namespace LLD
                 pstream->seekp(nCurrentFileSize, std::ios::beg);
 
                 /* Write the size of record. */
-                WriteCompactSize(*pstream, vData.size());
+                WriteCompactSize(*pstream, vRecord.size());
 
                 /* Write the data record. */
-                if(!pstream->write((char*) &vData[0], vData.size()))
-                    return debug::error(FUNCTION, "only ", pstream->gcount(), "/", vData.size(), " bytes written");
+                if(!pstream->write((char*) &vRecord[0], vRecord.size()))
+                    return debug::error(FUNCTION, "only ", pstream->gcount(), "/", vRecord.size(), " bytes written");
 
                 pstream->flush();
-            }
+                setSyncFiles.insert(nCurrentFile);
 
-            /* Get current size */
-            uint64_t nSize = vData.size() + GetSizeOfCompactSize(vData.size());
+                /* Create a new Sector Key. */
+                key = SectorKey(STATE::READY, vKey, static_cast<uint16_t>(nCurrentFile),
+                                nCurrentFileSize, static_cast<uint32_t>(nSize));
 
-            /* Create a new Sector Key. */
-            SectorKey key(STATE::READY, vKey, static_cast<uint16_t>(nCurrentFile),
-                            nCurrentFileSize, static_cast<uint32_t>(nSize));
-
-            /* Increment the current filesize */
-            nCurrentFileSize += static_cast<uint32_t>(nSize);
+                /* Increment the current filesize */
+                nCurrentFileSize += static_cast<uint32_t>(nSize);
+            }
 
             /* Records flushed indicator. */
             ++nRecordsFlushed;
-            nBytesWrote += static_cast<uint32_t>(nSize);
+            nBytesWrote += static_cast<uint64_t>(nSize);
 
             /* Assign the Key to Keychain. */
             if(!pSectorKeys->Put(key))
@@ -420,6 +911,10 @@ namespace LLD
     template<class KeychainType, class CacheType>
     bool SectorDatabase<KeychainType, CacheType>::Put(const std::vector<uint8_t>& vKey, const std::vector<uint8_t>& vData)
     {
+        /* Keep the record being replaced for open snapshots. */
+        SnapshotWrite write(pSnapshots);
+        SaveSnapshot(write, vKey);
+
         /* Handle force write mode. */
         if(nFlags & FLAGS::FORCE)
             return Force(vKey, vData);
@@ -450,6 +945,13 @@ namespace LLD
     template<class KeychainType, class CacheType>
     bool SectorDatabase<KeychainType, CacheType>::Delete(const std::vector<uint8_t>& vKey)
     {
+        /* Keep the record being erased for open snapshots. */
+        SnapshotWrite write(pSnapshots);
+        SaveSnapshot(write, vKey);
+
+        /* Hold the sector files so the garbage collector can't move the record before it is blanked. */
+        LOCK(SECTOR_MUTEX);
+
         /* Check the keychain for key. */
         SectorKey key;
         if(!pSectorKeys->Get(vKey, key))
@@ -464,8 +966,6 @@ namespace LLD
             return true;
 
         {
-            LOCK(SECTOR_MUTEX);
-
             /* Find the file stream for LRU cache. */
             std::fstream* pstream;
             if(!fileCache->Get(key.nSectorFile, pstream))
@@ -502,6 +1002,7 @@ namespace LLD
 
             /* Flush the rest of the write buffer in stream. */
             pstream->flush();
+            setSyncFiles.insert(key.nSectorFile);
         }
 
         return true;
@@ -548,17 +1049,20 @@ namespace LLD
             }
 
             /* Create a new file if the sector file size is over file size limits. */
-            if(nCurrentFileSize > MAX_SECTOR_FILE_SIZE)
             {
-                debug::log(0, FUNCTION, "allocating new sector file ", nCurrentFile + 1);
+                LOCK(SECTOR_MUTEX);
+                if(nCurrentFileSize > MAX_SECTOR_FILE_SIZE)
+                {
+                    debug::log(0, FUNCTION, "allocating new sector file ", nCurrentFile + 1);
 
-                /* Iterate the current file and reset current file sie. */
-                ++nCurrentFile;
-                nCurrentFileSize = 0;
+                    /* Iterate the current file and reset current file sie. */
+                    ++nCurrentFile;
+                    nCurrentFileSize = 0;
 
-                /* Create a new file for next writes. */
-                std::fstream stream(debug::safe_printstr(strBaseLocation, "_block.", std::setfill('0'), std::setw(5), nCurrentFile), std::ios::out | std::ios::binary | std::ios::trunc);
-                stream.close();
+                    /* Create a new file for next writes. */
+                    std::fstream stream(debug::safe_printstr(strBaseLocation, "_block.", std::setfill('0'), std::setw(5), nCurrentFile), std::ios::out | std::ios::binary | std::ios::trunc);
+                    stream.close();
+                }
             }
 
             /* Iterate through buffer to queue disk writes. */
@@ -575,20 +1079,12 @@ namespace LLD
             CONDITION.notify_all();
 
             /* Verbose logging. */
-            debug::log(3, FUNCTION, "Flushed ", nRecordsFlushed.load(),
-                " Records of ", nBytesWrote.load(), " Bytes");
-
-            /* Reset counters if not in meter mode. */
-            if(!config::GetBoolArg("-meters"))
-            {
-                nBytesWrote     = 0;
-                nRecordsFlushed = 0;
-            }
+            debug::log(3, FUNCTION, "Flushed ", vIndexes.size(), " Records");
         }
     }
 
 
-    /*  LLD Meter Thread. Tracks the Reads/Writes per second. */
+    /*  LLD Meter Thread. Logs the Reads/Writes per second since the last log. */
     template<class KeychainType, class CacheType>
     void SectorDatabase<KeychainType, CacheType>::Meter()
     {
@@ -598,18 +1094,36 @@ namespace LLD
         runtime::timer TIMER;
         TIMER.Start();
 
+        /* The totals at the last log, so each log covers its own interval. */
+        uint64_t nLastRead    = nBytesRead.load();
+        uint64_t nLastWrote   = nBytesWrote.load();
+        uint64_t nLastFlushed = nRecordsFlushed.load();
+
         while(!fDestruct.load())
         {
             runtime::sleep(100);
             if(TIMER.Elapsed() < 30)
                 continue;
 
+            /* Read the totals and take the interval since the last log. */
+            const uint64_t nRead    = nBytesRead.load();
+            const uint64_t nWrote   = nBytesWrote.load();
+            const uint64_t nFlushed = nRecordsFlushed.load();
+            const double   dSeconds = TIMER.Elapsed();
+
+            TIMER.Reset();
+
             /* Write and Read data rates. */
-            double WPS = nBytesWrote.load() / (TIMER.Elapsed() * 1024.0);
-            double RPS = nBytesRead.load() / (TIMER.Elapsed() * 1024.0);
+            double WPS = (nWrote - nLastWrote) / (dSeconds * 1024.0);
+            double RPS = (nRead - nLastRead) / (dSeconds * 1024.0);
+            const uint64_t nRecords = nFlushed - nLastFlushed;
+
+            nLastRead    = nRead;
+            nLastWrote   = nWrote;
+            nLastFlushed = nFlushed;
 
             /* Check for zero values. */
-            if(WPS == 0 && RPS == 0 && nRecordsFlushed.load() == 0)
+            if(WPS == 0 && RPS == 0 && nRecords == 0)
                 continue;
 
             /* Debug output. */
@@ -617,12 +1131,31 @@ namespace LLD
                 ANSI_COLOR_FUNCTION, strName, " LLD : ", ANSI_COLOR_RESET,
                 "Writing ", WPS, " Kb/s | ",
                 "Reading ", RPS, " Kb/s | ",
-                "Records ", nRecordsFlushed.load());
-
-            TIMER.Reset();
-            nBytesWrote.store(0);
-            nBytesRead.store(0);
-            nRecordsFlushed.store(0);
+                "Records ", nRecords);
+
+            /* Compression statistics if records were compressed or decompressed. */
+            const uint64_t nIn       = nCompressedIn.exchange(0);
+            const uint64_t nOut      = nCompressedOut.exchange(0);
+            const uint64_t nDecoded  = nDecompressed.exchange(0);
+            const uint64_t nDecodeUs = nDecompressTime.exchange(0);
+            if(nIn > 0 || nDecoded > 0)
+                debug::log(0,
+                    ANSI_COLOR_FUNCTION, strName, " LLD : ", ANSI_COLOR_RESET,
+                    "Compression ", nOut > 0 ? double(nIn) / nOut : 1.0, "x (", nIn, " to ", nOut, " bytes) | ",
+                    "Decompressed ", nDecoded, " records at ", nDecoded > 0 ? double(nDecodeUs) / nDecoded : 0.0, " us each");
+
+            /* Cache statistics since the database was opened. */
+            const CacheStats stats = GetCacheStats();
+            debug::log(0,
+                ANSI_COLOR_FUNCTION, strName, " LLD : ", ANSI_COLOR_RESET,
+                "Cache ", stats.HitRate() * 100.0, "% hits | ",
+                stats.nBytes / 1024, " of ", stats.nMaxBytes / 1024, " Kb | ",
+                "Evicted ", stats.nEvictions, " records");
+
+            /* Keychain statistics if the keychain keeps any. */
+            std::string strKeychain = pSectorKeys->Meter();
+            if(!strKeychain.empty())
+                debug::log(0, ANSI_COLOR_FUNCTION, strName, " LLD : ", ANSI_COLOR_RESET, strKeychain);
         }
     }
 
@@ -665,6 +1198,29 @@ namespace LLD
         stream.write((char*)&vBytes[0], vBytes.size());
         stream.close();
 
+        /* Flag the journal file to be cleared on release. */
+        fJournal = true;
+
+        return true;
+    }
+
+
+    /*  Write the transaction commitment message into a shared write-ahead log record. */
+    template<class KeychainType, class CacheType>
+    bool SectorDatabase<KeychainType, CacheType>::TxnCheckpoint(DataStream& ssJournal)
+    {
+        LOCK(TRANSACTION_MUTEX);
+
+        /* Check for active transaction. */
+        if(!pTransaction)
+            return false;
+
+        /* Set commit message into journal. */
+        pTransaction->ssJournal << std::string("commit");
+
+        /* Add this database's journal to the log record. */
+        ssJournal << strName << pTransaction->ssJournal.Bytes();
+
         return true;
     }
 
@@ -682,9 +1238,14 @@ namespace LLD
         /** Set the transaction pointer to null also acting like a flag **/
         pTransaction = nullptr;
 
-        /* Delete the transaction journal file. */
-        std::ofstream stream(debug::safe_printstr(config::GetDataDir(), strName, "/journal.dat"), std::ios::trunc);
-        stream.close();
+        /* Clear the transaction journal file if it was written to. */
+        if(fJournal)
+        {
+            std::ofstream stream(debug::safe_printstr(config::GetDataDir(), strName, "/journal.dat"), std::ios::trunc);
+            stream.close();
+
+            fJournal = false;
+        }
     }
 
 
@@ -698,15 +1259,24 @@ namespace LLD
         if(!pTransaction)
             return false;
 
+        /* Commit the transaction as one version for open snapshots. */
+        SnapshotWrite write(pSnapshots);
+
         /* Erase data set to be removed. */
         for(const auto& item : pTransaction->setErasedData)
+        {
+            SaveSnapshot(write, item);
             if(!pSectorKeys->Erase(item))
                 return debug::error(FUNCTION, "failed to erase from keychain");
+        }
 
         /* Commit the sector data. */
         for(const auto& item : pTransaction->mapTransactions)
+        {
+            SaveSnapshot(write, item.first);
             if(!Force(item.first, item.second))
                 return debug::error(FUNCTION, "failed to commit sector data");
+        }
 
         /* Commit keychain entries. */
         for(const auto& item : pTransaction->setKeychain)
@@ -716,7 +1286,22 @@ namespace LLD
                 return debug::error(FUNCTION, "failed to commit to keychain");
         }
 
-        /* Commit the index data. */
+        /* Commit the ordered keychain entries. */
+        for(const auto& item : pTransaction->setOrderedErased)
+            if(!pOrderedKeys->Erase(item))
+                return debug::error(FUNCTION, "failed to erase from ordered keychain");
+
+        for(const auto& item : pTransaction->mapOrdered)
+            if(!pOrderedKeys->Put(item.first, item.second))
+                return debug::error(FUNCTION, "failed to commit to ordered keychain");
+
+        /* Keep the records the indexes pointed to, before the sector files are held. */
+        for(const auto& item : pTransaction->mapIndex)
+            SaveSnapshot(write, item.first);
+
+        /* Commit the index data, holding the sector files so the garbage collector can't move the records. */
+        LOCK2(SECTOR_MUTEX);
+
         std::map<std::vector<uint8_t>, SectorKey> mapIndex;
         for(const auto& item : pTransaction->mapIndex)
         {
@@ -775,11 +1360,25 @@ namespace LLD
 
         debug::log(0, FUNCTION, strName, " transaction journal detected of ", nSize, " bytes");
 
+        /* Flag the journal file to be cleared on release. */
+        {
+            LOCK(TRANSACTION_MUTEX);
+            fJournal = true;
+        }
+
+        return TxnRecovery(vBuffer);
+    }
+
+
+    /*  Recover a transaction from journal data. */
+    template<class KeychainType, class CacheType>
+    bool SectorDatabase<KeychainType, CacheType>::TxnRecovery(const std::vector<uint8_t>& vJournal)
+    {
         /* Create the transaction object. */
         TxnBegin();
 
         /* Serialize the key. */
-        const DataStream ssJournal(vBuffer, SER_LLD, DATABASE_VERSION);
+        const DataStream ssJournal(vJournal, SER_LLD, DATABASE_VERSION);
         while(!ssJournal.End())
         {
             /* Read the data entry type. */
@@ -793,7 +1392,13 @@ namespace LLD
                 std::vector<uint8_t> vKey;
                 ssJournal >> vKey;
 
-                /* Erase the key. */
+                /* Skip keys that were already erased before the journal was interrupted. */
+                SectorKey cKey;
+                if(!pSectorKeys->Get(vKey, cKey))
+                    continue;
+
+                /* Erase the key, dropping any copy the cache holds from an earlier replayed record. */
+                cachePool->Remove(vKey);
                 pTransaction->EraseTransaction(vKey);
 
                 /* Debug output. */
@@ -843,6 +1448,36 @@ namespace LLD
                 /* Debug output. */
                 debug::log(0, FUNCTION, "indexing key ", HexStr(vKey.begin(), vKey.end()).substr(0, 20));
             }
+            else if(strType == "ordered")
+            {
+                /* Get the ordered key to write. */
+                std::vector<uint8_t> vKey;
+                ssJournal >> vKey;
+
+                /* Get the value to write. */
+                std::vector<uint8_t> vValue;
+                ssJournal >> vValue;
+
+                /* Write the ordered key. */
+                pTransaction->setOrderedErased.erase(vKey);
+                pTransaction->mapOrdered[vKey] = vValue;
+
+                /* Debug output. */
+                debug::log(0, FUNCTION, "writing ordered key ", HexStr(vKey.begin(), vKey.end()).substr(0, 20));
+            }
+            else if(strType == "eraseordered")
+            {
+                /* Get the ordered key to erase. */
+                std::vector<uint8_t> vKey;
+                ssJournal >> vKey;
+
+                /* Erase the ordered key. */
+                pTransaction->mapOrdered.erase(vKey);
+                pTransaction->setOrderedErased.insert(vKey);
+
+                /* Debug output. */
+                debug::log(0, FUNCTION, "erasing ordered key ", HexStr(vKey.begin(), vKey.end()).substr(0, 20));
+            }
             if(strType == "commit")
             {
                 debug::log(0, FUNCTION, strName, " transaction journal ready to be restored");
@@ -855,9 +1490,378 @@ namespace LLD
     }
 
 
+    /*  Sync the sector and keychain files to disk so the write-ahead log can be cleared. */
+    template<class KeychainType, class CacheType>
+    bool SectorDatabase<KeychainType, CacheType>::Sync()
+    {
+        /* Take the files written since the last sync. */
+        std::set<uint32_t> setFiles;
+        {
+            LOCK(SECTOR_MUTEX);
+            setFiles.swap(setSyncFiles);
+        }
+
+        /* Time the sync for the metrics. */
+        runtime::timer timer;
+        timer.Start();
+
+        /* Sync the sector files. */
+        for(const auto& nFile : setFiles)
+        {
+            if(!filesystem::sync(debug::safe_printstr(strBaseLocation, "_block.", std::setfill('0'), std::setw(5), nFile)))
+            {
+                /* Keep the remaining files for the next sync. */
+                LOCK(SECTOR_MUTEX);
+                setSyncFiles.insert(setFiles.begin(), setFiles.end());
+
+                return debug::error(FUNCTION, strName, " failed to sync sector file ", nFile);
+            }
+        }
+
+        /* Sync the keychain. */
+        if(!pSectorKeys->Sync())
+            return false;
+
+        pSyncTime->Observe(timer.ElapsedMicroseconds());
+
+        return true;
+    }
+
+
+    /*  Compact the keychain into fewer files while the database keeps serving reads. */
+    template<class KeychainType, class CacheType>
+    bool SectorDatabase<KeychainType, CacheType>::Compact()
+    {
+        return pSectorKeys->Compact();
+    }
+
+
+    /*  Sector garbage collector thread. */
+    template<class KeychainType, class CacheType>
+    void SectorDatabase<KeychainType, CacheType>::Collector()
+    {
+        /* Wait for initialization. */
+        while(!fInitialized)
+            runtime::sleep(100);
+
+        /* Only collect databases that asked for it and can be written to. */
+        if(!(nFlags & FLAGS::COLLECT) || (nFlags & FLAGS::READONLY))
+            return;
+
+        /* The Kb/s to copy records at and the seconds between passes. */
+        const uint64_t nRate     = std::max(int64_t(1), config::GetArg("-sectorgcrate", 1024)) * 1024;
+        const uint64_t nInterval = config::GetArg("-sectorgcinterval", 600);
+
+        runtime::timer TIMER;
+        TIMER.Start();
+
+        while(!fDestruct.load())
+        {
+            runtime::sleep(100);
+            if(TIMER.Elapsed() < nInterval)
+                continue;
+
+            Collect(nRate);
+            TIMER.Reset();
+        }
+    }
+
+
+    /*  Reclaim the space of erased and resized records. */
+    template<class KeychainType, class CacheType>
+    bool SectorDatabase<KeychainType, CacheType>::Collect(const uint64_t nRate)
+    {
+        runtime::timer timer;
+        timer.Start();
+
+        /* Add up the bytes and keys of each sector file that keys point to. */
+        std::map<uint32_t, uint64_t> mapLive;
+        std::map<uint32_t, uint64_t> mapKeys;
+        if(!pSectorKeys->Scan([&mapLive, &mapKeys](const uint64_t nSlot, const SectorKey& cKey)
+        {
+            if(cKey.nSectorSize > 0)
+            {
+                mapLive[cKey.nSectorFile] += cKey.nSectorSize;
+                ++mapKeys[cKey.nSectorFile];
+            }
+        }))
+            return debug::error(FUNCTION, strName, " keychain can't be scanned");
+
+        /* Truncate the files emptied by the last pass that no keys point into any more. */
+        std::vector<uint32_t> vTruncate;
+        for(auto it = setCollected.begin(); it != setCollected.end(); )
+        {
+            /* A key changed since the file was emptied, collect it again on a later pass. */
+            if(!mapLive.count(*it))
+                vTruncate.push_back(*it);
+
+            it = setCollected.erase(it);
+        }
+
+        if(!vTruncate.empty())
+        {
+            /* Make sure no key on disk points into the files before they are cut. */
+            if(!pSectorKeys->Sync())
+                return debug::error(FUNCTION, strName, " failed to sync keychain");
+
+            LOCK(SECTOR_MUTEX);
+            for(const auto& nFile : vTruncate)
+            {
+                /* Close the handles of the file first. */
+                fileCache->Remove(nFile);
+                pSectorReader->Release(nFile);
+
+                /* The records of the file are gone from the segment index too. */
+                pSegments->Reset(nFile);
+
+                /* Keep the empty file so the sector files are still numbered in order. A mapped file
+                   is only cut once no reader is copying from its mapping. */
+                if(pSectorMap)
+                {
+                    if(!pSectorMap->Truncate(nFile))
+                        return debug::error(FUNCTION, strName, " failed to truncate sector file ", nFile);
+                }
+                else
+                {
+                    std::ofstream stream(debug::safe_printstr(strBaseLocation, "_block.", std::setfill('0'), std::setw(5), nFile), std::ios::out | std::ios::binary | std::ios::trunc);
+                    stream.close();
+                }
+
+                setSyncFiles.erase(nFile);
+
+                debug::log(0, FUNCTION, strName, " truncated sector file ", nFile);
+            }
+        }
+
+        /* Find the sector files that are at least half unused, the current file is still being written. */
+        uint32_t nCurrent = 0;
+        {
+            LOCK(SECTOR_MUTEX);
+            nCurrent = nCurrentFile;
+        }
+
+        std::vector< std::pair<uint32_t, uint64_t> > vFiles;
+        for(uint32_t nFile = 0; nFile < nCurrent; ++nFile)
+        {
+            std::ifstream stream(debug::safe_printstr(strBaseLocation, "_block.", std::setfill('0'), std::setw(5), nFile), std::ios::in | std::ios::binary);
+            if(!stream)
+                continue;
+
+            /* Get the Binary Size. */
+            stream.seekg(0, std::ios::end);
+            const uint64_t nFileSize = static_cast<uint64_t>(stream.tellg());
+            stream.close();
+
+            if(nFileSize > 0 && mapLive[nFile] * 2 <= nFileSize)
+                vFiles.push_back(std::make_pair(nFile, nFileSize));
+        }
+
+        /* Copy the live records of each file a range at a time. */
+        uint64_t nRecords = 0;
+        uint64_t nBytes   = 0;
+        for(const auto& pairFile : vFiles)
+        {
+            const uint32_t nFile = pairFile.first;
+
+            /* Size the ranges so each keychain scan finds about SECTOR_COLLECT_KEYS keys. */
+            const uint64_t nRanges = std::max(uint64_t(1), (mapKeys[nFile] + SECTOR_COLLECT_KEYS - 1) / SECTOR_COLLECT_KEYS);
+            const uint64_t nRange  = std::max(uint64_t(1), (pairFile.second + nRanges - 1) / nRanges);
+
+            /* Records of this file are appended rather than updated in place until it is copied. */
+            {
+                LOCK(SECTOR_MUTEX);
+                nCollectFile = nFile;
+            }
+
+            const bool fCopied = CollectFile(nFile, pairFile.second, nRange, nRate, nRecords, nBytes);
+
+            {
+                LOCK(SECTOR_MUTEX);
+                nCollectFile = std::numeric_limits<uint32_t>::max();
+            }
+
+            if(!fCopied)
+                return false;
+
+            /* Truncate the file on the next pass if no keys were written into it meanwhile. */
+            setCollected.insert(nFile);
+        }
+
+        if(!vFiles.empty() || !vTruncate.empty())
+            debug::log(0, FUNCTION, strName, " collected ", vFiles.size(), " sector files, moved ", nRecords,
+                " keys and ", nBytes, " bytes in ", timer.Elapsed(), " seconds");
+
+        return true;
+    }
+
+
+    /*  Copy the live records of a sector file to the end of the current file a range at a time. */
+    template<class KeychainType, class CacheType>
+    bool SectorDatabase<KeychainType, CacheType>::CollectFile(const uint32_t nFile, const uint64_t nFileSize, const uint64_t nRange,
+                                                              const uint64_t nRate, uint64_t &nRecords, uint64_t &nBytes)
+    {
+        for(uint64_t nBegin = 0; nBegin < nFileSize; nBegin += nRange)
+        {
+            /* Find the keys pointing into this range. */
+            const uint64_t nEnd = nBegin + nRange;
+
+            runtime::timer scan;
+            scan.Start();
+
+            std::vector< std::pair<uint64_t, SectorKey> > vKeys;
+            if(!pSectorKeys->Scan([&vKeys, nFile, nBegin, nEnd](const uint64_t nSlot, const SectorKey& cKey)
+            {
+                if(cKey.nSectorFile == nFile && cKey.nSectorSize > 0 && cKey.nSectorStart >= nBegin && cKey.nSectorStart < nEnd)
+                    vKeys.push_back(std::make_pair(nSlot, cKey));
+            }))
+                return debug::error(FUNCTION, strName, " keychain can't be scanned");
+
+            /* Pause for a multiple of the scan, so scans take a bounded share of the keychain. */
+            const uint64_t nPause = scan.ElapsedMilliseconds() * SECTOR_COLLECT_PAUSE;
+            for(uint64_t nSlept = 0; nSlept < nPause; nSlept += 100)
+            {
+                if(fDestruct.load() || config::fShutdown.load())
+                    return debug::error(FUNCTION, strName, " garbage collection stopped by shutdown");
+
+                runtime::sleep(std::min(uint64_t(100), nPause - nSlept));
+            }
+
+            /* Copy records in file order, so keys indexed to the same record move together. */
+            std::sort(vKeys.begin(), vKeys.end(),
+                [](const std::pair<uint64_t, SectorKey>& a, const std::pair<uint64_t, SectorKey>& b)
+                {
+                    return a.second.nSectorStart < b.second.nSectorStart;
+                });
+
+            for(uint32_t nKey = 0; nKey < vKeys.size(); )
+            {
+                /* Stop early if the database is closing. */
+                if(fDestruct.load() || config::fShutdown.load())
+                    return debug::error(FUNCTION, strName, " garbage collection stopped by shutdown");
+
+                runtime::timer batch;
+                batch.Start();
+
+                /* Copy a tenth of a second's worth of records while writers are held. */
+                uint64_t nBatch = 0;
+                std::set<uint32_t> setWritten;
+                std::vector< std::pair<uint32_t, std::pair<uint32_t, uint32_t> > > vMoves;
+                {
+                    LOCK(SECTOR_MUTEX);
+
+                    while(nKey < vKeys.size() && (nBatch == 0 || nBatch < nRate / 10))
+                    {
+                        /* Find the keys of this record. */
+                        const SectorKey& cKey = vKeys[nKey].second;
+
+                        uint32_t nNext = nKey + 1;
+                        while(nNext < vKeys.size() && vKeys[nNext].second.nSectorStart == cKey.nSectorStart
+                            && vKeys[nNext].second.nSectorSize == cKey.nSectorSize)
+                            ++nNext;
+
+                        /* Read the record with its compact size. */
+                        std::vector<uint8_t> vRecord(cKey.nSectorSize, 0);
+                        if(!pSectorReader->Read(nFile, cKey.nSectorStart, &vRecord[0], vRecord.size()))
+                        {
+                            debug::error(FUNCTION, strName, " failed to read record at ", cKey.nSectorStart, " of sector file ", nFile);
+
+                            nKey = nNext;
+                            continue;
+                        }
+
+                        /* Create new file if above current file size. */
+                        if(nCurrentFileSize > MAX_SECTOR_FILE_SIZE)
+                        {
+                            debug::log(4, FUNCTION, "allocating new sector file ", nCurrentFile + 1);
+
+                            ++nCurrentFile;
+                            nCurrentFileSize = 0;
+
+                            std::ofstream stream
+                            (
+                                debug::safe_printstr(strBaseLocation, "_block.", std::setfill('0'), std::setw(5), nCurrentFile),
+                                std::ios::out | std::ios::binary | std::ios::trunc
+                            );
+                            stream.close();
+                        }
+
+                        /* Find the file stream for LRU cache. */
+                        std::fstream* pstream;
+                        if(!fileCache->Get(nCurrentFile, pstream))
+                        {
+                            /* Set the new stream pointer. */
+                            pstream = new std::fstream(debug::safe_printstr(strBaseLocation, "_block.", std::setfill('0'), std::setw(5), nCurrentFile), std::ios::in | std::ios::out | std::ios::binary);
+                            if(!pstream->is_open())
+                            {
+                                delete pstream;
+                                return debug::error(FUNCTION, "couldn't create stream file");
+                            }
+
+                            /* If file not found add to LRU cache. */
+                            fileCache->Put(nCurrentFile, pstream);
+                        }
+
+                        /* Append the copy to the current file. */
+                        pstream->seekp(nCurrentFileSize, std::ios::beg);
+                        if(!pstream->write((char*) &vRecord[0], vRecord.size()))
+                            return debug::error(FUNCTION, "only ", pstream->gcount(), "/", vRecord.size(), " bytes written");
+
+                        pstream->flush();
+                        setWritten.insert(nCurrentFile);
+
+                        for(uint32_t i = nKey; i < nNext; ++i)
+                            vMoves.push_back(std::make_pair(i, std::make_pair(nCurrentFile, nCurrentFileSize)));
+
+                        nCurrentFileSize += static_cast<uint32_t>(vRecord.size());
+                        nBatch += vRecord.size();
+
+                        nKey = nNext;
+                    }
+                }
+
+                /* The copies must be on disk before any key points to them. Writers carry on meanwhile, the
+                   records being copied are only written again by appending, which leaves their keys to fail
+                   the relocate. */
+                for(const auto& nWritten : setWritten)
+                {
+                    if(!filesystem::sync(debug::safe_printstr(strBaseLocation, "_block.", std::setfill('0'), std::setw(5), nWritten)))
+                        return debug::error(FUNCTION, strName, " failed to sync sector file ", nWritten);
+                }
+
+                /* Point the keys to the copies, keys written since the scan are left alone. */
+                {
+                    LOCK(SECTOR_MUTEX);
+
+                    for(const auto& pairMove : vMoves)
+                    {
+                        const std::pair<uint64_t, SectorKey>& pairKey = vKeys[pairMove.first];
+                        if(pSectorKeys->Relocate(pairKey.first, pairKey.second,
+                            static_cast<uint16_t>(pairMove.second.first), pairMove.second.second))
+                            ++nRecords;
+                    }
+                }
+
+                nBytes += nBatch;
+
+                /* Sleep off the rest of the batch's share of the rate. */
+                const uint64_t nTarget = (nBatch * 1000) / nRate;
+                const uint64_t nElapsed = batch.ElapsedMilliseconds();
+                if(nTarget > nElapsed)
+                    runtime::sleep(nTarget - nElapsed);
+            }
+        }
+
+        return true;
+    }
+
+
     /* Explicity instantiate all template instances needed for compiler. */
+    template class SectorDatabase<Keychain,       BinaryLRU>;
     template class SectorDatabase<BinaryHashMap,  BinaryLRU>;
-    //template class SectorDatabase<ShardHashMap,   BinaryLRU>;
+    template class SectorDatabase<ShardHashMap,   BinaryLRU>;
+    template class SectorDatabase<Keychain,       Binary2Q>;
+    template class SectorDatabase<BinaryHashMap,  Binary2Q>;
+    template class SectorDatabase<ShardHashMap,   Binary2Q>;
     //template class SectorDatabase<BinaryHashMap,  BinaryLFU>;
     //template class SectorDatabase<BinaryHashTree, BinaryLRU>;
 
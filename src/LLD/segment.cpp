@@ -0,0 +1,175 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLD/templates/segment.h>
+#include <LLD/include/compress.h>
+
+#include <Util/include/mutex.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace LLD
+{
+
+    /* Read the compact size in front of a record or a type string in a buffer. */
+    bool RecordHeader(const uint8_t* pData, const uint64_t nAvailable, uint64_t& nSize, uint32_t& nHeader)
+    {
+        if(nAvailable == 0)
+            return false;
+
+        /* The first byte is the size, or the width of the little-endian size after it. */
+        nHeader = (pData[0] < 253) ? 1 : (pData[0] == 253) ? 3 : (pData[0] == 254) ? 5 : 9;
+        if(nAvailable < nHeader)
+            return false;
+
+        nSize = 0;
+        if(nHeader == 1)
+            nSize = pData[0];
+        else
+        {
+            for(uint32_t n = nHeader - 1; n > 0; --n)
+                nSize = (nSize << 8) | pData[n];
+        }
+
+        return true;
+    }
+
+
+    /* Get the serialized type string a record starts with, decompressing the record if needed. */
+    bool RecordType(const uint8_t* pRecord, const uint64_t nSize, std::vector<uint8_t>& vType)
+    {
+        /* Compressed records hold their type string in the compressed data. */
+        std::vector<uint8_t> vData;
+        if(IsCompressed(pRecord, nSize))
+        {
+            if(!DecompressRecord(pRecord, nSize, vData))
+                return false;
+
+            return RecordType(&vData[0], vData.size(), vType);
+        }
+
+        /* Read the length of the type string. */
+        uint64_t nLength;
+        uint32_t nHeader;
+        if(!RecordHeader(pRecord, nSize, nLength, nHeader) || nHeader + nLength > nSize)
+            return false;
+
+        vType.assign(pRecord, pRecord + nHeader + nLength);
+
+        return true;
+    }
+
+
+    /* Segment Size Constructor */
+    SegmentIndex::SegmentIndex(const uint32_t nSegmentRecordsIn)
+    : MUTEX           ( )
+    , nSegmentRecords (std::max(nSegmentRecordsIn, 1u))
+    , mapFiles        ( )
+    {
+    }
+
+
+    /* Default Destructor */
+    SegmentIndex::~SegmentIndex()
+    {
+    }
+
+
+    /* Get how far a file is indexed. */
+    uint64_t SegmentIndex::Indexed(const uint32_t nFile) const
+    {
+        LOCK(MUTEX);
+
+        auto it = mapFiles.find(nFile);
+        if(it == mapFiles.end())
+            return 0;
+
+        return it->second.nIndexed;
+    }
+
+
+    /* Add the next record of a file to the index. */
+    bool SegmentIndex::Add(const uint32_t nFile, const uint64_t nPos, const uint64_t nNext, const std::vector<uint8_t>& vType)
+    {
+        LOCK(MUTEX);
+
+        /* Records are only added in the order of the file. */
+        SegmentFile& file = mapFiles[nFile];
+        if(nPos != file.nIndexed || nNext <= nPos)
+            return false;
+
+        /* Start a new segment when the last one is full. */
+        if(file.vStarts.empty() || file.nRecords >= nSegmentRecords)
+        {
+            file.vStarts.push_back(nPos);
+            file.nRecords = 0;
+        }
+
+        /* Add the segment to the list of its type. */
+        const uint32_t nSegment = static_cast<uint32_t>(file.vStarts.size() - 1);
+        std::vector<uint32_t>& vSegments = file.mapTypes[vType];
+        if(vSegments.empty() || vSegments.back() != nSegment)
+            vSegments.push_back(nSegment);
+
+        ++file.nRecords;
+        file.nIndexed = nNext;
+
+        return true;
+    }
+
+
+    /* Get the ranges of a file that hold records of a type, from a starting position. */
+    void SegmentIndex::Ranges(const uint32_t nFile, const std::vector<uint8_t>& vType, const uint64_t nStart,
+        std::vector< std::pair<uint64_t, uint64_t> >& vRanges) const
+    {
+        vRanges.clear();
+
+        LOCK(MUTEX);
+
+        /* Check for the file and type. */
+        auto itFile = mapFiles.find(nFile);
+        if(itFile == mapFiles.end() || nStart >= itFile->second.nIndexed)
+            return;
+
+        const SegmentFile& file = itFile->second;
+        auto itType = file.mapTypes.find(vType);
+        if(itType == file.mapTypes.end())
+            return;
+
+        /* Find the segment holding the start. */
+        const uint32_t nFirst = static_cast<uint32_t>(std::upper_bound(file.vStarts.begin(), file.vStarts.end(), nStart) - file.vStarts.begin() - 1);
+
+        /* Add the type's segments from there, joining neighbours into one range. */
+        const std::vector<uint32_t>& vSegments = itType->second;
+        for(auto it = std::lower_bound(vSegments.begin(), vSegments.end(), nFirst); it != vSegments.end(); ++it)
+        {
+            const uint64_t nBegin = std::max(file.vStarts[*it], nStart);
+            const uint64_t nEnd   = (*it + 1 < file.vStarts.size()) ? file.vStarts[*it + 1] : file.nIndexed;
+
+            if(!vRanges.empty() && vRanges.back().second == nBegin)
+                vRanges.back().second = nEnd;
+            else
+                vRanges.push_back(std::make_pair(nBegin, nEnd));
+        }
+    }
+
+
+    /* Drop the index of a file. */
+    void SegmentIndex::Reset(const uint32_t nFile)
+    {
+        LOCK(MUTEX);
+
+        mapFiles.erase(nFile);
+    }
+}
@@ -17,82 +17,65 @@ ________________________________________________________________________________
 #include <LLD/hash/xxh3.h>
 
 #include <Util/templates/datastream.h>
+#include <Util/include/args.h>
 #include <Util/include/filesystem.h>
 #include <Util/include/debug.h>
 #include <Util/include/hex.h>
+#include <Util/include/runtime.h>
 
+#include <algorithm>
 #include <iomanip>
+#include <limits>
 
 namespace LLD
 {
 
-    /** The Database Constructor. To determine file location and the Bytes per Record. **/
+    /* The Database Constructor. To determine file location and the Bytes per Record. */
     ShardHashMap::ShardHashMap(const std::string& strBaseLocationIn, const uint8_t nFlagsIn,
         const uint64_t nBucketsIn, const uint32_t nShardsIn)
-    : KEY_MUTEX()
-    , strBaseLocation(strBaseLocationIn)
-    , fileCache(new TemplateLRU<std::pair<uint16_t, uint16_t>, std::fstream*>(8))
-    , diskShards(new TemplateLRU<uint16_t, std::vector<uint16_t>*>(nShardsIn))
-    , indexCache(new TemplateLRU<uint16_t, std::fstream*>(nShardsIn))
-    , HASHMAP_TOTAL_BUCKETS(nBucketsIn)
-    , HASHMAP_TOTAL_SHARDS(nShardsIn)
-    , HASHMAP_MAX_KEY_SIZE(32)
-    , HASHMAP_KEY_ALLOCATION(static_cast<uint16_t>(HASHMAP_MAX_KEY_SIZE + 13))
-    , nFlags(nFlagsIn)
-    , RECORD_MUTEX(1024)
+    : KEY_MUTEX              ( )
+    , strBaseLocation        (strBaseLocationIn)
+    , fileCache              (new TemplateLRU<std::pair<uint16_t, uint16_t>, std::fstream*>(64))
+    , vIndex                 (std::max(nShardsIn, 1u), nullptr)
+    , vReader                (std::max(nShardsIn, 1u), nullptr)
+    , vHashmap               (std::max(nShardsIn, 1u))
+    , HASHMAP_TOTAL_BUCKETS  (static_cast<uint32_t>(std::max(nBucketsIn / std::max(nShardsIn, 1u), uint64_t(1))))
+    , HASHMAP_TOTAL_SHARDS   (std::max(nShardsIn, 1u))
+    , HASHMAP_MAX_KEY_SIZE   (32)
+    , HASHMAP_KEY_ALLOCATION (static_cast<uint16_t>(HASHMAP_MAX_KEY_SIZE + 13))
+    , nFlags                 (nFlagsIn)
+    , RECORD_MUTEX           (1024)
+    , vBloom                 (std::max(nShardsIn, 1u))
+    , HASHMAP_BLOOM_BITS     (static_cast<uint8_t>(std::min(std::max(config::GetArg("-bloombits", 8), int64_t(0)), int64_t(32))))
+    , nBloomSkipped          (0)
+    , nBloomHits             (0)
+    , nBloomFalse            (0)
+    , pProbes                (nullptr)
     {
         Initialize();
     }
 
 
-    /* Copy Constructor */
-    ShardHashMap::ShardHashMap(const ShardHashMap& map)
-    : KEY_MUTEX()
-    , strBaseLocation(map.strBaseLocation)
-    , fileCache(map.fileCache)
-    , diskShards(map.diskShards)
-    , indexCache(map.indexCache)
-    , HASHMAP_TOTAL_BUCKETS(map.HASHMAP_TOTAL_BUCKETS)
-    , HASHMAP_TOTAL_SHARDS(map.HASHMAP_TOTAL_SHARDS)
-    , HASHMAP_MAX_KEY_SIZE(map.HASHMAP_MAX_KEY_SIZE)
-    , HASHMAP_KEY_ALLOCATION(map.HASHMAP_KEY_ALLOCATION)
-    , nFlags(map.nFlags)
-    , RECORD_MUTEX(map.RECORD_MUTEX.size())
-    {
-        Initialize();
-    }
-
-
-    /* Copy Assignment Operator */
-    ShardHashMap& ShardHashMap::operator=(const ShardHashMap& map)
+    /* Default Destructor */
+    ShardHashMap::~ShardHashMap()
     {
-        strBaseLocation        = map.strBaseLocation;
-        fileCache              = map.fileCache;
-        diskShards             = map.diskShards;
-        indexCache             = map.indexCache;
-        HASHMAP_TOTAL_BUCKETS  = map.HASHMAP_TOTAL_BUCKETS;
-        HASHMAP_TOTAL_SHARDS   = map.HASHMAP_TOTAL_SHARDS;
-        HASHMAP_MAX_KEY_SIZE   = map.HASHMAP_MAX_KEY_SIZE;
-        HASHMAP_KEY_ALLOCATION = map.HASHMAP_KEY_ALLOCATION;
-        nFlags                 = map.nFlags;
+        /* Persist the bloom filters so they don't need to be rebuilt on next startup. */
+        bloom_save();
 
-        Initialize();
-
-        return *this;
-    }
+        if(fileCache)
+            delete fileCache;
 
+        for(auto& pindex : vIndex)
+            if(pindex)
+                delete pindex;
 
-    /** Default Destructor **/
-    ShardHashMap::~ShardHashMap()
-    {
-        delete fileCache;
-        delete diskShards;
-        delete indexCache;
+        for(auto& pReader : vReader)
+            if(pReader)
+                delete pReader;
     }
 
 
-    /*  Compresses a given key until it matches size criteria.
-     *  This function is one way and efficient for reducing key sizes. */
+    /*  Compresses a given key until it matches size criteria. */
     void ShardHashMap::CompressKey(std::vector<uint8_t>& vData, uint16_t nSize)
     {
         /* Loop until key is of desired size. */
@@ -113,146 +96,102 @@ namespace LLD
     }
 
 
-    /*  Calculates a bucket to be used for the hashmap allocation. */
-    uint32_t ShardHashMap::GetBucket(const std::vector<uint8_t>& vKey, uint32_t& nShard)
+    /* Calculates the shard and bucket to be used for the hashmap allocation. */
+    uint32_t ShardHashMap::GetBucket(const std::vector<uint8_t>& vKeyCompressed, uint32_t& nShard)
     {
         /* Get an xxHash. */
-        uint64_t nBucket = XXH64(&vKey[0], vKey.size(), 0) / 7;
-        nShard = static_cast<uint32_t>(nBucket % HASHMAP_TOTAL_SHARDS);
+        uint64_t nHash = XXH64(&vKeyCompressed[0], vKeyCompressed.size(), 0);
+
+        /* Use the low part for the shard so the bucket isn't correlated with it. */
+        nShard = static_cast<uint32_t>(nHash % HASHMAP_TOTAL_SHARDS);
 
-        /* Get the hashmap bucket. */
-        return static_cast<uint32_t>(nBucket % HASHMAP_TOTAL_BUCKETS);
+        return static_cast<uint32_t>((nHash / HASHMAP_TOTAL_SHARDS) % HASHMAP_TOTAL_BUCKETS);
     }
 
 
-    /* Loads a disk index containing shard data into memory.*/
-    static uint64_t TOTAL_KEYS = 0;
-    void ShardHashMap::LoadShardIndex(const uint32_t nShard)
+    /* Initialize the shard hash map keychain. */
+    void ShardHashMap::Initialize()
     {
-        /* Check that disk index isn't already loaded. */
-        if(diskShards->Has(nShard))
-            return;
-
-        /* Build the hashmap indexes. */
-        std::string index = debug::safe_printstr(strBaseLocation, "_index.", std::setfill('0'), std::setw(3), nShard);
-        if(!filesystem::exists(index))
-        {
-            /* Generate empty space for new file. */
-            const static std::vector<uint8_t> vSpace(HASHMAP_TOTAL_BUCKETS * 2, 0);
-
-            /* Write the new disk index .*/
-            std::fstream stream(index, std::ios::out | std::ios::binary | std::ios::trunc);
-            stream.write((char*)&vSpace[0], vSpace.size());
-            stream.close();
-
-            /* Debug output showing generation of disk index. */
-            debug::log(0, FUNCTION, "Generated Disk Index ", nShard, " of ", vSpace.size(), " bytes");
-
-            /* Set disk index cache to blank values. */
-            std::vector<uint16_t>* hashmap = new std::vector<uint16_t>(HASHMAP_TOTAL_BUCKETS, 0);
+        /* Create directories if they don't exist yet. */
+        if(!filesystem::exists(strBaseLocation) && filesystem::create_directories(strBaseLocation))
+            debug::log(0, FUNCTION, "Generated Path ", strBaseLocation);
 
-            /* Add to the LRU cache. */
-            diskShards->Put(nShard, hashmap);
-        }
+        /* Build a vector to read and write the disk indexes. */
+        std::vector<uint8_t> vDisk(HASHMAP_TOTAL_BUCKETS * 2, 0);
 
-        /* Read the hashmap indexes. */
-        else
+        uint64_t nTotalKeys = 0;
+        for(uint32_t nShard = 0; nShard < HASHMAP_TOTAL_SHARDS; ++nShard)
         {
-            /* Create the stream index object. */
-            std::fstream* pstream;
-            if(!indexCache->Get(nShard, pstream))
+            vHashmap[nShard].assign(HASHMAP_TOTAL_BUCKETS, 0);
+
+            /* Build the shard's disk index if it doesn't exist. */
+            std::string index = debug::safe_printstr(strBaseLocation, "_index.", std::setfill('0'), std::setw(3), nShard);
+            if(!filesystem::exists(index))
             {
-                pstream = new std::fstream(index, std::ios::in | std::ios::out | std::ios::binary);
-                if(!pstream->is_open())
-                {
-                    delete pstream;
-                    throw debug::exception(FUNCTION, "index cache file could not be loaded");
-                }
+                std::fill(vDisk.begin(), vDisk.end(), 0);
 
-                indexCache->Put(nShard, pstream);
+                std::fstream stream(index, std::ios::out | std::ios::binary | std::ios::trunc);
+                stream.write((char*)&vDisk[0], vDisk.size());
+                stream.close();
             }
 
-            /* Build a vector to read the disk index. */
-            std::vector<uint8_t> vIndex(HASHMAP_TOTAL_BUCKETS * 2, 0);
-
-            /* Read the entire index shard. */
-            pstream->read((char*)&vIndex[0], vIndex.size());
-
-            /* Deserialize the values into memory index. */
-            uint32_t nTotalKeys = 0;
-
-            /* Create the hashmap vector. */
-            std::vector<uint16_t>* hashmap = new std::vector<uint16_t>(HASHMAP_TOTAL_BUCKETS, 0);
-            for(uint32_t nBucket = 0; nBucket < HASHMAP_TOTAL_BUCKETS; ++nBucket)
+            /* Read the shard's disk index. */
+            else
             {
-                std::copy((uint8_t *)&vIndex[nBucket * 2], (uint8_t *)&vIndex[nBucket * 2] + 2, (uint8_t *)&hashmap->at(nBucket));
+                std::fstream stream(index, std::ios::in | std::ios::binary);
+                stream.read((char*)&vDisk[0], vDisk.size());
+                stream.close();
 
-                nTotalKeys += hashmap->at(nBucket);
+                /* Deserialize the values into memory index. */
+                for(uint32_t nBucket = 0; nBucket < HASHMAP_TOTAL_BUCKETS; ++nBucket)
+                {
+                    std::copy((uint8_t *)&vDisk[nBucket * 2], (uint8_t *)&vDisk[nBucket * 2] + 2, (uint8_t *)&vHashmap[nShard][nBucket]);
 
-                TOTAL_KEYS += hashmap->at(nBucket);
+                    nTotalKeys += vHashmap[nShard][nBucket];
+                }
             }
 
-            /* Debug output showing loading of disk index. */
-            //debug::log(0, FUNCTION, "Loaded Shard ", nShard, " Index of ", vIndex.size(), " bytes and ", nTotalKeys, " keys");
-
-            /* Add to the LRU cache. */
-            diskShards->Put(nShard, hashmap);
-        }
-    }
-
-
-    /*  Read a key index from the disk hashmaps. */
-    void ShardHashMap::Initialize()
-    {
-        /* Create directories if they don't exist yet. */
-        if(!filesystem::exists(strBaseLocation) && filesystem::create_directories(strBaseLocation))
-            debug::log(0, FUNCTION, "Generated Path ", strBaseLocation);
-
-        /* Loop through the available shards. */
-        for(uint32_t nShard = 0; nShard < HASHMAP_TOTAL_SHARDS; ++nShard)
-        {
-            /* Load the hashmap shards. */
-            LoadShardIndex(nShard);
-
-            /* Build the first hashmap index file if it doesn't exist. */
-            std::string file = debug::safe_printstr(strBaseLocation, "_hashmap.",
-                std::setfill('0'), std::setw(3), nShard, ".", std::setfill('0'), std::setw(5), 0u);
-
-            /* Create hashmap for current shard. */
+            /* Build the shard's first hashmap file if it doesn't exist. */
+            std::string file = hashmap_file(nShard, 0);
             if(!filesystem::exists(file))
             {
-                /* Build a vector with empty bytes to flush to disk. */
                 std::vector<uint8_t> vSpace(HASHMAP_TOTAL_BUCKETS * HASHMAP_KEY_ALLOCATION, 0);
 
-                /* Flush the empty keychain file to disk. */
                 std::fstream stream(file, std::ios::out | std::ios::binary | std::ios::trunc);
                 stream.write((char*)&vSpace[0], vSpace.size());
                 stream.close();
-
-                /* Debug output showing generating of the hashmap file. */
-                debug::log(0, FUNCTION, "Generated Disk Hash Map 0 of ", vSpace.size(), " bytes");
             }
 
-            /* Load the stream object into the stream LRU cache. */
-            std::fstream* pstream = new std::fstream(file, std::ios::in | std::ios::out | std::ios::binary);
-            if(!pstream->is_open())
-                throw debug::exception(FUNCTION, "failed to open ", file);
+            /* Create the stream index object and positional reader. */
+            vIndex[nShard]  = new std::fstream(index, std::ios::in | std::ios::out | std::ios::binary);
+            vReader[nShard] = new FileReader(debug::safe_printstr(strBaseLocation, "_hashmap.", std::setfill('0'), std::setw(3), nShard, "."));
 
-            fileCache->Put(std::make_pair(nShard, 0), pstream);
+            /* Reserve a filter slot for every possible hashmap file so that adding a file never
+               moves the filters that concurrent readers are using. */
+            vBloom[nShard].reserve(std::numeric_limits<uint16_t>::max() + 1);
         }
 
-        debug::log(0, FUNCTION, "Shard Hashmap Initialized with ", TOTAL_KEYS, " total keys");
+        /* Debug output showing loading of disk indexes. */
+        debug::log(0, FUNCTION, "Loaded ", HASHMAP_TOTAL_SHARDS, " Disk Indexes of ", vDisk.size(), " bytes and ", nTotalKeys, " keys");
+
+        /* Load or rebuild the bloom filters. */
+        bloom_load();
     }
 
 
-    /*  Read a key index from the disk hashmaps. */
+    /* Read a key index from the disk hashmaps. */
     bool ShardHashMap::Get(const std::vector<uint8_t>& vKey, SectorKey &cKey)
     {
-        LOCK(KEY_MUTEX);
+        /* Compress any keys larger than max size. */
+        std::vector<uint8_t> vKeyCompressed = vKey;
+        CompressKey(vKeyCompressed, HASHMAP_MAX_KEY_SIZE);
 
-        /* Get the assigned bucket for the hashmap. */
+        /* Get the assigned shard and bucket for the hashmap. */
         uint32_t nShard  = 0;
-        uint32_t nBucket = GetBucket(vKey, nShard);
+        uint32_t nBucket = GetBucket(vKeyCompressed, nShard);
+
+        /* Lock the stripe for this bucket so readers of other buckets don't contend. */
+        LOCK(RECORD_MUTEX[(nShard * HASHMAP_TOTAL_BUCKETS + nBucket) % RECORD_MUTEX.size()]);
 
         /* Get the file binary position. */
         uint32_t nFilePos = nBucket * HASHMAP_KEY_ALLOCATION;
@@ -260,47 +199,32 @@ namespace LLD
         /* Set the cKey return value non compressed. */
         cKey.vKey = vKey;
 
-        /* Compress any keys larger than max size. */
-        std::vector<uint8_t> vKeyCompressed = vKey;
-        CompressKey(vKeyCompressed, HASHMAP_MAX_KEY_SIZE);
-
-        /* Get the disk index. */
-        std::vector<uint16_t>* hashmap;
-        if(!diskShards->Get(nShard, hashmap))
-        {
-            LoadShardIndex(nShard);
-            if(!diskShards->Get(nShard, hashmap))
-                return debug::error(FUNCTION, "couldn't get shard index");
-        }
-
         /* Reverse iterate the linked file list from hashmap to get most recent keys first. */
         std::vector<uint8_t> vBucket(HASHMAP_KEY_ALLOCATION, 0);
-        for(int16_t i = hashmap->at(nBucket) - 1; i >= 0; --i)
+        uint32_t nProbes = 0;
+        for(int32_t i = vHashmap[nShard][nBucket] - 1; i >= 0; --i)
         {
-            /* Find the file stream for LRU cache. */
-            std::fstream *pstream;
-            if(!fileCache->Get(std::make_pair(nShard, i), pstream))
+            /* Skip the disk probe if the bloom filter rules this file out. */
+            if(!bloom_check(nShard, i, vKeyCompressed))
+                continue;
+
+            ++nProbes;
+
+            /* Read the bucket with a positional read, falling back to the stream. */
+            if(!vReader[nShard]->Read(i, nFilePos, &vBucket[0], vBucket.size()))
             {
-                /* Set the new stream pointer. */
-                std::string filename = debug::safe_printstr(strBaseLocation, "_hashmap.",
-                    std::setfill('0'), std::setw(3), nShard, ".", std::setfill('0'), std::setw(5), i);
+                LOCK2(KEY_MUTEX);
 
-                pstream = new std::fstream(filename, std::ios::in | std::ios::out | std::ios::binary);
-                if(!pstream->is_open())
-                {
-                    delete pstream;
+                std::fstream* pstream = get_stream(nShard, i);
+                if(!pstream)
                     continue;
-                }
-
-                /* If file not found add to LRU cache. */
-                fileCache->Put(std::make_pair(nShard, i), pstream);
-            }
 
-            /* Seek to the hashmap index in file. */
-            pstream->seekg(nFilePos, std::ios::beg);
+                /* Seek to the hashmap index in file. */
+                pstream->seekg(nFilePos, std::ios::beg);
 
-            /* Read the bucket binary data from file stream */
-            pstream->read((char*) &vBucket[0], vBucket.size());
+                /* Read the bucket binary data from file stream */
+                pstream->read((char*) &vBucket[0], vBucket.size());
+            }
 
             /* Check if this bucket has the key */
             if(std::equal(vBucket.begin() + 13, vBucket.begin() + 13 + vKeyCompressed.size(), vKeyCompressed.begin()))
@@ -317,166 +241,123 @@ namespace LLD
                 if(config::nVerbose >= 4)
                     debug::log(4, FUNCTION, "State: ", cKey.nState == STATE::READY ? "Valid" : "Invalid",
                         " | Length: ", cKey.nLength,
+                        " | Shard ", nShard,
                         " | Bucket ", nBucket,
                         " | Location: ", nFilePos,
-                        " | File: ", hashmap->at(nBucket) - 1,
+                        " | File: ", i,
                         " | Sector File: ", cKey.nSectorFile,
                         " | Sector Size: ", cKey.nSectorSize,
                         " | Sector Start: ", cKey.nSectorStart, "\n",
                         HexStr(vKeyCompressed.begin(), vKeyCompressed.end(), true));
 
+                /* Count the bloom filter hit. */
+                if(HASHMAP_BLOOM_BITS > 0)
+                    ++nBloomHits;
+
+                if(pProbes)
+                    pProbes->Observe(nProbes);
+
                 return true;
             }
+
+            /* The bloom filter reported a key that wasn't in this file. */
+            if(HASHMAP_BLOOM_BITS > 0)
+                ++nBloomFalse;
         }
 
+        /* Count the probes of a key that wasn't found. */
+        if(pProbes)
+            pProbes->Observe(nProbes);
+
         return false;
     }
 
 
-    /*  Read a key index from the disk hashmaps.
-     *  This method iterates all maps to find all keys. */
+    /* Read a key index from the disk hashmaps. This method iterates all maps to find all keys. */
     bool ShardHashMap::Get(const std::vector<uint8_t>& vKey, std::vector<SectorKey>& vKeys)
     {
-        LOCK(KEY_MUTEX);
+        /* Compress any keys larger than max size. */
+        std::vector<uint8_t> vKeyCompressed = vKey;
+        CompressKey(vKeyCompressed, HASHMAP_MAX_KEY_SIZE);
 
-        /* Get the assigned bucket for the hashmap. */
+        /* Get the assigned shard and bucket for the hashmap. */
         uint32_t nShard  = 0;
-        uint32_t nBucket = GetBucket(vKey, nShard);
+        uint32_t nBucket = GetBucket(vKeyCompressed, nShard);
+
+        /* Lock the stripe for this bucket. */
+        LOCK(RECORD_MUTEX[(nShard * HASHMAP_TOTAL_BUCKETS + nBucket) % RECORD_MUTEX.size()]);
 
         /* Get the file binary position. */
         uint32_t nFilePos = nBucket * HASHMAP_KEY_ALLOCATION;
 
-        /* Compress any keys larger than max size. */
-        std::vector<uint8_t> vKeyCompressed = vKey;
-        CompressKey(vKeyCompressed, HASHMAP_MAX_KEY_SIZE);
-
-        /* Get the disk index. */
-        std::vector<uint16_t>* hashmap;
-        if(!diskShards->Get(nShard, hashmap))
-        {
-            LoadShardIndex(nShard);
-            if(!diskShards->Get(nShard, hashmap))
-                return debug::error(FUNCTION, "couldn't get shard index");
-        }
-
         /* Reverse iterate the linked file list from hashmap to get most recent keys first. */
         std::vector<uint8_t> vBucket(HASHMAP_KEY_ALLOCATION, 0);
-        for(int16_t i = hashmap->at(nBucket) - 1; i >= 0; --i)
+        for(int32_t i = vHashmap[nShard][nBucket] - 1; i >= 0; --i)
         {
-            /* Find the file stream for LRU cache. */
-            std::fstream *pstream;
-            if(!fileCache->Get(std::make_pair(nShard, i), pstream))
-            {
-                /* Set the new stream pointer. */
-                std::string filename = debug::safe_printstr(strBaseLocation, "_hashmap.",
-                    std::setfill('0'), std::setw(3), nShard, ".", std::setfill('0'), std::setw(5), i);
-
-                pstream = new std::fstream(filename, std::ios::in | std::ios::out | std::ios::binary);
-                if(!pstream->is_open())
-                {
-                    delete pstream;
-                    continue;
-                }
-
-                /* If file not found add to LRU cache. */
-                fileCache->Put(std::make_pair(nShard, i), pstream);
-            }
-
-            /* Seek to the hashmap index in file. */
-            pstream->seekg (nFilePos, std::ios::beg);
+            /* Skip the disk probe if the bloom filter rules this file out. */
+            if(!bloom_check(nShard, i, vKeyCompressed))
+                continue;
 
-            /* Read the bucket binary data from file stream */
-            pstream->read((char*) &vBucket[0], vBucket.size());
+            /* Read the bucket with a positional read. */
+            if(!vReader[nShard]->Read(i, nFilePos, &vBucket[0], vBucket.size()))
+                continue;
 
             /* Check if this bucket has the key */
             if(std::equal(vBucket.begin() + 13, vBucket.begin() + 13 + vKeyCompressed.size(), vKeyCompressed.begin()))
             {
-                /* Deserialize key and return if found. */
+                /* Deserialie key and add to the list if ready. */
                 DataStream ssKey(vBucket, SER_LLD, DATABASE_VERSION);
                 SectorKey cKey;
                 ssKey >> cKey;
 
-                /* Check if the key is in ready state. */
                 if(!cKey.Ready())
                     continue;
 
-                /* Assign the binary key. */
                 cKey.vKey = vKey;
-
-                /* Add key to return vector. */
                 vKeys.push_back(cKey);
-
-                /* Debug Output of Sector Key Information. */
-                if(config::nVerbose >= 4)
-                    debug::log(4, FUNCTION, "Found State: ", cKey.nState == STATE::READY ? "Valid" : "Invalid",
-                        " | Length: ", cKey.nLength,
-                        " | Bucket ", nBucket,
-                        " | Location: ", nFilePos,
-                        " | File: ", hashmap->at(nBucket) - 1,
-                        " | Sector File: ", cKey.nSectorFile,
-                        " | Sector Size: ", cKey.nSectorSize,
-                        " | Sector Start: ", cKey.nSectorStart, "\n",
-                        HexStr(vKeyCompressed.begin(), vKeyCompressed.end(), true));
             }
         }
 
-        return (vKeys.size() > 0);
+        return vKeys.size() > 0;
     }
 
 
-    /*  Write a key to the disk hashmaps. */
+    /* Write a key to the disk hashmaps. */
     bool ShardHashMap::Put(const SectorKey& cKey)
     {
-        LOCK(KEY_MUTEX);
+        /* Compress any keys larger than max size. */
+        std::vector<uint8_t> vKeyCompressed = cKey.vKey;
+        CompressKey(vKeyCompressed, HASHMAP_MAX_KEY_SIZE);
 
-        /* Get the assigned bucket for the hashmap. */
+        /* Get the assigned shard and bucket for the hashmap. */
         uint32_t nShard  = 0;
-        uint32_t nBucket = GetBucket(cKey.vKey, nShard);
+        uint32_t nBucket = GetBucket(vKeyCompressed, nShard);
+
+        /* Lock the bucket stripe first, then the keychain streams. */
+        LOCK(RECORD_MUTEX[(nShard * HASHMAP_TOTAL_BUCKETS + nBucket) % RECORD_MUTEX.size()]);
+        LOCK2(KEY_MUTEX);
 
         /* Get the file binary position. */
         uint32_t nFilePos = nBucket * HASHMAP_KEY_ALLOCATION;
 
-        /* Compress any keys larger than max size. */
-        std::vector<uint8_t> vKeyCompressed = cKey.vKey;
-        CompressKey(vKeyCompressed, HASHMAP_MAX_KEY_SIZE);
-
-        /* Get the disk index. */
-        std::vector<uint16_t>* hashmap;
-        if(!diskShards->Get(nShard, hashmap))
-        {
-            LoadShardIndex(nShard);
-            if(!diskShards->Get(nShard, hashmap))
-                return debug::error(FUNCTION, "couldn't get shard index");
-        }
+        /* Serialize the key header followed by the compressed key. */
+        DataStream ssKey(SER_LLD, DATABASE_VERSION);
+        ssKey << cKey;
+        ssKey.write((char*)&vKeyCompressed[0], vKeyCompressed.size());
 
         /* Handle if not in append mode which will update the key. */
         if(!(nFlags & FLAGS::APPEND))
         {
             /* Reverse iterate the linked file list from hashmap to get most recent keys first. */
             std::vector<uint8_t> vBucket(HASHMAP_KEY_ALLOCATION, 0);
-            for(int16_t i = hashmap->at(nBucket) - 1; i >= 0; --i)
+            for(int32_t i = vHashmap[nShard][nBucket] - 1; i >= 0; --i)
             {
-                /* Find the file stream for LRU cache. */
-                std::fstream *pstream;
-                if(!fileCache->Get(std::make_pair(nShard, i), pstream))
-                {
-                    /* Set the new stream pointer. */
-                    std::string filename = debug::safe_printstr(strBaseLocation, "_hashmap.",
-                        std::setfill('0'), std::setw(3), nShard, ".", std::setfill('0'), std::setw(5), i);
-
-                    pstream = new std::fstream(filename, std::ios::in | std::ios::out | std::ios::binary);
-                    if(!pstream->is_open())
-                    {
-                        delete pstream;
-                        continue;
-                    }
-
-                    /* If file not found add to LRU cache. */
-                    fileCache->Put(std::make_pair(nShard, i), pstream);
-                }
+                std::fstream* pstream = get_stream(nShard, i);
+                if(!pstream)
+                    return debug::error(FUNCTION, "couldn't open hashmap object at: ", hashmap_file(nShard, i), " (", strerror(errno), ")");
 
                 /* Seek to the hashmap index in file. */
-                pstream->seekg (nFilePos, std::ios::beg);
+                pstream->seekg(nFilePos, std::ios::beg);
 
                 /* Read the bucket binary data from file stream */
                 pstream->read((char*) &vBucket[0], vBucket.size());
@@ -484,133 +365,71 @@ namespace LLD
                 /* Check if this bucket has the key or is in an empty state. */
                 if(vBucket[0] == STATE::EMPTY || std::equal(vBucket.begin() + 13, vBucket.begin() + 13 + vKeyCompressed.size(), vKeyCompressed.begin()))
                 {
-                    /* Serialize the key and return if found. */
-                    DataStream ssKey(SER_LLD, DATABASE_VERSION);
-                    ssKey << cKey;
-
-                    /* Serialize the key into the end of the vector. */
-                    ssKey.write((char*)&vKeyCompressed[0], vKeyCompressed.size());
-
                     /* Handle the disk writing operations. */
-                    pstream->seekp (nFilePos, std::ios::beg);
+                    pstream->seekp(nFilePos, std::ios::beg);
                     pstream->write((char*)&ssKey.Bytes()[0], ssKey.size());
                     pstream->flush();
 
-                    /* Debug Output of Sector Key Information. */
-                    if(config::nVerbose >= 4)
-                        debug::log(4, FUNCTION, "State: ", cKey.nState == STATE::READY ? "Valid" : "Invalid",
-                            " | Length: ", cKey.nLength,
-                            " | Bucket ", nBucket,
-                            " | Location: ", nFilePos,
-                            " | File: ", hashmap->at(nBucket) - 1,
-                            " | Sector File: ", cKey.nSectorFile,
-                            " | Sector Size: ", cKey.nSectorSize,
-                            " | Sector Start: ", cKey.nSectorStart, "\n",
-                            HexStr(vKeyCompressed.begin(), vKeyCompressed.end(), true));
+                    /* Add the key to this file's bloom filter. */
+                    bloom_insert(nShard, i, vKeyCompressed);
 
                     return true;
                 }
             }
         }
 
-        /* Create a new disk hashmap object in linked list if it doesn't exist. */
-        std::string file = debug::safe_printstr(strBaseLocation, "_hashmap.",
-            std::setfill('0'), std::setw(3), nShard, ".", std::setfill('0'), std::setw(5), hashmap->at(nBucket));
+        /* Create a new disk hashmap object in the shard's linked list if it doesn't exist. */
+        const uint16_t nFile = vHashmap[nShard][nBucket];
+        if(nFile == std::numeric_limits<uint16_t>::max())
+            return debug::error(FUNCTION, "shard ", nShard, " bucket ", nBucket, " is out of hashmap files");
 
+        std::string file = hashmap_file(nShard, nFile);
         if(!filesystem::exists(file))
         {
             /* Blank vector to write empty space in new disk file. */
-            std::vector<uint8_t> vSpace(HASHMAP_KEY_ALLOCATION, 0);
+            std::vector<uint8_t> vSpace(HASHMAP_KEY_ALLOCATION * std::min(HASHMAP_TOTAL_BUCKETS, 16384u), 0);
 
             /* Write the blank data to the new file handle. */
             std::ofstream stream(file, std::ios::out | std::ios::binary | std::ios::app);
             if(!stream)
                 return debug::error(FUNCTION, strerror(errno));
 
-            for(uint32_t i = 0; i < HASHMAP_TOTAL_BUCKETS; ++i)
-                stream.write((char*)&vSpace[0], vSpace.size());
+            for(uint32_t i = 0; i < HASHMAP_TOTAL_BUCKETS; i += 16384)
+                stream.write((char*)&vSpace[0], HASHMAP_KEY_ALLOCATION * std::min(HASHMAP_TOTAL_BUCKETS - i, 16384u));
 
-            stream.flush();
             stream.close();
 
-            /* Debug output for monitoring new disk maps. */
-            debug::log(0, FUNCTION, "Generated Disk Hash Map ", hashmap->at(nBucket), " in Shard ", nShard, " of ", vSpace.size(), " bytes");
-
-            //debug::log(0, FUNCTION, "Total Space Efficiency is ", (nTotalKeys * 100.0) / (hashmap.size() * nTotalHashmaps),
-            //                        " With ", nTotalKeys, " Keys");
+            /* Debug output showing generating of the hashmap file. */
+            debug::log(2, FUNCTION, "Generated Shard ", nShard, " Hash Map ", nFile);
         }
 
-        /* Read the State and Size of Sector Header. */
-        DataStream ssKey(SER_LLD, DATABASE_VERSION);
-        ssKey << cKey;
-
-        /* Serialize the key into the end of the vector. */
-        ssKey.write((char*)&vKeyCompressed[0], vKeyCompressed.size());
-
         /* Find the file stream for LRU cache. */
-        std::fstream* pstream;
-        if(!fileCache->Get(std::make_pair(nShard, hashmap->at(nBucket)), pstream))
-        {
-            /* Set the new stream pointer. */
-            std::string filename = debug::safe_printstr(strBaseLocation, "_hashmap.",
-                std::setfill('0'), std::setw(3), nShard, ".", std::setfill('0'), std::setw(5), hashmap->at(nBucket));
-
-            /* Set the new stream pointer. */
-            pstream = new std::fstream(filename, std::ios::in | std::ios::out | std::ios::binary);
-            if(!pstream || !pstream->is_open())
-            {
-                delete pstream;
-                return debug::error(FUNCTION, "Failed to generate file object");
-            }
-
-            /* If not in cache, add to the LRU. */
-            fileCache->Put(std::make_pair(nShard, hashmap->at(nBucket)), pstream);
-        }
+        std::fstream* pstream = get_stream(nShard, nFile);
+        if(!pstream)
+            return debug::error(FUNCTION, "Failed to generate file object");
 
         /* Flush the key file to disk. */
-        pstream->seekp (nFilePos, std::ios::beg);
+        pstream->seekp(nFilePos, std::ios::beg);
         pstream->write((char*)&ssKey.Bytes()[0], ssKey.size());
         pstream->flush();
 
-        /* Seek to the index position. */
-        std::fstream* pindex;
-        if(!indexCache->Get(nShard, pindex))
-        {
-            /* Build the hashmap indexes. */
-            std::string index = debug::safe_printstr(strBaseLocation, "_index.", std::setfill('0'), std::setw(3), nShard);
-
-            /* Create new index file. */
-            pindex = new std::fstream(index, std::ios::in | std::ios::out | std::ios::binary);
-            if(!pindex->is_open())
-            {
-                delete pindex;
-                return debug::error(FUNCTION, "Failed to generate file object");
-            }
-
-            /* If not in cache, add to the LRU. */
-            indexCache->Put(nShard, pindex);
-        }
-
-        /* Seek to binary position in index file. */
-        pindex->seekp((nBucket * 2), std::ios::beg);
+        /* Add the key to the new file's bloom filter. */
+        bloom_insert(nShard, nFile, vKeyCompressed);
 
         /* Write the index to disk. */
-        uint16_t nIndex = ++hashmap->at(nBucket);
-
-        /* Get the bucket data. */
-        std::vector<uint8_t> vBucket((uint8_t*)&nIndex, (uint8_t*)&nIndex + 2);
-
-        /* Write the index into hashmap. */
-        pindex->write((char*)&vBucket[0], vBucket.size());
-        pindex->flush();
+        uint16_t nIndex = ++vHashmap[nShard][nBucket];
+        vIndex[nShard]->seekp((nBucket * 2), std::ios::beg);
+        vIndex[nShard]->write((char*)&nIndex, sizeof(nIndex));
+        vIndex[nShard]->flush();
 
         /* Debug Output of Sector Key Information. */
         if(config::nVerbose >= 4)
             debug::log(4, FUNCTION, "State: ", cKey.nState == STATE::READY ? "Valid" : "Invalid",
                 " | Length: ", cKey.nLength,
+                " | Shard ", nShard,
                 " | Bucket ", nBucket,
                 " | Location: ", nFilePos,
-                " | File: ", hashmap->at(nBucket) - 1,
+                " | File: ", nFile,
                 " | Sector File: ", cKey.nSectorFile,
                 " | Sector Size: ", cKey.nSectorSize,
                 " | Sector Start: ", cKey.nSectorStart,
@@ -620,58 +439,86 @@ namespace LLD
     }
 
 
-    /*  Erase a key from the disk hashmaps.
-     *  TODO: This should be optimized further. */
-    bool ShardHashMap::Erase(const std::vector<uint8_t>& vKey)
+    /* Flush all buffers to disk if using ACID transaction. */
+    void ShardHashMap::Flush()
     {
-        LOCK(KEY_MUTEX);
+        /* Flush the index files. */
+        for(auto& pindex : vIndex)
+            pindex->flush();
 
-        /* Get the assigned bucket for the hashmap. */
-        uint32_t nShard  = 0;
-        uint32_t nBucket = GetBucket(vKey, nShard);
+        /* Flush every open hashmap file. */
+        TemplateNode<std::pair<uint16_t, uint16_t>, std::fstream*>* pnode = fileCache->pfirst;
+        while(pnode)
+        {
+            pnode->Data->flush();
+            pnode = pnode->pnext;
+        }
+    }
 
-        /* Get the file binary position. */
-        uint32_t nFilePos = nBucket * HASHMAP_KEY_ALLOCATION;
 
+    /* Sync the index and hashmap files to disk so the write-ahead log can be cleared. */
+    bool ShardHashMap::Sync()
+    {
+        /* Push any buffered stream data to the operating system first. */
+        {
+            LOCK(KEY_MUTEX);
+            Flush();
+        }
+
+        for(uint32_t nShard = 0; nShard < HASHMAP_TOTAL_SHARDS; ++nShard)
+        {
+            /* Sync the shard's index file. */
+            if(!filesystem::sync(debug::safe_printstr(strBaseLocation, "_index.", std::setfill('0'), std::setw(3), nShard)))
+                return debug::error(FUNCTION, "failed to sync index of shard ", nShard);
+
+            /* Sync every hashmap file in the shard's linked list. */
+            for(uint32_t i = 0; ; ++i)
+            {
+                std::string file = hashmap_file(nShard, i);
+                if(!filesystem::exists(file))
+                    break;
+
+                if(!filesystem::sync(file))
+                    return debug::error(FUNCTION, "failed to sync ", file);
+            }
+        }
+
+        return true;
+    }
+
+
+    /* Erase a key from the disk hashmaps. */
+    bool ShardHashMap::Erase(const std::vector<uint8_t> &vKey)
+    {
         /* Compress any keys larger than max size. */
         std::vector<uint8_t> vKeyCompressed = vKey;
         CompressKey(vKeyCompressed, HASHMAP_MAX_KEY_SIZE);
 
-        /* Get the disk index. */
-        std::vector<uint16_t>* hashmap;
-        if(!diskShards->Get(nShard, hashmap))
-        {
-            LoadShardIndex(nShard);
-            if(!diskShards->Get(nShard, hashmap))
-                return debug::error(FUNCTION, "couldn't get shard index");
-        }
+        /* Get the assigned shard and bucket for the hashmap. */
+        uint32_t nShard  = 0;
+        uint32_t nBucket = GetBucket(vKeyCompressed, nShard);
+
+        /* Lock the bucket stripe first, then the keychain streams. */
+        LOCK(RECORD_MUTEX[(nShard * HASHMAP_TOTAL_BUCKETS + nBucket) % RECORD_MUTEX.size()]);
+        LOCK2(KEY_MUTEX);
+
+        /* Get the file binary position. */
+        uint32_t nFilePos = nBucket * HASHMAP_KEY_ALLOCATION;
 
         /* Reverse iterate the linked file list from hashmap to get most recent keys first. */
         std::vector<uint8_t> vBucket(HASHMAP_KEY_ALLOCATION, 0);
-        for(int16_t i = hashmap->at(nBucket) - 1; i >= 0; --i)
+        for(int32_t i = vHashmap[nShard][nBucket] - 1; i >= 0; --i)
         {
-            /* Find the file stream for LRU cache. */
-            std::fstream* pstream;
-            if(!fileCache->Get(std::make_pair(nShard, i), pstream))
-            {
-                /* Set the new stream pointer. */
-                std::string filename = debug::safe_printstr(strBaseLocation, "_hashmap.",
-                    std::setfill('0'), std::setw(3), nShard, ".", std::setfill('0'), std::setw(5), i);
-
-                /* Set the new stream pointer. */
-                pstream = new std::fstream(filename, std::ios::in | std::ios::out | std::ios::binary);
-                if(!pstream->is_open())
-                {
-                    delete pstream;
-                    return debug::error(FUNCTION, "Failed to generate file object");
-                }
+            /* Skip the disk probe if the bloom filter rules this file out. */
+            if(!bloom_check(nShard, i, vKeyCompressed))
+                continue;
 
-                /* If not in cache, add to the LRU. */
-                fileCache->Put(std::make_pair(nShard, i), pstream);
-            }
+            std::fstream* pstream = get_stream(nShard, i);
+            if(!pstream)
+                continue;
 
             /* Seek to the hashmap index in file. */
-            pstream->seekg (nFilePos, std::ios::beg);
+            pstream->seekg(nFilePos, std::ios::beg);
 
             /* Read the bucket binary data from file stream */
             pstream->read((char*) &vBucket[0], vBucket.size());
@@ -679,85 +526,68 @@ namespace LLD
             /* Check if this bucket has the key */
             if(std::equal(vBucket.begin() + 13, vBucket.begin() + 13 + vKeyCompressed.size(), vKeyCompressed.begin()))
             {
-                /* Deserialize key and return if found. */
-                DataStream ssKey(vBucket, SER_LLD, DATABASE_VERSION);
-                SectorKey cKey;
-                ssKey >> cKey;
-
-                /* Seek to the hashmap index in file. */
-                pstream->seekp (nFilePos, std::ios::beg);
-
-                /* Read the bucket binary data from file stream */
+                /* Clear the bucket, which also marks it empty for reuse. */
                 std::vector<uint8_t> vEmpty(HASHMAP_KEY_ALLOCATION, 0);
+                pstream->seekp(nFilePos, std::ios::beg);
                 pstream->write((char*) &vEmpty[0], vEmpty.size());
                 pstream->flush();
 
                 /* Debug Output of Sector Key Information. */
                 if(config::nVerbose >= 4)
-                    debug::log(4, FUNCTION, "Erased State: ", cKey.nState == STATE::READY ? "Valid" : "Invalid",
-                        " | Length: ", cKey.nLength,
+                    debug::log(4, FUNCTION, "Erased Shard ", nShard,
                         " | Bucket ", nBucket,
                         " | Location: ", nFilePos,
-                        " | File: ", hashmap->at(nBucket) - 1,
-                        " | Sector File: ", cKey.nSectorFile,
-                        " | Sector Size: ", cKey.nSectorSize,
-                        " | Sector Start: ", cKey.nSectorStart,
+                        " | File: ", i,
                         " | Key: ", HexStr(vKeyCompressed.begin(), vKeyCompressed.end()));
 
+                /* Count the bloom filter hit. */
+                if(HASHMAP_BLOOM_BITS > 0)
+                    ++nBloomHits;
+
                 return true;
             }
+
+            /* The bloom filter reported a key that wasn't in this file. */
+            if(HASHMAP_BLOOM_BITS > 0)
+                ++nBloomFalse;
         }
 
         return false;
     }
 
 
-    /*  Restore an index in the hashmap if it is found. */
+    /* Restore an index in the hashmap if it is found. */
     bool ShardHashMap::Restore(const std::vector<uint8_t> &vKey)
     {
-        LOCK(KEY_MUTEX);
+        /* Compress any keys larger than max size. */
+        std::vector<uint8_t> vKeyCompressed = vKey;
+        CompressKey(vKeyCompressed, HASHMAP_MAX_KEY_SIZE);
 
-        /* Get the assigned bucket for the hashmap. */
+        /* Get the assigned shard and bucket for the hashmap. */
         uint32_t nShard  = 0;
-        uint32_t nBucket = GetBucket(vKey, nShard);
+        uint32_t nBucket = GetBucket(vKeyCompressed, nShard);
+
+        /* Lock the bucket stripe first, then the keychain streams. */
+        LOCK(RECORD_MUTEX[(nShard * HASHMAP_TOTAL_BUCKETS + nBucket) % RECORD_MUTEX.size()]);
+        LOCK2(KEY_MUTEX);
 
         /* Get the file binary position. */
         uint32_t nFilePos = nBucket * HASHMAP_KEY_ALLOCATION;
 
-        /* Compress any keys larger than max size. */
-        std::vector<uint8_t> vKeyCompressed = vKey;
-        CompressKey(vKeyCompressed, HASHMAP_MAX_KEY_SIZE);
-
-        /* Get the disk index. */
-        std::vector<uint16_t>* hashmap;
-        if(!diskShards->Get(nShard, hashmap))
-        {
-            LoadShardIndex(nShard);
-            if(!diskShards->Get(nShard, hashmap))
-                return debug::error(FUNCTION, "couldn't get shard index");
-        }
-
         /* Reverse iterate the linked file list from hashmap to get most recent keys first. */
         std::vector<uint8_t> vBucket(HASHMAP_KEY_ALLOCATION, 0);
-        for(int16_t i = hashmap->at(nBucket) - 1; i >= 0; --i)
+        for(int32_t i = vHashmap[nShard][nBucket] - 1; i >= 0; --i)
         {
-            /* Find the file stream for LRU cache. */
-            std::fstream* pstream;
-            if(!fileCache->Get(std::make_pair(nShard, i), pstream))
-            {
-                /* Set the new stream pointer. */
-                std::string filename = debug::safe_printstr(strBaseLocation, "_hashmap.",
-                    std::setfill('0'), std::setw(3), nShard, ".", std::setfill('0'), std::setw(5), hashmap->at(nBucket));
+            /* Skip the disk probe if the bloom filter rules this file out. */
+            if(!bloom_check(nShard, i, vKeyCompressed))
+                continue;
 
-                /* Set the new stream pointer. */
-                pstream = new std::fstream(filename, std::ios::in | std::ios::out | std::ios::binary);
-
-                /* If file not found add to LRU cache. */
-                fileCache->Put(std::make_pair(nShard, i), pstream);
-            }
+            std::fstream* pstream = get_stream(nShard, i);
+            if(!pstream)
+                continue;
 
             /* Seek to the hashmap index in file. */
-            pstream->seekg (nFilePos, std::ios::beg);
+            pstream->seekg(nFilePos, std::ios::beg);
 
             /* Read the bucket binary data from file stream */
             pstream->read((char*) &vBucket[0], vBucket.size());
@@ -765,41 +595,477 @@ namespace LLD
             /* Check if this bucket has the key */
             if(std::equal(vBucket.begin() + 13, vBucket.begin() + 13 + vKeyCompressed.size(), vKeyCompressed.begin()))
             {
-                /* Deserialize key and return if found. */
-                DataStream ssKey(vBucket, SER_LLD, DATABASE_VERSION);
-                SectorKey cKey;
-                ssKey >> cKey;
-
-                /* Skip over keys that are already erased. */
-                if(cKey.Ready())
+                /* Nothing to do if the key is already ready. */
+                if(vBucket[0] == STATE::READY)
                     return true;
 
-                /* Seek to the hashmap index in file. */
-                pstream->seekp (nFilePos, std::ios::beg);
-
-                /* Read the bucket binary data from file stream */
-                std::vector<uint8_t> vReady(STATE::READY);
-                pstream->write((char*) &vReady[0], vReady.size());
+                /* Write the ready state over the bucket's state byte. */
+                const uint8_t nState = STATE::READY;
+                pstream->seekp(nFilePos, std::ios::beg);
+                pstream->write((char*) &nState, sizeof(nState));
                 pstream->flush();
 
                 /* Debug Output of Sector Key Information. */
                 if(config::nVerbose >= 4)
-                    debug::log(4, FUNCTION, "Restored State: ", cKey.nState == STATE::READY ? "Valid" : "Invalid",
-                        " | Length: ", cKey.nLength,
+                    debug::log(4, FUNCTION, "Restored Shard ", nShard,
                         " | Bucket ", nBucket,
                         " | Location: ", nFilePos,
-                        " | File: ", hashmap->at(nBucket) - 1,
-                        " | Sector File: ", cKey.nSectorFile,
-                        " | Sector Size: ", cKey.nSectorSize,
-                        " | Sector Start: ", cKey.nSectorStart,
+                        " | File: ", i,
                         " | Key: ", HexStr(vKeyCompressed.begin(), vKeyCompressed.end()));
 
+                /* Count the bloom filter hit. */
+                if(HASHMAP_BLOOM_BITS > 0)
+                    ++nBloomHits;
+
                 return true;
             }
+
+            /* The bloom filter reported a key that wasn't in this file. */
+            if(HASHMAP_BLOOM_BITS > 0)
+                ++nBloomFalse;
         }
 
         return false;
     }
 
 
+    /* Get the bloom filter statistics for the LLD meters and reset the counters. */
+    std::string ShardHashMap::Meter()
+    {
+        /* There is nothing to count with the filters disabled. */
+        if(HASHMAP_BLOOM_BITS == 0)
+            return debug::safe_printstr("Shards ", HASHMAP_TOTAL_SHARDS, " | Bloom Disabled");
+
+        /* Grab the counters and reset them for the next meter period. */
+        const uint64_t nSkipped = nBloomSkipped.exchange(0);
+        const uint64_t nHits    = nBloomHits.exchange(0);
+        const uint64_t nFalse   = nBloomFalse.exchange(0);
+
+        /* Calculate the false positive rate of the probes that did touch the disk. */
+        const double dFalseRate = (nHits + nFalse) > 0 ? (100.0 * nFalse) / (nHits + nFalse) : 0.0;
+
+        return debug::safe_printstr(
+            "Shards ", HASHMAP_TOTAL_SHARDS, " | ",
+            "Bloom Skipped ", nSkipped, " | ",
+            "Hits ", nHits, " | ",
+            "False Positives ", nFalse, " (", std::fixed, std::setprecision(2), dFalseRate, "%)");
+    }
+
+
+    /* Set the histogram to count the keychain files each read probes in. */
+    void ShardHashMap::SetProbes(metrics::Histogram* pProbesIn)
+    {
+        pProbes = pProbesIn;
+    }
+
+
+    /* Copy every key of a BinaryHashMap in the same directory into this keychain. */
+    bool ShardHashMap::Migrate(const uint32_t nHashmapBuckets)
+    {
+        runtime::timer timer;
+        timer.Start();
+
+        debug::log(0, FUNCTION, "Migrating ", strBaseLocation, " from BinaryHashMap to ", HASHMAP_TOTAL_SHARDS, " shards...");
+
+        /* Copy the files oldest first so that newer keys end up in front in append mode. */
+        uint64_t nTotalKeys = 0;
+        for(uint32_t nFile = 0; ; ++nFile)
+        {
+            std::ifstream stream(debug::safe_printstr(strBaseLocation, "_hashmap.", std::setfill('0'), std::setw(5), nFile),
+                std::ios::in | std::ios::binary);
+
+            if(!stream)
+                break;
+
+            /* Read the file in chunks of whole buckets. */
+            const uint32_t nChunk = 16384;
+            std::vector<uint8_t> vBuffer(nChunk * HASHMAP_KEY_ALLOCATION, 0);
+            for(uint32_t nBucket = 0; nBucket < nHashmapBuckets; nBucket += nChunk)
+            {
+                /* Read the next chunk of buckets. */
+                const uint32_t nBuckets = std::min(nChunk, nHashmapBuckets - nBucket);
+                if(!stream.read((char*)&vBuffer[0], nBuckets * HASHMAP_KEY_ALLOCATION))
+                    return debug::error(FUNCTION, "hashmap file ", nFile, " is truncated at bucket ", nBucket);
+
+                for(uint32_t i = 0; i < nBuckets; ++i)
+                {
+                    /* Erased and unused buckets are all zero. */
+                    const uint8_t* pBucket = &vBuffer[i * HASHMAP_KEY_ALLOCATION];
+                    if(pBucket[0] == STATE::EMPTY)
+                        continue;
+
+                    /* Deserialize the key header, keeping the original key length. */
+                    DataStream ssKey(std::vector<uint8_t>(pBucket, pBucket + HASHMAP_KEY_ALLOCATION), SER_LLD, DATABASE_VERSION);
+                    SectorKey cKey;
+                    ssKey >> cKey;
+
+                    /* Find the compressed length of the key from its original length. */
+                    uint16_t nLength = cKey.nLength;
+                    while(nLength > HASHMAP_MAX_KEY_SIZE)
+                        nLength = std::max(uint16_t(nLength >> 1), HASHMAP_MAX_KEY_SIZE);
+
+                    /* The compressed key hashes to the same shard and bucket as the original. */
+                    cKey.vKey.assign(pBucket + 13, pBucket + 13 + nLength);
+                    if(!Put(cKey))
+                        return debug::error(FUNCTION, "failed to migrate key ", HexStr(cKey.vKey.begin(), cKey.vKey.end()));
+
+                    ++nTotalKeys;
+                }
+            }
+
+            debug::log(0, FUNCTION, "Migrated hashmap file ", nFile, " (", nTotalKeys, " keys)");
+        }
+
+        /* Make sure the new keychain is on disk before it is used instead of the old one. */
+        if(!Sync())
+            return false;
+
+        debug::log(0, FUNCTION, "Migrated ", nTotalKeys, " keys in ", timer.Elapsed(), " seconds");
+
+        return true;
+    }
+
+
+    /* Walk every ready key in the hashmap files, reading them in chunks of buckets. */
+    bool ShardHashMap::Scan(const std::function<void(const uint64_t nSlot, const SectorKey& cKey)>& fnKey)
+    {
+        /* Take the files in use by each bucket, files added after this are left out. */
+        std::vector< std::vector<uint16_t> > vIndexes;
+        {
+            LOCK(KEY_MUTEX);
+            vIndexes = vHashmap;
+        }
+
+        /* Read the chunk from each file in use. Torn reads are fine, Relocate checks the slot again. */
+        const uint32_t nChunk = 4096;
+        std::vector<uint8_t> vBuffer(nChunk * HASHMAP_KEY_ALLOCATION, 0);
+        for(uint32_t nShard = 0; nShard < HASHMAP_TOTAL_SHARDS; ++nShard)
+        {
+            const std::vector<uint16_t>& vShard = vIndexes[nShard];
+            for(uint32_t nBucket = 0; nBucket < HASHMAP_TOTAL_BUCKETS; nBucket += nChunk)
+            {
+                /* Stop early if the node is shutting down. */
+                if(config::fShutdown.load())
+                    return false;
+
+                /* Find the deepest bucket in this chunk. */
+                const uint32_t nBuckets = std::min(nChunk, HASHMAP_TOTAL_BUCKETS - nBucket);
+
+                uint16_t nDepth = 0;
+                for(uint32_t i = 0; i < nBuckets; ++i)
+                    nDepth = std::max(nDepth, vShard[nBucket + i]);
+
+                for(uint16_t nFile = 0; nFile < nDepth; ++nFile)
+                {
+                    if(!vReader[nShard]->Read(nFile, uint64_t(nBucket) * HASHMAP_KEY_ALLOCATION, &vBuffer[0], nBuckets * HASHMAP_KEY_ALLOCATION))
+                        return debug::error(FUNCTION, "failed to read ", hashmap_file(nShard, nFile));
+
+                    for(uint32_t i = 0; i < nBuckets; ++i)
+                    {
+                        /* Skip over files the bucket doesn't use and keys that aren't ready. */
+                        const uint8_t* pBucket = &vBuffer[i * HASHMAP_KEY_ALLOCATION];
+                        if(nFile >= vShard[nBucket + i] || pBucket[0] != STATE::READY)
+                            continue;
+
+                        /* Deserialize the key header. */
+                        DataStream ssKey(std::vector<uint8_t>(pBucket, pBucket + 13), SER_LLD, DATABASE_VERSION);
+                        SectorKey cKey;
+                        ssKey >> cKey;
+
+                        /* Find the compressed length of the key from its original length. */
+                        uint16_t nLength = cKey.nLength;
+                        while(nLength > HASHMAP_MAX_KEY_SIZE)
+                            nLength = std::max(uint16_t(nLength >> 1), HASHMAP_MAX_KEY_SIZE);
+
+                        cKey.vKey.assign(pBucket + 13, pBucket + 13 + nLength);
+                        fnKey((uint64_t(nShard) * 65536 + nFile) * HASHMAP_TOTAL_BUCKETS + nBucket + i, cKey);
+                    }
+                }
+            }
+        }
+
+        return true;
+    }
+
+
+    /* Point a key found by Scan to a new sector location, only if its slot still holds it unchanged. */
+    bool ShardHashMap::Relocate(const uint64_t nSlot, const SectorKey& cKey, const uint16_t nSectorFile, const uint32_t nSectorStart)
+    {
+        /* Get the shard, file and bucket of the slot. */
+        const uint32_t nBucket = static_cast<uint32_t>(nSlot % HASHMAP_TOTAL_BUCKETS);
+        const uint16_t nFile   = static_cast<uint16_t>((nSlot / HASHMAP_TOTAL_BUCKETS) % 65536);
+        const uint32_t nShard  = static_cast<uint32_t>((nSlot / HASHMAP_TOTAL_BUCKETS) / 65536);
+
+        if(nShard >= HASHMAP_TOTAL_SHARDS)
+            return false;
+
+        /* Lock the bucket stripe first, then the keychain streams. */
+        LOCK(RECORD_MUTEX[(nShard * HASHMAP_TOTAL_BUCKETS + nBucket) % RECORD_MUTEX.size()]);
+        LOCK2(KEY_MUTEX);
+
+        /* Check that the bucket still uses the file. */
+        if(nFile >= vHashmap[nShard][nBucket])
+            return false;
+
+        std::fstream* pstream = get_stream(nShard, nFile);
+        if(!pstream)
+            return debug::error(FUNCTION, "couldn't open hashmap object at: ", hashmap_file(nShard, nFile), " (", strerror(errno), ")");
+
+        /* Read the bucket binary data from file stream */
+        const uint64_t nFilePos = uint64_t(nBucket) * HASHMAP_KEY_ALLOCATION;
+
+        std::vector<uint8_t> vBucket(HASHMAP_KEY_ALLOCATION, 0);
+        pstream->seekg(nFilePos, std::ios::beg);
+        if(!pstream->read((char*) &vBucket[0], vBucket.size()))
+            return debug::error(FUNCTION, "failed to read ", hashmap_file(nShard, nFile));
+
+        /* Check that the slot still holds the same key at the same location. */
+        DataStream ssKey(vBucket, SER_LLD, DATABASE_VERSION);
+        SectorKey cSlot;
+        ssKey >> cSlot;
+
+        if(!cSlot.Ready() || cSlot.nSectorFile != cKey.nSectorFile || cSlot.nSectorStart != cKey.nSectorStart
+        || cSlot.nSectorSize != cKey.nSectorSize || cKey.vKey.empty()
+        || !std::equal(cKey.vKey.begin(), cKey.vKey.end(), vBucket.begin() + 13))
+            return false;
+
+        /* Write the new location over the key header. */
+        cSlot.nSectorFile  = nSectorFile;
+        cSlot.nSectorStart = nSectorStart;
+
+        DataStream ssSlot(SER_LLD, DATABASE_VERSION);
+        ssSlot << cSlot;
+
+        pstream->seekp(nFilePos, std::ios::beg);
+        pstream->write((char*)&ssSlot.Bytes()[0], ssSlot.size());
+        pstream->flush();
+
+        return true;
+    }
+
+
+    /* Get the file name of a hashmap file in a shard. */
+    std::string ShardHashMap::hashmap_file(const uint32_t nShard, const uint32_t nFile) const
+    {
+        return debug::safe_printstr(strBaseLocation, "_hashmap.", std::setfill('0'), std::setw(3), nShard, ".", std::setw(5), nFile);
+    }
+
+
+    /* Get the stream of a hashmap file from the LRU, opening it if needed. */
+    std::fstream* ShardHashMap::get_stream(const uint32_t nShard, const uint16_t nFile)
+    {
+        /* Find the file stream for LRU cache. */
+        const std::pair<uint16_t, uint16_t> pairFile = std::make_pair(static_cast<uint16_t>(nShard), nFile);
+
+        std::fstream* pstream;
+        if(fileCache->Get(pairFile, pstream))
+            return pstream;
+
+        /* Set the new stream pointer. */
+        pstream = new std::fstream(hashmap_file(nShard, nFile), std::ios::in | std::ios::out | std::ios::binary);
+        if(!pstream->is_open())
+        {
+            delete pstream;
+            return nullptr;
+        }
+
+        /* If file not found add to LRU cache. */
+        fileCache->Put(pairFile, pstream);
+
+        return pstream;
+    }
+
+
+    /* Check the bloom filter of a hashmap file for a key. */
+    bool ShardHashMap::bloom_check(const uint32_t nShard, const uint16_t nFile, const std::vector<uint8_t>& vKeyCompressed)
+    {
+        /* Every file has to be probed with the filters disabled. */
+        if(HASHMAP_BLOOM_BITS == 0)
+            return true;
+
+        /* Every file below the bucket's index has a filter, see bloom_insert. The filter words are
+           atomic, so this can run under a different RECORD_MUTEX stripe than the inserts into it. */
+        if(vBloom[nShard][nFile].Contains(vKeyCompressed))
+            return true;
+
+        ++nBloomSkipped;
+        return false;
+    }
+
+
+    /* Add a key to the bloom filter of a hashmap file, creating the filter if needed. */
+    void ShardHashMap::bloom_insert(const uint32_t nShard, const uint16_t nFile, const std::vector<uint8_t>& vKeyCompressed)
+    {
+        /* Check that the filters are enabled. */
+        if(HASHMAP_BLOOM_BITS == 0)
+            return;
+
+        /* Allocate filters up to this file before the bucket index is raised to include it.
+           This is only ever called holding KEY_MUTEX, and capacity is reserved up front. */
+        while(vBloom[nShard].size() <= nFile)
+            vBloom[nShard].emplace_back(bloom_create());
+
+        vBloom[nShard][nFile].Insert(vKeyCompressed);
+    }
+
+
+    /* Create an empty bloom filter for one hashmap file of a shard. */
+    BloomFilter ShardHashMap::bloom_create() const
+    {
+        /* A file holds at most one key per bucket. */
+        return BloomFilter(HASHMAP_TOTAL_BUCKETS, HASHMAP_BLOOM_BITS);
+    }
+
+
+    /* Load the bloom filters from disk, or rebuild them from the hashmap files. */
+    void ShardHashMap::bloom_load()
+    {
+        /* Remove any stale filters if they are disabled, so they are rebuilt once enabled again. */
+        if(HASHMAP_BLOOM_BITS == 0)
+        {
+            filesystem::remove(debug::safe_printstr(strBaseLocation, "_shard.bloom"));
+            return;
+        }
+
+        /* Find the total number of hashmap files in use by each shard. */
+        std::vector<uint16_t> vFiles(HASHMAP_TOTAL_SHARDS, 1);
+        for(uint32_t nShard = 0; nShard < HASHMAP_TOTAL_SHARDS; ++nShard)
+            for(const auto& nIndex : vHashmap[nShard])
+                vFiles[nShard] = std::max(vFiles[nShard], nIndex);
+
+        /* Try to read the filters persisted on last shutdown. */
+        std::string strBloom = debug::safe_printstr(strBaseLocation, "_shard.bloom");
+        if(filesystem::exists(strBloom))
+        {
+            std::ifstream stream(strBloom, std::ios::in | std::ios::binary);
+
+            /* Read the total shards, they must match the current configuration. */
+            uint32_t nShards = 0;
+            stream.read((char*)&nShards, sizeof(nShards));
+
+            bool fLoaded = (stream && nShards == HASHMAP_TOTAL_SHARDS);
+            for(uint32_t nShard = 0; fLoaded && nShard < HASHMAP_TOTAL_SHARDS; ++nShard)
+            {
+                /* Read the total filters of this shard, they must match its hashmap files. */
+                uint16_t nTotal = 0;
+                stream.read((char*)&nTotal, sizeof(nTotal));
+                if(!stream || nTotal != vFiles[nShard])
+                {
+                    fLoaded = false;
+                    break;
+                }
+
+                /* Read each filter. */
+                vBloom[nShard].assign(nTotal, bloom_create());
+                for(auto& bloom : vBloom[nShard])
+                {
+                    if(!bloom.Read(stream))
+                    {
+                        fLoaded = false;
+                        break;
+                    }
+                }
+            }
+            stream.close();
+
+            /* Remove the file so that an unclean shutdown forces a rebuild. */
+            filesystem::remove(strBloom);
+
+            /* Debug output showing loading of bloom filters. */
+            if(fLoaded)
+            {
+                debug::log(0, FUNCTION, "Loaded Bloom Filters for ", HASHMAP_TOTAL_SHARDS, " shards of ", vBloom[0][0].Bytes(), " bytes");
+                return;
+            }
+
+            debug::log(0, FUNCTION, "Bloom Filters are out of date, rebuilding...");
+        }
+
+        /* Rebuild the filters from the hashmap files. */
+        runtime::timer timer;
+        timer.Start();
+
+        uint64_t nTotalKeys = 0;
+        for(uint32_t nShard = 0; nShard < HASHMAP_TOTAL_SHARDS; ++nShard)
+        {
+            vBloom[nShard].assign(vFiles[nShard], bloom_create());
+
+            for(uint16_t nFile = 0; nFile < vFiles[nShard]; ++nFile)
+            {
+                std::ifstream stream(hashmap_file(nShard, nFile), std::ios::in | std::ios::binary);
+                if(!stream)
+                    continue;
+
+                /* Read the file in chunks of whole buckets. */
+                const uint32_t nChunk = 16384;
+                std::vector<uint8_t> vBuffer(nChunk * HASHMAP_KEY_ALLOCATION, 0);
+                for(uint32_t nBucket = 0; nBucket < HASHMAP_TOTAL_BUCKETS; nBucket += nChunk)
+                {
+                    /* Read the next chunk of buckets. */
+                    const uint32_t nBuckets = std::min(nChunk, HASHMAP_TOTAL_BUCKETS - nBucket);
+                    if(!stream.read((char*)&vBuffer[0], nBuckets * HASHMAP_KEY_ALLOCATION))
+                        break;
+
+                    for(uint32_t i = 0; i < nBuckets; ++i)
+                    {
+                        /* Erased and unused buckets are all zero. */
+                        const uint8_t* pBucket = &vBuffer[i * HASHMAP_KEY_ALLOCATION];
+                        if(pBucket[0] == STATE::EMPTY)
+                            continue;
+
+                        /* Find the compressed length of the key from its original length. */
+                        uint16_t nLength = 0;
+                        std::copy(pBucket + 1, pBucket + 3, (uint8_t*)&nLength);
+                        while(nLength > HASHMAP_MAX_KEY_SIZE)
+                            nLength = std::max(uint16_t(nLength >> 1), HASHMAP_MAX_KEY_SIZE);
+
+                        /* Add the key to the filter. */
+                        vBloom[nShard][nFile].Insert(std::vector<uint8_t>(pBucket + 13, pBucket + 13 + nLength));
+                        ++nTotalKeys;
+                    }
+                }
+            }
+        }
+
+        /* Debug output showing rebuilding of bloom filters. */
+        debug::log(0, FUNCTION, "Rebuilt Bloom Filters for ", HASHMAP_TOTAL_SHARDS, " shards with ", nTotalKeys, " keys in ", timer.Elapsed(), " seconds");
+    }
+
+
+    /* Persist the bloom filters next to the shard indexes. */
+    void ShardHashMap::bloom_save()
+    {
+        /* Check that the filters are enabled. */
+        if(HASHMAP_BLOOM_BITS == 0)
+            return;
+
+        /* Write to a temporary file to avoid leaving a partial file behind. */
+        std::string strBloom = debug::safe_printstr(strBaseLocation, "_shard.bloom");
+        std::ofstream stream(strBloom + ".tmp", std::ios::out | std::ios::binary | std::ios::trunc);
+        if(!stream)
+            return;
+
+        /* Write the total shards. */
+        stream.write((char*)&HASHMAP_TOTAL_SHARDS, sizeof(HASHMAP_TOTAL_SHARDS));
+
+        /* Write the filters of each shard. */
+        for(const auto& vFilters : vBloom)
+        {
+            const uint16_t nTotal = static_cast<uint16_t>(vFilters.size());
+            stream.write((char*)&nTotal, sizeof(nTotal));
+
+            for(const auto& bloom : vFilters)
+            {
+                if(!bloom.Write(stream))
+                {
+                    debug::error(FUNCTION, "failed to write bloom filters");
+                    return;
+                }
+            }
+        }
+        stream.close();
+
+        /* Move the completed file into place. */
+        filesystem::rename(strBloom + ".tmp", strBloom);
+    }
 }
@@ -0,0 +1,260 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLD/templates/snapshot.h>
+
+#include <Util/include/mutex.h>
+
+namespace LLD
+{
+
+    /* Default Constructor */
+    SnapshotLog::SnapshotLog()
+    : MUTEX      ( )
+    , CONDITION  ( )
+    , nVersion   (0)
+    , fWriting   (false)
+    , nSnapshots (0)
+    , nUnsaved   (0)
+    , mapPinned  ( )
+    , mapRecords ( )
+    {
+    }
+
+
+    /* Default Destructor */
+    SnapshotLog::~SnapshotLog()
+    {
+    }
+
+
+    /* Open a snapshot of the last complete version. */
+    uint64_t SnapshotLog::Pin()
+    {
+        /* Count the snapshot first so new writes save records. */
+        ++nSnapshots;
+
+        /* A write that started with no snapshots open doesn't save records, so wait for it to finish. */
+        std::unique_lock<std::mutex> CONDITION_LOCK(MUTEX);
+        CONDITION.wait(CONDITION_LOCK, [this]{ return nUnsaved.load() == 0; });
+
+        ++mapPinned[nVersion];
+
+        return nVersion;
+    }
+
+
+    /* Close a snapshot, dropping the records no open snapshot needs. */
+    void SnapshotLog::Release(const uint64_t nVersionIn)
+    {
+        LOCK(MUTEX);
+
+        /* Unpin the version. */
+        auto it = mapPinned.find(nVersionIn);
+        if(it == mapPinned.end())
+            return;
+
+        if(--it->second == 0)
+            mapPinned.erase(it);
+
+        prune();
+
+        --nSnapshots;
+    }
+
+
+    /* Start a write, waiting for the write in progress to finish if a snapshot is open. */
+    bool SnapshotLog::Begin()
+    {
+        /* With no snapshots open the write doesn't save records, so it doesn't need a version. */
+        if(nSnapshots.load() == 0)
+        {
+            /* Check again once counted, a snapshot opening now waits for this write. */
+            ++nUnsaved;
+            if(nSnapshots.load() == 0)
+                return false;
+
+            /* A snapshot is opening, so take a version instead. */
+            End(false);
+        }
+
+        /* Wait for the write in progress, and for writes that don't save records so their changes aren't saved. */
+        std::unique_lock<std::mutex> CONDITION_LOCK(MUTEX);
+        CONDITION.wait(CONDITION_LOCK, [this]{ return !fWriting && nUnsaved.load() == 0; });
+
+        fWriting = true;
+
+        return true;
+    }
+
+
+    /* Finish a write, completing its version if it saves records. */
+    void SnapshotLog::End(const bool fSaving)
+    {
+        /* Wake the snapshots waiting for the last write that doesn't save records. */
+        if(!fSaving)
+        {
+            if(--nUnsaved == 0 && nSnapshots.load() > 0)
+            {
+                /* Notify holding the lock so a snapshot checking the count can't miss it. */
+                LOCK(MUTEX);
+                CONDITION.notify_all();
+            }
+
+            return;
+        }
+
+        {
+            LOCK(MUTEX);
+
+            ++nVersion;
+            fWriting = false;
+
+            /* Records are dropped as snapshots are released, or all at once if none are open. */
+            if(mapPinned.empty())
+                mapRecords.clear();
+        }
+
+        CONDITION.notify_all();
+    }
+
+
+    /* Save a record before the write in progress changes it. */
+    void SnapshotLog::Save(const std::vector<uint8_t>& vKey, const bool fExists, const std::vector<uint8_t>& vData)
+    {
+        LOCK(MUTEX);
+
+        /* Only the first change in a version holds the record as of the version before. */
+        std::vector<SnapshotRecord>& vRecords = mapRecords[vKey];
+        if(!vRecords.empty() && vRecords.back().nVersion == nVersion + 1)
+            return;
+
+        vRecords.push_back(SnapshotRecord(nVersion + 1, fExists, vData));
+    }
+
+
+    /* Get a record as of a version, if it has changed since. */
+    bool SnapshotLog::Get(const std::vector<uint8_t>& vKey, const uint64_t nVersionIn, bool &fExists, std::vector<uint8_t>& vData) const
+    {
+        LOCK(MUTEX);
+
+        /* Check for saved records of the key. */
+        auto it = mapRecords.find(vKey);
+        if(it == mapRecords.end())
+            return false;
+
+        /* The first change after the version holds the record as of the version. */
+        for(const auto& record : it->second)
+        {
+            if(record.nVersion > nVersionIn)
+            {
+                fExists = record.fExists;
+                vData   = record.vData;
+
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+
+    /* Drop the saved records no open snapshot needs. */
+    void SnapshotLog::prune()
+    {
+        /* Drop everything once no snapshot is open. */
+        if(mapPinned.empty())
+        {
+            mapRecords.clear();
+            return;
+        }
+
+        /* Records replaced by a version no later than the oldest snapshot are not read. */
+        const uint64_t nOldest = mapPinned.begin()->first;
+        for(auto it = mapRecords.begin(); it != mapRecords.end(); )
+        {
+            std::vector<SnapshotRecord>& vRecords = it->second;
+
+            uint32_t nDrop = 0;
+            while(nDrop < vRecords.size() && vRecords[nDrop].nVersion <= nOldest)
+                ++nDrop;
+
+            vRecords.erase(vRecords.begin(), vRecords.begin() + nDrop);
+            if(vRecords.empty())
+                it = mapRecords.erase(it);
+            else
+                ++it;
+        }
+    }
+
+
+    /* Start a write on the versions of a database. */
+    SnapshotWrite::SnapshotWrite(SnapshotLog* pLogIn)
+    : pLog    (pLogIn)
+    , fSaving (pLogIn->Begin())
+    {
+    }
+
+
+    /* Finish the write. */
+    SnapshotWrite::~SnapshotWrite()
+    {
+        pLog->End(fSaving);
+    }
+
+
+    /* Check if the write saves the records it replaces. */
+    bool SnapshotWrite::Saving() const
+    {
+        return fSaving;
+    }
+
+
+    /* Open a snapshot of the last complete version. */
+    Snapshot::Snapshot(SnapshotLog* pLogIn)
+    : pLog     (pLogIn)
+    , nVersion (pLogIn->Pin())
+    {
+    }
+
+
+    /* Move Constructor. */
+    Snapshot::Snapshot(Snapshot&& snapshot)
+    : pLog     (snapshot.pLog)
+    , nVersion (snapshot.nVersion)
+    {
+        snapshot.pLog = nullptr;
+    }
+
+
+    /* Close the snapshot. */
+    Snapshot::~Snapshot()
+    {
+        if(pLog)
+            pLog->Release(nVersion);
+    }
+
+
+    /* Check if this is a snapshot of a database. */
+    bool Snapshot::Of(const SnapshotLog* pLogIn) const
+    {
+        return pLog != nullptr && pLog == pLogIn;
+    }
+
+
+    /* Get the version of the snapshot. */
+    uint64_t Snapshot::Version() const
+    {
+        return nVersion;
+    }
+}
@@ -0,0 +1,196 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#pragma once
+#ifndef NEXUS_LLD_TEMPLATES_JOURNAL_H
+#define NEXUS_LLD_TEMPLATES_JOURNAL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace LLD
+{
+
+    /** Journal
+     *
+     *  Append-only write-ahead log shared by the global LLD instances.
+     *
+     *  Each record holds the transaction journals of every database for one commit,
+     *  framed by its size and checksum so a record torn by a crash is ignored.
+     *  Each commit syncs only the log, the database files themselves are synced by
+     *  the background checkpoint once the log grows past its checkpoint size.
+     *
+     *  Commits are not grouped behind a shared sync. Each database has a single open
+     *  transaction, so LLD::TxnCommit commits one at a time and each commit syncs its
+     *  own record. The transactions are still written to the sector and keychain files
+     *  when they commit, as the databases only read them from there.
+     *
+     *  A commit that fails is truncated off the log. If the log can't be truncated
+     *  it is marked failed, and every commit fails until a checkpoint clears it.
+     *
+     **/
+    class Journal
+    {
+        /* Mutex for appending to the log file. */
+        std::mutex WRITE_MUTEX;
+
+
+        /* The mutex for the condition. */
+        std::mutex CONDITION_MUTEX;
+
+
+        /* The condition for checkpoint thread sleeping. */
+        std::condition_variable CONDITION;
+
+
+        /* The path of the log file. */
+        std::string strPath;
+
+
+        /* The append stream of the log file. */
+        std::ofstream stream;
+
+
+        /* The descriptor used to sync and truncate the log file. */
+        int fd;
+
+
+        /* The current size of the log file in bytes, up to the end of the last complete record. */
+        std::atomic<uint64_t> nSize;
+
+
+        /* Flag set when a failed commit couldn't be truncated off the log. */
+        std::atomic<bool> fFailed;
+
+
+        /* The size of the log file that triggers a checkpoint. */
+        uint64_t nCheckpointSize;
+
+
+        /* Syncs the database files and clears the log, called from the checkpoint thread. */
+        std::function<bool()> fnCheckpoint;
+
+
+        /* Destructor Flag. */
+        std::atomic<bool> fDestruct;
+
+
+        /* The checkpoint thread. */
+        std::thread CheckpointThread;
+
+
+    public:
+
+
+        /** Default Constructor. **/
+        Journal()                                = delete;
+
+
+        /** Copy Constructor. **/
+        Journal(const Journal& journal)          = delete;
+
+
+        /** Copy assignment. **/
+        Journal& operator=(const Journal& journal) = delete;
+
+
+        /** Journal Constructor
+         *
+         *  @param[in] strPathIn The path of the log file.
+         *  @param[in] nCheckpointSizeIn The size of the log in bytes that triggers a checkpoint.
+         *  @param[in] fnCheckpointIn The function to sync the databases and clear the log.
+         *
+         **/
+        Journal(const std::string& strPathIn, const uint64_t nCheckpointSizeIn, const std::function<bool()>& fnCheckpointIn);
+
+
+        /** Default Destructor **/
+        ~Journal();
+
+
+        /** Commit
+         *
+         *  Append a record and wait until it is on disk. On failure the log is
+         *  truncated back to the end of the last complete record, so the record
+         *  must not be applied to the databases.
+         *
+         *  @param[in] vRecord The record to commit.
+         *
+         *  @return True if the record is on disk.
+         *
+         **/
+        bool Commit(const std::vector<uint8_t>& vRecord);
+
+
+        /** Read
+         *
+         *  Read every complete record from a log in the order they were appended.
+         *  Used for recovery before the log is opened for new commits.
+         *
+         *  @param[in] strFile The path of the log file.
+         *  @param[out] vRecords The records read.
+         *
+         *  @return True if the log was read, false if it couldn't be opened.
+         *
+         **/
+        static bool Read(const std::string& strFile, std::vector< std::vector<uint8_t> >& vRecords);
+
+
+        /** Clear
+         *
+         *  Clear the log once all databases are synced to disk, and reset a failed
+         *  log. Must not be called while a commit is between Commit and applying
+         *  its transactions.
+         *
+         *  @return True if the log was cleared.
+         *
+         **/
+        bool Clear();
+
+
+        /** Size
+         *
+         *  Get the current size of the log file in bytes.
+         *
+         **/
+        uint64_t Size() const;
+
+
+    private:
+
+        /** Rollback
+         *
+         *  Truncate the log back to the end of the last complete record after a failed
+         *  commit, or mark the log failed if it can't be. Must hold WRITE_MUTEX.
+         *
+         **/
+        void rollback();
+
+
+        /** Checkpoint
+         *
+         *  Checkpoint thread. Calls the checkpoint function when the log is full or failed.
+         *
+         **/
+        void Checkpoint();
+    };
+}
+
+#endif
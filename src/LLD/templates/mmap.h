@@ -0,0 +1,210 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#pragma once
+#ifndef NEXUS_LLD_TEMPLATES_MMAP_H
+#define NEXUS_LLD_TEMPLATES_MMAP_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+namespace LLD
+{
+
+    /* The files in each block of the mapping table. */
+    const uint32_t MMAP_BLOCK_FILES = 256;
+
+
+    /* The blocks of the mapping table, files past it are read without a mapping. */
+    const uint32_t MMAP_TOTAL_BLOCKS = 256;
+
+
+    /** MappedRegion
+     *
+     *  A read-only memory mapping of a single database file.
+     *  The mapping is released once no reader can still be copying from it.
+     *
+     **/
+    struct MappedRegion;
+
+
+    /** MemoryMap
+     *
+     *  Read-only memory mappings for a numbered series of database files, such as
+     *  the _block.NNNNN sector files or the _hashmap.NNNNN keychain files.
+     *
+     *  Readers copy straight out of the mapping without seeking a shared stream
+     *  or taking a lock. Writes still go through the file streams, and become
+     *  visible through the shared mapping. A file that has grown past its mapping
+     *  is remapped on demand.
+     *
+     *  The mappings are published through atomic pointers. Readers register in
+     *  the current epoch while copying, and a replaced mapping is only unmapped
+     *  once the readers of its epoch are done, so a reader never sees it unmapped.
+     *
+     **/
+    class MemoryMap
+    {
+        /* Mutex to serialize remapping and releasing files, readers never take it. */
+        mutable std::mutex MUTEX;
+
+
+        /* The file path prefix, the file number is appended to this. */
+        std::string strPrefix;
+
+
+        /* The mappings by file number, in blocks allocated on first use. */
+        std::atomic<std::atomic<MappedRegion*>*> vBlocks[MMAP_TOTAL_BLOCKS];
+
+
+        /* The epoch new readers register in, moved on when a mapping is replaced. */
+        std::atomic<uint32_t> nEpoch;
+
+
+        /* The readers copying out of a mapping, by the parity of their epoch. */
+        std::atomic<uint32_t> nReaders[2];
+
+
+    public:
+
+
+        /** Default Constructor. **/
+        MemoryMap()                                  = delete;
+
+
+        /** Copy Constructor. **/
+        MemoryMap(const MemoryMap& map)              = delete;
+
+
+        /** Copy assignment. **/
+        MemoryMap& operator=(const MemoryMap& map)   = delete;
+
+
+        /** Prefix Constructor
+         *
+         *  @param[in] strPrefixIn The path prefix of the files, such as "<base>_block."
+         *
+         **/
+        MemoryMap(const std::string& strPrefixIn);
+
+
+        /** Default Destructor **/
+        ~MemoryMap();
+
+
+        /** Read
+         *
+         *  Copy data out of a mapped file, mapping or remapping the file if needed.
+         *
+         *  @param[in] nFile The file number to read from.
+         *  @param[in] nPos The binary position in the file.
+         *  @param[out] pData The buffer to copy into.
+         *  @param[in] nSize The number of bytes to read.
+         *
+         *  @return True if the full range was read, false if it is not on disk.
+         *
+         **/
+        bool Read(const uint32_t nFile, const uint64_t nPos, uint8_t* pData, const uint64_t nSize);
+
+
+        /** Release
+         *
+         *  Drop the mapping of a file so it is remapped on next read. This waits
+         *  for the readers still copying from the mapping before unmapping it.
+         *
+         *  @param[in] nFile The file number to release.
+         *
+         **/
+        void Release(const uint32_t nFile);
+
+
+        /** Truncate
+         *
+         *  Drop the mapping of a file and truncate the file to empty once no reader
+         *  is copying from it, so a reader can't fault on the cut pages.
+         *
+         *  @param[in] nFile The file number to truncate.
+         *
+         *  @return True if the file was truncated.
+         *
+         **/
+        bool Truncate(const uint32_t nFile);
+
+
+        /** Supported
+         *
+         *  Check if memory mapped files are supported on this platform.
+         *
+         **/
+        static bool Supported();
+
+
+    private:
+
+        /** Slot
+         *
+         *  Get the table entry of a file's mapping.
+         *
+         *  @param[in] nFile The file number to get the entry for.
+         *  @param[in] fCreate Allocate the block of the entry if it isn't yet, holding MUTEX.
+         *
+         *  @return The entry, or nullptr if its block isn't allocated.
+         *
+         **/
+        std::atomic<MappedRegion*>* slot(const uint32_t nFile, const bool fCreate);
+
+
+        /** Copy
+         *
+         *  Copy data out of the current mapping of a file, registered as a reader.
+         *
+         *  @param[in] nFile The file number to read from.
+         *  @param[in] nPos The binary position in the file.
+         *  @param[out] pData The buffer to copy into.
+         *  @param[in] nSize The number of bytes to read.
+         *
+         *  @return True if the mapping covered the range.
+         *
+         **/
+        bool copy(const uint32_t nFile, const uint64_t nPos, uint8_t* pData, const uint64_t nSize);
+
+
+        /** Remap
+         *
+         *  Map a file at its current size if its mapping doesn't cover a range.
+         *
+         *  @param[in] nFile The file number to map.
+         *  @param[in] nEnd The end of the range that needs to be mapped.
+         *
+         *  @return True if the file is mapped past the range.
+         *
+         **/
+        bool remap(const uint32_t nFile, const uint64_t nEnd);
+
+
+        /** Retire
+         *
+         *  Replace the mapping of a file, and unmap the old one once the readers that
+         *  could still see it are done. This must be called holding MUTEX.
+         *
+         *  @param[in] nFile The file number to replace the mapping of.
+         *  @param[in] pRegion The new mapping, or nullptr to drop it.
+         *
+         **/
+        void retire(const uint32_t nFile, MappedRegion* pRegion);
+    };
+}
+
+#endif
@@ -0,0 +1,140 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#pragma once
+#ifndef NEXUS_LLD_TEMPLATES_READER_H
+#define NEXUS_LLD_TEMPLATES_READER_H
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace LLD
+{
+
+    /** FileHandle
+     *
+     *  A read-only descriptor of a single database file.
+     *  The descriptor is closed when the last reader drops its reference.
+     *
+     **/
+    struct FileHandle;
+
+
+    /** FileReader
+     *
+     *  Positional reads for a numbered series of database files, such as the
+     *  _block.NNNNN sector files or the _hashmap.NNNNN keychain files.
+     *
+     *  Each read is a single pread() on a shared read-only descriptor, so there is
+     *  no stream position to protect and concurrent readers never contend with
+     *  each other or with writers appending through the file streams.
+     *
+     **/
+    class FileReader
+    {
+        /* Mutex to protect the handle list, never held while reading. */
+        mutable std::mutex MUTEX;
+
+
+        /* The file path prefix, the file number is appended to this. */
+        std::string strPrefix;
+
+
+        /* The open handles by file number. */
+        std::vector< std::shared_ptr<FileHandle> > vHandles;
+
+
+    public:
+
+
+        /** Default Constructor. **/
+        FileReader()                                  = delete;
+
+
+        /** Copy Constructor. **/
+        FileReader(const FileReader& reader)          = delete;
+
+
+        /** Copy assignment. **/
+        FileReader& operator=(const FileReader& reader) = delete;
+
+
+        /** Prefix Constructor
+         *
+         *  @param[in] strPrefixIn The path prefix of the files, such as "<base>_block."
+         *
+         **/
+        FileReader(const std::string& strPrefixIn);
+
+
+        /** Default Destructor **/
+        ~FileReader();
+
+
+        /** Read
+         *
+         *  Read data from a file at a given position.
+         *
+         *  @param[in] nFile The file number to read from.
+         *  @param[in] nPos The binary position in the file.
+         *  @param[out] pData The buffer to read into.
+         *  @param[in] nSize The number of bytes to read.
+         *
+         *  @return True if the full range was read, false otherwise.
+         *
+         **/
+        bool Read(const uint32_t nFile, const uint64_t nPos, uint8_t* pData, const uint64_t nSize);
+
+
+        /** Size
+         *
+         *  Get the current size of a file.
+         *
+         *  @param[in] nFile The file number.
+         *  @param[out] nSize The size of the file in bytes.
+         *
+         *  @return True if the file is open and its size was read.
+         *
+         **/
+        bool Size(const uint32_t nFile, uint64_t& nSize);
+
+
+        /** Release
+         *
+         *  Close the handle of a file so it is reopened on next read.
+         *
+         *  @param[in] nFile The file number to release.
+         *
+         **/
+        void Release(const uint32_t nFile);
+
+
+    private:
+
+        /** Handle
+         *
+         *  Get the open handle of a file, opening it if needed.
+         *
+         *  @param[in] nFile The file number to get the handle for.
+         *
+         *  @return The handle, or nullptr if the file can't be opened.
+         *
+         **/
+        std::shared_ptr<FileHandle> handle(const uint32_t nFile);
+    };
+}
+
+#endif
@@ -16,22 +16,32 @@ ________________________________________________________________________________
 #define NEXUS_LLD_TEMPLATES_SECTOR_H
 
 
+#include <LLD/include/compress.h>
 #include <LLD/include/enum.h>
 #include <LLD/include/version.h>
 #include <LLD/templates/key.h>
+#include <LLD/templates/mmap.h>
+#include <LLD/templates/reader.h>
+#include <LLD/templates/segment.h>
+#include <LLD/templates/snapshot.h>
+#include <LLD/keychain/ordered.h>
 #include <LLD/templates/transaction.h>
 
 #include <LLD/cache/template_lru.h>
+#include <LLD/cache/stats.h>
 
 #include <Util/templates/datastream.h>
 #include <Util/include/runtime.h>
 #include <Util/include/debug.h>
+#include <Util/include/metrics.h>
 
+#include <algorithm>
 #include <string>
 #include <cstdint>
 #include <atomic>
 #include <thread>
 #include <mutex>
+#include <set>
 #include <condition_variable>
 
 namespace LLD
@@ -42,12 +52,28 @@ namespace LLD
     const uint32_t MAX_SECTOR_FILE_SIZE = 1024 * 1024 * 512; //512 MB per File
 
 
-    /* Maximum cache buckets for sectors. */
-    const uint32_t MAX_SECTOR_CACHE_SIZE = 1024 * 1024 * 4; //256 MB Max Cache
+    /* The maximum amount of bytes allowed in the memory buffer for disk flushes. **/
+    const uint32_t MAX_SECTOR_BUFFER_SIZE = 1024 * 1024 * 4; //4 MB Max Disk Buffer
 
 
-    /* The maximum amount of bytes allowed in the memory buffer for disk flushes. **/
-    const uint32_t MAX_SECTOR_BUFFER_SIZE = 1024 * 1024 * 4; //32 MB Max Disk Buffer
+    /* The keys of a sector file the garbage collector aims to find in one keychain scan. */
+    const uint32_t SECTOR_COLLECT_KEYS = 1024 * 256; //256k Keys per Keychain Scan
+
+
+    /* The time the garbage collector pauses after a keychain scan, as a multiple of the scan's time. */
+    const uint32_t SECTOR_COLLECT_PAUSE = 9; //Scans take a tenth of the time
+
+
+    /* The records in each segment of the typed segment index. */
+    const uint32_t SECTOR_SEGMENT_RECORDS = 16;
+
+
+    /* The largest gap between records of a batch read that is read through rather than split into another read. */
+    const uint32_t SECTOR_MULTIREAD_GAP = 1024 * 16; //16 KB Read Gap
+
+
+    /* The maximum amount of bytes of a sector file read at once by a batch read. */
+    const uint32_t SECTOR_MULTIREAD_SIZE = 1024 * 1024; //1 MB per Read
 
 
     /** SectorDatabase
@@ -88,14 +114,17 @@ namespace LLD
         std::condition_variable CONDITION;
 
     protected:
-        /* Mutex for Thread Synchronization.
-            TODO: Lock Mutex based on Read / Writes on a per Sector Basis.
-            Will allow higher efficiency for thread concurrency. */
+        /* Mutex for Thread Synchronization of the sector file streams.
+            Reads go through positional reads and only take this as a fallback. */
         std::mutex SECTOR_MUTEX;
         std::mutex BUFFER_MUTEX;
         std::mutex TRANSACTION_MUTEX;
 
 
+        /* Mutex so only one reader indexes the sector files at a time. */
+        std::mutex SEGMENT_MUTEX;
+
+
         /* The String to hold the Disk Location of Database File. */
         std::string strBaseLocation;
         std::string strName;
@@ -121,11 +150,35 @@ namespace LLD
         mutable TemplateLRU<uint32_t, std::fstream*>* fileCache;
 
 
+        /* Memory mapped sector files for reads, only used in MMAP mode. */
+        MemoryMap* pSectorMap;
+
+
+        /* Positional read handles for sector files. */
+        FileReader* pSectorReader;
+
+
+        /* Typed segment index of the sector files, for sequential reads of one type. */
+        SegmentIndex* pSegments;
+
+
+        /* Ordered keychain, for reading sequences of values by range. */
+        BinaryOrderedMap* pOrderedKeys;
+
+
+        /* The versions of the records, for reading them as of an open snapshot. */
+        SnapshotLog* pSnapshots;
+
+
         /* The current File Position. */
         mutable uint32_t nCurrentFile;
         mutable uint32_t nCurrentFileSize;
 
 
+        /* Sector files written since the last sync, guarded by SECTOR_MUTEX. */
+        std::set<uint32_t> setSyncFiles;
+
+
         /* Cache Writer Thread. */
         std::thread CacheWriterThread;
 
@@ -134,6 +187,20 @@ namespace LLD
         std::thread MeterThread;
 
 
+        /* The sector garbage collector thread. */
+        std::thread CollectorThread;
+
+
+        /* Sector files emptied by the garbage collector, truncated once no keys point into them.
+            Only used by the thread running Collect. */
+        std::set<uint32_t> setCollected;
+
+
+        /* The sector file the garbage collector is copying records out of, guarded by SECTOR_MUTEX.
+            Its records are written again at the end of the current file rather than in place. */
+        uint32_t nCollectFile;
+
+
         /* Disk Buffer Vector. */
         std::vector< std::pair< std::vector<uint8_t>, std::vector<uint8_t> > > vDiskBuffer;
 
@@ -141,10 +208,26 @@ namespace LLD
         /* Disk Buffer Memory Size. */
         std::atomic<uint32_t> nBufferBytes;
 
-        /* For the Meter. */
-        std::atomic<uint32_t> nBytesRead;
-        std::atomic<uint32_t> nBytesWrote;
-        std::atomic<uint32_t> nRecordsFlushed;
+        /* Totals since the database was opened, for the meter and the metrics. */
+        std::atomic<uint64_t> nReads;
+        std::atomic<uint64_t> nBytesRead;
+        std::atomic<uint64_t> nBytesWrote;
+        std::atomic<uint64_t> nRecordsFlushed;
+
+        /* Compression statistics for the meter. */
+        std::atomic<uint64_t> nCompressedIn;
+        std::atomic<uint64_t> nCompressedOut;
+        std::atomic<uint64_t> nDecompressed;
+        std::atomic<uint64_t> nDecompressTime;
+
+        /* Microseconds spent reading records from disk on cache misses. */
+        std::atomic<uint64_t> nMissTime;
+
+        /* The time to sync the files written since the last sync, in microseconds. */
+        metrics::Histogram* pSyncTime;
+
+        /* The values of this database watched by the metrics, removed when it is closed. */
+        std::vector<uint64_t> vWatches;
 
         /* Destructor Flag. */
         std::atomic<bool> fDestruct;
@@ -154,6 +237,10 @@ namespace LLD
         std::atomic<bool> fInitialized;
 
 
+        /* Flag for when the local journal file has data to clear, guarded by TRANSACTION_MUTEX. */
+        bool fJournal;
+
+
         /** Database Flags. **/
         uint8_t nFlags;
 
@@ -178,6 +265,59 @@ namespace LLD
         void Initialize();
 
 
+        /** GetName
+         *
+         *  Get the name of this database.
+         *
+         **/
+        const std::string& GetName() const
+        {
+            return strName;
+        }
+
+
+        /** GetCacheStats
+         *
+         *  Get the statistics of the cache pool, with the time spent reading records it missed.
+         *
+         **/
+        CacheStats GetCacheStats() const
+        {
+            CacheStats stats = cachePool->Stats();
+            stats.nMissTime  = nMissTime.load();
+
+            return stats;
+        }
+
+
+        /** SetCacheSize
+         *
+         *  Change the maximum memory of the cache pool, evicting records if it shrinks.
+         *
+         *  @param[in] nCacheSize The new maximum size in bytes.
+         *
+         **/
+        void SetCacheSize(const uint32_t nCacheSize)
+        {
+            cachePool->Resize(nCacheSize);
+        }
+
+
+        /** OpenSnapshot
+         *
+         *  Open a snapshot of the records as of the last complete write or transaction commit,
+         *  to read with ReadSnapshot while writers carry on. The snapshot is closed when it goes
+         *  out of scope, and should be kept only as long as it is read from.
+         *
+         *  @return The open snapshot.
+         *
+         **/
+        Snapshot OpenSnapshot()
+        {
+            return Snapshot(pSnapshots);
+        }
+
+
         /** Exists
          *
          *  Determine if the entry identified by the given key exists.
@@ -272,6 +412,145 @@ namespace LLD
         }
 
 
+        /** WriteOrdered
+         *
+         *  Writes a value to the ordered keychain under a key and a sequence number.
+         *  Values under the same key are read back in the order of their sequence.
+         *
+         *  @param[in] key The key the sequence is under.
+         *  @param[in] nSequence The sequence number of the value.
+         *  @param[in] value The value to write.
+         *
+         *  @return True if successful write, false otherwise.
+         *
+         **/
+        template<typename Key, typename Type>
+        bool WriteOrdered(const Key& key, const uint64_t nSequence, const Type& value)
+        {
+            if(nFlags & FLAGS::READONLY)
+                return debug::error(FUNCTION, "WriteOrdered called on database in read-only mode");
+
+            /* Serialize Key into Bytes. */
+            DataStream ssKey(SER_LLD, DATABASE_VERSION);
+            ssKey << key;
+
+            /* Serialize the value into bytes. */
+            DataStream ssValue(SER_LLD, DATABASE_VERSION);
+            ssValue << value;
+
+            const std::vector<uint8_t> vKey = OrderedKey(ssKey.Bytes(), nSequence);
+
+            /* Check for transaction. */
+            {
+                LOCK(TRANSACTION_MUTEX);
+                if(pTransaction)
+                {
+                    /* Write to journal in memory. */
+                    pTransaction->ssJournal << std::string("ordered") << vKey << ssValue.Bytes();
+
+                    pTransaction->setOrderedErased.erase(vKey);
+                    pTransaction->mapOrdered[vKey] = ssValue.Bytes();
+
+                    return true;
+                }
+            }
+
+            return pOrderedKeys->Put(vKey, ssValue.Bytes());
+        }
+
+
+        /** EraseOrdered
+         *
+         *  Erase a value from the ordered keychain.
+         *
+         *  @param[in] key The key the sequence is under.
+         *  @param[in] nSequence The sequence number of the value.
+         *
+         *  @return True if the entry erased, false otherwise.
+         *
+         **/
+        template<typename Key>
+        bool EraseOrdered(const Key& key, const uint64_t nSequence)
+        {
+            if(nFlags & FLAGS::READONLY)
+                return debug::error(FUNCTION, "EraseOrdered called on database in read-only mode");
+
+            /* Serialize Key into Bytes. */
+            DataStream ssKey(SER_LLD, DATABASE_VERSION);
+            ssKey << key;
+
+            const std::vector<uint8_t> vKey = OrderedKey(ssKey.Bytes(), nSequence);
+
+            /* Check for transaction. */
+            {
+                LOCK(TRANSACTION_MUTEX);
+                if(pTransaction)
+                {
+                    /* Write to journal in memory. */
+                    pTransaction->ssJournal << std::string("eraseordered") << vKey;
+
+                    pTransaction->mapOrdered.erase(vKey);
+                    pTransaction->setOrderedErased.insert(vKey);
+
+                    return true;
+                }
+            }
+
+            return pOrderedKeys->Erase(vKey);
+        }
+
+
+        /** ReadRange
+         *
+         *  Read the values under a key from the ordered keychain, in the order of their sequence.
+         *  Values written in an open transaction are not read until it commits.
+         *
+         *  @param[in] key The key the sequence is under.
+         *  @param[in] nFrom The sequence number to start from.
+         *  @param[in] nLimit The maximum values to read.
+         *  @param[out] vValues The sequence numbers and values read.
+         *
+         *  @return True if any values were read, false otherwise.
+         *
+         **/
+        template<typename Key, typename Type>
+        bool ReadRange(const Key& key, const uint64_t nFrom, const uint32_t nLimit,
+            std::vector< std::pair<uint64_t, Type> >& vValues)
+        {
+            vValues.clear();
+
+            /* Serialize Key into Bytes. */
+            DataStream ssKey(SER_LLD, DATABASE_VERSION);
+            ssKey << key;
+
+            /* Read the range in one pass over the ordered keychain. */
+            std::vector< std::pair<std::vector<uint8_t>, std::vector<uint8_t>> > vRecords;
+            if(!pOrderedKeys->ReadRange(ssKey.Bytes(), OrderedKey(ssKey.Bytes(), nFrom), nLimit, vRecords))
+                return false;
+
+            /* Iterate if meters are enabled. */
+            for(const auto& record : vRecords)
+            {
+                ++nReads;
+                nBytesRead += static_cast<uint64_t>(record.first.size() + record.second.size());
+
+                /* Skip keys that only share the prefix of the key. */
+                if(record.first.size() != ssKey.size() + 8)
+                    continue;
+
+                /* Deseriazlie the Value. */
+                DataStream ssValue(record.second, SER_LLD, DATABASE_VERSION);
+
+                Type value;
+                ssValue >> value;
+
+                vValues.push_back(std::make_pair(OrderedSequence(record.first), value));
+            }
+
+            return !vValues.empty();
+        }
+
+
         /** BatchRead
          *
          *  Sequential read from beginning of datachain.
@@ -342,90 +621,92 @@ namespace LLD
             /* Clear any remaining data. */
             vValues.clear();
 
+            /* Serialize the type to compare with the front of the records. */
+            DataStream ssType(SER_LLD, DATABASE_VERSION);
+            ssType << strType;
+
+            const std::vector<uint8_t>& vType = ssType.Bytes();
+
             /* Scan until limit is reached. */
             while(nLimit == -1 || nLimit > 0)
             {
-                /* Get filestream object. */
-                std::ifstream stream = std::ifstream(debug::safe_printstr(strBaseLocation, "_block.", std::setfill('0'), std::setw(5), nFile), std::ios::in | std::ios::binary);
-                if(!stream)
+                /* Index the records written since the last read, stopping at the last file. */
+                if(!IndexSegments(nFile))
                     break;
 
-                /* Check filesize. */
-                stream.seekg(0, std::ios::end);
-                uint64_t nFileSize = stream.tellg();
-                uint64_t nBufferSize = (nLimit == -1) ? nFileSize : (1024 * 1024); //1 MB read buffer
-                stream.seekg(0, std::ios::beg); //reset seek position
+                /* Get the parts of the file that hold records of this type. */
+                std::vector< std::pair<uint64_t, uint64_t> > vRanges;
+                pSegments->Ranges(nFile, vType, nStart, vRanges);
 
-                /* Loop until stream encounters exceptions. */
-                while(stream)
+                /* Read the records of each range, skipping the segments of other types. */
+                for(const auto& range : vRanges)
                 {
-                    /* Check that we aren't seeking past end of file. */
-                    if(nStart >= nFileSize)
-                        break;
-
-                    /* Read into serialize stream. */
-                    DataStream ssData(SER_LLD, DATABASE_VERSION);
-                    ssData.resize(nBufferSize);
-
+                    uint64_t nPos = range.first;
+                    uint64_t nBufferSize = 1024 * 1024; //1 MB read buffer
+                    while(nPos < range.second)
                     {
-                        LOCK(SECTOR_MUTEX);
-
-                        /* Seek stream to beginning. */
-                        stream.seekg(nStart, std::ios::beg);
-
-                        /* Read the data into the buffer. */
-                        stream.read((char*)ssData.data(), nBufferSize);
-                        if(!stream)
-                            ssData.resize(stream.gcount());
+                        /* Read the next part of the range. */
+                        std::vector<uint8_t> vData(std::min(range.second - nPos, nBufferSize), 0);
+                        if(!ReadSector(nFile, nPos, &vData[0], vData.size()))
+                            return debug::error(FUNCTION, "failed to read ", vData.size(), " bytes at ", nPos, " of file ", nFile);
 
                         /* Iterate if meters are enabled. */
-                        nBytesRead += static_cast<uint32_t>(nBufferSize);
-                    }
+                        nBytesRead += static_cast<uint64_t>(vData.size());
 
-                    /* Read records. */
-                    while(!ssData.End())
-                    {
-                        try
+                        /* Read the whole records in the buffer. */
+                        uint64_t nOffset = 0;
+                        while(nOffset < vData.size())
                         {
-                            /* Get the current stream position. */
-                            uint64_t nPos  = ssData.GetPos();
-
                             /* Read compact size. */
-                            uint64_t nSize = ReadCompactSize(ssData);
-                            if(nSize == 0) //reached end of current file
+                            uint64_t nSize;
+                            uint32_t nHeader;
+                            if(!RecordHeader(&vData[nOffset], vData.size() - nOffset, nSize, nHeader)
+                            || nOffset + nHeader + nSize > vData.size())
                                 break;
 
-                            /* Deserialize the String. */
-                            std::string strThis;
-                            ssData >> strThis;
+                            /* Decompress the record if it was written in compress mode. */
+                            std::vector<uint8_t> vRecord(vData.begin() + nOffset + nHeader, vData.begin() + nOffset + nHeader + nSize);
+                            if(!Decompress(vRecord))
+                                debug::error(FUNCTION, "corrupted compressed record at ", nPos + nOffset, " of file ", nFile);
 
-                            /* Check the type. */
-                            if(strType == strThis)
+                            /* Check the type, a segment may hold records of other types. */
+                            else if(vRecord.size() >= vType.size() && std::equal(vType.begin(), vType.end(), vRecord.begin()))
                             {
-                                /* Get the value. */
-                                Type value;
-                                ssData >> value;
-
-                                /* Push next value. */
-                                vValues.push_back(value);
-
-                                /* Check limits. */
-                                if(nLimit != -1 && --nLimit == 0)
-                                    return (vValues.size() > 0);
+                                try
+                                {
+                                    /* Get the value. */
+                                    const DataStream ssRecord(vRecord.begin() + vType.size(), vRecord.end(), SER_LLD, DATABASE_VERSION);
+
+                                    Type value;
+                                    ssRecord >> value;
+
+                                    /* Push next value. */
+                                    vValues.push_back(value);
+
+                                    /* Check limits. */
+                                    if(nLimit != -1 && --nLimit == 0)
+                                        return (vValues.size() > 0);
+                                }
+                                catch(const std::exception& e)
+                                {
+                                    debug::error(FUNCTION, "corrupted record at ", nPos + nOffset, " of file ", nFile, ": ", e.what());
+                                }
                             }
-                            else
-                                ssData.SetPos(nPos + nSize + GetSizeOfCompactSize(nSize));
 
                             /* Iterate to next position. */
-                            nStart += nSize + GetSizeOfCompactSize(nSize);
+                            nOffset += nHeader + nSize;
                         }
-                        catch(const std::exception& e)
+
+                        /* Allocate a larger buffer if full record exceeds default buffer. */
+                        if(nOffset == 0)
                         {
-                            /* Allocate a larger buffer if full record exceeds default buffer. */
-                            nBufferSize *= 2;
+                            if(vData.size() == range.second - nPos)
+                                return debug::error(FUNCTION, "indexed range of file ", nFile, " ends in a partial record");
 
-                            break;
+                            nBufferSize *= 2;
                         }
+
+                        nPos += nOffset;
                     }
                 }
 
@@ -515,6 +796,178 @@ namespace LLD
         }
 
 
+        /** ReadSnapshot
+         *
+         *  Read a database entry as of an open snapshot. Writes pending in a transaction
+         *  and writes committed after the snapshot was opened are not seen.
+         *
+         *  @param[in] key The key to the database entry to read.
+         *  @param[out] value The database entry value to read out.
+         *  @param[in] snapshot The snapshot to read as of.
+         *
+         *  @return True if the entry existed as of the snapshot, false otherwise.
+         *
+         **/
+        template<typename Key, typename Type>
+        bool ReadSnapshot(const Key& key, Type& value, const Snapshot& snapshot)
+        {
+            if(!snapshot.Of(pSnapshots))
+                return debug::error(FUNCTION, strName, " snapshot is not of this database");
+
+            /* Serialize Key into Bytes. */
+            DataStream ssKey(SER_LLD, DATABASE_VERSION);
+            ssKey << key;
+
+            /* Get reference of key. */
+            const std::vector<uint8_t>& vKey = ssKey.Bytes();
+
+            /* Read the current record before the saved records, so a record changed in between is found saved. */
+            std::vector<uint8_t> vData;
+            bool fExists = Get(vKey, vData);
+
+            /* Get the record as of the snapshot if it has changed since. */
+            pSnapshots->Get(vKey, snapshot.Version(), fExists, vData);
+            if(!fExists)
+                return false;
+
+            /* Deserialize Value. */
+            DataStream ssValue(vData, SER_LLD, DATABASE_VERSION);
+
+            /* Deserialize the String. */
+            std::string strType;
+            ssValue >> strType;
+
+            /* Deseriazlie the Value. */
+            ssValue >> value;
+
+            return true;
+        }
+
+
+        /** MultiRead
+         *
+         *  Read the database entries of a list of keys together. The entries not in the cache
+         *  are looked up in the keychain first, then read in the order they are on disk, with
+         *  records near each other read at once.
+         *
+         *  @param[in] vKeys The keys to the database entries to read.
+         *  @param[out] vValues The database entry values, in the order of the keys.
+         *  @param[out] vFound True for each key whose entry was read.
+         *
+         *  @return True if any entries were read, false otherwise.
+         *
+         **/
+        template<typename Key, typename Type>
+        bool MultiRead(const std::vector<Key>& vKeys, std::vector<Type>& vValues, std::vector<bool>& vFound)
+        {
+            vValues.clear();
+            vValues.resize(vKeys.size());
+            vFound.assign(vKeys.size(), false);
+
+            /* Serialize the keys into bytes. */
+            std::vector< std::vector<uint8_t> > vKeyData(vKeys.size());
+            for(uint32_t n = 0; n < vKeys.size(); ++n)
+            {
+                DataStream ssKey(SER_LLD, DATABASE_VERSION);
+                ssKey << vKeys[n];
+
+                vKeyData[n] = ssKey.Bytes();
+            }
+
+            /* The binary data of each entry, and the keys left to read from the database. */
+            std::vector< std::vector<uint8_t> > vData(vKeys.size());
+            std::vector< std::vector<uint8_t> > vRead;
+            std::vector<uint32_t> vIndex;
+
+            /* Check the keys that are pending in a transaction. */
+            {
+                LOCK(TRANSACTION_MUTEX);
+                for(uint32_t n = 0; n < vKeyData.size(); ++n)
+                {
+                    std::vector<uint8_t>& vKey = vKeyData[n];
+                    if(pTransaction)
+                    {
+                        /* Check if in erase queue. */
+                        if(pTransaction->setErasedData.count(vKey))
+                            continue;
+
+                        /* Check for indexes. */
+                        if(pTransaction->mapIndex.count(vKey))
+                            vKey = pTransaction->mapIndex[vKey];
+
+                        /* Get the data from the transaction object. */
+                        if(pTransaction->mapTransactions.count(vKey))
+                        {
+                            vData[n]  = pTransaction->mapTransactions[vKey];
+                            vFound[n] = true;
+
+                            continue;
+                        }
+                    }
+
+                    vRead.push_back(vKey);
+                    vIndex.push_back(n);
+                }
+            }
+
+            /* Get the data from the database. */
+            std::vector< std::vector<uint8_t> > vRecords;
+            std::vector<bool> vRecordFound;
+            Get(vRead, vRecords, vRecordFound);
+
+            for(uint32_t n = 0; n < vIndex.size(); ++n)
+            {
+                if(!vRecordFound[n])
+                    continue;
+
+                vData[vIndex[n]].swap(vRecords[n]);
+                vFound[vIndex[n]] = true;
+            }
+
+            /* Deserialize the values that were read. */
+            bool fRead = false;
+            for(uint32_t n = 0; n < vKeys.size(); ++n)
+            {
+                if(!vFound[n])
+                    continue;
+
+                /* Deserialize Value. */
+                DataStream ssValue(vData[n], SER_LLD, DATABASE_VERSION);
+
+                /* Deserialize the String. */
+                std::string strType;
+                ssValue >> strType;
+
+                /* Deseriazlie the Value. */
+                ssValue >> vValues[n];
+
+                fRead = true;
+            }
+
+            return fRead;
+        }
+
+
+        /** MultiRead
+         *
+         *  Read the database entries of a list of keys together.
+         *
+         *  @param[in] vKeys The keys to the database entries to read.
+         *  @param[out] vValues The database entry values, in the order of the keys.
+         *
+         *  @return True if every entry was read, false otherwise.
+         *
+         **/
+        template<typename Key, typename Type>
+        bool MultiRead(const std::vector<Key>& vKeys, std::vector<Type>& vValues)
+        {
+            std::vector<bool> vFound;
+            MultiRead(vKeys, vValues, vFound);
+
+            return std::find(vFound.begin(), vFound.end(), false) == vFound.end();
+        }
+
+
         /** Index
          *
          *  Indexes a key into memory.
@@ -558,6 +1011,13 @@ namespace LLD
                 }
             }
 
+            /* Keep the record the key pointed to for open snapshots. */
+            SnapshotWrite write(pSnapshots);
+            SaveSnapshot(write, vKey);
+
+            /* Hold the sector files so the garbage collector can't move the record while it is indexed. */
+            LOCK(SECTOR_MUTEX);
+
             /* Get the key. */
             SectorKey cKey;
             if(!pSectorKeys->Get(vIndex, cKey))
@@ -699,6 +1159,22 @@ namespace LLD
         bool Get(const SectorKey& cKey, std::vector<uint8_t>& vData);
 
 
+        /** Get
+         *
+         *  Get a list of records from cache or from disk. The records not in the cache are
+         *  read in the order of their sector files, joining records close to each other
+         *  into one read.
+         *
+         *  @param[in] vKeys The binary data of the keys to get.
+         *  @param[out] vData The binary data of the records, in the order of the keys.
+         *  @param[out] vFound True for each key whose record was read.
+         *
+         *  @return True if any records were read.
+         *
+         **/
+        bool Get(const std::vector< std::vector<uint8_t> >& vKeys, std::vector< std::vector<uint8_t> >& vData, std::vector<bool>& vFound);
+
+
         /** Update
          *
          *  Update a record on disk.
@@ -712,6 +1188,85 @@ namespace LLD
         bool Update(const std::vector<uint8_t>& vKey, const std::vector<uint8_t>& vData);
 
 
+        /** Update
+         *
+         *  Update a record on disk with the bytes to store for it.
+         *
+         *  @param[in] vKey The binary data of the key to flush
+         *  @param[in] vData The binary data of the record, written into the cache
+         *  @param[in] vRecord The binary data to write to disk, compressed in compress mode
+         *
+         *  @return True if the flush was successful, false if the record must be appended instead
+         *          as its size changed or the garbage collector is copying its file.
+         *
+         **/
+        bool Update(const std::vector<uint8_t>& vKey, const std::vector<uint8_t>& vData, const std::vector<uint8_t>& vRecord);
+
+
+        /** Compress
+         *
+         *  Get the bytes to store for a record, compressing it in compress mode.
+         *
+         *  @param[in] vData The binary data of the record.
+         *  @param[out] vCompressed The compressed record, if it was compressed.
+         *
+         *  @return Reference to the compressed record, or to the record itself if it wasn't compressed.
+         *
+         **/
+        const std::vector<uint8_t>& Compress(const std::vector<uint8_t>& vData, std::vector<uint8_t>& vCompressed);
+
+
+        /** Decompress
+         *
+         *  Decompress a record read from disk if it is compressed.
+         *
+         *  @param[out] vData The binary data of the record, replaced with the uncompressed record.
+         *
+         *  @return True if the record was uncompressed or decompressed, false if it is corrupted.
+         *
+         **/
+        bool Decompress(std::vector<uint8_t>& vData);
+
+
+        /** ReadSector
+         *
+         *  Read bytes of a sector file, through a positional read or the file streams as a fallback.
+         *
+         *  @param[in] nFile The sector file to read from.
+         *  @param[in] nPos The binary position in the file.
+         *  @param[out] pData The buffer to read into.
+         *  @param[in] nSize The number of bytes to read.
+         *
+         *  @return True if the full range was read.
+         *
+         **/
+        bool ReadSector(const uint32_t nFile, const uint64_t nPos, uint8_t* pData, const uint64_t nSize);
+
+
+        /** IndexSegments
+         *
+         *  Add the records written to a sector file since it was last indexed to the typed segment index.
+         *
+         *  @param[in] nFile The sector file to index.
+         *
+         *  @return True if the file exists, false otherwise.
+         *
+         **/
+        bool IndexSegments(const uint32_t nFile);
+
+
+        /** SaveSnapshot
+         *
+         *  Save the committed record of a key before a write changes it, if the write
+         *  saves records for open snapshots.
+         *
+         *  @param[in] write The write that changes the key.
+         *  @param[in] vKey The binary data of the key to be changed.
+         *
+         **/
+        void SaveSnapshot(const SnapshotWrite& write, const std::vector<uint8_t>& vKey);
+
+
         /** Force
          *
          *  Force a write to disk immediately bypassing write buffers.
@@ -767,6 +1322,54 @@ namespace LLD
         void Meter();
 
 
+        /** Collector
+         *
+         *  Sector garbage collector thread. Runs Collect every -sectorgcinterval seconds
+         *  for databases opened with FLAGS::COLLECT.
+         *
+         **/
+        void Collector();
+
+
+        /** Collect
+         *
+         *  Reclaim the space of erased and resized records. Sector files that are at least half
+         *  unused have their live records copied to the end of the current sector file and their
+         *  keys pointed to the copies. An emptied file is truncated on the next pass, once a
+         *  keychain scan shows no keys point into it.
+         *
+         *  Each file is copied a range at a time, sized to hold about SECTOR_COLLECT_KEYS keys,
+         *  with one keychain scan per range. Every scan is followed by a pause of
+         *  SECTOR_COLLECT_PAUSE times its length, so scans don't starve readers of the keychain.
+         *
+         *  @param[in] nRate The maximum bytes per second to copy, so writers aren't starved.
+         *
+         *  @return True if the pass completed.
+         *
+         **/
+        bool Collect(const uint64_t nRate);
+
+
+        /** CollectFile
+         *
+         *  Copy the live records of a sector file to the end of the current sector file, a
+         *  range at a time. The copies are synced without holding SECTOR_MUTEX, then the keys
+         *  that haven't changed since the scan are pointed to them.
+         *
+         *  @param[in] nFile The sector file to copy the records of.
+         *  @param[in] nFileSize The size of the sector file.
+         *  @param[in] nRange The bytes of the file to find the keys of in one keychain scan.
+         *  @param[in] nRate The maximum bytes per second to copy.
+         *  @param[out] nRecords Added to with the keys moved.
+         *  @param[out] nBytes Added to with the bytes copied.
+         *
+         *  @return True if every range was copied.
+         *
+         **/
+        bool CollectFile(const uint32_t nFile, const uint64_t nFileSize, const uint64_t nRange,
+                         const uint64_t nRate, uint64_t &nRecords, uint64_t &nBytes);
+
+
         /** TxnBegin
          *
          *  Start a database transaction.
@@ -783,6 +1386,19 @@ namespace LLD
         bool TxnCheckpoint();
 
 
+        /** TxnCheckpoint
+         *
+         *  Write the transaction commitment message into a shared write-ahead log
+         *  record instead of this database's own journal file.
+         *
+         *  @param[out] ssJournal The log record to append the name and journal to.
+         *
+         *  @return True if there was an active transaction to checkpoint.
+         *
+         **/
+        bool TxnCheckpoint(DataStream& ssJournal);
+
+
         /** TxnRelease
          *
          *  Release the transaction checkpoint.
@@ -808,6 +1424,38 @@ namespace LLD
          **/
         bool TxnRecovery();
 
+
+        /** TxnRecovery
+         *
+         *  Recover a transaction from journal data, such as an entry of the write-ahead log.
+         *
+         *  @param[in] vJournal The serialized journal ending in a commit message.
+         *
+         *  @return True if the journal reached commit and is ready to be restored.
+         *
+         **/
+        bool TxnRecovery(const std::vector<uint8_t>& vJournal);
+
+
+        /** Sync
+         *
+         *  Sync the sector and keychain files to disk so the write-ahead log can be cleared.
+         *
+         *  @return True if all files were synced, false otherwise.
+         *
+         **/
+        bool Sync();
+
+
+        /** Compact
+         *
+         *  Compact the keychain into fewer files while the database keeps serving reads.
+         *
+         *  @return True if the keychain was compacted.
+         *
+         **/
+        bool Compact();
+
     };
 }
 
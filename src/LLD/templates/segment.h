@@ -0,0 +1,196 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#pragma once
+#ifndef NEXUS_LLD_TEMPLATES_SEGMENT_H
+#define NEXUS_LLD_TEMPLATES_SEGMENT_H
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace LLD
+{
+
+    /** RecordHeader
+     *
+     *  Read the compact size in front of a record or a type string in a buffer.
+     *
+     *  @param[in] pData The buffer to read from.
+     *  @param[in] nAvailable The bytes available in the buffer.
+     *  @param[out] nSize The size that was read.
+     *  @param[out] nHeader The bytes taken by the compact size.
+     *
+     *  @return True if the whole compact size was in the buffer.
+     *
+     **/
+    bool RecordHeader(const uint8_t* pData, const uint64_t nAvailable, uint64_t& nSize, uint32_t& nHeader);
+
+
+    /** RecordType
+     *
+     *  Get the serialized type string a record starts with, decompressing the record if needed.
+     *
+     *  @param[in] pRecord The record data, after its compact size.
+     *  @param[in] nSize The size of the record.
+     *  @param[out] vType The type string with its compact size.
+     *
+     *  @return True if the type string was read, false if the record is corrupted.
+     *
+     **/
+    bool RecordType(const uint8_t* pRecord, const uint64_t nSize, std::vector<uint8_t>& vType);
+
+
+    /** SegmentFile
+     *
+     *  The typed segments of one sector file.
+     *
+     **/
+    struct SegmentFile
+    {
+        /** The bytes of the file that are indexed. **/
+        uint64_t nIndexed;
+
+
+        /** The records in the last segment. **/
+        uint32_t nRecords;
+
+
+        /** The start of each segment. **/
+        std::vector<uint64_t> vStarts;
+
+
+        /** The segments holding records of each type, by serialized type string. **/
+        std::map< std::vector<uint8_t>, std::vector<uint32_t> > mapTypes;
+
+
+        /** Default Constructor. **/
+        SegmentFile()
+        : nIndexed (0)
+        , nRecords (0)
+        , vStarts  ( )
+        , mapTypes ( )
+        {
+        }
+    };
+
+
+    /** SegmentIndex
+     *
+     *  Sparse index of the record types in the sector files.
+     *
+     *  The records of each file are grouped in segments of a fixed number of
+     *  records, in the order they were written. Each type keeps the list of
+     *  segments it has records in, so a sequential read of one type can seek
+     *  from one of its segments to the next, past the records of other types.
+     *
+     *  The index is kept in memory and built as files are read. A file is
+     *  indexed up to its last complete record, so the index grows with the
+     *  file it covers.
+     *
+     **/
+    class SegmentIndex
+    {
+        /* Mutex to protect the files. */
+        mutable std::mutex MUTEX;
+
+
+        /* The records in each segment. */
+        uint32_t nSegmentRecords;
+
+
+        /* The indexed files by file number. */
+        std::map<uint32_t, SegmentFile> mapFiles;
+
+
+    public:
+
+        /** Default Constructor. **/
+        SegmentIndex()                                    = delete;
+
+
+        /** Copy Constructor. **/
+        SegmentIndex(const SegmentIndex& index)           = delete;
+
+
+        /** Copy assignment. **/
+        SegmentIndex& operator=(const SegmentIndex& index) = delete;
+
+
+        /** Segment Size Constructor
+         *
+         *  @param[in] nSegmentRecordsIn The records in each segment.
+         *
+         **/
+        SegmentIndex(const uint32_t nSegmentRecordsIn);
+
+
+        /** Default Destructor **/
+        ~SegmentIndex();
+
+
+        /** Indexed
+         *
+         *  Get how far a file is indexed.
+         *
+         *  @param[in] nFile The file number.
+         *
+         *  @return The position after the last indexed record.
+         *
+         **/
+        uint64_t Indexed(const uint32_t nFile) const;
+
+
+        /** Add
+         *
+         *  Add the next record of a file to the index.
+         *
+         *  @param[in] nFile The file number.
+         *  @param[in] nPos The position of the record, which must be where the file is indexed to.
+         *  @param[in] nNext The position after the record.
+         *  @param[in] vType The serialized type string of the record.
+         *
+         *  @return True if the record was added, false if it isn't the next record.
+         *
+         **/
+        bool Add(const uint32_t nFile, const uint64_t nPos, const uint64_t nNext, const std::vector<uint8_t>& vType);
+
+
+        /** Ranges
+         *
+         *  Get the ranges of a file that hold records of a type, from a starting position.
+         *
+         *  @param[in] nFile The file number.
+         *  @param[in] vType The serialized type string.
+         *  @param[in] nStart The position to start from.
+         *  @param[out] vRanges The start and end of each range, in order.
+         *
+         **/
+        void Ranges(const uint32_t nFile, const std::vector<uint8_t>& vType, const uint64_t nStart,
+            std::vector< std::pair<uint64_t, uint64_t> >& vRanges) const;
+
+
+        /** Reset
+         *
+         *  Drop the index of a file, such as when it is truncated.
+         *
+         *  @param[in] nFile The file number.
+         *
+         **/
+        void Reset(const uint32_t nFile);
+    };
+}
+
+#endif
@@ -0,0 +1,326 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#pragma once
+#ifndef NEXUS_LLD_TEMPLATES_SNAPSHOT_H
+#define NEXUS_LLD_TEMPLATES_SNAPSHOT_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace LLD
+{
+
+    /** SnapshotRecord
+     *
+     *  A record as it was before a version changed it.
+     *
+     **/
+    struct SnapshotRecord
+    {
+        /** The version that changed the record. **/
+        uint64_t nVersion;
+
+
+        /** True if the record existed before the change. **/
+        bool fExists;
+
+
+        /** The binary data of the record before the change. **/
+        std::vector<uint8_t> vData;
+
+
+        /** Default Constructor. **/
+        SnapshotRecord(const uint64_t nVersionIn, const bool fExistsIn, const std::vector<uint8_t>& vDataIn)
+        : nVersion (nVersionIn)
+        , fExists  (fExistsIn)
+        , vData    (vDataIn)
+        {
+        }
+    };
+
+
+    /** SnapshotLog
+     *
+     *  The versions of a database, and the records changed since the oldest open snapshot.
+     *
+     *  Every write or transaction commit is a new version. A snapshot pins the last
+     *  complete version, and while any snapshot is open each write saves the record it
+     *  replaces before changing it. A snapshot reads the current record, then the first
+     *  record saved by a later version if there is one, so it sees the database as of
+     *  its version while writers carry on.
+     *
+     *  Saved records are dropped once no open snapshot is older than the version that
+     *  replaced them.
+     *
+     *  Writes are only ordered into versions while a snapshot is open or waiting to
+     *  open. Otherwise they run side by side without taking the lock, and a snapshot
+     *  waits for them to drain before it pins a version.
+     *
+     **/
+    class SnapshotLog
+    {
+        /* Mutex to protect the versions. */
+        mutable std::mutex MUTEX;
+
+
+        /* Condition to wait for the writes in progress. */
+        std::condition_variable CONDITION;
+
+
+        /* The last complete version. */
+        uint64_t nVersion;
+
+
+        /* True while a write that saves records is in progress. */
+        bool fWriting;
+
+
+        /* The snapshots open or waiting to be opened. */
+        std::atomic<uint32_t> nSnapshots;
+
+
+        /* The writes in progress that don't save records. */
+        std::atomic<uint32_t> nUnsaved;
+
+
+        /* The open snapshots by version. */
+        std::map<uint64_t, uint32_t> mapPinned;
+
+
+        /* The saved records of each key, oldest first. */
+        std::map< std::vector<uint8_t>, std::vector<SnapshotRecord> > mapRecords;
+
+
+    public:
+
+        /** Default Constructor. **/
+        SnapshotLog();
+
+
+        /** Copy Constructor. **/
+        SnapshotLog(const SnapshotLog& log)            = delete;
+
+
+        /** Copy assignment. **/
+        SnapshotLog& operator=(const SnapshotLog& log) = delete;
+
+
+        /** Default Destructor **/
+        ~SnapshotLog();
+
+
+        /** Pin
+         *
+         *  Open a snapshot of the last complete version. Waits for the writes in
+         *  progress that don't save records.
+         *
+         *  @return The version of the snapshot.
+         *
+         **/
+        uint64_t Pin();
+
+
+        /** Release
+         *
+         *  Close a snapshot, dropping the records no open snapshot needs.
+         *
+         *  @param[in] nVersionIn The version of the snapshot.
+         *
+         **/
+        void Release(const uint64_t nVersionIn);
+
+
+        /** Begin
+         *
+         *  Start a write. With no snapshot open it starts at once, otherwise it waits
+         *  for the write in progress to finish.
+         *
+         *  @return True if the write saves the records it replaces.
+         *
+         **/
+        bool Begin();
+
+
+        /** End
+         *
+         *  Finish a write, completing its version if it saves records.
+         *
+         *  @param[in] fSaving True if the write saves the records it replaces.
+         *
+         **/
+        void End(const bool fSaving);
+
+
+        /** Save
+         *
+         *  Save a record before the write in progress changes it. Only the first
+         *  change of a record in a version is saved.
+         *
+         *  @param[in] vKey The binary data of the key.
+         *  @param[in] fExists True if the record exists.
+         *  @param[in] vData The binary data of the record.
+         *
+         **/
+        void Save(const std::vector<uint8_t>& vKey, const bool fExists, const std::vector<uint8_t>& vData);
+
+
+        /** Get
+         *
+         *  Get a record as of a version, if it has changed since.
+         *
+         *  @param[in] vKey The binary data of the key.
+         *  @param[in] nVersionIn The version to read as of.
+         *  @param[out] fExists True if the record existed as of the version.
+         *  @param[out] vData The binary data of the record as of the version.
+         *
+         *  @return True if the record changed since the version, false if the current record is as of the version.
+         *
+         **/
+        bool Get(const std::vector<uint8_t>& vKey, const uint64_t nVersionIn, bool &fExists, std::vector<uint8_t>& vData) const;
+
+
+    private:
+
+        /** Prune
+         *
+         *  Drop the saved records no open snapshot needs. Must be called holding MUTEX.
+         *
+         **/
+        void prune();
+    };
+
+
+    /** SnapshotWrite
+     *
+     *  A write in progress on the versions of a database, finished when it goes out of scope.
+     *
+     **/
+    class SnapshotWrite
+    {
+        /* The versions of the database. */
+        SnapshotLog* pLog;
+
+
+        /* True if the write saves the records it replaces. */
+        const bool fSaving;
+
+
+    public:
+
+        /** Default Constructor. **/
+        SnapshotWrite()                                        = delete;
+
+
+        /** Copy Constructor. **/
+        SnapshotWrite(const SnapshotWrite& write)              = delete;
+
+
+        /** Copy assignment. **/
+        SnapshotWrite& operator=(const SnapshotWrite& write)   = delete;
+
+
+        /** Log Constructor
+         *
+         *  Start a write, waiting for the write in progress to finish if a snapshot is open.
+         *
+         *  @param[in] pLogIn The versions of the database.
+         *
+         **/
+        SnapshotWrite(SnapshotLog* pLogIn);
+
+
+        /** Default Destructor **/
+        ~SnapshotWrite();
+
+
+        /** Saving
+         *
+         *  Check if the write saves the records it replaces.
+         *
+         **/
+        bool Saving() const;
+    };
+
+
+    /** Snapshot
+     *
+     *  An open snapshot of a database, closed when it goes out of scope.
+     *
+     **/
+    class Snapshot
+    {
+        /* The versions of the database. */
+        SnapshotLog* pLog;
+
+
+        /* The version of the snapshot. */
+        uint64_t nVersion;
+
+
+    public:
+
+        /** Default Constructor. **/
+        Snapshot()                                   = delete;
+
+
+        /** Copy Constructor. **/
+        Snapshot(const Snapshot& snapshot)           = delete;
+
+
+        /** Copy assignment. **/
+        Snapshot& operator=(const Snapshot& snapshot) = delete;
+
+
+        /** Log Constructor
+         *
+         *  Open a snapshot of the last complete version.
+         *
+         *  @param[in] pLogIn The versions of the database.
+         *
+         **/
+        Snapshot(SnapshotLog* pLogIn);
+
+
+        /** Move Constructor. **/
+        Snapshot(Snapshot&& snapshot);
+
+
+        /** Default Destructor **/
+        ~Snapshot();
+
+
+        /** Of
+         *
+         *  Check if this is a snapshot of a database.
+         *
+         *  @param[in] pLogIn The versions of the database.
+         *
+         **/
+        bool Of(const SnapshotLog* pLogIn) const;
+
+
+        /** Version
+         *
+         *  Get the version of the snapshot.
+         *
+         **/
+        uint64_t Version() const;
+    };
+}
+
+#endif
@@ -76,6 +76,12 @@ namespace LLD
         /** Vector to hold the keys of transactions to be erased. **/
         std::set< std::vector<uint8_t> > setErasedData;
 
+        /** Ordered keychain items to commit. **/
+        std::map< std::vector<uint8_t>, std::vector<uint8_t> > mapOrdered;
+
+        /** Ordered keychain items to erase. **/
+        std::set< std::vector<uint8_t> > setOrderedErased;
+
         /** Binary stream with data to be written. **/
         DataStream ssJournal;
 
@@ -23,6 +23,8 @@ namespace LLD
     , setKeychain()
     , mapIndex()
     , setErasedData()
+    , mapOrdered()
+    , setOrderedErased()
     , ssJournal(SER_LLD, DATABASE_VERSION)
     {
     }
@@ -19,7 +19,7 @@ ________________________________________________________________________________
 
 #include <LLD/templates/sector.h>
 #include <LLD/cache/binary_lru.h>
-#include <LLD/keychain/hashmap.h>
+#include <LLD/keychain/keychain.h>
 
 #include <TAO/Ledger/include/enum.h>
 
@@ -50,7 +50,7 @@ namespace LLD
      *  Database class for storing local wallet transactions.
      *
      **/
-    class ContractDB : public SectorDatabase<BinaryHashMap, BinaryLRU>
+    class ContractDB : public SectorDatabase<Keychain, BinaryLRU>
     {
         /** Internal mutex for MEMPOOL mode. **/
         std::mutex MEMORY_MUTEX;
@@ -18,8 +18,8 @@ ________________________________________________________________________________
 #include <LLC/types/uint1024.h>
 
 #include <LLD/templates/sector.h>
-#include <LLD/cache/binary_lru.h>
-#include <LLD/keychain/hashmap.h>
+#include <LLD/cache/binary_2q.h>
+#include <LLD/keychain/keychain.h>
 
 #include <TAO/Operation/types/contract.h>
 
@@ -72,7 +72,7 @@ namespace LLD
      *  The database class for the Ledger Layer.
      *
      **/
-    class LedgerDB : public SectorDatabase<BinaryHashMap, BinaryLRU>
+    class LedgerDB : public SectorDatabase<Keychain, Binary2Q>
     {
 
         /** Mutex to lock internall when accessing memory mode. **/
@@ -209,6 +209,20 @@ namespace LLD
         bool ReadTx(const uint512_t& hashTx, TAO::Ledger::Transaction &tx, bool &fConflicted, const uint8_t nFlags = TAO::Ledger::FLAGS::BLOCK);
 
 
+        /** ReadTx
+         *
+         *  Reads a list of transactions from the ledger DB, reading the ones on disk together.
+         *
+         *  @param[in] vHashes The txids of the transactions to read.
+         *  @param[out] vtx The transaction objects, in the order of the txids.
+         *  @param[in] nFlags The flags to determine memory pool or disk
+         *
+         *  @return True if every transaction was successfully read, false otherwise.
+         *
+         **/
+        bool ReadTx(const std::vector<uint512_t>& vHashes, std::vector<TAO::Ledger::Transaction> &vtx, const uint8_t nFlags = TAO::Ledger::FLAGS::BLOCK);
+
+
         /** EraseTx
          *
          *  Erases a transaction from the ledger DB.
@@ -482,6 +496,24 @@ namespace LLD
         bool ReadEvent(const uint256_t& hashAddress, const uint32_t nSequence, TAO::Ledger::Transaction &tx);
 
 
+        /** ReadEvents
+         *
+         *  Reads a range of events in order of their sequence, finding their transactions in
+         *  one read of the ordered keychain. Events written before the ordered keychain held
+         *  them are read one at a time and added to it.
+         *
+         *  @param[in] hashAddress The event address to read.
+         *  @param[in] nSequence The sequence number of the first event to read.
+         *  @param[in] nLimit The maximum events to read.
+         *  @param[out] vtx The transactions of the events, in order.
+         *
+         *  @return True if any events were read.
+         *
+         **/
+        bool ReadEvents(const uint256_t& hashAddress, const uint32_t nSequence, const uint32_t nLimit,
+            std::vector<TAO::Ledger::Transaction> &vtx);
+
+
         /** ReadLastEvent
          *
          *  Reads the last event (highest sequence number) for the sig chain / register
@@ -18,8 +18,8 @@ ________________________________________________________________________________
 #include <LLC/types/uint1024.h>
 
 #include <LLD/templates/sector.h>
-#include <LLD/cache/binary_lru.h>
-#include <LLD/keychain/hashmap.h>
+#include <LLD/cache/binary_2q.h>
+#include <LLD/keychain/keychain.h>
 
 #include <TAO/Register/types/state.h>
 
@@ -52,7 +52,7 @@ namespace LLD
      *  The database class for the Register Layer.
      *
      **/
-    class RegisterDB : public SectorDatabase<BinaryHashMap, BinaryLRU>
+    class RegisterDB : public SectorDatabase<Keychain, Binary2Q>
     {
         
         /** Memory mutex to lock when accessing internal memory states. **/
@@ -115,6 +115,21 @@ namespace LLD
         bool ReadState(const uint256_t& hashRegister, TAO::Register::State& state, const uint8_t nFlags = TAO::Ledger::FLAGS::BLOCK);
 
 
+        /** ReadState
+         *
+         *  Read a state register from the register database as of an open snapshot, without
+         *  waiting on blocks being connected. Memory pool states are not read.
+         *
+         *  @param[in] hashRegister The register address.
+         *  @param[out] state The state register to read.
+         *  @param[in] snapshot The snapshot from OpenSnapshot to read as of.
+         *
+         *  @return True if read was successful, false otherwise.
+         *
+         **/
+        bool ReadState(const uint256_t& hashRegister, TAO::Register::State& state, const Snapshot& snapshot);
+
+
         /** EraseState
          *
          *  Erase a state register from the register database.
@@ -12,6 +12,7 @@
 ____________________________________________________________________________________________*/
 
 
+#include <LLP/include/global.h>
 #include <LLP/types/apinode.h>
 #include <LLP/templates/events.h>
 
@@ -21,6 +22,7 @@ ________________________________________________________________________________
 #include <Util/include/string.h>
 #include <Util/include/urlencode.h>
 #include <Util/include/config.h>
+#include <Util/include/metrics.h>
 #include <Util/include/base64.h>
 
 namespace LLP
@@ -75,7 +77,7 @@ namespace LLP
     bool APINode::ProcessPacket()
     {
 
-        if(!Authorized(INCOMING.mapHeaders))
+        if(!Authorized(INCOMING.HEADERS))
         {
             debug::error(FUNCTION, "API incorrect password attempt from ", this->addr.ToString());
 
@@ -90,14 +92,62 @@ namespace LLP
             return false;
         }
 
+        /* Run the request on the API workers. */
+        return Dispatch(API_WORKERS);
+    }
+
+
+    /* Handle a request and build its response. */
+    bool APINode::Execute(HTTPPacket& REQUEST, HTTPPacket& RESPONSE, std::string& strMethod)
+    {
+        /* Reset the error log for this worker. */
+        debug::GetLastError();
+
         /* Parse the packet request. */
-        std::string::size_type npos = INCOMING.strRequest.find('/', 1);
+        std::string::size_type npos = REQUEST.strRequest.find('/', 1);
 
         /* Extract the API requested. */
-        std::string strAPI = INCOMING.strRequest.substr(1, npos - 1);
+        std::string strAPI = REQUEST.strRequest.substr(1, npos - 1);
 
         /* Extract the method to invoke. */
-        std::string METHOD = INCOMING.strRequest.substr(npos + 1);
+        std::string METHOD = REQUEST.strRequest.substr(npos + 1);
+
+        /* Serve the node metrics in the Prometheus text format for scrapers. */
+        if(strAPI == "metrics" && REQUEST.strType == "GET")
+        {
+            strMethod = "metrics";
+
+            RESPONSE = HTTPPacket(200);
+            RESPONSE.HEADERS.Set("Content-Type", "text/plain; version=0.0.4");
+            RESPONSE.strContent = metrics::Export();
+
+            return true;
+        }
+
+        /* Answer CORS preflight requests. */
+        if(REQUEST.strType == "OPTIONS")
+        {
+            strMethod = "options";
+
+            /* Build packet. */
+            RESPONSE = HTTPPacket(204);
+            if(REQUEST.HEADERS.Has("origin"))
+                RESPONSE.HEADERS.Set("Access-Control-Allow-Origin", REQUEST.HEADERS.Get("origin"));
+
+            /* Check for access methods. */
+            if(REQUEST.HEADERS.Has("access-control-request-method"))
+                RESPONSE.HEADERS.Set("Access-Control-Allow-Methods", "POST, GET, OPTIONS");
+
+            /* Check for access headers. */
+            if(REQUEST.HEADERS.Has("access-control-request-headers"))
+                RESPONSE.HEADERS.Set("Access-Control-Allow-Headers", REQUEST.HEADERS.Get("access-control-request-headers"));
+
+            /* Set conneciton headers. */
+            RESPONSE.HEADERS.Set("Access-Control-Max-Age", "86400");
+            RESPONSE.HEADERS.Set("Accept", "*/*");
+
+            return true;
+        }
 
         /* The JSON response */
         json::json ret;
@@ -105,9 +155,6 @@ namespace LLP
         /* The HTTP response status code, default to 200 unless an error is encountered */
         uint16_t nStatus = 200;
 
-        /* Flag indicating that the connection should be kept alive */
-        bool fKeepAlive = false;
-
         runtime::timer TIMER;
         TIMER.Start();
         uint32_t nStart = TIMER.ElapsedMilliseconds();
@@ -116,35 +163,35 @@ namespace LLP
         try
         {
             json::json params;
-            if(INCOMING.strType == "POST")
+            if(REQUEST.strType == "POST")
             {
                 /* Only parse content if some has been provided */
-                if(INCOMING.strContent.size() > 0)
+                if(REQUEST.strContent.size() > 0)
                 {
                     /* Handle different content types. */
-                    if(INCOMING.mapHeaders.count("content-type"))
+                    if(REQUEST.HEADERS.Has("content-type"))
                     {
                         /* Form encoding. */
-                        if(INCOMING.mapHeaders["content-type"] == "application/x-www-form-urlencoded")
+                        if(REQUEST.HEADERS.Get("content-type") == "application/x-www-form-urlencoded")
                         {
                             /* Decode if url-form-encoded. */
-                            INCOMING.strContent = encoding::urldecode(INCOMING.strContent);
+                            REQUEST.strContent = encoding::urldecode(REQUEST.strContent);
 
                             /* parse the querystring */
-                            params = QuerystringToJSON(INCOMING.strContent, METHOD);
+                            params = QuerystringToJSON(REQUEST.strContent, METHOD);
                         }
 
                         /* JSON encoding. */
-                        else if(INCOMING.mapHeaders["content-type"] == "application/json")
-                            params = json::json::parse(INCOMING.strContent);
+                        else if(REQUEST.HEADERS.Get("content-type") == "application/json")
+                            params = json::json::parse(REQUEST.strContent);
                         else
-                            throw TAO::API::APIException(-5, debug::safe_printstr("content-type ", INCOMING.mapHeaders["content-type"], " not supported"));
+                            throw TAO::API::APIException(-5, debug::safe_printstr("content-type ", REQUEST.HEADERS.Get("content-type"), " not supported"));
                     }
                     else
                         throw TAO::API::APIException(-6, "content-type not provided when content included");
                 }
             }
-            else if(INCOMING.strType == "GET")
+            else if(REQUEST.strType == "GET")
             {
                 /* Detect if it is url form encoding. */
                 std::string::size_type pos = METHOD.find("?");
@@ -160,62 +207,43 @@ namespace LLP
                     params = QuerystringToJSON(encoding::urldecode(strQuerystring), METHOD);
                 }
             }
-            else if(INCOMING.strType == "OPTIONS")
-            {
-                /* Build packet. */
-                HTTPPacket RESPONSE(204);
-                if(INCOMING.mapHeaders.count("origin"))
-                    RESPONSE.mapHeaders["Access-Control-Allow-Origin"] = INCOMING.mapHeaders["origin"];;
-
-                /* Check for access methods. */
-                if(INCOMING.mapHeaders.count("access-control-request-method"))
-                    RESPONSE.mapHeaders["Access-Control-Allow-Methods"] = "POST, GET, OPTIONS";
-
-                /* Check for access headers. */
-                if(INCOMING.mapHeaders.count("access-control-request-headers"))
-                    RESPONSE.mapHeaders["Access-Control-Allow-Headers"] = INCOMING.mapHeaders["access-control-request-headers"];
-
-                /* Set conneciton headers. */
-                RESPONSE.mapHeaders["Connection"]             = "keep-alive";
-                RESPONSE.mapHeaders["Access-Control-Max-Age"] = "86400";
-                //RESPONSE.mapHeaders["Content-Length"]         = "0";
-                RESPONSE.mapHeaders["Accept"]                 = "*/*";
-
-                /* Add content. */
-                this->WritePacket(RESPONSE);
-
-                return true;
-            }
 
-            /* Execute the api and methods. */
+            /* Find the api requested. */
+            TAO::API::Base* pAPI = nullptr;
             if(strAPI == "supply")
-                ret = { {"result", TAO::API::supply->Execute(METHOD, params) } };
+                pAPI = TAO::API::supply;
             else if(strAPI == "users")
-                ret = { {"result", TAO::API::users->Execute(METHOD, params) } };
+                pAPI = TAO::API::users;
             else if(strAPI == "assets")
-                ret = { {"result", TAO::API::assets->Execute(METHOD, params) } };
+                pAPI = TAO::API::assets;
             else if(strAPI == "ledger")
-                ret = { {"result", TAO::API::ledger->Execute(METHOD, params) } };
+                pAPI = TAO::API::ledger;
             else if(strAPI == "tokens")
-                ret = { {"result", TAO::API::tokens->Execute(METHOD, params) } };
+                pAPI = TAO::API::tokens;
             else if(strAPI == "system")
-                ret = { {"result", TAO::API::system->Execute(METHOD, params) } };
+                pAPI = TAO::API::system;
             else if(strAPI == "finance")
-                ret = { {"result", TAO::API::finance->Execute(METHOD, params) } };
+                pAPI = TAO::API::finance;
             else if(strAPI == "names")
-                ret = { {"result", TAO::API::names->Execute(METHOD, params) } };
+                pAPI = TAO::API::names;
             else if(strAPI == "dex")
-                ret = { {"result", TAO::API::dex->Execute(METHOD, params) } };
+                pAPI = TAO::API::dex;
             else if(strAPI == "voting")
-                ret = { {"result", TAO::API::voting->Execute(METHOD, params) } };
+                pAPI = TAO::API::voting;
             else if(strAPI == "invoices")
-                ret = { {"result", TAO::API::invoices->Execute(METHOD, params) } };
+                pAPI = TAO::API::invoices;
             else if(strAPI == "crypto")
-                ret = { {"result", TAO::API::crypto->Execute(METHOD, params) } };
+                pAPI = TAO::API::crypto;
             else if(strAPI == "p2p")
-                ret = { {"result", TAO::API::p2p->Execute(METHOD, params) } };
+                pAPI = TAO::API::p2p;
             else
                 throw TAO::API::APIException(-4, debug::safe_printstr("API not found: ", strAPI));
+
+            /* Label the request by its method, keeping unknown names out of the metrics. */
+            strMethod = strAPI + "/" + (pAPI->Supports(METHOD) ? METHOD : "other");
+
+            /* Execute the api and methods. */
+            ret = { {"result", pAPI->Execute(METHOD, params) } };
         }
 
         /* Handle for custom API exceptions. */
@@ -225,8 +253,8 @@ namespace LLP
             json::json jsonError = e.ToJSON();
 
             /* Check to see if the caller has specified an error code to use for general API errors */
-            if(INCOMING.mapHeaders.count("api-error-code"))
-                nStatus = std::stoi(INCOMING.mapHeaders["api-error-code"]);
+            if(REQUEST.HEADERS.Has("api-error-code"))
+                nStatus = std::stoi(REQUEST.HEADERS.Get("api-error-code"));
             else
                 /* Default error status code is 400. */
                 nStatus = 400;
@@ -259,51 +287,36 @@ namespace LLP
 
 
         /* Build packet. */
-        HTTPPacket RESPONSE(nStatus);
+        RESPONSE = HTTPPacket(nStatus);
 
         /* Add the origin header if supplied in the request */
-        if(INCOMING.mapHeaders.count("origin"))
-            RESPONSE.mapHeaders["Access-Control-Allow-Origin"] = INCOMING.mapHeaders["origin"];
-
-        /* Add the connection header */
-        if(INCOMING.mapHeaders.count("connection") && INCOMING.mapHeaders["connection"] == "keep-alive")
-        {
-            RESPONSE.mapHeaders["Connection"] = "keep-alive";
-            fKeepAlive = true;
-        }
-        else
-        {
-            RESPONSE.mapHeaders["Connection"] = "close";
-            fKeepAlive = true;
-        }
+        if(REQUEST.HEADERS.Has("origin"))
+            RESPONSE.HEADERS.Set("Access-Control-Allow-Origin", REQUEST.HEADERS.Get("origin"));
 
         /* Add content. */
         RESPONSE.strContent = ret.dump();
-            
-        /* Write the response */
-        this->WritePacket(RESPONSE);
 
         uint32_t nStop = TIMER.ElapsedMilliseconds();
                     
         debug::log(3, "API Request ", strAPI +"/" +METHOD, " from ", this->addr.ToString(), " completed in ", nStop - nStart, " milliseconds");
 
-
-        return fKeepAlive;
+        /* The connection header is set from the request once the response is sent. */
+        return true;
     }
 
 
-    bool APINode::Authorized(std::map<std::string, std::string>& mapHeaders)
+    bool APINode::Authorized(const HTTPHeaders& HEADERS)
     {
         /* Check for apiauth settings. */
         if(!config::GetBoolArg("-apiauth", true))
             return true;
 
         /* Check the headers. */
-        if(!mapHeaders.count("authorization"))
+        if(!HEADERS.Has("authorization"))
             return debug::error(FUNCTION, "no authorization in header");
 
 
-        std::string strAuth = mapHeaders["authorization"];
+        std::string strAuth = HEADERS.Get("authorization");
         if(strAuth.substr(0,6) != "Basic ")
             return debug::error(FUNCTION, "incorrect authorization type");
 
@@ -190,9 +190,17 @@ namespace LLP
     /*  Write a single packet to the TCP stream. */
     template <class PacketType>
     void BaseConnection<PacketType>::WritePacket(const PacketType& PACKET)
+    {
+        WritePacket(std::make_shared<const std::vector<uint8_t>>(PACKET.GetBytes()));
+    }
+
+
+    /*  Write a serialized packet to the TCP stream, sharing the buffer instead of copying it. */
+    template <class PacketType>
+    void BaseConnection<PacketType>::WritePacket(const SendBuffer& pBuffer)
     {
         /* Get the bytes of the packet. */
-        const std::vector<uint8_t> vBytes = PACKET.GetBytes();
+        const std::vector<uint8_t>& vBytes = *pBuffer;
 
         /* Stop sending packets if send buffer is full. */
         uint64_t nMaxSendBuffer = config::GetArg("-maxsendbuffer", MAX_SEND_BUFFER);
@@ -207,7 +215,7 @@ namespace LLP
                 PrintHex(vBytes);
 
             /* Write the packet to socket buffer. */
-            Write(vBytes, vBytes.size());
+            Write(pBuffer);
 
             /* Update packet count. */
             ++PACKETS;
@@ -15,6 +15,7 @@ ________________________________________________________________________________
 #include <LLP/templates/data.h>
 
 #include <LLP/templates/socket.h>
+#include <LLP/templates/wheel.h>
 
 #include <LLP/types/tritium.h>
 #include <LLP/types/time.h>
@@ -29,6 +30,10 @@ ________________________________________________________________________________
 namespace LLP
 {
 
+    /* The milliseconds between the checks of each connection. */
+    const uint32_t CHECK_INTERVAL = 100;
+
+
     /** Default Constructor **/
     template <class ProtocolType>
     DataThread<ProtocolType>::DataThread(uint32_t nID, bool ffDDOSIn,
@@ -43,8 +48,16 @@ namespace LLP
     , TIMEOUT         (nTimeout)
     , DDOS_rSCORE     (rScore)
     , DDOS_cSCORE     (cScore)
+    , PACKETS         (&metrics::GetCounter("nexus_llp_packets_total", "Packets received.",
+                            metrics::Label("server", ProtocolType::Name())))
+    , BYTES_RECEIVED  (&metrics::GetCounter("nexus_llp_received_bytes_total", "Bytes received.",
+                            metrics::Label("server", ProtocolType::Name())))
+    , BYTES_SENT      (&metrics::GetCounter("nexus_llp_sent_bytes_total", "Bytes sent.",
+                            metrics::Label("server", ProtocolType::Name())))
     , CONNECTIONS     (memory::atomic_ptr< std::vector<std::shared_ptr<ProtocolType>> >(new std::vector<std::shared_ptr<ProtocolType>>()))
     , RELAY           (memory::atomic_ptr< std::queue<std::pair<typename ProtocolType::message_t, DataStream>> >(new std::queue<std::pair<typename ProtocolType::message_t, DataStream>>()))
+    , POLLER          (config::GetBoolArg("-llppoll", false))
+    , ADDED           (memory::atomic_ptr< std::queue<uint32_t> >(new std::queue<uint32_t>()))
     , CONDITION       ( )
     , DATA_THREAD     (std::bind(&DataThread::Thread, this))
     , FLUSH_CONDITION ( )
@@ -68,6 +81,7 @@ namespace LLP
 
         CONNECTIONS.free();
         RELAY.free();
+        ADDED.free();
     }
 
 
@@ -103,10 +117,33 @@ namespace LLP
         /* The mutex for the condition. */
         std::mutex CONDITION_MUTEX;
 
-        /* This mirrors CONNECTIONS with pollfd settings for passing to poll methods.
-         * Windows throws SOCKET_ERROR intermittently if pass CONNECTIONS directly.
-         */
-        std::vector<pollfd> POLLFDS;
+        /* The timers of the connection checks, in ticks of 10 ms. */
+        TimerWheel WHEEL(10, 256, runtime::timestamp(true));
+
+        /* The tick each connection's check is due, to skip the timers of removed connections. */
+        std::vector<uint64_t> vChecks;
+
+        /* The connections that may have data to read, and if each slot is in the list. */
+        std::vector<uint32_t> vReady;
+        std::vector<uint32_t> vReading;
+        std::vector<bool> vListed;
+
+        /* The socket events and expired timers of each pass. */
+        std::vector<PollEvent> vEvents;
+        std::vector< std::pair<uint32_t, uint64_t> > vExpired;
+
+        /* Add a connection to the ready list if it isn't already. */
+        auto ready = [&vReady, &vListed](const uint32_t nIndex)
+        {
+            if(vListed.size() <= nIndex)
+                vListed.resize(nIndex + 1, false);
+
+            if(!vListed[nIndex])
+            {
+                vListed[nIndex] = true;
+                vReady.push_back(nIndex);
+            }
+        };
 
         /* The main connection handler loop. */
         while(!fDestruct.load() && !config::fShutdown.load())
@@ -133,61 +170,32 @@ namespace LLP
             if(fDestruct.load() || config::fShutdown.load())
                 return;
 
-            /* Wrapped mutex lock. */
-            uint32_t nSize = static_cast<uint32_t>(CONNECTIONS->size());
-
-            /* Check the pollfd's size. */
-            if(POLLFDS.size() != nSize)
-                POLLFDS.resize(nSize);
-
-            /* Initialize the revents for all connection pollfd structures.
-            * One connection must be live, so verify that and skip if none
-            */
-            for(uint32_t nIndex = 0; nIndex < nSize; ++nIndex)
+            /* Schedule the checks of new connections, and read anything sent before their sockets were added. */
+            while(!ADDED->empty())
             {
-                try
-                {
-                    /* Set the proper POLLIN flags. */
-                    POLLFDS.at(nIndex).events  = POLLIN;// | POLLRDHUP;
-                    POLLFDS.at(nIndex).revents = 0; //reset return events
-
-                    /* Set to invalid socket if connection is inactive. */
-                    if(!CONNECTIONS->at(nIndex))
-                    {
-                        POLLFDS.at(nIndex).fd = INVALID_SOCKET;
+                const uint32_t nIndex = ADDED->front();
+                ADDED->pop();
 
-                        continue;
-                    }
+                if(vChecks.size() <= nIndex)
+                    vChecks.resize(nIndex + 1, 0);
 
-                    /* Set the correct file descriptor. */
-                    POLLFDS.at(nIndex).fd = CONNECTIONS->at(nIndex)->fd;
-                }
-                catch(const std::exception& e)
-                {
-                    debug::error(FUNCTION, e.what());
-                }
+                vChecks[nIndex] = WHEEL.Schedule(nIndex, CHECK_INTERVAL, runtime::timestamp(true));
+                ready(nIndex);
             }
 
-            /* Poll the sockets. */
-#ifdef WIN32
-            int32_t nPoll = WSAPoll((pollfd*)&POLLFDS[0], nSize, 100);
-#else
-            int32_t nPoll = poll((pollfd*)&POLLFDS[0], nSize, 100);
-#endif
-
-            /* Check poll for available sockets. */
-            if(nPoll < 0)
+            /* Wait for sockets with data, without blocking while connections are still being read. */
+            const uint64_t nTimeout = vReady.empty() ? WHEEL.Timeout(runtime::timestamp(true), CHECK_INTERVAL) : 0;
+            if(POLLER.Wait(vEvents, static_cast<uint32_t>(nTimeout)) < 0)
             {
                 runtime::sleep(1);
                 continue;
             }
 
-
-            /* Check all connections for data and packets. */
-            for(uint32_t nIndex = 0; nIndex < nSize; ++nIndex)
+            /* Handle the events of the sockets that are ready. */
+            for(const PollEvent& event : vEvents)
             {
                 /* Access the shared pointer. */
-                std::shared_ptr<ProtocolType> CONNECTION = CONNECTIONS->at(nIndex);
+                std::shared_ptr<ProtocolType> CONNECTION = CONNECTIONS->at(event.nIndex);
                 try
                 {
                     /* Skip over Inactive Connections. */
@@ -195,116 +203,78 @@ namespace LLP
                         continue;
 
                     /* Disconnect if there was a polling error */
-                    if(POLLFDS.at(nIndex).revents & POLLERR)
+                    if(event.nFlags & POLL::FAILED)
                     {
-                         remove_connection_with_event(nIndex, DISCONNECT::POLL_ERROR);
-                         continue;
+                        remove_connection_with_event(event.nIndex, DISCONNECT::POLL_ERROR);
+                        continue;
                     }
 
                     /* Disconnect if the socket was disconnected by peer (need for Windows) */
-                    if(POLLFDS.at(nIndex).revents & POLLHUP)
+                    if(event.nFlags & POLL::CLOSED)
                     {
-                        remove_connection_with_event(nIndex, DISCONNECT::PEER);
+                        remove_connection_with_event(event.nIndex, DISCONNECT::PEER);
                         continue;
                     }
 
-                    /* Remove Connection if it has Timed out or had any read/write Errors. */
-                    if(CONNECTION->Errors())
+                    /* Read what the peer sent before it stopped sending, then disconnect. */
+                    if(event.nFlags & POLL::SHUTDOWN)
                     {
-                        remove_connection_with_event(nIndex, DISCONNECT::ERRORS);
-                        continue;
-                    }
+                        while(read_connection(event.nIndex));
+
+                        if(CONNECTIONS->at(event.nIndex) == CONNECTION)
+                            remove_connection_with_event(event.nIndex, DISCONNECT::PEER);
 
-                    /* Remove Connection if it has Timed out or had any Errors. */
-                    if(CONNECTION->Timeout(TIMEOUT * 1000, Socket::READ))
-                    {
-                        remove_connection_with_event(nIndex, DISCONNECT::TIMEOUT);
                         continue;
                     }
 
                     /* Disconnect if pollin signaled with no data (This happens on Linux). */
-                    if((POLLFDS.at(nIndex).revents & POLLIN)
+                    if(!POLLER.EdgeTriggered() && (event.nFlags & POLL::READABLE)
                     && CONNECTION->Available() == 0 && !CONNECTION->IsSSL())
                     {
-                        remove_connection_with_event(nIndex, DISCONNECT::POLL_EMPTY);
-                        continue;
-                    }
-
-                    /* Disconnect if buffer is full and remote host isn't reading at all. */
-                    if(CONNECTION->Buffered()
-                    && CONNECTION->Timeout(15000, Socket::WRITE))
-                    {
-                        remove_connection_with_event(nIndex, DISCONNECT::TIMEOUT_WRITE);
-                        continue;
-                    }
-
-                    /* Check that write buffers aren't overflowed. */
-                    if(CONNECTION->Buffered() > config::GetArg("-maxsendbuffer", MAX_SEND_BUFFER))
-                    {
-                        remove_connection_with_event(nIndex, DISCONNECT::BUFFER);
+                        remove_connection_with_event(event.nIndex, DISCONNECT::POLL_EMPTY);
                         continue;
                     }
 
-                    /* Handle any DDOS Filters. */
-                    if(fDDOS.load() && CONNECTION->DDOS)
-                    {
-                        /* Ban a node if it has too many Requests per Second. **/
-                        if(CONNECTION->DDOS->rSCORE.Score() > DDOS_rSCORE
-                        || CONNECTION->DDOS->cSCORE.Score() > DDOS_cSCORE)
-                            CONNECTION->DDOS->Ban();
-
-                        /* Remove a connection if it was banned by DDOS Protection. */
-                        if(CONNECTION->DDOS->Banned())
-                        {
-                            debug::log(0, ProtocolType::Name(), " BANNED: ", CONNECTION->GetAddress().ToString());
-                            remove_connection_with_event(nIndex, DISCONNECT::DDOS);
-                            continue;
-                        }
-                    }
-
-                    /* Generic event for Connection. */
-                    CONNECTION->Event(EVENTS::GENERIC);
-
-                    /* Work on Reading a Packet. **/
-                    CONNECTION->ReadPacket();
-
-                    /* If a Packet was received successfully, increment request count [and DDOS count if enabled]. */
-                    if(CONNECTION->PacketComplete())
-                    {
-                        /* Debug dump of message type. */
-                        if(config::nVerbose.load() >= 4)
-                            debug::log(4, FUNCTION, "Received Message (", CONNECTION->INCOMING.GetBytes().size(), " bytes)");
-
-                        /* Debug dump of packet data. */
-                        if(config::nVerbose.load() >= 5)
-                            PrintHex(CONNECTION->INCOMING.GetBytes());
-
-                        /* Handle Meters and DDOS. */
-                        if(fMETER)
-                            ++ProtocolType::REQUESTS;
-
-                        /* Increment rScore. */
-                        if(fDDOS.load() && CONNECTION->DDOS)
-                            CONNECTION->DDOS->rSCORE += 1;
-
-                        /* Packet Process return value of False will flag Data Thread to Disconnect. */
-                        if(!CONNECTION->ProcessPacket())
-                        {
-                            remove_connection_with_event(nIndex, DISCONNECT::FORCE);
-                            continue;
-                        }
-
-                        /* Run procssed event for connection triggers. */
-                        CONNECTION->Event(EVENTS::PROCESSED);
-                        CONNECTION->ResetPacket();
-                    }
+                    ready(event.nIndex);
                 }
                 catch(const std::exception& e)
                 {
                     debug::error(FUNCTION, "Data Connection: ", e.what());
-                    remove_connection_with_event(nIndex, DISCONNECT::ERRORS);
+                    remove_connection_with_event(event.nIndex, DISCONNECT::ERRORS);
                 }
             }
+
+            /* Read a packet from each connection with data, keeping the ones that may have more. */
+            vReading.swap(vReady);
+            vReady.clear();
+            for(const uint32_t nIndex : vReading)
+            {
+                vListed[nIndex] = false;
+                if(read_connection(nIndex))
+                    ready(nIndex);
+            }
+
+            /* Check the connections whose timers are due. */
+            const uint64_t nNow = runtime::timestamp(true);
+            WHEEL.Expire(nNow, vExpired);
+            for(const auto& timer : vExpired)
+            {
+                /* Skip the timers of removed connections. */
+                const uint32_t nIndex = timer.first;
+                if(vChecks[nIndex] != timer.second)
+                    continue;
+
+                /* Connections that were removed or closed aren't checked again. */
+                if(!check_connection(nIndex))
+                    continue;
+
+                vChecks[nIndex] = WHEEL.Schedule(nIndex, CHECK_INTERVAL, nNow);
+
+                /* Read connections with data left, in case their socket isn't reported again. */
+                std::shared_ptr<ProtocolType> CONNECTION = CONNECTIONS->at(nIndex);
+                if(CONNECTION && CONNECTION->Available() > 0)
+                    ready(nIndex);
+            }
         }
     }
 
@@ -376,15 +346,15 @@ namespace LLP
                 RELAY->pop();
             }
 
+            /* Prepare the relay once for every connection. */
+            typename ProtocolType::Relay RELAYING(qRelay.first, qRelay.second);
+
             /* Check all connections for data and packets. */
             uint32_t nSize = CONNECTIONS->size();
             for(uint32_t nIndex = 0; nIndex < nSize; ++nIndex)
             {
                 try
                 {
-                    /* Reset stream read position. */
-                    qRelay.second.Reset();
-
                     /* Get shared pointer to prevent race condition on the internal connection pointer. */
                     std::shared_ptr<ProtocolType> CONNECTION = CONNECTIONS->at(nIndex);
 
@@ -393,15 +363,11 @@ namespace LLP
                         continue;
 
                     /* Relay if there are active subscriptions. */
-                    const DataStream ssRelay = CONNECTION->RelayFilter(qRelay.first, qRelay.second);
-                    if(ssRelay.size() != 0)
+                    if(qRelay.second.size() != 0)
                     {
-                        /* Build the sender packet. */
-                        typename ProtocolType::packet_t PACKET = typename ProtocolType::packet_t(qRelay.first);
-                        PACKET.SetData(ssRelay);
-
-                        /* Write packet to socket. */
-                        CONNECTION->WritePacket(PACKET);
+                        const SendBuffer pRelay = CONNECTION->RelayFilter(RELAYING);
+                        if(pRelay)
+                            CONNECTION->WritePacket(pRelay);
                     }
 
                     /* Attempt to flush data when buffer is available. */
@@ -471,12 +437,153 @@ namespace LLP
         else
             --nOutbound;
 
+        /* Stop waiting on the socket, as its descriptor may be reused once it is closed. */
+        POLLER.Remove(CONNECTIONS->at(nIndex)->fd);
+
         /* Free the memory and notify threads. */
         CONNECTIONS->at(nIndex) = nullptr;
         CONDITION.notify_all();
     }
 
 
+    /* Read a packet from a connection with data, and process it. */
+    template <class ProtocolType>
+    bool DataThread<ProtocolType>::read_connection(const uint32_t nIndex)
+    {
+        /* Access the shared pointer. */
+        std::shared_ptr<ProtocolType> CONNECTION = CONNECTIONS->at(nIndex);
+        try
+        {
+            /* Skip over Inactive Connections. */
+            if(!CONNECTION || !CONNECTION->Connected())
+                return false;
+
+            /* Work on Reading a Packet. **/
+            const int32_t nAvailable = CONNECTION->Available();
+            CONNECTION->ReadPacket();
+
+            /* If a Packet was received successfully, increment request count [and DDOS count if enabled]. */
+            if(CONNECTION->PacketComplete())
+            {
+                /* Debug dump of message type. */
+                if(config::nVerbose.load() >= 4)
+                    debug::log(4, FUNCTION, "Received Message (", CONNECTION->INCOMING.GetBytes().size(), " bytes)");
+
+                /* Debug dump of packet data. */
+                if(config::nVerbose.load() >= 5)
+                    PrintHex(CONNECTION->INCOMING.GetBytes());
+
+                /* Handle Meters and DDOS. */
+                if(fMETER)
+                    ++ProtocolType::REQUESTS;
+
+                PACKETS->Add();
+
+                /* Increment rScore. */
+                if(fDDOS.load() && CONNECTION->DDOS)
+                    CONNECTION->DDOS->rSCORE += 1;
+
+                /* Packet Process return value of False will flag Data Thread to Disconnect. */
+                if(!CONNECTION->ProcessPacket())
+                {
+                    remove_connection_with_event(nIndex, DISCONNECT::FORCE);
+                    return false;
+                }
+
+                /* Run procssed event for connection triggers. */
+                CONNECTION->Event(EVENTS::PROCESSED);
+                CONNECTION->ResetPacket();
+
+                return true;
+            }
+
+            /* Keep reading while the packet takes more of the data. */
+            const int32_t nRemaining = CONNECTION->Available();
+            return (nRemaining > 0 && nRemaining < nAvailable);
+        }
+        catch(const std::exception& e)
+        {
+            debug::error(FUNCTION, "Data Connection: ", e.what());
+            remove_connection_with_event(nIndex, DISCONNECT::ERRORS);
+        }
+
+        return false;
+    }
+
+
+    /* Check a connection for errors, timeouts and DDOS, and fire its generic event. */
+    template <class ProtocolType>
+    bool DataThread<ProtocolType>::check_connection(const uint32_t nIndex)
+    {
+        /* Access the shared pointer. */
+        std::shared_ptr<ProtocolType> CONNECTION = CONNECTIONS->at(nIndex);
+        try
+        {
+            /* Skip over Inactive Connections. */
+            if(!CONNECTION || !CONNECTION->Connected())
+                return false;
+
+            /* Remove Connection if it has Timed out or had any read/write Errors. */
+            if(CONNECTION->Errors())
+            {
+                remove_connection_with_event(nIndex, DISCONNECT::ERRORS);
+                return false;
+            }
+
+            /* Remove Connection if it has Timed out or had any Errors. */
+            if(CONNECTION->Timeout(TIMEOUT * 1000, Socket::READ))
+            {
+                remove_connection_with_event(nIndex, DISCONNECT::TIMEOUT);
+                return false;
+            }
+
+            /* Disconnect if buffer is full and remote host isn't reading at all. */
+            if(CONNECTION->Buffered()
+            && CONNECTION->Timeout(15000, Socket::WRITE))
+            {
+                remove_connection_with_event(nIndex, DISCONNECT::TIMEOUT_WRITE);
+                return false;
+            }
+
+            /* Check that write buffers aren't overflowed. */
+            if(CONNECTION->Buffered() > config::GetArg("-maxsendbuffer", MAX_SEND_BUFFER))
+            {
+                remove_connection_with_event(nIndex, DISCONNECT::BUFFER);
+                return false;
+            }
+
+            /* Handle any DDOS Filters. */
+            if(fDDOS.load() && CONNECTION->DDOS)
+            {
+                /* Ban a node if it has too many Requests per Second. **/
+                if(CONNECTION->DDOS->rSCORE.Score() > DDOS_rSCORE
+                || CONNECTION->DDOS->cSCORE.Score() > DDOS_cSCORE)
+                    CONNECTION->DDOS->Ban();
+
+                /* Remove a connection if it was banned by DDOS Protection. */
+                if(CONNECTION->DDOS->Banned())
+                {
+                    debug::log(0, ProtocolType::Name(), " BANNED: ", CONNECTION->GetAddress().ToString());
+                    remove_connection_with_event(nIndex, DISCONNECT::DDOS);
+                    return false;
+                }
+            }
+
+            /* Generic event for Connection. */
+            CONNECTION->Event(EVENTS::GENERIC);
+
+            return true;
+        }
+        catch(const std::exception& e)
+        {
+            debug::error(FUNCTION, "Data Connection: ", e.what());
+            remove_connection_with_event(nIndex, DISCONNECT::ERRORS);
+        }
+
+        return false;
+    }
+
+
     /* Returns the index of a component of the CONNECTIONS vector that has been flagged Disconnected */
     template <class ProtocolType>
     uint32_t DataThread<ProtocolType>::find_slot()
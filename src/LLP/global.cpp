@@ -27,6 +27,11 @@ namespace LLP
     Server<P2PNode>*  P2P_SERVER;
 
 
+    /* Declare the Global Worker Pools for HTTP requests. */
+    WorkerPool*          API_WORKERS = nullptr;
+    WorkerPool*          RPC_WORKERS = nullptr;
+
+
     /* Current session identifier. */
     const uint64_t SESSION_ID = LLC::GetRand();
 
@@ -51,12 +56,32 @@ namespace LLP
         /* Shutdown the tritium server and its subsystems. */
         Shutdown<TritiumNode>(TRITIUM_SERVER);
 
+        /* Finish the running HTTP requests while their servers still exist. */
+        if(API_WORKERS)
+            API_WORKERS->Stop();
+
+        if(RPC_WORKERS)
+            RPC_WORKERS->Stop();
+
         /* Shutdown the core API server and its subsystems. */
         Shutdown<APINode>(API_SERVER);
 
         /* Shutdown the RPC server and its subsystems. */
         Shutdown<RPCNode>(RPC_SERVER);
 
+        /* Free the HTTP workers once their servers can't dispatch to them. */
+        if(API_WORKERS)
+        {
+            delete API_WORKERS;
+            API_WORKERS = nullptr;
+        }
+
+        if(RPC_WORKERS)
+        {
+            delete RPC_WORKERS;
+            RPC_WORKERS = nullptr;
+        }
+
         /* Shutdown the mining server and its subsystems. */
         Shutdown<Miner>(MINING_SERVER);
 
@@ -254,6 +279,10 @@ namespace LLP
         /* Require SSL if configured */
         config.fSSLRequired = config::GetBoolArg(std::string("-rpcsslrequired"), false);
 
+        /* Workers to run the requests, with the most requests that can wait for them. */
+        RPC_WORKERS = new WorkerPool(static_cast<uint32_t>(config::GetArg(std::string("-rpcworkers"), std::thread::hardware_concurrency())),
+                                     static_cast<uint64_t>(config::GetArg(std::string("-rpcqueue"), 1000)));
+
         /* Instantiate the RPC server */
         return new LLP::Server<LLP::RPCNode>(config);
     }
@@ -306,6 +335,10 @@ namespace LLP
         /* Require SSL if configured */
         config.fSSLRequired = config::GetBoolArg(std::string("-apisslrequired"), false);
 
+        /* Workers to run the requests, with the most requests that can wait for them. */
+        API_WORKERS = new WorkerPool(static_cast<uint32_t>(config::GetArg(std::string("-apiworkers"), std::thread::hardware_concurrency())),
+                                     static_cast<uint64_t>(config::GetArg(std::string("-apiqueue"), 1000)));
+
         /* Instantiate the API server */
         return new LLP::Server<LLP::APINode>(config);
     }
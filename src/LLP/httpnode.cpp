@@ -15,8 +15,11 @@ ________________________________________________________________________________
 #include <LLP/templates/ddos.h>
 
 #include <Util/include/string.h>
+#include <Util/include/metrics.h>
+#include <Util/include/workers.h>
 
 #include <algorithm>
+#include <cstring>
 
 namespace LLP
 {
@@ -25,6 +28,11 @@ namespace LLP
     HTTPNode::HTTPNode()
     : BaseConnection<HTTPPacket> ( )
     , vchBuffer                  ( )
+    , nBufferPos                 (0)
+    , fHeaderDump                (config::GetBoolArg("-httpheader"))
+    , REQUEST_MUTEX              ( )
+    , qRequests                  ( )
+    , fExecuting                 (false)
     {
     }
 
@@ -33,6 +41,11 @@ namespace LLP
     HTTPNode::HTTPNode(const Socket &SOCKET_IN, DDOS_Filter* DDOS_IN, bool fDDOSIn)
     : BaseConnection<HTTPPacket> (SOCKET_IN, DDOS_IN, fDDOSIn)
     , vchBuffer                  ( )
+    , nBufferPos                 (0)
+    , fHeaderDump                (config::GetBoolArg("-httpheader"))
+    , REQUEST_MUTEX              ( )
+    , qRequests                  ( )
+    , fExecuting                 (false)
     {
     }
 
@@ -41,6 +54,11 @@ namespace LLP
     HTTPNode::HTTPNode(DDOS_Filter* DDOS_IN, bool fDDOSIn)
     : BaseConnection<HTTPPacket> (DDOS_IN, fDDOSIn)
     , vchBuffer                  ( )
+    , nBufferPos                 (0)
+    , fHeaderDump                (config::GetBoolArg("-httpheader"))
+    , REQUEST_MUTEX              ( )
+    , qRequests                  ( )
+    , fExecuting                 (false)
     {
     }
 
@@ -64,98 +82,95 @@ namespace LLP
     /*  Non-Blocking Packet reader to build a packet from TCP Connection. */
     void HTTPNode::ReadPacket()
     {
-        if(!INCOMING.Complete())
+        if(INCOMING.Complete())
+            return;
+
+        /* Handle Reading Data into Buffer. */
+        uint32_t nAvailable = Available();
+        if(nAvailable > 0)
         {
-            /* Handle Reading Data into Buffer. */
-            uint32_t nAvailable = Available();
-            if(nAvailable > 0)
-            {                
-                std::vector<int8_t> vchData(nAvailable);
-                int nRead = Read(vchData, nAvailable);
-                if(nRead > 0)
-                    vchBuffer.insert(vchBuffer.end(), vchData.begin(), vchData.begin() + nRead);
-            }
+            std::vector<int8_t> vchData(nAvailable);
+            int nRead = Read(vchData, nAvailable);
+            if(nRead > 0)
+                vchBuffer.insert(vchBuffer.end(), vchData.begin(), vchData.begin() + nRead);
+        }
 
-            /* If waiting for buffer data, don't try to parse. */
-            if(vchBuffer.size() == 0)
+        /* Parse the header a line at a time, straight from the buffer. */
+        const char* pBuffer = reinterpret_cast<const char*>(vchBuffer.data());
+        while(!INCOMING.fHeader && nBufferPos < vchBuffer.size())
+        {
+            /* Return if a full line hasn't been read yet. */
+            const char* pLine = pBuffer + nBufferPos;
+            const char* pEnd  = static_cast<const char*>(std::memchr(pLine, '\n', vchBuffer.size() - nBufferPos));
+            if(!pEnd)
                 return;
 
-            /* Allow up to 10 iterations to parse the header. */
-            for(int i = 0; i < 10; ++i)
-            {
-                /* Read content if there is some. */
-                if(INCOMING.fHeader)
-                {
-                    INCOMING.strContent += std::string(vchBuffer.begin(), vchBuffer.end());
-                    vchBuffer.clear();
-                    return;
-                }
-
-                /* Break out the lines by the input buffer. */
-                auto it = std::find(vchBuffer.begin(), vchBuffer.end(), '\n');
-
-                /* Return if a full line hasn't been read yet. */
-                if(it == vchBuffer.end())
-                    return;
-
-                /* Check for the end of header with double CLRF. */
-                if(vchBuffer.begin() == (it - 1))
-                {
-                    INCOMING.fHeader = true;
-
-                    vchBuffer.erase(vchBuffer.begin(), it + 1); //erase the CLRF
-                    //this->Event()
-                    //TODO: assess the events code and calling virutal method from lower class in the inheritance heirarchy
-                }
+            /* Move past the line, then drop its line ending. */
+            nBufferPos += (pEnd - pLine) + 1;
+            if(pEnd > pLine && *(pEnd - 1) == '\r')
+                --pEnd;
 
-                /* Read all the headers. */
-                else if(!INCOMING.fHeader)
-                {
-                    /* Extract the line from the buffer. */
-                    std::string strLine = std::string(vchBuffer.begin(), it - 1);
+            /* Dump the header if requested on read. */
+            if(fHeaderDump)
+                debug::log(0, std::string(pLine, pEnd));
 
-                    /* Dump the header if requested on read. */
-                    if(config::GetBoolArg("-httpheader"))
-                        debug::log(0, strLine);
+            /* Check for the end of header with an empty line. */
+            if(pLine == pEnd)
+            {
+                /* Skip empty lines kept alive between requests. */
+                if(INCOMING.strType.empty())
+                    continue;
 
-                    /* Find the delimiter to split. */
-                    std::string::size_type pos = strLine.find(':', 0);
+                /* Parse out the content length field. */
+                if(INCOMING.HEADERS.Has("content-length"))
+                    INCOMING.nContentLength = std::stoul(INCOMING.HEADERS.Get("content-length"));
 
-                    /* Handle the request types. */
-                    if(INCOMING.strType == "")
-                    {
-                        /* Find the end of request type. */
-                        std::string::size_type npos = strLine.find(' ', 0);
-                        INCOMING.strType = strLine.substr(0, npos);
+                INCOMING.fHeader = true;
+                break;
+            }
 
-                        /* Find the start of version. */
-                        std::string::size_type npos2 = strLine.find(' ', npos + 1);
-                        INCOMING.strVersion = strLine.substr(npos2 + 1);
+            /* Handle the request line. */
+            if(INCOMING.strType.empty())
+            {
+                const std::string strLine(pLine, pEnd);
 
-                        /* Parse request from between the two. */
-                        INCOMING.strRequest = strLine.substr(npos + 1, npos2 - INCOMING.strType.length() - 1);
+                /* Find the end of request type. */
+                std::string::size_type npos = strLine.find(' ', 0);
+                INCOMING.strType = strLine.substr(0, npos);
 
-                    }
+                /* Find the start of version. */
+                std::string::size_type npos2 = strLine.find(' ', npos + 1);
+                INCOMING.strVersion = strLine.substr(npos2 + 1);
 
-                    /* Handle normal headers. */
-                    else if(pos != std::string::npos)
-                    {
-                        /* Set the field value to lowercase. */
-                        std::string strField = ToLower(strLine.substr(0, pos));
+                /* Parse request from between the two. */
+                INCOMING.strRequest = strLine.substr(npos + 1, npos2 - INCOMING.strType.length() - 1);
+            }
 
-                        /* Parse out the content length field. */
-                        if(strField == "content-length")
-                            INCOMING.nContentLength = std::stoul(strLine.substr(pos + 2));
+            /* Handle normal headers. */
+            else
+                INCOMING.HEADERS.Parse(pLine, pEnd - pLine);
+        }
 
-                        /* Add line to the headers map. */
-                        INCOMING.mapHeaders[strField] = strLine.substr(pos + 2);
+        /* Take only this request's content, leaving any pipelined requests after it in the buffer. */
+        if(INCOMING.fHeader && INCOMING.nContentLength > INCOMING.strContent.size())
+        {
+            const uint64_t nContent = std::min(static_cast<uint64_t>(INCOMING.nContentLength - INCOMING.strContent.size()),
+                                               static_cast<uint64_t>(vchBuffer.size() - nBufferPos));
 
-                    }
+            INCOMING.strContent.append(pBuffer + nBufferPos, nContent);
+            nBufferPos += nContent;
+        }
 
-                    /* Erase line read from the read buffer. */
-                    vchBuffer.erase(vchBuffer.begin(), it + 1);
-                }
-            }
+        /* Drop what was parsed once the request is complete, or the whole buffer once it is all read. */
+        if(nBufferPos == vchBuffer.size())
+        {
+            vchBuffer.clear();
+            nBufferPos = 0;
+        }
+        else if(INCOMING.Complete())
+        {
+            vchBuffer.erase(vchBuffer.begin(), vchBuffer.begin() + nBufferPos);
+            nBufferPos = 0;
         }
     }
 
@@ -177,4 +192,141 @@ namespace LLP
         }
     }
 
+
+    /* Run the incoming packet as a request on a worker pool, after the earlier requests of this connection. */
+    bool HTTPNode::Dispatch(WorkerPool* pWorkers)
+    {
+        /* Run the request now without a pool. */
+        if(!pWorkers)
+            return execute(INCOMING, 0);
+
+        /* Queue the request, starting the clock on its wait. */
+        {
+            LOCK(REQUEST_MUTEX);
+
+            runtime::timer TIMER;
+            TIMER.Start();
+            qRequests.push(std::make_pair(INCOMING, TIMER));
+
+            /* The running request submits the next one when it is done. */
+            if(fExecuting)
+                return true;
+
+            fExecuting = true;
+        }
+
+        submit(pWorkers);
+
+        return true;
+    }
+
+
+    /* Queue the next dispatched request of this connection on a worker pool. */
+    void HTTPNode::submit(WorkerPool* pWorkers)
+    {
+        /* Hold the connection weakly, so a queued request doesn't keep a closed connection alive. */
+        std::weak_ptr<HTTPNode> pWeak = shared_from_this();
+        const bool fQueued = pWorkers->Submit([pWeak, pWorkers]
+        {
+            std::shared_ptr<HTTPNode> pNode = pWeak.lock();
+            if(!pNode)
+                return;
+
+            /* Take the oldest request. */
+            std::pair<HTTPPacket, runtime::timer> REQUEST;
+            {
+                LOCK(pNode->REQUEST_MUTEX);
+
+                REQUEST = std::move(pNode->qRequests.front());
+                pNode->qRequests.pop();
+            }
+
+            /* Close the connection once the response is sent, unless it is still being sent. */
+            if(!pNode->execute(REQUEST.first, REQUEST.second.ElapsedMicroseconds()) && !pNode->Buffered())
+                pNode->Disconnect();
+
+            /* Submit the next request, or let the next dispatch do it. */
+            {
+                LOCK(pNode->REQUEST_MUTEX);
+
+                if(!pNode->Connected())
+                    pNode->qRequests = std::queue< std::pair<HTTPPacket, runtime::timer> >();
+
+                if(pNode->qRequests.empty())
+                {
+                    pNode->fExecuting = false;
+                    return;
+                }
+            }
+
+            pNode->submit(pWorkers);
+        });
+
+        if(fQueued)
+            return;
+
+        /* Turn the requests away while the pool is full. Nothing of this connection is running, so they are answered in order. */
+        static metrics::Counter& REJECTED = metrics::GetCounter("nexus_http_rejected_total",
+            "HTTP requests answered with 503 because the worker queue was full.");
+
+        LOCK(REQUEST_MUTEX);
+        while(!qRequests.empty())
+        {
+            PushResponse(503, "");
+            REJECTED.Add();
+
+            qRequests.pop();
+        }
+
+        fExecuting = false;
+    }
+
+
+    /* Run a request, send its response, and record its latency. */
+    bool HTTPNode::execute(HTTPPacket& REQUEST, const uint64_t nQueued)
+    {
+        runtime::timer TIMER;
+        TIMER.Start();
+
+        /* Build the response, answering with an error if the request failed outside of the API. */
+        HTTPPacket RESPONSE;
+        std::string strMethod = "other";
+
+        bool fKeepAlive = true;
+        try
+        {
+            fKeepAlive = Execute(REQUEST, RESPONSE, strMethod);
+        }
+        catch(const std::exception& e)
+        {
+            debug::error(FUNCTION, "HTTP request failed: ", e.what());
+
+            RESPONSE   = HTTPPacket(500);
+            fKeepAlive = false;
+        }
+
+        /* Keep the connection open if both the request and the handler allow it. */
+        fKeepAlive = fKeepAlive && REQUEST.KeepAlive();
+        RESPONSE.HEADERS.Set("Connection", fKeepAlive ? "keep-alive" : "close");
+
+        /* Send large content in chunks to clients that can read them. */
+        static const uint32_t nChunkSize = static_cast<uint32_t>(config::GetArg("-httpchunksize", 64 * 1024));
+        if(nChunkSize > 0 && RESPONSE.strContent.size() > nChunkSize && REQUEST.strVersion == "HTTP/1.1")
+        {
+            for(const auto& pChunk : RESPONSE.GetChunks(nChunkSize))
+                this->WritePacket(pChunk);
+        }
+        else
+            this->WritePacket(RESPONSE);
+
+        /* Record the wait and run time by method. */
+        const std::string strLabels = metrics::Label("method", strMethod);
+        metrics::GetHistogram("nexus_http_queue_microseconds", "Time HTTP requests waited for a worker.",
+            metrics::LATENCY_BOUNDS, strLabels).Observe(nQueued);
+        metrics::GetHistogram("nexus_http_request_microseconds", "Time to run HTTP requests.",
+            metrics::LATENCY_BOUNDS, strLabels).Observe(TIMER.ElapsedMicroseconds());
+
+        return fKeepAlive;
+    }
+
 }
@@ -25,6 +25,8 @@ ________________________________________________________________________________
 #include <LLP/types/miner.h>
 #include <LLP/types/p2p.h>
 
+#include <Util/include/workers.h>
+
 namespace LLP
 {
     extern Server<TritiumNode>*  TRITIUM_SERVER;
@@ -35,6 +37,11 @@ namespace LLP
     extern Server<P2PNode>*      P2P_SERVER;
 
 
+    /** Worker pools to run the API and RPC requests, so slow requests don't hold up reading other connections. **/
+    extern WorkerPool*           API_WORKERS;
+    extern WorkerPool*           RPC_WORKERS;
+
+
     /** Current session identifier. **/
     const extern uint64_t SESSION_ID;
 
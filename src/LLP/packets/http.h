@@ -18,12 +18,268 @@ ________________________________________________________________________________
 
 #include <Util/include/runtime.h>
 #include <Util/include/debug.h>
+#include <Util/templates/datastream.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <memory>
 #include <vector>
-#include <map>
 
 namespace LLP
 {
 
+    /** HTTPHeaders
+     *
+     *  The header fields of a HTTP packet.
+     *
+     *  The names and values of all fields are stored back to back in one string, with
+     *  the position of each field kept in a list, so reading a header doesn't allocate
+     *  for each field. Names are matched without regard to case.
+     *
+     **/
+    class HTTPHeaders
+    {
+        /* The position of a field in the data. */
+        struct Field
+        {
+            uint32_t nName;
+            uint32_t nNameSize;
+            uint32_t nValue;
+            uint32_t nValueSize;
+        };
+
+
+        /* The names and values of the fields. */
+        std::string strData;
+
+
+        /* The fields, in the order they were added. */
+        std::vector<Field> vFields;
+
+
+    public:
+
+        /** Default Constructor **/
+        HTTPHeaders()
+        : strData ( )
+        , vFields ( )
+        {
+        }
+
+
+        /** Clear
+         *
+         *  Remove all fields, keeping the memory for the next packet.
+         *
+         **/
+        void Clear()
+        {
+            strData.clear();
+            vFields.clear();
+        }
+
+
+        /** Empty
+         *
+         *  Check if there are no fields.
+         *
+         **/
+        bool Empty() const
+        {
+            return vFields.empty();
+        }
+
+
+        /** Has
+         *
+         *  Check if a field is set.
+         *
+         *  @param[in] strName The name of the field.
+         *
+         **/
+        bool Has(const std::string& strName) const
+        {
+            return find(strName.data(), strName.size()) != nullptr;
+        }
+
+
+        /** Get
+         *
+         *  Get the value of a field.
+         *
+         *  @param[in] strName The name of the field.
+         *
+         *  @return The value, or an empty string if the field isn't set.
+         *
+         **/
+        std::string Get(const std::string& strName) const
+        {
+            const Field* pField = find(strName.data(), strName.size());
+            if(!pField)
+                return "";
+
+            return strData.substr(pField->nValue, pField->nValueSize);
+        }
+
+
+        /** Matches
+         *
+         *  Check if a field is set to a value, without regard to case.
+         *
+         *  @param[in] strName The name of the field.
+         *  @param[in] strValue The value to compare with.
+         *
+         **/
+        bool Matches(const std::string& strName, const std::string& strValue) const
+        {
+            const Field* pField = find(strName.data(), strName.size());
+            if(!pField)
+                return false;
+
+            return equals(strData.data() + pField->nValue, pField->nValueSize, strValue.data(), strValue.size());
+        }
+
+
+        /** Set
+         *
+         *  Set the value of a field, replacing the value it had.
+         *
+         *  @param[in] strName The name of the field.
+         *  @param[in] strValue The value of the field.
+         *
+         **/
+        void Set(const std::string& strName, const std::string& strValue)
+        {
+            /* Point an existing field at its new value. */
+            for(Field& field : vFields)
+            {
+                if(!equals(strData.data() + field.nName, field.nNameSize, strName.data(), strName.size()))
+                    continue;
+
+                field.nValue     = static_cast<uint32_t>(strData.size());
+                field.nValueSize = static_cast<uint32_t>(strValue.size());
+                strData.append(strValue);
+
+                return;
+            }
+
+            add(strName.data(), strName.size(), strValue.data(), strValue.size());
+        }
+
+
+        /** Parse
+         *
+         *  Add a field from a header line of the form "Name: value", without the line ending.
+         *
+         *  @param[in] pLine The start of the line.
+         *  @param[in] nSize The length of the line.
+         *
+         *  @return True if the line was a field.
+         *
+         **/
+        bool Parse(const char* pLine, const size_t nSize)
+        {
+            /* Find the delimiter to split. */
+            const char* pDelimiter = static_cast<const char*>(std::memchr(pLine, ':', nSize));
+            if(!pDelimiter)
+                return false;
+
+            /* Skip the whitespace around the value. */
+            const char* pValue = pDelimiter + 1;
+            const char* pEnd   = pLine + nSize;
+            while(pValue < pEnd && (*pValue == ' ' || *pValue == '\t'))
+                ++pValue;
+
+            while(pEnd > pValue && (*(pEnd - 1) == ' ' || *(pEnd - 1) == '\t'))
+                --pEnd;
+
+            add(pLine, pDelimiter - pLine, pValue, pEnd - pValue);
+
+            return true;
+        }
+
+
+        /** Write
+         *
+         *  Append the fields as header lines.
+         *
+         *  @param[out] strOut The string to append to.
+         *
+         **/
+        void Write(std::string& strOut) const
+        {
+            for(const Field& field : vFields)
+            {
+                strOut.append(strData, field.nName, field.nNameSize);
+                strOut.append(": ");
+                strOut.append(strData, field.nValue, field.nValueSize);
+                strOut.append("\r\n");
+            }
+        }
+
+
+    private:
+
+        /** find
+         *
+         *  Find a field by its name.
+         *
+         **/
+        const Field* find(const char* pName, const size_t nSize) const
+        {
+            for(const Field& field : vFields)
+            {
+                if(equals(strData.data() + field.nName, field.nNameSize, pName, nSize))
+                    return &field;
+            }
+
+            return nullptr;
+        }
+
+
+        /** add
+         *
+         *  Add a field to the end of the list.
+         *
+         **/
+        void add(const char* pName, const size_t nNameSize, const char* pValue, const size_t nValueSize)
+        {
+            Field field;
+            field.nName      = static_cast<uint32_t>(strData.size());
+            field.nNameSize  = static_cast<uint32_t>(nNameSize);
+            strData.append(pName, nNameSize);
+
+            field.nValue     = static_cast<uint32_t>(strData.size());
+            field.nValueSize = static_cast<uint32_t>(nValueSize);
+            strData.append(pValue, nValueSize);
+
+            vFields.push_back(field);
+        }
+
+
+        /** equals
+         *
+         *  Compare two strings without regard to case.
+         *
+         **/
+        static bool equals(const char* pFirst, const size_t nFirst, const char* pSecond, const size_t nSecond)
+        {
+            if(nFirst != nSecond)
+                return false;
+
+            for(size_t n = 0; n < nFirst; ++n)
+            {
+                if(std::tolower(static_cast<unsigned char>(pFirst[n])) != std::tolower(static_cast<unsigned char>(pSecond[n])))
+                    return false;
+            }
+
+            return true;
+        }
+    };
+
+
     /** HTTPPacket
      *
      *  Class to handle sending and receiving of LLP Packets.
@@ -50,7 +306,7 @@ namespace LLP
 
 
         /* HTTP Status Headers. */
-        std::map<std::string, std::string> mapHeaders;
+        HTTPHeaders HEADERS;
 
 
         /* The content length. */
@@ -70,7 +326,7 @@ namespace LLP
         : strType        ("")
         , strRequest     ("")
         , strVersion     ("")
-        , mapHeaders     ( )
+        , HEADERS        ( )
         , nContentLength (0)
         , strContent     ("")
         , fHeader        (false)
@@ -83,7 +339,7 @@ namespace LLP
         : strType        (packet.strType)
         , strRequest     (packet.strRequest)
         , strVersion     (packet.strVersion)
-        , mapHeaders     (packet.mapHeaders)
+        , HEADERS        (packet.HEADERS)
         , nContentLength (packet.nContentLength)
         , strContent     (packet.strContent)
         , fHeader        (packet.fHeader)
@@ -96,7 +352,7 @@ namespace LLP
         : strType        (std::move(packet.strType))
         , strRequest     (std::move(packet.strRequest))
         , strVersion     (std::move(packet.strVersion))
-        , mapHeaders     (std::move(packet.mapHeaders))
+        , HEADERS        (std::move(packet.HEADERS))
         , nContentLength (std::move(packet.nContentLength))
         , strContent     (std::move(packet.strContent))
         , fHeader        (std::move(packet.fHeader))
@@ -110,7 +366,7 @@ namespace LLP
             strType        = packet.strType;
             strRequest     = packet.strRequest;
             strVersion     = packet.strVersion;
-            mapHeaders     = packet.mapHeaders;
+            HEADERS        = packet.HEADERS;
             nContentLength = packet.nContentLength;
             strContent     = packet.strContent;
             fHeader        = packet.fHeader;
@@ -125,7 +381,7 @@ namespace LLP
             strType        = std::move(packet.strType);
             strRequest     = std::move(packet.strRequest);
             strVersion     = std::move(packet.strVersion);
-            mapHeaders     = std::move(packet.mapHeaders);
+            HEADERS        = std::move(packet.HEADERS);
             nContentLength = std::move(packet.nContentLength);
             strContent     = std::move(packet.strContent);
             fHeader        = std::move(packet.fHeader);
@@ -145,7 +401,7 @@ namespace LLP
         : strType        ("")
         , strRequest     ("")
         , strVersion     ("")
-        , mapHeaders     ( )
+        , HEADERS        ( )
         , nContentLength (0)
         , strContent     ("")
         , fHeader        (false)
@@ -165,7 +421,7 @@ namespace LLP
             strRequest = "";
             strVersion = "";
 
-            mapHeaders.clear();
+            HEADERS.Clear();
             strContent = "";
             nContentLength = 0;
 
@@ -180,7 +436,7 @@ namespace LLP
          **/
         bool IsNull() const
         {
-            return strType == "" && strRequest == "" && strVersion == "" && mapHeaders.empty() && strContent == "" && !fHeader;
+            return strType == "" && strRequest == "" && strVersion == "" && HEADERS.Empty() && strContent == "" && !fHeader;
         }
 
 
@@ -249,10 +505,30 @@ namespace LLP
                 case 500:
                     strType = "500 Internal Server Error";
                     break;
+
+                case 503:
+                    strType = "503 Service Unavailable";
+                    break;
             }
 
             /* Set connection header. */
-            mapHeaders["Connection"] = "close";
+            HEADERS.Set("Connection", "close");
+        }
+
+
+        /** KeepAlive
+         *
+         *  Check if the connection should stay open after this request. HTTP/1.1
+         *  connections stay open unless the client closes them, earlier versions only
+         *  stay open when the client asks.
+         *
+         **/
+        bool KeepAlive() const
+        {
+            if(strVersion == "HTTP/1.1")
+                return !HEADERS.Matches("connection", "close");
+
+            return HEADERS.Matches("connection", "keep-alive");
         }
 
 
@@ -266,35 +542,94 @@ namespace LLP
          **/
         std::vector<uint8_t> GetBytes() const
         {
-            //TODO: use constant format (not ...) -> ostringstream
-            std::string strReply = debug::safe_printstr
+            /* Add the header with the length of the content. */
+            std::string strReply = header(false);
+            strReply.append(strContent);
+
+            //get the bytes to submit over socket
+            return std::vector<uint8_t>(strReply.begin(), strReply.end());
+        }
+
+
+        /** GetChunks
+         *
+         *  Serializes class into buffers with chunked transfer encoding, so large
+         *  content is sent in pieces instead of being copied into one buffer with the header.
+         *
+         *  @param[in] nChunkSize The most bytes of content in each chunk.
+         *
+         *  @return Returns the header, the chunks, and the end of the content.
+         *
+         **/
+        std::vector< std::shared_ptr<const std::vector<uint8_t>> > GetChunks(const uint32_t nChunkSize) const
+        {
+            std::vector< std::shared_ptr<const std::vector<uint8_t>> > vChunks;
+
+            /* Add the header without the length of the content. */
+            const std::string strHeader = header(true);
+            vChunks.push_back(std::make_shared<const std::vector<uint8_t>>(strHeader.begin(), strHeader.end()));
+
+            /* Add each chunk with its size in hex before it. */
+            for(uint64_t nPos = 0; nPos < strContent.size(); nPos += nChunkSize)
+            {
+                const uint64_t nSize = std::min(static_cast<uint64_t>(nChunkSize), strContent.size() - nPos);
+
+                char chSize[20];
+                const int32_t nLength = std::snprintf(chSize, sizeof(chSize), "%llx\r\n", static_cast<unsigned long long>(nSize));
+
+                std::vector<uint8_t> vChunk;
+                vChunk.reserve(nLength + nSize + 2);
+                vChunk.insert(vChunk.end(), chSize, chSize + nLength);
+                vChunk.insert(vChunk.end(), strContent.begin() + nPos, strContent.begin() + nPos + nSize);
+                vChunk.push_back('\r');
+                vChunk.push_back('\n');
+
+                vChunks.push_back(std::make_shared<const std::vector<uint8_t>>(std::move(vChunk)));
+            }
+
+            /* Add the last chunk, which is empty. */
+            const std::string strEnd = "0\r\n\r\n";
+            vChunks.push_back(std::make_shared<const std::vector<uint8_t>>(strEnd.begin(), strEnd.end()));
+
+            return vChunks;
+        }
+
+
+    private:
+
+        /** header
+         *
+         *  Serialize the status line and header fields.
+         *
+         *  @param[in] fChunked True to send the content in chunks instead of giving its length.
+         *
+         **/
+        std::string header(const bool fChunked) const
+        {
+            std::string strHeader = debug::safe_printstr
             (
                 "HTTP/1.1 ", strType, "\r\n",
                 "Date: ", debug::rfc1123Time(), "\r\n",
                 "Server: Tritium HTTP\r\n"
             );
 
-            /* Check for content. */
+            /* Check for content, which is JSON unless another type is given. */
             if(strContent.size() > 0)
             {
-                strReply += debug::safe_printstr
-                (
-                    "Content-Length: ", strContent.size(), "\r\n",
-                    "Content-Type: application/json\r\n"
-                );
-            }
-
-            /* Add custom header fields. */
-            for(const auto& header : mapHeaders)
-                strReply += debug::safe_printstr(header.first, ": ", header.second, "\r\n");;
+                if(fChunked)
+                    strHeader.append("Transfer-Encoding: chunked\r\n");
+                else
+                    strHeader.append(debug::safe_printstr("Content-Length: ", strContent.size(), "\r\n"));
 
-            /* Add end of header and content. */
-            strReply += debug::safe_printstr("\r\n", strContent);
+                if(!HEADERS.Has("Content-Type"))
+                    strHeader.append("Content-Type: application/json\r\n");
+            }
 
-            //get the bytes to submit over socket
-            std::vector<uint8_t> vBytes(strReply.begin(), strReply.end());
+            /* Add custom header fields and the end of header. */
+            HEADERS.Write(strHeader);
+            strHeader.append("\r\n");
 
-            return vBytes;
+            return strHeader;
         }
     };
 }
@@ -0,0 +1,242 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLP/templates/poller.h>
+
+#include <Util/include/debug.h>
+#include <Util/include/mutex.h>
+#include <Util/include/runtime.h>
+
+#include <cerrno>
+#include <cstring>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <unistd.h>
+#endif
+
+namespace LLP
+{
+
+    /* The most events read from epoll in one wait. */
+    const uint32_t MAX_POLL_EVENTS = 256;
+
+
+    /* Default Constructor */
+    Poller::Poller(const bool fPortable)
+    : MUTEX        ( )
+    , nEpoll       (-1)
+    , vPollFds     ( )
+    , vIndexes     ( )
+    , mapPositions ( )
+    {
+    #ifdef __linux__
+        if(!fPortable)
+        {
+            nEpoll = epoll_create1(EPOLL_CLOEXEC);
+            if(nEpoll < 0)
+                debug::error(FUNCTION, "epoll unavailable, using poll: ", strerror(errno));
+        }
+    #endif
+    }
+
+
+    /* Default Destructor */
+    Poller::~Poller()
+    {
+    #ifdef __linux__
+        if(nEpoll >= 0)
+            close(nEpoll);
+    #endif
+    }
+
+
+    /* Add a socket to wait on. */
+    bool Poller::Add(const SOCKET hSocket, const uint32_t nIndex)
+    {
+    #ifdef __linux__
+        if(nEpoll >= 0)
+        {
+            struct epoll_event event;
+            event.events   = EPOLLIN | EPOLLRDHUP | EPOLLET;
+            event.data.u64 = nIndex;
+
+            /* A socket that is already added has only changed its index. */
+            if(epoll_ctl(nEpoll, EPOLL_CTL_ADD, hSocket, &event) < 0
+            && !(errno == EEXIST && epoll_ctl(nEpoll, EPOLL_CTL_MOD, hSocket, &event) == 0))
+                return debug::error(FUNCTION, "failed to add socket ", hSocket, ": ", strerror(errno));
+
+            return true;
+        }
+    #endif
+
+        LOCK(MUTEX);
+
+        /* A socket that is already added has only changed its index. */
+        auto it = mapPositions.find(hSocket);
+        if(it != mapPositions.end())
+        {
+            vIndexes[it->second] = nIndex;
+            return true;
+        }
+
+        pollfd entry;
+        entry.fd      = hSocket;
+        entry.events  = POLLIN;
+        entry.revents = 0;
+
+        mapPositions[hSocket] = static_cast<uint32_t>(vPollFds.size());
+        vPollFds.push_back(entry);
+        vIndexes.push_back(nIndex);
+
+        return true;
+    }
+
+
+    /* Stop waiting on a socket. */
+    void Poller::Remove(const SOCKET hSocket)
+    {
+        if(hSocket == INVALID_SOCKET)
+            return;
+
+    #ifdef __linux__
+        if(nEpoll >= 0)
+        {
+            struct epoll_event event;
+            epoll_ctl(nEpoll, EPOLL_CTL_DEL, hSocket, &event);
+
+            return;
+        }
+    #endif
+
+        LOCK(MUTEX);
+
+        auto it = mapPositions.find(hSocket);
+        if(it == mapPositions.end())
+            return;
+
+        /* Move the last socket into the removed one's place. */
+        const uint32_t nPosition = it->second;
+        mapPositions.erase(it);
+
+        if(nPosition + 1 != vPollFds.size())
+        {
+            vPollFds[nPosition] = vPollFds.back();
+            vIndexes[nPosition] = vIndexes.back();
+
+            mapPositions[vPollFds[nPosition].fd] = nPosition;
+        }
+
+        vPollFds.pop_back();
+        vIndexes.pop_back();
+    }
+
+
+    /* Wait for events on the sockets. */
+    int32_t Poller::Wait(std::vector<PollEvent>& vEvents, const uint32_t nTimeout)
+    {
+        vEvents.clear();
+
+    #ifdef __linux__
+        if(nEpoll >= 0)
+        {
+            struct epoll_event vReady[MAX_POLL_EVENTS];
+
+            const int32_t nReady = epoll_wait(nEpoll, vReady, MAX_POLL_EVENTS, nTimeout);
+            if(nReady < 0)
+                return (errno == EINTR) ? 0 : nReady;
+
+            for(int32_t n = 0; n < nReady; ++n)
+            {
+                PollEvent event;
+                event.nIndex = static_cast<uint32_t>(vReady[n].data.u64);
+                event.nFlags = 0;
+
+                if(vReady[n].events & EPOLLIN)
+                    event.nFlags |= POLL::READABLE;
+
+                if(vReady[n].events & EPOLLERR)
+                    event.nFlags |= POLL::FAILED;
+
+                if(vReady[n].events & EPOLLHUP)
+                    event.nFlags |= POLL::CLOSED;
+
+                if(vReady[n].events & EPOLLRDHUP)
+                    event.nFlags |= POLL::SHUTDOWN;
+
+                vEvents.push_back(event);
+            }
+
+            return nReady;
+        }
+    #endif
+
+        /* Poll a copy of the sockets so they can be added and removed while waiting.
+         * Windows throws SOCKET_ERROR intermittently if the sockets change during a poll.
+         */
+        std::vector<pollfd> vPoll;
+        std::vector<uint32_t> vPollIndexes;
+        {
+            LOCK(MUTEX);
+
+            vPoll        = vPollFds;
+            vPollIndexes = vIndexes;
+        }
+
+        /* Poll can fail with no sockets, so only wait out the timeout. */
+        if(vPoll.empty())
+        {
+            runtime::sleep(nTimeout);
+            return 0;
+        }
+
+    #ifdef WIN32
+        int32_t nPoll = WSAPoll((pollfd*)&vPoll[0], vPoll.size(), nTimeout);
+    #else
+        int32_t nPoll = poll((pollfd*)&vPoll[0], vPoll.size(), nTimeout);
+    #endif
+
+        if(nPoll <= 0)
+            return nPoll;
+
+        for(uint32_t n = 0; n < vPoll.size(); ++n)
+        {
+            if(vPoll[n].revents == 0)
+                continue;
+
+            PollEvent event;
+            event.nIndex = vPollIndexes[n];
+            event.nFlags = 0;
+
+            if(vPoll[n].revents & POLLIN)
+                event.nFlags |= POLL::READABLE;
+
+            if(vPoll[n].revents & POLLERR)
+                event.nFlags |= POLL::FAILED;
+
+            if(vPoll[n].revents & POLLHUP)
+                event.nFlags |= POLL::CLOSED;
+
+            vEvents.push_back(event);
+        }
+
+        return static_cast<int32_t>(vEvents.size());
+    }
+
+
+    /* Check if sockets are only reported when they become ready. */
+    bool Poller::EdgeTriggered() const
+    {
+        return nEpoll >= 0;
+    }
+}
@@ -12,6 +12,7 @@
 ____________________________________________________________________________________________*/
 
 
+#include <LLP/include/global.h>
 #include <LLP/types/rpcnode.h>
 #include <LLP/templates/events.h>
 
@@ -131,7 +132,7 @@ namespace LLP
     bool RPCNode::ProcessPacket()
     {
         /* Check HTTP authorization */
-        if(!Authorized(INCOMING.mapHeaders))
+        if(!Authorized(INCOMING.HEADERS))
         {
             debug::error(FUNCTION, "RPC incorrect password attempt from ", this->addr.ToString());
 
@@ -146,11 +147,19 @@ namespace LLP
             return false;
         }
 
+        /* Run the request on the RPC workers. */
+        return Dispatch(RPC_WORKERS);
+    }
+
+
+    /* Run an RPC request on a worker and build its response. */
+    bool RPCNode::Execute(HTTPPacket& REQUEST, HTTPPacket& RESPONSE, std::string& strMethod)
+    {
         json::json jsonID = nullptr;
         try
         {
             /* Get the parameters from the HTTP Packet. */
-            json::json jsonIncoming = json::json::parse(INCOMING.strContent);
+            json::json jsonIncoming = json::json::parse(REQUEST.strContent);
 
             /* Ensure the method is in the calling json. */
             if(jsonIncoming["method"].is_null())
@@ -161,7 +170,7 @@ namespace LLP
                 throw APIException(-32600, "Method must be a string");
 
             /* Get the method string. */
-            std::string strMethod = jsonIncoming["method"].get<std::string>();
+            const std::string strName = jsonIncoming["method"].get<std::string>();
 
             /* Check for parameters, if none set default value to empty array. */
             json::json jsonParams = jsonIncoming["params"].is_null() ? "[]" : jsonIncoming["params"];
@@ -178,19 +187,24 @@ namespace LLP
             if(!config::fInitialized)
                 throw APIException(-1, "Daemon is still initializing");
 
-            /* Execute the RPC method. */
             #ifndef NO_WALLET
-            json::json jsonResult = TAO::API::RPCCommands->Execute(strMethod, jsonParams, false);
 
-            /* Push the response data with json payload. */
-            PushResponse(200, JSONReply(jsonResult, nullptr, jsonID).dump());
+            /* Label the request by its method, keeping unknown names out of the metrics. */
+            strMethod = "rpc/" + (TAO::API::RPCCommands->Supports(strName) ? strName : std::string("other"));
+
+            /* Execute the RPC method. */
+            json::json jsonResult = TAO::API::RPCCommands->Execute(strName, jsonParams, false);
+
+            /* Build the response data with json payload. */
+            RESPONSE = HTTPPacket(200);
+            RESPONSE.strContent = JSONReply(jsonResult, nullptr, jsonID).dump();
             #endif
         }
 
         /* Handle for custom API exceptions. */
         catch(APIException& e)
         {
-            ErrorReply(e.ToJSON(), jsonID);
+            RESPONSE = ErrorReply(e.ToJSON(), jsonID);
 
             return debug::error("RPC Exception: ", e.what());
         }
@@ -198,7 +212,7 @@ namespace LLP
         /* Handle for JSON exceptions. */
         catch(const json::detail::exception& e)
         {
-            ErrorReply(APIException(e.id, e.what()).ToJSON(), jsonID);
+            RESPONSE = ErrorReply(APIException(e.id, e.what()).ToJSON(), jsonID);
 
             return debug::error("RPC Exception: ", e.what());
         }
@@ -206,12 +220,11 @@ namespace LLP
         /* Handle for STD exceptions. */
         catch(const std::exception& e)
         {
-            ErrorReply(APIException(-32700, e.what()).ToJSON(), jsonID);
+            RESPONSE = ErrorReply(APIException(-32700, e.what()).ToJSON(), jsonID);
 
             return debug::error("RPC Exception: ", e.what());
         }
 
-        /* Handle a connection close header. */
         return true;
     }
 
@@ -239,7 +252,8 @@ namespace LLP
         return jsonReply;
     }
 
-    void RPCNode::ErrorReply(const json::json& jsonError, const json::json& jsonID)
+    /* Reply an error from the RPC server. */
+    HTTPPacket RPCNode::ErrorReply(const json::json& jsonError, const json::json& jsonID)
     {
         /* Default error status code is 500. */
         uint16_t nStatus = 500;
@@ -259,17 +273,20 @@ namespace LLP
                 break;
         }
 
-        /* Send the response packet. */
-        PushResponse(nStatus, JSONReply(json::json(nullptr), jsonError, jsonID).dump());
+        /* Build the response packet. */
+        HTTPPacket RESPONSE(nStatus);
+        RESPONSE.strContent = JSONReply(json::json(nullptr), jsonError, jsonID).dump();
+
+        return RESPONSE;
     }
 
-    bool RPCNode::Authorized(std::map<std::string, std::string>& mapHeaders)
+    bool RPCNode::Authorized(const HTTPHeaders& HEADERS)
     {
         /* Check the headers. */
-        if(!mapHeaders.count("authorization"))
+        if(!HEADERS.Has("authorization"))
             return debug::error(FUNCTION, "no authorization in header");
 
-        std::string strAuth = mapHeaders["authorization"];
+        std::string strAuth = HEADERS.Get("authorization");
         if(strAuth.substr(0,6) != "Basic ")
             return debug::error(FUNCTION, "incorrect authorization type");
 
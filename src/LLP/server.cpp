@@ -80,6 +80,7 @@ namespace LLP
     , nMaxIncoming      (config.nMaxIncoming)
     , nMaxConnections   (config.nMaxConnections)
     , fRemote           (config.fRemote)
+    , vWatches          ( )
     {
         /* Add the individual data threads to the vector that will be holding their state. */
         for(uint16_t nIndex = 0; nIndex < MAX_THREADS; ++nIndex)
@@ -88,6 +89,44 @@ namespace LLP
                 nIndex, config.fDDOS, config.nDDOSRScore, config.nDDOSCScore, config.nTimeout, config.fMeter));
         }
 
+        /* Watch the connections and queues of the data threads for the metrics. */
+        const std::string strLabels = metrics::Label("server", ProtocolType::Name());
+        vWatches.push_back(metrics::Watch("nexus_llp_connections", "Open connections.", false, strLabels,
+            [this]{ return double(GetConnectionCount()); }));
+        vWatches.push_back(metrics::Watch("nexus_llp_relay_queue", "Messages waiting to be relayed.", false, strLabels,
+            [this]
+            {
+                uint64_t nQueued = 0;
+                for(const auto& pThread : DATA_THREADS)
+                    nQueued += pThread->RELAY->size();
+
+                return double(nQueued);
+            }));
+        vWatches.push_back(metrics::Watch("nexus_llp_send_buffer_bytes", "Bytes waiting in send buffers.", false, strLabels,
+            [this]
+            {
+                uint64_t nBuffered = 0;
+                for(const auto& pThread : DATA_THREADS)
+                {
+                    const uint32_t nSize = static_cast<uint32_t>(pThread->CONNECTIONS->size());
+                    for(uint32_t nIndex = 0; nIndex < nSize; ++nIndex)
+                    {
+                        try
+                        {
+                            std::shared_ptr<ProtocolType> CONNECTION = pThread->CONNECTIONS->at(nIndex);
+                            if(CONNECTION)
+                                nBuffered += CONNECTION->Buffered();
+                        }
+                        catch(const std::exception& e)
+                        {
+                            /* The slot was emptied while it was read. */
+                        }
+                    }
+                }
+
+                return double(nBuffered);
+            }));
+
         /* Initialize the address manager. */
         if(config.fManager)
         {
@@ -135,6 +174,10 @@ namespace LLP
     template <class ProtocolType>
     Server<ProtocolType>::~Server()
     {
+        /* Stop the metrics reading the data threads. */
+        for(const auto& nId : vWatches)
+            metrics::Unwatch(nId);
+
         /* Wait for address manager. */
         if(pAddressManager && MANAGER_THREAD.joinable())
             MANAGER_THREAD.join();
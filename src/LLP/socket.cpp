@@ -11,6 +11,8 @@
 
 ____________________________________________________________________________________________*/
 
+#include <algorithm>
+#include <cstring>
 #include <string>
 #include <vector>
 #include <stdio.h>
@@ -24,6 +26,7 @@ ________________________________________________________________________________
 #ifndef WIN32
 #include <arpa/inet.h>
 #include <sys/ioctl.h>
+#include <sys/uio.h>
 #endif
 
 #include <openssl/ssl.h>
@@ -42,10 +45,14 @@ namespace LLP
     , nLastSend          (0)
     , nLastRecv          (0)
     , nError             (0)
-    , vBuffer            ( )
+    , qSend              ( )
+    , nSendOffset        (0)
+    , nBuffered          (0)
     , fBufferFull        (false)
     , nConsecutiveErrors (0)
     , addr               ( )
+    , BYTES_RECEIVED     (nullptr)
+    , BYTES_SENT         (nullptr)
     {
         fd = INVALID_SOCKET;
         events = POLLIN;
@@ -64,10 +71,14 @@ namespace LLP
     , nLastSend          (socket.nLastSend.load())
     , nLastRecv          (socket.nLastRecv.load())
     , nError             (socket.nError.load())
-    , vBuffer            (socket.vBuffer)
+    , qSend              (socket.qSend)
+    , nSendOffset        (socket.nSendOffset)
+    , nBuffered          (socket.nBuffered.load())
     , fBufferFull        (socket.fBufferFull.load())
     , nConsecutiveErrors (socket.nConsecutiveErrors.load())
     , addr               (socket.addr)
+    , BYTES_RECEIVED     (socket.BYTES_RECEIVED)
+    , BYTES_SENT         (socket.BYTES_SENT)
     {
         if(socket.pSSL)
         {
@@ -98,10 +109,14 @@ namespace LLP
     , nLastSend          (0)
     , nLastRecv          (0)
     , nError             (0)
-    , vBuffer            ( )
+    , qSend              ( )
+    , nSendOffset        (0)
+    , nBuffered          (0)
     , fBufferFull        (false)
     , nConsecutiveErrors (0)
     , addr               (addrIn)
+    , BYTES_RECEIVED     (nullptr)
+    , BYTES_SENT         (nullptr)
     {
         fd = nSocketIn;
         events = POLLIN;
@@ -215,10 +230,14 @@ namespace LLP
     , nLastSend          (0)
     , nLastRecv          (0)
     , nError             (0)
-    , vBuffer            ( )
+    , qSend              ( )
+    , nSendOffset        (0)
+    , nBuffered          (0)
     , fBufferFull        (false)
     , nConsecutiveErrors (0)
     , addr               ( )
+    , BYTES_RECEIVED     (nullptr)
+    , BYTES_SENT         (nullptr)
     {
         fd = INVALID_SOCKET;
         events = POLLIN;
@@ -661,8 +680,14 @@ namespace LLP
             }
         }
         else if(nRead > 0)
+        {
             nLastRecv = runtime::timestamp(true);
 
+            /* Count the bytes for the metrics. */
+            if(BYTES_RECEIVED)
+                BYTES_RECEIVED->Add(nRead);
+        }
+
         return nRead;
     }
 
@@ -750,8 +775,14 @@ namespace LLP
             }
         }
         else if(nRead > 0)
+        {
             nLastRecv = runtime::timestamp(true);
 
+            /* Count the bytes for the metrics. */
+            if(BYTES_RECEIVED)
+                BYTES_RECEIVED->Add(nRead);
+        }
+
         return nRead;
     }
 
@@ -759,119 +790,172 @@ namespace LLP
     /* Write data into the socket buffer non-blocking */
     int32_t Socket::Write(const std::vector<uint8_t>& vData, size_t nBytes)
     {
-        int32_t nSent = 0;
+        /* Check for data to write. */
+        nBytes = std::min(nBytes, vData.size());
+        if(nBytes == 0)
+            return 0;
 
-        {
-            LOCK(DATA_MUTEX);
+        LOCK(DATA_MUTEX);
 
-            /* Check overflow buffer. */
-            if(vBuffer.size() > 0)
-            {
-                debug::log(3, FUNCTION, "vBuffer ", vBuffer.size(), " bytes");
+        /* Queue behind the data already waiting so the bytes stay in order. */
+        if(!qSend.empty())
+        {
+            debug::log(3, FUNCTION, "buffered ", nBuffered.load(), " bytes");
 
-                vBuffer.insert(vBuffer.end(), vData.begin(), vData.end());
+            qSend.push_back(SendBuffer(new std::vector<uint8_t>(vData.begin(), vData.begin() + nBytes)));
+            nBuffered += nBytes;
 
-                return static_cast<int32_t>(nBytes);
-            }
+            return static_cast<int32_t>(nBytes);
         }
 
-        /* Write the packet. */
-        {
-            LOCK(SOCKET_MUTEX);
+        /* Send what the socket takes now, and only copy the rest into the queue. */
+        int32_t nSent = send_bytes(&vData[0], nBytes);
 
-            if(pSSL)
-                nSent = static_cast<int32_t>(SSL_write(pSSL, (int8_t*)&vData[0], nBytes));
-            else
-            {
-            #ifdef WIN32
-                nSent = static_cast<int32_t>(send(fd, (char*)&vData[0], nBytes, MSG_NOSIGNAL | MSG_DONTWAIT));
-            #else
-                nSent = static_cast<int32_t>(send(fd, (int8_t*)&vData[0], nBytes, MSG_NOSIGNAL | MSG_DONTWAIT));
-            #endif
-            }
+        /* A full socket buffer isn't an error, the bytes are queued for the next flush. */
+        if(nSent < 0 && error_code() == 0)
+            nSent = 0;
+
+        if(nSent >= 0 && static_cast<size_t>(nSent) < nBytes)
+        {
+            qSend.push_back(SendBuffer(new std::vector<uint8_t>(vData.begin() + nSent, vData.begin() + nBytes)));
+            nBuffered += nBytes - nSent;
         }
+        else if(nSent >= 0) //don't update last sent unless all the data was written to the buffer
+            nLastSend = runtime::timestamp(true);
 
+        /* Count the bytes for the metrics. */
+        if(nSent > 0 && BYTES_SENT)
+            BYTES_SENT->Add(nSent);
 
-        /* Handle for error state. */
-        if(nSent < 0)
+        return nSent;
+    }
+
+
+    /* Write a shared buffer into the socket buffer non-blocking. */
+    int32_t Socket::Write(const SendBuffer& pBuffer)
+    {
+        /* Check for data to write. */
+        const size_t nBytes = pBuffer->size();
+        if(nBytes == 0)
+            return 0;
+
+        LOCK(DATA_MUTEX);
+
+        /* Queue behind the data already waiting so the bytes stay in order. */
+        if(!qSend.empty())
         {
-            if(pSSL)
-                nError = SSL_get_error(pSSL, nSent);
-            else
-                nError = WSAGetLastError();
+            debug::log(3, FUNCTION, "buffered ", nBuffered.load(), " bytes");
+
+            qSend.push_back(pBuffer);
+            nBuffered += nBytes;
+
+            return static_cast<int32_t>(nBytes);
         }
 
-        /* If not all data was sent non-blocking, recurse until it is complete. */
-        else if(nSent != vData.size())
+        /* Send what the socket takes now, and queue the rest by reference. */
+        int32_t nSent = send_bytes(pBuffer->data(), nBytes);
+
+        /* A full socket buffer isn't an error, the bytes are queued for the next flush. */
+        if(nSent < 0 && error_code() == 0)
+            nSent = 0;
+
+        if(nSent >= 0 && static_cast<size_t>(nSent) < nBytes)
         {
-            LOCK(DATA_MUTEX);
-            vBuffer.insert(vBuffer.end(), vData.begin() + nSent, vData.end());
+            qSend.push_back(pBuffer);
+            nSendOffset = nSent;
+            nBuffered  += nBytes - nSent;
         }
-        else //don't update last sent unless all the data was written to the buffer
+        else if(nSent >= 0) //don't update last sent unless all the data was written to the buffer
             nLastSend = runtime::timestamp(true);
 
+        /* Count the bytes for the metrics. */
+        if(nSent > 0 && BYTES_SENT)
+            BYTES_SENT->Add(nSent);
+
         return nSent;
     }
 
 
-    /* Flushes data out of the overflow buffer */
+    /* Flushes data out of the send queue */
     int Socket::Flush()
     {
-        int32_t nSent   = 0;
-        uint32_t nBytes = 0;
-        uint32_t nSize  = 0;
-
-        {
-            LOCK(DATA_MUTEX);
-            nSize = static_cast<uint32_t>(vBuffer.size());
-        }
+        LOCK(DATA_MUTEX);
 
         /* Don't flush if buffer doesn't have any data. */
-        if(nSize == 0)
+        if(qSend.empty())
             return 0;
 
         /* maximum transmission unit. */
-        const uint32_t MTU = 16384;
+        const uint64_t MTU = 16384;
 
         /* Set the maximum bytes to flush to 2^16 or maximum socket buffers. */
-        nBytes = std::min(nSize, std::min((uint32_t)config::GetArg("-maxsendsize", MTU), MTU));
+        const uint64_t nMax = std::min(uint64_t(config::GetArg("-maxsendsize", MTU)), MTU);
 
-        /* If there were any errors, handle them gracefully. */
+        int32_t nSent = 0;
+    #ifndef WIN32
+        if(!pSSL)
         {
-            LOCK2(DATA_MUTEX);
-            LOCK(SOCKET_MUTEX);
+            /* Gather the waiting buffers into one send, without copying them. */
+            struct iovec vBuffers[MAX_SEND_GATHER];
 
-            if(pSSL)
-                nSent = static_cast<int32_t>(SSL_write(pSSL, (int8_t *)&vBuffer[0], nBytes));
-            else
+            uint32_t nBuffers = 0;
+            uint64_t nBytes   = 0;
+            uint64_t nOffset  = nSendOffset;
+            for(auto it = qSend.begin(); it != qSend.end() && nBuffers < MAX_SEND_GATHER && nBytes < nMax; ++it)
             {
-            #ifdef WIN32
-                nSent = static_cast<int32_t>(send(fd, (char*)&vBuffer[0], nBytes, MSG_NOSIGNAL | MSG_DONTWAIT));
-            #else
-                nSent = static_cast<int32_t>(send(fd, (int8_t*)&vBuffer[0], nBytes, MSG_NOSIGNAL | MSG_DONTWAIT));
-            #endif
+                const uint64_t nSize = std::min(uint64_t((*it)->size() - nOffset), nMax - nBytes);
+
+                vBuffers[nBuffers].iov_base = const_cast<uint8_t*>((*it)->data() + nOffset);
+                vBuffers[nBuffers].iov_len  = nSize;
+
+                ++nBuffers;
+                nBytes += nSize;
+                nOffset = 0;
+            }
+
+            struct msghdr msg;
+            std::memset(&msg, 0, sizeof(msg));
+            msg.msg_iov    = vBuffers;
+            msg.msg_iovlen = nBuffers;
+
+            {
+                LOCK2(SOCKET_MUTEX);
+                nSent = static_cast<int32_t>(sendmsg(fd, &msg, MSG_NOSIGNAL | MSG_DONTWAIT));
             }
 
+            if(nSent < 0)
+                nError = WSAGetLastError();
+        }
+        else
+    #endif
+        {
+            /* Send the oldest buffer on its own, as SSL can't gather writes. */
+            const SendBuffer& pFront = qSend.front();
+            nSent = send_bytes(pFront->data() + nSendOffset, std::min(uint64_t(pFront->size() - nSendOffset), nMax));
         }
 
         /* Handle errors on flush. */
         if(nSent < 0)
-        {
-            if(pSSL)
-                nError = SSL_get_error(pSSL, nSent);
-            else
-                nError = WSAGetLastError();
-
             ++nConsecutiveErrors;
-        }
 
-        /* If not all data was sent non-blocking, recurse until it is complete. */
+        /* Drop the buffers that were sent, keeping the rest for the next flush. */
         else if(nSent > 0)
         {
-            LOCK(DATA_MUTEX);
+            uint64_t nRemaining = nSent;
+            while(nRemaining > 0)
+            {
+                const uint64_t nLeft = qSend.front()->size() - nSendOffset;
+                if(nRemaining < nLeft)
+                {
+                    nSendOffset += nRemaining;
+                    break;
+                }
 
-            /* Erase from current buffer. */
-            vBuffer.erase(vBuffer.begin(), vBuffer.begin() + nSent);
+                nRemaining -= nLeft;
+                nSendOffset = 0;
+                qSend.pop_front();
+            }
+            nBuffered -= nSent;
 
             /* Update socket timers. */
             nLastSend          = runtime::timestamp(true);
@@ -879,6 +963,10 @@ namespace LLP
 
             /* Reset that buffers are full. */
             fBufferFull.store(false);
+
+            /* Count the bytes for the metrics. */
+            if(BYTES_SENT)
+                BYTES_SENT->Add(nSent);
         }
 
         return nSent;
@@ -904,7 +992,7 @@ namespace LLP
     /* Check that the socket has data that is buffered. */
     uint64_t Socket::Buffered() const
     {
-        return vBuffer.size();
+        return nBuffered.load();
     }
 
 
@@ -957,6 +1045,38 @@ namespace LLP
         return nError;
     }
 
+
+    /* Send bytes to the socket non-blocking. */
+    int32_t Socket::send_bytes(const uint8_t* pData, const size_t nBytes)
+    {
+        int32_t nSent = 0;
+        {
+            LOCK(SOCKET_MUTEX);
+
+            if(pSSL)
+                nSent = static_cast<int32_t>(SSL_write(pSSL, pData, nBytes));
+            else
+            {
+            #ifdef WIN32
+                nSent = static_cast<int32_t>(send(fd, (char*)pData, nBytes, MSG_NOSIGNAL | MSG_DONTWAIT));
+            #else
+                nSent = static_cast<int32_t>(send(fd, pData, nBytes, MSG_NOSIGNAL | MSG_DONTWAIT));
+            #endif
+            }
+        }
+
+        /* Handle for error state. */
+        if(nSent < 0)
+        {
+            if(pSSL)
+                nError = SSL_get_error(pSSL, nSent);
+            else
+                nError = WSAGetLastError();
+        }
+
+        return nSent;
+    }
+
     /*  Creates or destroys the SSL object depending on the flag set. */
     void Socket::SetSSL(bool fSSL)
     {
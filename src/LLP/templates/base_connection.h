@@ -169,15 +169,73 @@ namespace LLP
         static std::string Name() { return "Base"; }
 
 
-        /** Notifications
+        /** Relay
          *
-         *  Filter out relay requests with notifications node is subscribed to.
+         *  A relay message prepared once for all the connections of a data thread.
+         *  By default every connection is sent the message as it was queued.
          *
          **/
-        template<typename MessageType>
-        const DataStream RelayFilter(const MessageType& message, const DataStream& ssData) const
+        class Relay
         {
-            return ssData; //copy over relay like normal for all items to be relayed
+            /* The packet as it was queued, serialized for the first connection that sends it. */
+            SendBuffer pPacket;
+
+        public:
+
+            /** The message type. **/
+            const message_t MESSAGE;
+
+
+            /** The message data as it was queued. **/
+            const DataStream& ssData;
+
+
+            /** Constructor
+             *
+             *  @param[in] nMsg The message type.
+             *  @param[in] ssDataIn The message data, which must outlive the relay.
+             *
+             **/
+            Relay(const message_t nMsg, const DataStream& ssDataIn)
+            : pPacket (nullptr)
+            , MESSAGE (nMsg)
+            , ssData  (ssDataIn)
+            {
+            }
+
+
+            /** Packet
+             *
+             *  Get the packet as it was queued, serialized once and shared by every connection.
+             *
+             **/
+            const SendBuffer& Packet()
+            {
+                if(!pPacket)
+                {
+                    PacketType PACKET = PacketType(MESSAGE);
+                    PACKET.SetData(ssData);
+
+                    pPacket = std::make_shared<const std::vector<uint8_t>>(PACKET.GetBytes());
+                }
+
+                return pPacket;
+            }
+        };
+
+
+        /** RelayFilter
+         *
+         *  Get the packet of a relay message to send to this connection.
+         *
+         *  @param[in] RELAY The relay message.
+         *
+         *  @return The packet to send, or null to send nothing.
+         *
+         **/
+        SendBuffer RelayFilter(Relay& RELAY) const
+        {
+            return RELAY.Packet(); //copy over relay like normal for all items to be relayed
         }
 
 
@@ -283,6 +341,16 @@ namespace LLP
         void WritePacket(const PacketType& PACKET);
 
 
+        /** WritePacket
+         *
+         *  Write a serialized packet to the TCP stream, sharing the buffer instead of copying it.
+         *
+         *  @param[in] pBuffer The bytes of the packet to write.
+         *
+         **/
+        void WritePacket(const SendBuffer& pBuffer);
+
+
         /** ReadPacket
          *
          *  Non-Blocking Packet reader to build a packet from TCP Connection.
@@ -20,9 +20,11 @@ ________________________________________________________________________________
 
 #include <LLP/templates/ddos.h>
 #include <LLP/templates/events.h>
+#include <LLP/templates/poller.h>
 
 #include <Util/include/mutex.h>
 #include <Util/include/memory.h>
+#include <Util/include/metrics.h>
 
 #include <Util/templates/datastream.h>
 
@@ -80,6 +82,12 @@ namespace LLP
         uint32_t DDOS_cSCORE;
 
 
+        /** The counters of the server's traffic, shared by its data threads. **/
+        metrics::Counter* PACKETS;
+        metrics::Counter* BYTES_RECEIVED;
+        metrics::Counter* BYTES_SENT;
+
+
         /* Vector to store Connections. */
         memory::atomic_ptr< std::vector< std::shared_ptr<ProtocolType>> > CONNECTIONS;
 
@@ -88,6 +96,14 @@ namespace LLP
         memory::atomic_ptr< std::queue<std::pair<typename ProtocolType::message_t, DataStream>> > RELAY;
 
 
+        /** The sockets of the connections, to wait for the ones with data. **/
+        Poller POLLER;
+
+
+        /** The slots of connections added since the data thread last checked. **/
+        memory::atomic_ptr< std::queue<uint32_t> > ADDED;
+
+
         /** The condition for thread sleeping. **/
         std::condition_variable CONDITION;
 
@@ -138,6 +154,8 @@ namespace LLP
                 pnode->nDataThread     = ID;
                 pnode->nDataIndex      = nSlot;
                 pnode->FLUSH_CONDITION = &FLUSH_CONDITION;
+                pnode->BYTES_RECEIVED  = BYTES_RECEIVED;
+                pnode->BYTES_SENT      = BYTES_SENT;
 
                 /* Find a slot that is empty. */
                 if(nSlot == CONNECTIONS->size())
@@ -145,6 +163,10 @@ namespace LLP
                 else
                     CONNECTIONS->at(nSlot) = std::shared_ptr<ProtocolType>(pnode);
 
+                /* Wait on the socket, and have the data thread schedule its checks. */
+                POLLER.Add(pnode->fd, nSlot);
+                ADDED->push(nSlot);
+
                 /* Fire the connected event. */
                 pnode->Event(EVENTS::CONNECT);
 
@@ -205,6 +227,8 @@ namespace LLP
                 pnode->nDataThread     = ID;
                 pnode->nDataIndex      = nSlot;
                 pnode->FLUSH_CONDITION = &FLUSH_CONDITION;
+                pnode->BYTES_RECEIVED  = BYTES_RECEIVED;
+                pnode->BYTES_SENT      = BYTES_SENT;
 
                 /* Find a slot that is empty. */
                 if(nSlot == CONNECTIONS->size())
@@ -212,6 +236,10 @@ namespace LLP
                 else
                     CONNECTIONS->at(nSlot) = std::shared_ptr<ProtocolType>(pnode);
 
+                /* Wait on the socket, and have the data thread schedule its checks. */
+                POLLER.Add(pnode->fd, nSlot);
+                ADDED->push(nSlot);
+
                 /* Fire the connected event. */
                 pnode->Event(EVENTS::CONNECT);
 
@@ -340,6 +368,30 @@ namespace LLP
         void remove_connection(const uint32_t nIndex);
 
 
+        /** read_connection
+         *
+         *  Read a packet from a connection with data, and process it.
+         *
+         *  @param[in] nIndex The index of the connection to read.
+         *
+         *  @return True if the connection may have more data to read.
+         *
+         **/
+        bool read_connection(const uint32_t nIndex);
+
+
+        /** check_connection
+         *
+         *  Check a connection for errors, timeouts and DDOS, and fire its generic event.
+         *
+         *  @param[in] nIndex The index of the connection to check.
+         *
+         *  @return True if the connection is still active.
+         *
+         **/
+        bool check_connection(const uint32_t nIndex);
+
+
         /** find_slot
          *
          *  Returns the index of a component of the CONNECTIONS vector that
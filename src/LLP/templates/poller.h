@@ -0,0 +1,162 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#pragma once
+#ifndef NEXUS_LLP_TEMPLATES_POLLER_H
+#define NEXUS_LLP_TEMPLATES_POLLER_H
+
+#include <LLP/include/network.h>
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace LLP
+{
+
+    /* The events the poller reports for a socket. */
+    namespace POLL
+    {
+        enum
+        {
+            READABLE = (1 << 0),
+            FAILED   = (1 << 1),
+            CLOSED   = (1 << 2),
+            SHUTDOWN = (1 << 3),
+        };
+    }
+
+
+    /** PollEvent
+     *
+     *  An event on a socket, with the index it was added with.
+     *
+     **/
+    struct PollEvent
+    {
+        /** The index the socket was added with. **/
+        uint32_t nIndex;
+
+
+        /** The POLL flags of the event. **/
+        uint8_t nFlags;
+    };
+
+
+    /** Poller
+     *
+     *  Waits for events on a set of sockets.
+     *
+     *  On Linux this uses edge-triggered epoll, so a wait only returns the sockets that
+     *  became ready and costs the same however many sockets are idle. A socket is only
+     *  reported again once more data arrives, so the caller must read it until it is
+     *  empty. A peer that stops sending is reported as SHUTDOWN, since a reported socket
+     *  with nothing to read may only have had its data read already.
+     *
+     *  Elsewhere, or if the portable backend is asked for, this uses poll over a copy
+     *  of every socket and reports readable sockets on every wait.
+     *
+     *  Sockets can be added and removed from any thread.
+     *
+     **/
+    class Poller
+    {
+        /* Mutex to protect the sockets of the poll backend. */
+        std::mutex MUTEX;
+
+
+        /* The epoll descriptor, or -1 when using poll. */
+        int32_t nEpoll;
+
+
+        /* The sockets of the poll backend. */
+        std::vector<pollfd> vPollFds;
+
+
+        /* The index of each socket of the poll backend. */
+        std::vector<uint32_t> vIndexes;
+
+
+        /* The position of each socket in the poll backend. */
+        std::map<SOCKET, uint32_t> mapPositions;
+
+
+    public:
+
+        /** Default Constructor
+         *
+         *  @param[in] fPortable Use poll even if epoll is available.
+         *
+         **/
+        Poller(const bool fPortable = false);
+
+
+        /** Copy Constructor. **/
+        Poller(const Poller& poller)            = delete;
+
+
+        /** Copy assignment. **/
+        Poller& operator=(const Poller& poller) = delete;
+
+
+        /** Default Destructor **/
+        ~Poller();
+
+
+        /** Add
+         *
+         *  Add a socket to wait on.
+         *
+         *  @param[in] hSocket The socket to add.
+         *  @param[in] nIndex The index to report its events with.
+         *
+         *  @return True if the socket was added.
+         *
+         **/
+        bool Add(const SOCKET hSocket, const uint32_t nIndex);
+
+
+        /** Remove
+         *
+         *  Stop waiting on a socket. Sockets are also removed from epoll when they are closed.
+         *
+         *  @param[in] hSocket The socket to remove.
+         *
+         **/
+        void Remove(const SOCKET hSocket);
+
+
+        /** Wait
+         *
+         *  Wait for events on the sockets.
+         *
+         *  @param[out] vEvents The events, cleared first.
+         *  @param[in] nTimeout The most milliseconds to wait.
+         *
+         *  @return The number of events, or negative on error.
+         *
+         **/
+        int32_t Wait(std::vector<PollEvent>& vEvents, const uint32_t nTimeout);
+
+
+        /** EdgeTriggered
+         *
+         *  Check if sockets are only reported when they become ready.
+         *
+         **/
+        bool EdgeTriggered() const;
+    };
+}
+
+#endif
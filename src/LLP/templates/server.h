@@ -145,6 +145,10 @@ namespace LLP
         bool fRemote;
 
 
+        /** The queue depths of this server watched by the metrics. **/
+        std::vector<uint64_t> vWatches;
+
+
     public:
 
 
@@ -399,9 +403,13 @@ namespace LLP
         template<typename MessageType, typename... Args>
         void Relay(const MessageType& message, Args&&... args)
         {
+            /* Serialize the message once for every data thread. */
+            DataStream ssData(SER_NETWORK, MIN_PROTO_VERSION);
+            message_args(ssData, std::forward<Args>(args)...);
+
             /* Relay message to each data thread, which will relay message to each connection of each data thread */
             for(uint16_t nThread = 0; nThread < MAX_THREADS; ++nThread)
-                DATA_THREADS[nThread]->Relay(message, args...);
+                DATA_THREADS[nThread]->_Relay(message, ssData);
         }
 
 
@@ -18,8 +18,12 @@ ________________________________________________________________________________
 
 #include <LLP/include/base_address.h>
 
+#include <Util/include/metrics.h>
+
 #include <vector>
 #include <cstdint>
+#include <deque>
+#include <memory>
 #include <mutex>
 #include <atomic>
 
@@ -34,6 +38,20 @@ namespace LLP
     const uint64_t MAX_SEND_BUFFER = 3 * 1024 * 1024; //3MB max send buffer
 
 
+    /** The most buffers gathered into one send. **/
+    const uint32_t MAX_SEND_GATHER = 64;
+
+
+    /** SendBuffer
+     *
+     *  An immutable serialized packet. It is shared by the send queue of every
+     *  connection it is written to, so a packet sent to many connections is only
+     *  serialized and stored once.
+     *
+     **/
+    typedef std::shared_ptr<const std::vector<uint8_t>> SendBuffer;
+
+
     /** Socket
      *
      *  Base Template class to handle outgoing / incoming LLP data for both
@@ -68,8 +86,16 @@ namespace LLP
         std::atomic<int32_t> nError;
 
 
-        /** Oversize buffer for large packets. **/
-        std::vector<uint8_t> vBuffer;
+        /** The buffers waiting to be sent, oldest first. **/
+        std::deque<SendBuffer> qSend;
+
+
+        /** The bytes of the oldest buffer that were already sent. **/
+        uint64_t nSendOffset;
+
+
+        /** The total bytes waiting to be sent. **/
+        std::atomic<uint64_t> nBuffered;
 
 
         /** Flag to catch if buffer write failed. **/
@@ -96,6 +122,11 @@ namespace LLP
         BaseAddress addr;
 
 
+        /** The counters of the bytes received and sent, shared by the connections of a server. **/
+        metrics::Counter* BYTES_RECEIVED;
+        metrics::Counter* BYTES_SENT;
+
+
         /** The default constructor. **/
         Socket();
 
@@ -205,9 +236,22 @@ namespace LLP
         int32_t Write(const std::vector<uint8_t>& vData, size_t nBytes);
 
 
+        /** Write
+         *
+         *  Write a shared buffer into the socket buffer non-blocking. Whatever can't be
+         *  sent now is queued by reference, without copying the buffer.
+         *
+         *  @param[in] pBuffer The buffer to write.
+         *
+         *  @return the total bytes that were written
+         *
+         **/
+        int32_t Write(const SendBuffer& pBuffer);
+
+
         /** Flush
          *
-         *  Flushes data out of the overflow buffer
+         *  Flushes data out of the send queue, gathering up to MAX_SEND_GATHER buffers into one send.
          *
          *  @return the total bytes that were written
          *
@@ -287,6 +331,20 @@ namespace LLP
          **/
         int32_t error_code() const;
 
+
+        /** send_bytes
+         *
+         *  Send bytes to the socket non-blocking, setting the error on failure.
+         *  Must be called holding DATA_MUTEX.
+         *
+         *  @param[in] pData The bytes to send.
+         *  @param[in] nBytes The number of bytes to send.
+         *
+         *  @return the total bytes that were sent, or negative on error.
+         *
+         **/
+        int32_t send_bytes(const uint8_t* pData, const size_t nBytes);
+
     };
 
 }
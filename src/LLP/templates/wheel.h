@@ -0,0 +1,114 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#pragma once
+#ifndef NEXUS_LLP_TEMPLATES_WHEEL_H
+#define NEXUS_LLP_TEMPLATES_WHEEL_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace LLP
+{
+
+    /** TimerWheel
+     *
+     *  Timers in a ring of slots, one slot per tick. A timer is stored in the slot of
+     *  the tick it is due, so expiring the timers of a tick only touches that slot,
+     *  however many timers there are. Timers further out than the ring go around it,
+     *  and are kept until their tick comes.
+     *
+     *  Times are in milliseconds and passed in by the caller. Not thread safe.
+     *
+     **/
+    class TimerWheel
+    {
+        /* The milliseconds of each tick. */
+        uint64_t nTick;
+
+
+        /* The timers of each slot, as their id and the tick they are due. */
+        std::vector< std::vector< std::pair<uint32_t, uint64_t> > > vSlots;
+
+
+        /* The last tick that was expired. */
+        uint64_t nCurrent;
+
+
+        /* The number of timers. */
+        uint64_t nTimers;
+
+
+    public:
+
+        /** Default Constructor. **/
+        TimerWheel()                                     = delete;
+
+
+        /** Tick Constructor
+         *
+         *  @param[in] nTickIn The milliseconds of each tick.
+         *  @param[in] nSlots The number of slots in the ring.
+         *  @param[in] nNow The current time.
+         *
+         **/
+        TimerWheel(const uint32_t nTickIn, const uint32_t nSlots, const uint64_t nNow);
+
+
+        /** Schedule
+         *
+         *  Add a timer. A timer is due no sooner than the next tick.
+         *
+         *  @param[in] nId The id to expire the timer with.
+         *  @param[in] nDelay The milliseconds until it is due.
+         *  @param[in] nNow The current time.
+         *
+         *  @return The tick the timer is due, to tell it apart from other timers of the id.
+         *
+         **/
+        uint64_t Schedule(const uint32_t nId, const uint64_t nDelay, const uint64_t nNow);
+
+
+        /** Expire
+         *
+         *  Remove the timers that are due.
+         *
+         *  @param[in] nNow The current time.
+         *  @param[out] vExpired The id and tick of each timer that was due, cleared first.
+         *
+         **/
+        void Expire(const uint64_t nNow, std::vector< std::pair<uint32_t, uint64_t> >& vExpired);
+
+
+        /** Timeout
+         *
+         *  Get the milliseconds until the next tick with timers, up to a limit.
+         *
+         *  @param[in] nNow The current time.
+         *  @param[in] nMax The most milliseconds to return.
+         *
+         **/
+        uint64_t Timeout(const uint64_t nNow, const uint64_t nMax) const;
+
+
+        /** Size
+         *
+         *  Get the number of timers.
+         *
+         **/
+        uint64_t Size() const;
+    };
+}
+
+#endif
@@ -91,6 +91,14 @@ namespace LLP
     std::map<uint256_t, uint64_t> TritiumNode::mapP2PRequests;
 
 
+    /* Declaration of subscription index mutex. */
+    std::mutex TritiumNode::SUBSCRIBERS_MUTEX;
+
+
+    /* Declaration of subscription index. */
+    std::map<std::pair<uint8_t, uint256_t>, std::set<const TritiumNode*>> TritiumNode::mapSubscribers;
+
+
     /* Declaration of block height at the start of last sync. */
     std::atomic<uint32_t> TritiumNode::nSyncStart(0);
 
@@ -213,6 +221,8 @@ namespace LLP
     /** Default Destructor **/
     TritiumNode::~TritiumNode()
     {
+        /* Make sure no relay can match this node once it is gone. */
+        clear_subscriptions();
     }
 
 
@@ -510,6 +520,8 @@ namespace LLP
                 nUnsubscribed   = 0;
                 nNotifications  = 0;
 
+                clear_subscriptions();
+
                 break;
             }
         }
@@ -648,6 +660,10 @@ namespace LLP
                 if(TAO::Ledger::ChainState::Synchronizing())
                     return true;
 
+                /* Stop relaying the previous sigchain, the subscription moves to the new one once accepted. */
+                if(nNotifications & SUBSCRIPTION::SIGCHAIN)
+                    index_subscription(TYPES::SIGCHAIN, hashGenesis, false);
+
                 /* Hard requirement for genesis. */
                 ssPacket >> hashGenesis;
 
@@ -712,6 +728,10 @@ namespace LLP
                 fAuthorized = true;
                 debug::log(0, NODE, "ACTION::AUTH: ", hashGenesis.SubString(), " AUTHORIZATION ACCEPTED");
 
+                /* Relay the sigchain of the new login if the peer is subscribed. */
+                if(nNotifications & SUBSCRIPTION::SIGCHAIN)
+                    index_subscription(TYPES::SIGCHAIN, hashGenesis, true);
+
                 PushMessage(RESPONSE::AUTHORIZED, hashGenesis);
 
 
@@ -1088,6 +1108,7 @@ namespace LLP
 
                                 /* Set the best chain flag. */
                                 nNotifications |= SUBSCRIPTION::SIGCHAIN;
+                                index_subscription(TYPES::SIGCHAIN, hashGenesis, true);
 
                                 /* Debug output. */
                                 debug::log(3, NODE, "ACTION::SUBSCRIBE::SIGCHAIN: ", std::bitset<16>(nNotifications));
@@ -1100,6 +1121,7 @@ namespace LLP
 
                                 /* Unset the bestchain flag. */
                                 nNotifications &= ~SUBSCRIPTION::SIGCHAIN;
+                                index_subscription(TYPES::SIGCHAIN, hashGenesis, false);
 
                                 /* Debug output. */
                                 debug::log(3, NODE, "ACTION::UNSUBSCRIBE::SIGCHAIN: " , std::bitset<16>(nNotifications));
@@ -1147,6 +1169,7 @@ namespace LLP
 
                                 /* Add the address to the notifications vector for this peer */
                                 vNotifications.push_back(hashAddress);
+                                index_subscription(TYPES::NOTIFICATION, hashAddress, true);
 
                                 /* Debug output. */
                                 debug::log(3, NODE, "ACTION::SUBSCRIBE::NOTIFICATION: ", hashAddress.ToString());
@@ -1162,6 +1185,7 @@ namespace LLP
 
                                 /* Remove the address from the notifications vector for this peer */
                                 vNotifications.erase(std::find(vNotifications.begin(), vNotifications.end(), hashAddress));
+                                index_subscription(TYPES::NOTIFICATION, hashAddress, false);
 
                                 /* Debug output. */
                                 debug::log(3, NODE, "ACTION::UNSUBSCRIBE::NOTIFICATION: " , hashAddress.ToString());
@@ -3197,7 +3221,9 @@ namespace LLP
                                 }
 
                                 /* Flush to disk and clear mempool. */
-                                LLD::TxnCommit(TAO::Ledger::FLAGS::BLOCK);
+                                if(!LLD::TxnCommit(TAO::Ledger::FLAGS::BLOCK))
+                                    return debug::error(FUNCTION, "tx ", hashTx.SubString(), " failed to commit to database");
+
                                 TAO::Ledger::mempool.Remove(hashTx);
 
                                 /* Verbose=3 dumps transaction data. */
@@ -3264,7 +3290,9 @@ namespace LLP
                                     }
 
                                     /* Flush to disk and clear mempool. */
-                                    LLD::TxnCommit(TAO::Ledger::FLAGS::BLOCK);
+                                    if(!LLD::TxnCommit(TAO::Ledger::FLAGS::BLOCK))
+                                        return debug::error(FUNCTION, "tx ", hashTx.SubString(), " failed to commit to database");
+
                                     TAO::Ledger::mempool.Remove(hashTx);
 
                                     debug::log(0, hashTx.SubString(), " ACCEPTED");
@@ -3959,296 +3987,295 @@ namespace LLP
     }
 
 
-    /* Checks if a node is subscribed to receive a notification. */
-    const DataStream TritiumNode::RelayFilter(const uint16_t nMsg, const DataStream& ssData) const
+    /* Parse a relay message once for all the connections of a data thread. */
+    TritiumNode::Relay::Relay(const uint16_t nMsg, const DataStream& ssDataIn)
+    : BaseConnection<MessagePacket>::Relay (nMsg, ssDataIn)
+    , nRequest                             (0)
+    , vNotifications                       ( )
+    , mapMatches                           ( )
+    , mapPackets                           ( )
     {
-        /* The data stream to relay*/
-        DataStream ssRelay(SER_NETWORK, MIN_PROTO_VERSION);
+        /* Get the request type to filter by protocol version. */
+        if(MESSAGE == ACTION::REQUEST && ssData.size() > 0)
+        {
+            ssData.Reset();
+            ssData >> nRequest;
+        }
 
-        /* Switch based on message type */
-        switch(nMsg)
+        /* Only notifications are split up. */
+        if(MESSAGE != ACTION::NOTIFY)
+            return;
+
+        /* The sigchains and registers that are notified, with their notification. */
+        std::vector< std::pair<std::pair<uint8_t, uint256_t>, uint32_t> > vWatched;
+
+        /* Split the stream into its notifications. */
+        ssData.Reset();
+        try
         {
-            /* Filter out request messages so that we don't send them to peers on older protocol versions */
-            case ACTION::REQUEST :
+            while(!ssData.End())
             {
-                /* Get the request type */
+                /* The notification is relayed from its type, or its specifier if it is kept. */
+                uint32_t nBegin = static_cast<uint32_t>(ssData.GetPos());
+
+                /* Get the first notify type. */
                 uint8_t nType = 0;
                 ssData >> nType;
 
+                /* Check for legacy or poolstake specifier. */
+                bool fLegacy = false;
+                if(nType == SPECIFIER::LEGACY)
+                {
+                    fLegacy = true;
+
+                    /* Go to next type in stream. */
+                    ssData >> nType;
+                }
+
+                /* The subscription the notification is for, and the address it watches. */
+                uint16_t nSubscription = 0;
+                uint256_t hashAddress  = 0;
+
                 /* Switch based on type. */
                 switch(nType)
                 {
-                    case TYPES::P2PCONNECTION:
+                    /* Blocks are relayed without their specifier. */
+                    case TYPES::BLOCK:
                     {
-                        /* Ensure the peer is on a high enough version to receive the P2PCONNECTION message */
-                        if(nProtocolVersion >= MIN_TRITIUM_VERSION)
-                            ssRelay = ssData;
+                        uint1024_t hashBlock;
+                        ssData >> hashBlock;
+
+                        if(fLegacy)
+                            ++nBegin;
+
+                        nSubscription = SUBSCRIPTION::BLOCK;
                         break;
                     }
-                    default:
+
+                    case TYPES::TRANSACTION:
                     {
-                        /* Default to letting the message be relayed */
-                        ssRelay = ssData;
+                        uint512_t hashTx;
+                        ssData >> hashTx;
+
+                        nSubscription = SUBSCRIPTION::TRANSACTION;
                         break;
                     }
-                }
-
-                break;
-            }
-
-            /* Filter notifications. */
-            case ACTION::NOTIFY:
-            {
-                /* Build a response data stream. */
-                while(!ssData.End())
-                {
-                    /* Get the first notify type. */
-                    uint8_t nType = 0;
-                    ssData >> nType;
 
-                    /* Check for legacy or poolstake specifier. */
-                    bool fLegacy = false;
-                    if(nType == SPECIFIER::LEGACY)
+                    case TYPES::BESTHEIGHT:
                     {
-                        /* Set specifiers. */
-                        fLegacy    = (nType == SPECIFIER::LEGACY);
+                        uint32_t nHeight;
+                        ssData >> nHeight;
 
-                        /* Go to next type in stream. */
-                        ssData >> nType;
+                        nSubscription = SUBSCRIPTION::BESTHEIGHT;
+                        break;
                     }
 
-                    /* Switch based on type. */
-                    switch(nType)
+                    case TYPES::CHECKPOINT:
                     {
-                        /* Check for block subscription. */
-                        case TYPES::BLOCK:
-                        {
-                            /* Get the index. */
-                            uint1024_t hashBlock;
-                            ssData >> hashBlock;
-
-                            /* Check subscription. */
-                            if(nNotifications & SUBSCRIPTION::BLOCK)
-                            {
-                                /* Write block to stream. */
-                                ssRelay << uint8_t(TYPES::BLOCK);
-                                ssRelay << hashBlock;
-                            }
-
-                            break;
-                        }
-
-
-                        /* Check for transaction subscription. */
-                        case TYPES::TRANSACTION:
-                        {
-                            /* Get the index. */
-                            uint512_t hashTx;
-                            ssData >> hashTx;
+                        uint1024_t hashCheck;
+                        ssData >> hashCheck;
 
-                            /* Check subscription. */
-                            if(nNotifications & SUBSCRIPTION::TRANSACTION)
-                            {
-                                /* Check for legacy. */
-                                if(fLegacy)
-                                    ssRelay << uint8_t(SPECIFIER::LEGACY);
+                        nSubscription = SUBSCRIPTION::CHECKPOINT;
+                        break;
+                    }
 
-                                /* Write transaction to stream. */
-                                ssRelay << uint8_t(TYPES::TRANSACTION);
-                                ssRelay << hashTx;
-                            }
+                    case TYPES::BESTCHAIN:
+                    {
+                        uint1024_t hashBest;
+                        ssData >> hashBest;
 
-                            break;
-                        }
+                        nSubscription = SUBSCRIPTION::BESTCHAIN;
+                        break;
+                    }
 
+                    case TYPES::ADDRESS:
+                    {
+                        BaseAddress addr;
+                        ssData >> addr;
 
-                        /* Check for height subscription. */
-                        case TYPES::BESTHEIGHT:
-                        {
-                            /* Get the index. */
-                            uint32_t nHeight;
-                            ssData >> nHeight;
+                        nSubscription = SUBSCRIPTION::ADDRESS;
+                        break;
+                    }
 
-                            /* Check for legacy. */
-                            if(fLegacy)
-                            {
-                                debug::error(FUNCTION, "BESTHEIGHT cannot have legacy specifier");
-                                continue;
-                            }
+                    /* Sigchain notifications only go to the peer logged in to the sigchain. */
+                    case TYPES::SIGCHAIN:
+                    {
+                        uint512_t hashTx;
+                        ssData >> hashAddress;
+                        ssData >> hashTx;
 
-                            /* Check subscription. */
-                            if(nNotifications & SUBSCRIPTION::BESTHEIGHT)
-                            {
-                                /* Write transaction to stream. */
-                                ssRelay << uint8_t(TYPES::BESTHEIGHT);
-                                ssRelay << nHeight;
-                            }
+                        nSubscription = SUBSCRIPTION::SIGCHAIN;
+                        break;
+                    }
 
-                            break;
-                        }
+                    /* Register notifications only go to the peers watching the register. */
+                    case TYPES::NOTIFICATION:
+                    {
+                        uint512_t hashTx;
+                        ssData >> hashAddress;
+                        ssData >> hashTx;
 
+                        nSubscription = SUBSCRIPTION::NOTIFICATION;
+                        break;
+                    }
 
-                        /* Check for checkpoint subscription. */
-                        case TYPES::CHECKPOINT:
-                        {
-                            /* Get the index. */
-                            uint1024_t hashCheck;
-                            ssData >> hashCheck;
+                    /* Default catch (relay up to this point) */
+                    default:
+                    {
+                        debug::error(FUNCTION, "Malformed binary stream");
+                        throw std::runtime_error("unknown notification type");
+                    }
+                }
 
-                            /* Check for legacy. */
-                            if(fLegacy)
-                            {
-                                debug::error(FUNCTION, "CHECKPOINT cannot have legacy specifier");
-                                continue;
-                            }
+                /* These types have no legacy form, so they are not relayed with one. */
+                if(fLegacy && (nType == TYPES::BESTHEIGHT || nType == TYPES::CHECKPOINT || nType == TYPES::BESTCHAIN || nType == TYPES::ADDRESS))
+                {
+                    debug::error(FUNCTION, "notification type ", uint32_t(nType), " cannot have legacy specifier");
+                    continue;
+                }
 
-                            /* Check subscription. */
-                            if(nNotifications & SUBSCRIPTION::CHECKPOINT)
-                            {
-                                /* Write transaction to stream. */
-                                ssRelay << uint8_t(TYPES::CHECKPOINT);
-                                ssRelay << hashCheck;
-                            }
+                /* Remember which sigchain or register the notification watches. */
+                if(nType == TYPES::SIGCHAIN || nType == TYPES::NOTIFICATION)
+                    vWatched.push_back(std::make_pair(std::make_pair(nType, hashAddress), static_cast<uint32_t>(vNotifications.size())));
 
-                            break;
-                        }
+                Notification notification;
+                notification.nSubscription = nSubscription;
+                notification.nBegin        = nBegin;
+                notification.nEnd          = static_cast<uint32_t>(ssData.GetPos());
 
+                vNotifications.push_back(notification);
+            }
+        }
+        catch(const std::exception& e) { }
 
-                        /* Check for best chain subscription. */
-                        case TYPES::BESTCHAIN:
-                        {
-                            /* Get the index. */
-                            uint1024_t hashBest;
-                            ssData >> hashBest;
+        /* Find the connections watching each sigchain and register, with one lookup for the relay. */
+        if(!vWatched.empty())
+        {
+            LOCK(SUBSCRIBERS_MUTEX);
 
-                            /* Check for legacy. */
-                            if(fLegacy)
-                            {
-                                debug::error(FUNCTION, "BESTCHAIN cannot have legacy specifier");
-                                continue;
-                            }
+            for(const auto& watched : vWatched)
+            {
+                const auto it = mapSubscribers.find(watched.first);
+                if(it == mapSubscribers.end())
+                    continue;
 
-                            /* Check subscription. */
-                            if(nNotifications & SUBSCRIPTION::BESTCHAIN)
-                            {
-                                /* Write transaction to stream. */
-                                ssRelay << uint8_t(TYPES::BESTCHAIN);
-                                ssRelay << hashBest;
-                            }
+                for(const TritiumNode* pNode : it->second)
+                    mapMatches[pNode].push_back(watched.second);
+            }
+        }
+    }
 
-                            break;
-                        }
 
+    /* Get the NOTIFY packet for a connection. */
+    SendBuffer TritiumNode::Relay::Notify(const uint16_t nMask, const std::vector<uint32_t>& vMatches)
+    {
+        /* Connections without matches share the packet of their subscriptions. */
+        if(vMatches.empty() && mapPackets.count(nMask))
+            return mapPackets[nMask];
 
-                        /* Check for address subscription. */
-                        case TYPES::ADDRESS:
-                        {
-                            /* Get the index. */
-                            BaseAddress addr;
-                            ssData >> addr;
+        /* Copy the notifications of the connection, keeping their order. */
+        DataStream ssRelay(SER_NETWORK, MIN_PROTO_VERSION);
 
-                            /* Check for legacy. */
-                            if(fLegacy)
-                            {
-                                debug::error(FUNCTION, "ADDRESS cannot have legacy specifier");
-                                continue;
-                            }
+        auto itMatch = vMatches.begin();
+        for(uint32_t n = 0; n < vNotifications.size(); ++n)
+        {
+            const Notification& notification = vNotifications[n];
 
-                            /* Check subscription. */
-                            if(nNotifications & SUBSCRIPTION::ADDRESS)
-                            {
-                                /* Write transaction to stream. */
-                                ssRelay << uint8_t(TYPES::ADDRESS);
-                                ssRelay << addr;
-                            }
+            /* Sigchain and register notifications need a match as well as the subscription. */
+            bool fMatched = true;
+            if(notification.nSubscription == SUBSCRIPTION::SIGCHAIN || notification.nSubscription == SUBSCRIPTION::NOTIFICATION)
+            {
+                fMatched = (itMatch != vMatches.end() && *itMatch == n);
+                if(fMatched)
+                    ++itMatch;
+            }
 
-                            break;
-                        }
+            if(fMatched && (nMask & notification.nSubscription))
+                ssRelay.write((const char*)&ssData.Bytes()[notification.nBegin], notification.nEnd - notification.nBegin);
+        }
 
+        /* Build the packet, sharing the queued one if nothing was left out. */
+        SendBuffer pPacket;
+        if(ssRelay.Bytes() == ssData.Bytes())
+            pPacket = Packet();
+        else if(ssRelay.size() > 0)
+        {
+            MessagePacket PACKET(MESSAGE);
+            PACKET.SetData(ssRelay);
 
-                        /* Check for sigchain subscription. */
-                        case TYPES::SIGCHAIN:
-                        {
-                            /* Get the index. */
-                            uint256_t hashSigchain = 0;
-                            ssData >> hashSigchain;
+            pPacket = std::make_shared<const std::vector<uint8_t>>(PACKET.GetBytes());
+        }
 
-                            /* Get the txid. */
-                            uint512_t hashTx = 0;
-                            ssData >> hashTx;
+        /* Keep the packet for the other connections with the same subscriptions. */
+        if(vMatches.empty())
+            mapPackets[nMask] = pPacket;
 
-                            /* Check subscription. */
-                            if(nNotifications & SUBSCRIPTION::SIGCHAIN)
-                            {
-                                /* Check for matching sigchain-id. */
-                                if(hashSigchain != hashGenesis)
-                                    break;
+        return pPacket;
+    }
 
-                                /* Check for legacy. */
-                                if(fLegacy)
-                                    ssRelay << uint8_t(SPECIFIER::LEGACY);
 
-                                /* Write transaction to stream. */
-                                ssRelay << uint8_t(TYPES::SIGCHAIN);
-                                ssRelay << hashSigchain;
-                                ssRelay << hashTx;
-                            }
+    /* Get the packet of a relay message with the notifications this node is subscribed to. */
+    SendBuffer TritiumNode::RelayFilter(Relay& RELAY) const
+    {
+        /* Switch based on message type */
+        switch(RELAY.MESSAGE)
+        {
+            /* Filter out request messages so that we don't send them to peers on older protocol versions */
+            case ACTION::REQUEST:
+            {
+                /* Ensure the peer is on a high enough version to receive the P2PCONNECTION message */
+                if(RELAY.nRequest == TYPES::P2PCONNECTION && nProtocolVersion < MIN_TRITIUM_VERSION)
+                    return SendBuffer();
 
-                            break;
-                        }
+                return RELAY.Packet();
+            }
 
+            /* Filter notifications. */
+            case ACTION::NOTIFY:
+            {
+                static const std::vector<uint32_t> vNone;
 
-                        /* Check for notification subscription. */
-                        case TYPES::NOTIFICATION:
-                        {
-                            /* Get the sig chain / register that the transaction relates to. */
-                            uint256_t hashAddress = 0;
-                            ssData >> hashAddress;
+                /* Look up the sigchain and register notifications this node was matched to. */
+                const auto it = RELAY.mapMatches.find(this);
+                return RELAY.Notify(nNotifications.load(), (it == RELAY.mapMatches.end()) ? vNone : it->second);
+            }
 
-                            /* Get the txid. */
-                            uint512_t hashTx = 0;
-                            ssData >> hashTx;
+            /* default behaviour is to let the message be relayed */
+            default:
+                return RELAY.Packet();
+        }
+    }
 
-                            /* Check subscription. */
-                            if(nNotifications & SUBSCRIPTION::NOTIFICATION)
-                            {
-                                /* Check that the address is one that has been subscribed to */
-                                if(std::find(vNotifications.begin(), vNotifications.end(), hashAddress) == vNotifications.end())
-                                    break;
 
-                                /* Check for legacy. */
-                                if(fLegacy)
-                                    ssRelay << uint8_t(SPECIFIER::LEGACY);
+    /* Add this node to or remove it from the subscription index. */
+    void TritiumNode::index_subscription(const uint8_t nType, const uint256_t& hashAddress, const bool fSubscribe)
+    {
+        LOCK(SUBSCRIBERS_MUTEX);
 
-                                /* Write transaction to stream. */
-                                ssRelay << uint8_t(TYPES::NOTIFICATION);
-                                ssRelay << hashAddress;
-                                ssRelay << hashTx;
-                            }
+        const std::pair<uint8_t, uint256_t> pairKey = std::make_pair(nType, hashAddress);
+        if(fSubscribe)
+        {
+            mapSubscribers[pairKey].insert(this);
+            return;
+        }
 
-                            break;
-                        }
+        /* Drop the entry once nobody watches the address. */
+        const auto it = mapSubscribers.find(pairKey);
+        if(it == mapSubscribers.end())
+            return;
 
-                        /* Default catch (relay up to this point) */
-                        default:
-                        {
-                            debug::error(FUNCTION, "Malformed binary stream");
-                            return ssRelay;
-                        }
-                    }
-                }
+        it->second.erase(this);
+        if(it->second.empty())
+            mapSubscribers.erase(it);
+    }
 
-                break;
-            }
-            default:
-            {
-                /* default behaviour is to let the message be relayed */
-                ssRelay = ssData;
-                break;
-            }
-        }
 
-        return ssRelay;
+    /* Remove this node from the subscription index for everything it watches. */
+    void TritiumNode::clear_subscriptions()
+    {
+        index_subscription(TYPES::SIGCHAIN, hashGenesis, false);
+        for(const uint256_t& hashAddress : vNotifications)
+            index_subscription(TYPES::NOTIFICATION, hashAddress, false);
     }
 
 
@@ -83,16 +83,30 @@ namespace LLP
         bool ProcessPacket() final;
 
 
+        /** Execute
+         *
+         *  Run an API request on a worker and build its response.
+         *
+         *  @param[in] REQUEST The request to handle.
+         *  @param[out] RESPONSE The response to send.
+         *  @param[out] strMethod The method name to record the latency of the request by.
+         *
+         *  @return True to keep the connection open.
+         *
+         **/
+        bool Execute(HTTPPacket& REQUEST, HTTPPacket& RESPONSE, std::string& strMethod) final;
+
+
         /** Authorized
          *
          *  Check if an authorization base64 encoded string is correct.
          *
-         *  @param[in] mapHeaders The list of headers to check.
+         *  @param[in] HEADERS The headers to check.
          *
          *  @return True if this connection is authorized.
          *
          **/
-        bool Authorized(std::map<std::string, std::string>& mapHeaders);
+        bool Authorized(const HTTPHeaders& HEADERS);
 
 
         /** QuerystringToJSON
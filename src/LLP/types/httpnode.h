@@ -18,10 +18,17 @@ ________________________________________________________________________________
 #include <LLP/templates/base_connection.h>
 #include <LLP/packets/http.h>
 
+#include <Util/include/runtime.h>
+
+#include <memory>
+#include <mutex>
+#include <queue>
 #include <string>
 #include <vector>
 #include <cstdint>
 
+class WorkerPool;
+
 
 #define HTTPNODE ANSI_COLOR_FUNCTION "HTTPNode" ANSI_COLOR_RESET " : "
 
@@ -46,12 +53,39 @@ namespace LLP
      *
      *  This could also be used as the base for a HTTP-LLP server implementation.
      *
+     *  Requests can be dispatched to a worker pool, so slow requests don't hold up the
+     *  data thread reading the other connections. Each connection runs one request at a
+     *  time on the pool, so its responses are written in the order of its requests.
+     *
+     *  Connections are kept open between requests as HTTP/1.1 allows, and a client can
+     *  pipeline requests without waiting for the responses to the ones before.
+     *
      **/
-    class HTTPNode : public BaseConnection<HTTPPacket>
+    class HTTPNode : public BaseConnection<HTTPPacket>, public std::enable_shared_from_this<HTTPNode>
     {
         /* Internal Read Buffer. */
         std::vector<int8_t> vchBuffer;
 
+
+        /* The position in the read buffer that is parsed up to. */
+        uint64_t nBufferPos;
+
+
+        /* Flag to dump the request headers as they are read. */
+        bool fHeaderDump;
+
+
+        /* Mutex to protect the dispatched requests. */
+        std::mutex REQUEST_MUTEX;
+
+
+        /* The dispatched requests waiting to run, with the time they have waited. */
+        std::queue< std::pair<HTTPPacket, runtime::timer> > qRequests;
+
+
+        /* Flag to show a request of this connection is queued on or running in the pool. */
+        bool fExecuting;
+
     public:
 
         /** Default Constructor **/
@@ -122,6 +156,60 @@ namespace LLP
          **/
         void PushResponse(const uint16_t nMsg, const std::string& strContent);
 
+
+    protected:
+
+        /** Dispatch
+         *
+         *  Run the incoming packet as a request on a worker pool, after the earlier
+         *  requests of this connection. Requests are answered with 503 when the pool is full.
+         *
+         *  @param[in] pWorkers The pool to run the request on, or null to run it now.
+         *
+         *  @return False if the request was run now and the connection should be closed.
+         *
+         **/
+        bool Dispatch(WorkerPool* pWorkers);
+
+
+        /** Execute
+         *
+         *  Handle a request and build its response. Runs on the worker pool when dispatched.
+         *
+         *  @param[in] REQUEST The request to handle.
+         *  @param[out] RESPONSE The response to send.
+         *  @param[out] strMethod The method name to record the latency of the request by.
+         *
+         *  @return True to keep the connection open, false to close it once the response is sent.
+         *
+         **/
+        virtual bool Execute(HTTPPacket& REQUEST, HTTPPacket& RESPONSE, std::string& strMethod) = 0;
+
+
+    private:
+
+        /** submit
+         *
+         *  Queue the next dispatched request of this connection on a worker pool.
+         *
+         *  @param[in] pWorkers The pool to run the request on.
+         *
+         **/
+        void submit(WorkerPool* pWorkers);
+
+
+        /** execute
+         *
+         *  Run a request, send its response, and record its latency.
+         *
+         *  @param[in] REQUEST The request to run.
+         *  @param[in] nQueued The microseconds the request waited for a worker.
+         *
+         *  @return True to keep the connection open.
+         *
+         **/
+        bool execute(HTTPPacket& REQUEST, const uint64_t nQueued);
+
     };
 
 }
@@ -78,6 +78,20 @@ namespace LLP
          **/
         bool ProcessPacket() final;
 
+
+        /** Execute
+         *
+         *  Run an RPC request on a worker and build its response.
+         *
+         *  @param[in] REQUEST The request to handle.
+         *  @param[out] RESPONSE The response to send.
+         *  @param[out] strMethod The method name to record the latency of the request by.
+         *
+         *  @return True to keep the connection open, false to close it after an error.
+         *
+         **/
+        bool Execute(HTTPPacket& REQUEST, HTTPPacket& RESPONSE, std::string& strMethod) final;
+
     protected:
 
         /** JSONReply
@@ -101,21 +115,22 @@ namespace LLP
          *  @param[in] jsonError The JSON error response object.
          *  @param[in] jsonID The identifier of request.
          *
+         *  @return The packet to respond with.
          *
          **/
-        void ErrorReply(const json::json& jsonError, const json::json& jsonID);
+        HTTPPacket ErrorReply(const json::json& jsonError, const json::json& jsonID);
 
 
         /** Authorized
          *
          *  Check if an authorization base64 encoded string is correct.
          *
-         *  @param[in] mapHeaders The list of headers to check.
+         *  @param[in] HEADERS The headers to check.
          *
          *  @return True if this connection is authorized.
          *
          **/
-        bool Authorized(std::map<std::string, std::string>& mapHeaders);
+        bool Authorized(const HTTPHeaders& HEADERS);
 
     };
 }
@@ -29,6 +29,8 @@ ________________________________________________________________________________
 
 #include <Util/include/memory.h>
 
+#include <set>
+
 namespace LLP
 {
     namespace Tritium
@@ -179,6 +181,14 @@ namespace LLP
         std::vector<uint256_t> vNotifications;
 
 
+        /** Mutex for the subscription index. **/
+        static std::mutex SUBSCRIBERS_MUTEX;
+
+
+        /** The connections subscribed to sigchain and register notifications, by the type and address they watch. **/
+        static std::map<std::pair<uint8_t, uint256_t>, std::set<const TritiumNode*>> mapSubscribers;
+
+
     public:
 
         /** Mutex for connected sessions. **/
@@ -405,14 +415,80 @@ namespace LLP
         void SubscribeNotification(const uint256_t& hashAddress, bool fSubscribe = true);
 
 
+        /** Relay
+         *
+         *  A relay message parsed once for all the connections of a data thread.
+         *
+         *  A NOTIFY message is split into its notifications, and the connections subscribed to
+         *  the sigchains and registers it names are looked up in the subscription index. Each
+         *  connection is then sent the notifications it subscribed to, sharing the packet with
+         *  every connection that has the same subscriptions and no sigchain or register matches.
+         *
+         **/
+        class Relay : public BaseConnection<MessagePacket>::Relay
+        {
+        public:
+
+            /** A notification of a NOTIFY message, with the bytes it is relayed as. **/
+            struct Notification
+            {
+                uint16_t nSubscription;
+                uint32_t nBegin;
+                uint32_t nEnd;
+            };
+
+
+            /** The request type of a REQUEST message. **/
+            uint8_t nRequest;
+
+
+            /** The notifications of a NOTIFY message, in the order they were queued. **/
+            std::vector<Notification> vNotifications;
+
+
+            /** The notifications that only go to the connections subscribed to their sigchain or register. **/
+            std::map<const TritiumNode*, std::vector<uint32_t>> mapMatches;
+
+
+            /** Constructor
+             *
+             *  @param[in] nMsg The message type.
+             *  @param[in] ssDataIn The message data, which must outlive the relay.
+             *
+             **/
+            Relay(const uint16_t nMsg, const DataStream& ssDataIn);
+
+
+            /** Notify
+             *
+             *  Get the NOTIFY packet for a connection.
+             *
+             *  @param[in] nMask The subscriptions of the connection.
+             *  @param[in] vMatches The notifications of the sigchains or registers the connection subscribed to.
+             *
+             *  @return The packet to send, or null if there is nothing to send.
+             *
+             **/
+            SendBuffer Notify(const uint16_t nMask, const std::vector<uint32_t>& vMatches);
+
+
+        private:
+
+            /** The packets of connections without matches, by their subscriptions. **/
+            std::map<uint16_t, SendBuffer> mapPackets;
+        };
+
+
         /** RelayFilter
          *
-         *  Checks if a node is subscribed to receive a notification.
+         *  Get the packet of a relay message with the notifications this node is subscribed to.
+         *
+         *  @param[in] RELAY The relay message.
          *
-         *  @return a data stream with relevant relay information
+         *  @return The packet to send, or null to send nothing.
          *
          **/
-        const DataStream RelayFilter(const uint16_t nMsg, const DataStream& ssData) const;
+        SendBuffer RelayFilter(Relay& RELAY) const;
 
 
         /** Auth
@@ -574,6 +650,28 @@ namespace LLP
          **/
         void Sync();
 
+
+    private:
+
+        /** index_subscription
+         *
+         *  Add this node to or remove it from the subscription index.
+         *
+         *  @param[in] nType The notification type, SIGCHAIN or NOTIFICATION.
+         *  @param[in] hashAddress The sigchain or register the node watches.
+         *  @param[in] fSubscribe Flag to add the node, or remove it.
+         *
+         **/
+        void index_subscription(const uint8_t nType, const uint256_t& hashAddress, const bool fSubscribe);
+
+
+        /** clear_subscriptions
+         *
+         *  Remove this node from the subscription index for everything it watches.
+         *
+         **/
+        void clear_subscriptions();
+
     };
 } // end namespace LLP
 
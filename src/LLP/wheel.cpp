@@ -0,0 +1,104 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLP/templates/wheel.h>
+
+#include <algorithm>
+
+namespace LLP
+{
+
+    /* Tick Constructor */
+    TimerWheel::TimerWheel(const uint32_t nTickIn, const uint32_t nSlots, const uint64_t nNow)
+    : nTick    (std::max(nTickIn, 1u))
+    , vSlots   (std::max(nSlots, 1u))
+    , nCurrent (nNow / nTick)
+    , nTimers  (0)
+    {
+    }
+
+
+    /* Add a timer. */
+    uint64_t TimerWheel::Schedule(const uint32_t nId, const uint64_t nDelay, const uint64_t nNow)
+    {
+        /* Round up to the tick it is due, as the current tick may already be expired. */
+        const uint64_t nDue = std::max((nNow + nDelay + nTick - 1) / nTick, nCurrent + 1);
+
+        vSlots[nDue % vSlots.size()].push_back(std::make_pair(nId, nDue));
+        ++nTimers;
+
+        return nDue;
+    }
+
+
+    /* Remove the timers that are due. */
+    void TimerWheel::Expire(const uint64_t nNow, std::vector< std::pair<uint32_t, uint64_t> >& vExpired)
+    {
+        vExpired.clear();
+
+        const uint64_t nTarget = nNow / nTick;
+        if(nTarget <= nCurrent)
+            return;
+
+        /* Once a whole turn has passed every slot has timers that may be due. */
+        const uint64_t nSteps = std::min(nTarget - nCurrent, uint64_t(vSlots.size()));
+        for(uint64_t nStep = 1; nStep <= nSteps; ++nStep)
+        {
+            std::vector< std::pair<uint32_t, uint64_t> >& vSlot = vSlots[(nCurrent + nStep) % vSlots.size()];
+
+            /* Keep the timers that are a turn or more away. */
+            uint32_t nKeep = 0;
+            for(uint32_t n = 0; n < vSlot.size(); ++n)
+            {
+                if(vSlot[n].second <= nTarget)
+                    vExpired.push_back(vSlot[n]);
+                else
+                    vSlot[nKeep++] = vSlot[n];
+            }
+
+            vSlot.resize(nKeep);
+        }
+
+        nCurrent = nTarget;
+        nTimers -= vExpired.size();
+    }
+
+
+    /* Get the milliseconds until the next tick with timers, up to a limit. */
+    uint64_t TimerWheel::Timeout(const uint64_t nNow, const uint64_t nMax) const
+    {
+        /* Look for the first slot with timers within the limit. */
+        const uint64_t nSteps = std::min(nMax / nTick + 1, uint64_t(vSlots.size()));
+        for(uint64_t nStep = 1; nStep <= nSteps; ++nStep)
+        {
+            if(vSlots[(nCurrent + nStep) % vSlots.size()].empty())
+                continue;
+
+            /* The time the tick starts. */
+            const uint64_t nDue = (nCurrent + nStep) * nTick;
+            if(nDue <= nNow)
+                return 0;
+
+            return std::min(nDue - nNow, nMax);
+        }
+
+        return nMax;
+    }
+
+
+    /* Get the number of timers. */
+    uint64_t TimerWheel::Size() const
+    {
+        return nTimers;
+    }
+}
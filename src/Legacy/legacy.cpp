@@ -547,7 +547,8 @@ namespace Legacy
         }
 
         /* Commit the transaction to database. */
-        LLD::TxnCommit();
+        if(!LLD::TxnCommit())
+            return debug::error(FUNCTION, "failed to commit block to database");
 
         return true;
     }
@@ -729,24 +730,22 @@ namespace Legacy
         /* Signature hash for version 7 blocks. */
         if(nVersion >= 7)
         {
-            /* Create a data stream to get the hash. */
-            DataStream ss(SER_GETHASH, LLP::PROTOCOL_VERSION);
-            ss.reserve(256);
+            /* Create a stream to get the hash. */
+            LLC::SK1024Stream ss(SER_GETHASH, LLP::PROTOCOL_VERSION);
 
             /* Serialize the data to hash into a stream. */
             ss << nVersion << hashPrevBlock << hashMerkleRoot << nChannel << nHeight << nBits << nNonce << nTime << vOffsets;
 
-            return LLC::SK1024(ss.begin(), ss.end());
+            return ss.GetHash();
         }
 
-        /* Create a data stream to get the hash. */
-        DataStream ss(SER_GETHASH, LLP::PROTOCOL_VERSION);
-        ss.reserve(256);
+        /* Create a stream to get the hash. */
+        LLC::SK1024Stream ss(SER_GETHASH, LLP::PROTOCOL_VERSION);
 
         /* Serialize the data to hash into a stream. */
         ss << nVersion << hashPrevBlock << hashMerkleRoot << nChannel << nHeight << nBits << nNonce << uint32_t(nTime);
 
-        return LLC::SK1024(ss.begin(), ss.end());
+        return ss.GetHash();
     }
 
 
@@ -45,11 +45,11 @@ namespace TAO
             RLOCK(MUTEX);
 
             /* Check the mempool. */
-            if(mapLegacy.count(nTxHash))
+            if(mapLegacy.Has(nTxHash))
                 return false;
 
             /* Add to the map. */
-            mapLegacy[nTxHash] = tx;
+            mapLegacy.Put(nTxHash, tx);
 
             return true;
         }
@@ -95,7 +95,7 @@ namespace TAO
                 {
                     /* Add to conflicts map. */
                     debug::error(FUNCTION, "LEGACY CONFLICT: INPUTS CLAIMED ", vin.prevout.hash.SubString(), ", ", vin.prevout.n);
-                    mapLegacyConflicts[hashTx] = tx;
+                    mapLegacyConflicts.Put(hashTx, tx);
 
                     return false;
                 }
@@ -229,7 +229,7 @@ namespace TAO
                 mapInputs[tx.vin[i].prevout] = hashTx;
 
             /* Add to the legacy map. */
-            mapLegacy[hashTx] = tx;
+            mapLegacy.Put(hashTx, tx);
 
             /* Relay tx if creating ourselves. */
             if(!pnode && LLP::TRITIUM_SERVER)
@@ -260,13 +260,10 @@ namespace TAO
         /* Gets a legacy transaction from mempool */
         bool Mempool::Get(const uint512_t& hashTx, Legacy::Transaction &tx, bool &fConflicted) const
         {
-            RLOCK(MUTEX);
-
             /* Check in conflict memory. */
-            if(mapLegacyConflicts.count(hashTx))
+            if(mapLegacyConflicts.Get(hashTx, tx))
             {
-                /* Get from conflicts map. */
-                tx = mapLegacyConflicts.at(hashTx);
+                /* Set the conflicted flag. */
                 fConflicted = true;
 
                 debug::log(0, FUNCTION, "CONFLICTED TRANSACTION: ", hashTx.SubString());
@@ -275,39 +272,20 @@ namespace TAO
             }
 
             /* Check the memory map. */
-            if(mapLegacy.count(hashTx))
-            {
-                /* Get the transaction from memory. */
-                tx = mapLegacy.at(hashTx);
-
-                return true;
-            }
-
-            return false;
+            return mapLegacy.Get(hashTx, tx);
         }
 
         /* Gets a legacy transaction from mempool */
         bool Mempool::Get(const uint512_t& hashTx, Legacy::Transaction &tx) const
         {
-            RLOCK(MUTEX);
-
-            /* Check the memory map. */
-            if(!mapLegacy.count(hashTx))
-                return false;
-
-            /* Get the transaction from memory. */
-            tx = mapLegacy.at(hashTx);
-
-            return true;
+            return mapLegacy.Get(hashTx, tx);
         }
 
 
         /* Gets the size of the memory pool. */
         uint32_t Mempool::SizeLegacy()
         {
-            RLOCK(MUTEX);
-
-            return mapLegacy.size();
+            return mapLegacy.Size();
         }
 
     }
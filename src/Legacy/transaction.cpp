@@ -197,15 +197,12 @@ namespace Legacy
 	/* Returns the hash of this object. */
 	uint512_t Transaction::GetHash() const
 	{
-        // Most of the time is spent allocating and deallocating DataStream's
-	    // buffer.  If this ever needs to be optimized further, make a CStaticStream
-	    // class with its buffer on the stack.
-	    DataStream ss(SER_GETHASH, LLP::PROTOCOL_VERSION);
-	    ss.reserve(10000);
+        /* Serialize straight into the hash, without a buffer. */
+	    LLC::SK512Stream ss(SER_GETHASH, LLP::PROTOCOL_VERSION);
 	    ss << *this;
 
         /* Get the hash. */
-	    uint512_t hash = LLC::SK512(ss.begin(), ss.end());
+	    uint512_t hash = ss.GetHash();
 
         /* Type of 0xfe designates legacy tx beginning with v7 activation (tx version 2). */
         if(nVersion >= 2)
@@ -0,0 +1,59 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <TAO/API/system/types/system.h>
+
+#include <LLD/include/global.h>
+
+#include <Util/include/debug.h>
+
+#include <set>
+
+/* Global TAO namespace. */
+namespace TAO
+{
+
+    /* API Layer namespace. */
+    namespace API
+    {
+        /* Compacts the keychains of the local databases in the background. */
+        json::json System::CompactLLD(const json::json& params, bool fHelp)
+        {
+            if(fHelp || params.size() > 1)
+                return std::string("compact/lld database=<database> - Compact the database keychains in the background, or only the one given");
+
+            /* Check for a database name. */
+            std::string strDatabase = "";
+            if(params.find("database") != params.end())
+            {
+                strDatabase = params["database"].get<std::string>();
+
+                /* Check that the name is one of the global databases. */
+                const static std::set<std::string> setDatabases = { "contract", "register", "ledger", "local", "client", "trust", "legacy" };
+                if(!setDatabases.count(strDatabase))
+                    throw APIException(-310, "Invalid database");
+            }
+
+            /* Start the compaction. */
+            if(!LLD::Compact(strDatabase))
+                throw APIException(-311, "Database compaction already running");
+
+            /* Build json response. */
+            json::json jsonRet;
+            jsonRet["started"]  = true;
+            jsonRet["database"] = strDatabase.empty() ? "all" : strDatabase;
+
+            return jsonRet;
+        }
+    }
+}
@@ -211,7 +211,29 @@ namespace TAO
             jsonReserves["hash"] = fHasHash ? double(lastHashBlockState.nReleasedReserve[0]) / TAO::Ledger::NXS_COIN : 0;
             jsonReserves["prime"] = fHasPrime ? double(lastPrimeBlockState.nReleasedReserve[0]) / TAO::Ledger::NXS_COIN : 0;
             jsonRet["reserves"] = jsonReserves;
-            
+
+
+            /* Add the cache statistics of the databases sharing the cache budget. */
+            auto CacheJSON = [](const LLD::CacheStats& stats)
+            {
+                json::json jsonStats;
+                jsonStats["hits"]      = stats.nHits;
+                jsonStats["misses"]    = stats.nMisses;
+                jsonStats["hitrate"]   = stats.HitRate();
+                jsonStats["bytes"]     = stats.nBytes;
+                jsonStats["maxbytes"]  = stats.nMaxBytes;
+                jsonStats["evictions"] = stats.nEvictions;
+
+                return jsonStats;
+            };
+
+            json::json jsonCache;
+            jsonCache["contract"] = CacheJSON(LLD::Contract->GetCacheStats());
+            jsonCache["register"] = CacheJSON(LLD::Register->GetCacheStats());
+            jsonCache["ledger"]   = CacheJSON(LLD::Ledger->GetCacheStats());
+            jsonCache["legacy"]   = CacheJSON(LLD::Legacy->GetCacheStats());
+            jsonRet["cache"] = jsonCache;
+
 
             return jsonRet;
         }
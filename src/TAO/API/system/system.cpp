@@ -52,6 +52,7 @@ namespace TAO
             mapFunctions["list/peers"]       = Function(std::bind(&System::ListPeers,    this, std::placeholders::_1, std::placeholders::_2));
             mapFunctions["list/lisp-eids"]   = Function(std::bind(&System::LispEIDs, this, std::placeholders::_1, std::placeholders::_2));
             mapFunctions["validate/address"] = Function(std::bind(&System::Validate,    this, std::placeholders::_1, std::placeholders::_2));
+            mapFunctions["compact/lld"]      = Function(std::bind(&System::CompactLLD,    this, std::placeholders::_1, std::placeholders::_2));
         }
 
 
@@ -139,6 +139,19 @@ namespace TAO
             json::json Metrics(const json::json& params, bool fHelp);
 
 
+            /** CompactLLD
+             *
+             *  Starts compacting the database keychains in the background
+             *
+             *  @param[in] params The parameters from the API call.
+             *  @param[in] fHelp Trigger for help data.
+             *
+             *  @return The return object in JSON.
+             *
+             **/
+            json::json CompactLLD(const json::json& params, bool fHelp);
+
+
 
         private:
 
@@ -105,6 +105,21 @@ namespace TAO
             }
 
 
+            /** Supports
+             *
+             *  Check if a method is in the function map as it is named, without rewriting the URL.
+             *
+             *  @param[in] strMethod The name of the method.
+             *
+             *  @return True if the method is registered.
+             *
+             **/
+            bool Supports(const std::string& strMethod) const
+            {
+                return mapFunctions.count(strMethod) > 0;
+            }
+
+
             /** RewriteURL
              *
              *  Allows derived API's to handle custom/dynamic URL's where the strMethod does not
@@ -466,85 +466,88 @@ namespace TAO
                 std::vector<std::tuple<TAO::Operation::Contract, uint32_t, uint256_t>> &vContracts)
         {
             /* Get notifications for personal genesis indexes. */
-            TAO::Ledger::Transaction tx;
+            std::vector<TAO::Ledger::Transaction> vtx;
 
-            /* Read back all the events. */
+            /* Read back all the events, a range at a time. */
             uint32_t nSequence = 0;
-            while(LLD::Ledger->ReadEvent(hashGenesis, nSequence, tx))
+            while(LLD::Ledger->ReadEvents(hashGenesis, nSequence, 1000, vtx))
             {
-                /* Loop through transaction contracts. */
-                uint32_t nContracts = tx.Size();
-                for(uint32_t nContract = 0; nContract < nContracts; ++nContract)
+                for(auto& tx : vtx)
                 {
-                    /* Reference to contract to check */
-                    const TAO::Operation::Contract& contract = tx[nContract];
+                    /* Loop through transaction contracts. */
+                    uint32_t nContracts = tx.Size();
+                    for(uint32_t nContract = 0; nContract < nContracts; ++nContract)
+                    {
+                        /* Reference to contract to check */
+                        const TAO::Operation::Contract& contract = tx[nContract];
 
-                    /* The proof to check for this contract */
-                    uint256_t hashProof = 0;
+                        /* The proof to check for this contract */
+                        uint256_t hashProof = 0;
 
-                    /* Reset the contract to the position of the primitive. */
-                    contract.SeekToPrimitive();
+                        /* Reset the contract to the position of the primitive. */
+                        contract.SeekToPrimitive();
 
-                    /* The operation */
-                    uint8_t nOP;
-                    contract >> nOP;
+                        /* The operation */
+                        uint8_t nOP;
+                        contract >> nOP;
 
-                    /* Check for that the debit is meant for us. */
-                    switch(nOP)
-                    {
-                        /* Check for transfer events. */
-                        case TAO::Operation::OP::TRANSFER:
+                        /* Check for that the debit is meant for us. */
+                        switch(nOP)
                         {
-                            /* The register address being transferred */
-                            uint256_t hashRegister;
-                            contract >> hashRegister;
+                            /* Check for transfer events. */
+                            case TAO::Operation::OP::TRANSFER:
+                            {
+                                /* The register address being transferred */
+                                uint256_t hashRegister;
+                                contract >> hashRegister;
 
-                            /* Get recipient genesis hash */
-                            contract >> hashProof;
+                                /* Get recipient genesis hash */
+                                contract >> hashProof;
 
-                            /* Read the force transfer flag */
-                            uint8_t nType = 0;
-                            contract >> nType;
+                                /* Read the force transfer flag */
+                                uint8_t nType = 0;
+                                contract >> nType;
 
-                            /* Ensure this wasn't a forced transfer (which requires no Claim) */
-                            if(nType == TAO::Operation::TRANSFER::FORCE)
-                                continue;
-
-                            /* Check that we are the recipient */
-                            if(hashGenesis != hashProof)
-                                continue;
+                                /* Ensure this wasn't a forced transfer (which requires no Claim) */
+                                if(nType == TAO::Operation::TRANSFER::FORCE)
+                                    continue;
 
-                            /* Check that the sender has not claimed it back (voided).  We can skip this in client mode and just 
-                               rely on whether a proof exists for it instead. */
-                            if(!config::fClient.load())
-                            {
-                                TAO::Register::State state;
-                                if(!LLD::Register->ReadState(hashRegister, state))
+                                /* Check that we are the recipient */
+                                if(hashGenesis != hashProof)
                                     continue;
 
-                                /* Make sure the register claim is in SYSTEM pending from a transfer.  */
-                                if(state.hashOwner.GetType() != TAO::Ledger::GENESIS::SYSTEM)
+                                /* Check that the sender has not claimed it back (voided).  We can skip this in client mode and just 
+                                   rely on whether a proof exists for it instead. */
+                                if(!config::fClient.load())
+                                {
+                                    TAO::Register::State state;
+                                    if(!LLD::Register->ReadState(hashRegister, state))
+                                        continue;
+
+                                    /* Make sure the register claim is in SYSTEM pending from a transfer.  */
+                                    if(state.hashOwner.GetType() != TAO::Ledger::GENESIS::SYSTEM)
+                                        continue;
+                                }
+
+                                /* Make sure we haven't already claimed it */
+                                if(LLD::Ledger->HasProof(hashRegister, tx.GetHash(), nContract, TAO::Ledger::FLAGS::MEMPOOL))
                                     continue;
-                            }
 
-                            /* Make sure we haven't already claimed it */
-                            if(LLD::Ledger->HasProof(hashRegister, tx.GetHash(), nContract, TAO::Ledger::FLAGS::MEMPOOL))
-                                continue;
+                                /* Add the contract and register address to the list */
+                                vContracts.push_back(std::make_tuple(contract, nContract, hashRegister));
 
-                            /* Add the contract and register address to the list */
-                            vContracts.push_back(std::make_tuple(contract, nContract, hashRegister));
+                                break;
+                            }
 
-                            break;
+                            /* Default continue. */
+                            default:
+                                break;
                         }
-
-                        /* Default continue. */
-                        default:
-                            break;
                     }
                 }
 
-                /* Iterate the sequence id forward. */
-                ++nSequence;
+                /* Iterate the sequence id forward past the range. */
+                nSequence += vtx.size();
             }
 
             return true;
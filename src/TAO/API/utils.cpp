@@ -1245,55 +1245,58 @@ namespace TAO
                 }
             }
 
-            /* Transaction for the event. */
-            TAO::Ledger::Transaction tx;
+            /* Transactions for the events. */
+            std::vector<TAO::Ledger::Transaction> vtx;
 
-            /* Iterate all events in the sig chain */
+            /* Iterate all events in the sig chain, a range at a time. */
             uint32_t nSequence = 0;
-            while(LLD::Ledger->ReadEvent(hashToken, nSequence, tx))
+            while(LLD::Ledger->ReadEvents(hashToken, nSequence, 1000, vtx))
             {
-                /* Loop through transaction contracts. */
-                uint32_t nContracts = tx.Size();
-                for(uint32_t nContract = 0; nContract < nContracts; ++nContract)
+                for(auto& tx : vtx)
                 {
-                    /* Reset the op stream */
-                    tx[nContract].Reset();
+                    /* Loop through transaction contracts. */
+                    uint32_t nContracts = tx.Size();
+                    for(uint32_t nContract = 0; nContract < nContracts; ++nContract)
+                    {
+                        /* Reset the op stream */
+                        tx[nContract].Reset();
 
-                    /* The operation */
-                    uint8_t nOp;
-                    tx[nContract] >> nOp;
+                        /* The operation */
+                        uint8_t nOp;
+                        tx[nContract] >> nOp;
 
-                    if(nOp == TAO::Operation::OP::TRANSFER)
-                    {
-                        /* The register address being transferred */
-                        TAO::Register::Address hashRegister;
-                        tx[nContract] >> hashRegister;
+                        if(nOp == TAO::Operation::OP::TRANSFER)
+                        {
+                            /* The register address being transferred */
+                            TAO::Register::Address hashRegister;
+                            tx[nContract] >> hashRegister;
 
-                        /* Get the new owner hash */
-                        TAO::Register::Address hashTo;
-                        tx[nContract] >> hashTo;
+                            /* Get the new owner hash */
+                            TAO::Register::Address hashTo;
+                            tx[nContract] >> hashTo;
 
-                        /* Read the force transfer flag */
-                        uint8_t nType = 0;
-                        tx[nContract] >> nType;
+                            /* Read the force transfer flag */
+                            uint8_t nType = 0;
+                            tx[nContract] >> nType;
 
-                        /* Ensure this was a forced transfer (which tokenized asset transfers must be) */
-                        if(nType != TAO::Operation::TRANSFER::FORCE)
-                            continue;
+                            /* Ensure this was a forced transfer (which tokenized asset transfers must be) */
+                            if(nType != TAO::Operation::TRANSFER::FORCE)
+                                continue;
 
-                        /* Check that the recipient of the transfer is the token */
-                        if(hashToken != hashTo)
-                            continue;
+                            /* Check that the recipient of the transfer is the token */
+                            if(hashToken != hashTo)
+                                continue;
 
-                        vObjects.push_back(hashRegister);
-                    }
+                            vObjects.push_back(hashRegister);
+                        }
 
-                    else
-                        continue;
+                        else
+                            continue;
+                    }
                 }
 
-                /* Iterate the sequence id forward. */
-                ++nSequence;
+                /* Iterate the sequence id forward past the range. */
+                nSequence += vtx.size();
             }
 
             /* Return true if we found any objects owned by the token */
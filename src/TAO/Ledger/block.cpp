@@ -577,23 +577,21 @@ namespace TAO
         /* Generates the StakeHash for this block from a uint256_t hashGenesis */
         uint1024_t Block::StakeHash(const uint256_t& hashGenesis) const
         {
-            /* Create a data stream to get the hash. */
-            DataStream ss(SER_GETHASH, LLP::PROTOCOL_VERSION);
-            ss.reserve(256);
+            /* Create a stream to get the hash. */
+            LLC::SK1024Stream ss(SER_GETHASH, LLP::PROTOCOL_VERSION);
 
             /* Serialize the data to hash into a stream. */
             ss << nVersion << hashPrevBlock << nChannel << nHeight << nBits << hashGenesis << nNonce;
 
-            return LLC::SK1024(ss.begin(), ss.end());
+            return ss.GetHash();
         }
 
 
         /* Generates the StakeHash for this block from a legacy trust key */
         uint1024_t Block::StakeHash(bool fGenesis, const uint576_t& hashTrustKey) const
         {
-            /* Create a data stream to get the hash. */
-            DataStream ss(SER_GETHASH, LLP::PROTOCOL_VERSION);
-            ss.reserve(256);
+            /* Create a stream to get the hash. */
+            LLC::SK1024Stream ss(SER_GETHASH, LLP::PROTOCOL_VERSION);
 
             /* Trust Key is part of stake hash if not genesis. */
             if(nHeight > 2392970 && fGenesis)
@@ -604,13 +602,13 @@ namespace TAO
                 /* Serialize the data to hash into a stream. */
                 ss << nVersion << hashPrevBlock << nChannel << nHeight << nBits << hashPrevout << nNonce;
 
-                return LLC::SK1024(ss.begin(), ss.end());
+                return ss.GetHash();
             }
 
             /* Serialize the data to hash into a stream. */
             ss << nVersion << hashPrevBlock << nChannel << nHeight << nBits << hashTrustKey << nNonce;
 
-            return LLC::SK1024(ss.begin(), ss.end());
+            return ss.GetHash();
         }
     }
 }
@@ -0,0 +1,336 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLD/include/global.h>
+
+#include <LLP/include/version.h>
+
+#include <TAO/Ledger/include/chainstate.h>
+#include <TAO/Ledger/include/constants.h>
+#include <TAO/Ledger/include/enum.h>
+#include <TAO/Ledger/types/candidates.h>
+#include <TAO/Ledger/types/mempool.h>
+#include <TAO/Ledger/types/transaction.h>
+
+#include <Util/include/args.h>
+#include <Util/include/debug.h>
+#include <Util/include/mutex.h>
+#include <Util/include/runtime.h>
+#include <Util/templates/serialize.h>
+
+/* Global TAO namespace. */
+namespace TAO
+{
+
+    /* Ledger Layer namespace. */
+    namespace Ledger
+    {
+
+        /* The block template candidates. */
+        Candidates candidates;
+
+
+        /* The serialized size of one block transaction entry, the type byte and the txid. */
+        static const uint64_t ENTRY_SIZE = 1 + uint512_t(0).GetSerializeSize(SER_NETWORK, LLP::PROTOCOL_VERSION);
+
+
+        /* Default Constructor. */
+        Candidates::Candidates()
+        : MUTEX         ( )
+        , QUEUE_MUTEX   ( )
+        , vQueued       ( )
+        , vRemoved      ( )
+        , hashBest      (0)
+        , vCandidates   ( )
+        , setCandidates ( )
+        , setRejected   ( )
+        , nSize         (0)
+        {
+        }
+
+
+        /* Default Destructor. */
+        Candidates::~Candidates()
+        {
+        }
+
+
+        /* Queue a transaction accepted into the memory pool. */
+        void Candidates::Queue(const uint512_t& hashTx)
+        {
+            LOCK(QUEUE_MUTEX);
+
+            vQueued.push_back(hashTx);
+        }
+
+
+        /* Queue a transaction removed from the memory pool. */
+        void Candidates::Remove(const uint512_t& hashTx)
+        {
+            LOCK(QUEUE_MUTEX);
+
+            vRemoved.push_back(hashTx);
+        }
+
+
+        /* Connect the queued transactions, and add the candidates to a block in order. */
+        void Candidates::List(std::vector<std::pair<uint8_t, uint512_t>>& vtx, const uint64_t nMaxSize)
+        {
+            LOCK(MUTEX);
+
+            /* Get the transactions accepted and removed since the last template. */
+            std::vector<uint512_t> vAdd;
+            std::vector<uint512_t> vRemove;
+            {
+                LOCK(QUEUE_MUTEX);
+                vAdd.swap(vQueued);
+                vRemove.swap(vRemoved);
+            }
+
+            /* Rebuild when the miner memory states are no longer on top of the best chain. */
+            if(!connect(vRemove))
+                rebuild();
+            else
+            {
+                /* Connect the new transactions on top of the current candidates. */
+                for(const auto& hash : vAdd)
+                    add(hash);
+            }
+
+            /* Add the candidates that fit, in order so dependents follow the transactions they spend. */
+            uint64_t nAdded = 0;
+            for(const auto& entry : vCandidates)
+            {
+                if(nAdded + ENTRY_SIZE >= nMaxSize)
+                    break;
+
+                vtx.push_back(entry);
+                nAdded += ENTRY_SIZE;
+            }
+        }
+
+
+        /* Gets the number of transactions in the candidate list. */
+        uint32_t Candidates::Size()
+        {
+            LOCK(MUTEX);
+
+            return static_cast<uint32_t>(vCandidates.size());
+        }
+
+
+        /* Rebuild the candidate list from the memory pool on top of the best chain. */
+        void Candidates::rebuild()
+        {
+            /* Clear the queue first, so transactions accepted while listing the memory pool are queued again. */
+            {
+                LOCK(QUEUE_MUTEX);
+                vQueued.clear();
+                vRemoved.clear();
+            }
+
+            hashBest = ChainState::stateBest.load().GetHash();
+
+            /* Start new miner memory states on top of the best chain. */
+            LLD::TxnAbort(FLAGS::MINER);
+            LLD::TxnBegin(FLAGS::MINER);
+
+            vCandidates.clear();
+            setCandidates.clear();
+            setRejected.clear();
+            nSize = 0;
+
+            debug::log(3, "BEGIN-------------------------------------");
+
+            /* Check the memory pool. */
+            std::vector<uint512_t> vMempool;
+            mempool.List(vMempool);
+
+            /* Loop through the list of transactions. */
+            for(const auto& hash : vMempool)
+                add(hash);
+
+            debug::log(3, "END-------------------------------------");
+        }
+
+
+        /* Drop the candidates connected by a new best block. */
+        bool Candidates::connect(const std::vector<uint512_t>& vRemove)
+        {
+            /* Without a new block, a candidate that left the memory pool still has its changes in the miner memory states. */
+            const BlockState stateBest = ChainState::stateBest.load();
+            const uint1024_t hashNew = stateBest.GetHash();
+            if(hashNew == hashBest)
+            {
+                for(const auto& hash : vRemove)
+                    if(setCandidates.count(hash))
+                        return false;
+
+                return true;
+            }
+
+            /* Only a single block on top of the list is followed, reorgs are rebuilt. */
+            if(hashBest == 0 || stateBest.hashPrevBlock != hashBest || stateBest.vtx.empty())
+                return false;
+
+            /* The block must hold the first candidates in order, so the miner memory states match what it connected. */
+            const uint32_t nConnected = static_cast<uint32_t>(stateBest.vtx.size() - 1);
+            if(nConnected > vCandidates.size())
+                return false;
+
+            for(uint32_t n = 0; n < nConnected; ++n)
+                if(stateBest.vtx[n] != vCandidates[n])
+                    return false;
+
+            /* The producer is not in the miner memory states, so it can't share a signature chain with any candidate. */
+            if(stateBest.vtx.back().first != TRANSACTION::TRITIUM)
+                return false;
+
+            Transaction txProducer;
+            if(!LLD::Ledger->ReadTx(stateBest.vtx.back().second, txProducer))
+                return false;
+
+            for(uint32_t n = 0; n < nConnected; ++n)
+            {
+                Transaction tx;
+                if(!LLD::Ledger->ReadTx(vCandidates[n].second, tx) || tx.hashGenesis == txProducer.hashGenesis)
+                    return false;
+            }
+
+            for(uint32_t n = nConnected; n < vCandidates.size(); ++n)
+            {
+                Transaction tx;
+                if(!mempool.Get(vCandidates[n].second, tx) || tx.hashGenesis == txProducer.hashGenesis)
+                    return false;
+            }
+
+            /* Drop the connected candidates. */
+            for(uint32_t n = 0; n < nConnected; ++n)
+                setCandidates.erase(vCandidates[n].second);
+
+            vCandidates.erase(vCandidates.begin(), vCandidates.begin() + nConnected);
+            nSize -= nConnected * ENTRY_SIZE;
+
+            /* Any other candidate that left the memory pool still has its changes in the miner memory states. */
+            for(const auto& hash : vRemove)
+                if(setCandidates.count(hash))
+                    return false;
+
+            hashBest = hashNew;
+
+            debug::log(3, FUNCTION, "Dropped ", nConnected, " candidates connected by ", hashNew.SubString());
+
+            /* Retry the rejected transactions in memory pool order, as some wait on a genesis the block connected. */
+            if(!setRejected.empty())
+            {
+                std::set<uint512_t> setRetry;
+                setRetry.swap(setRejected);
+
+                std::vector<uint512_t> vMempool;
+                mempool.List(vMempool);
+
+                for(const auto& hash : vMempool)
+                    if(setRetry.count(hash))
+                        add(hash);
+            }
+
+            return true;
+        }
+
+
+        /* Connect a memory pool transaction into the miner memory states and add it to the list. */
+        void Candidates::add(const uint512_t& hash)
+        {
+            /* Skip transactions already handled. */
+            if(setCandidates.count(hash) || setRejected.count(hash))
+                return;
+
+            /* Check the Size limits of a block. These are left out until the list is rebuilt. */
+            if(nSize + ENTRY_SIZE + 256 >= MAX_BLOCK_SIZE)
+                return;
+
+            /* Get the transaction from the memory pool. */
+            TAO::Ledger::Transaction tx;
+            if(!mempool.Get(hash, tx))
+                return;
+
+            /* Don't add transactions that are coinbase or coinstake. */
+            if(tx.IsCoinBase() || tx.IsCoinStake())
+            {
+                debug::log(2, FUNCTION, "Skipping transaction ", hash.SubString(), " - tx is coinbase/coinstake");
+                return;
+            }
+
+            /* Check for failed dependants. */
+            if(setRejected.count(tx.hashPrevTx))
+            {
+                setRejected.insert(hash);
+
+                debug::log(2, FUNCTION, "Skipping transaction ", hash.SubString(), " - INVALID dependent");
+                return;
+            }
+
+            /* Check for timestamp violations. */
+            if(tx.nTimestamp > runtime::unifiedtimestamp() + runtime::maxdrift())
+            {
+                setRejected.insert(hash);
+
+                debug::log(2, FUNCTION, "Skipping transaction ", hash.SubString(), " - timesamp too far in future");
+                return;
+            }
+
+            /* Check the pre-states and post-states. */
+            if(!tx.Verify(FLAGS::MINER))
+            {
+                setRejected.insert(hash);
+
+                debug::log(2, FUNCTION, "Skipping transaction ", hash.SubString(), " - failed to verify");
+                return;
+            }
+
+            /* Check to see if this transaction connects. */
+            if(!tx.Connect(FLAGS::MINER))
+            {
+                setRejected.insert(hash);
+
+                debug::log(2, FUNCTION, "Skipping transaction ", hash.SubString(), " - failed to connect");
+                return;
+            }
+
+            /* Check that the hashlast is on disk. If it is not, then the sig chain genesis must also be in this block.  If for
+               any reason the genesis transaction should be in this block but failed one of the above rules, then we could end
+               up with a subsequent transaction also in this block for which the genesis is not going to exist.  In which case
+               we need to omit this transaction also. The simplest solution for this is to skip any transactions that are not
+               the first in the sequence if the hash last is not currently on disk. If a sig chain transcation and subsequent
+               transaction genuinely should be in the same block, then ths will just result in the subsequent transaction being
+               left out of this block and included in the next.*/
+            uint512_t hashLast = 0;
+            if(!tx.IsFirst() && !LLD::Ledger->ReadLast(tx.hashGenesis, hashLast) )
+            {
+                setRejected.insert(hash);
+
+                debug::log(2, FUNCTION, "Skipping transaction ", hash.SubString(), " - genesis not on disk");
+                return;
+            }
+
+            /* Dump sequence on verbose 3 levels. */
+            if(config::nVerbose >= 3)
+                tx.print();
+
+            /* Add the transaction to the list. */
+            vCandidates.push_back(std::make_pair(TRANSACTION::TRITIUM, hash));
+            setCandidates.insert(hash);
+            nSize += ENTRY_SIZE;
+        }
+    }
+}
@@ -223,7 +223,8 @@ namespace TAO
                 /* Set the best to older block. */
                 LLD::TxnBegin();
                 state.SetBest();
-                LLD::TxnCommit();
+                if(!LLD::TxnCommit())
+                    return debug::error(FUNCTION, "failed to commit -forkblocks removal");
 
                 /* Debug Output. */
                 debug::log(0, FUNCTION, "-forkblocks=XXX requested removal of ", nForkblocks, " blocks");
@@ -0,0 +1,90 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#pragma once
+#ifndef NEXUS_TAO_LEDGER_INCLUDE_SIGNATURES_H
+#define NEXUS_TAO_LEDGER_INCLUDE_SIGNATURES_H
+
+#include <vector>
+
+/* Forward declarations. */
+class WorkerPool;
+
+/* Global TAO namespace. */
+namespace TAO
+{
+
+    /* Ledger Layer namespace. */
+    namespace Ledger
+    {
+
+        /* Forward declarations. */
+        class Transaction;
+
+
+        /** VERIFY_WORKERS
+         *
+         *  The threads that verify transaction signatures and block pre-states, sized with
+         *  -verifythreads, or nullptr to verify on the calling thread.
+         *
+         **/
+        extern WorkerPool* VERIFY_WORKERS;
+
+
+        /** InitializeSignatures
+         *
+         *  Start the verification threads and the cache of verified signatures.
+         *  The threads are set with -verifythreads and the cache size with -sigcachesize.
+         *
+         **/
+        void InitializeSignatures();
+
+
+        /** ShutdownSignatures
+         *
+         *  Stop the verification threads and free the cache.
+         *
+         **/
+        void ShutdownSignatures();
+
+
+        /** VerifySignature
+         *
+         *  Verify the signature of a transaction on the calling thread, unless it was
+         *  verified already with the same public key and signature.
+         *
+         *  @param[in] tx The transaction to verify.
+         *
+         *  @return True if the signature is valid.
+         *
+         **/
+        bool VerifySignature(const Transaction& tx);
+
+
+        /** VerifySignatures
+         *
+         *  Verify the signatures of a batch of transactions, spread over the verification
+         *  threads. The calling thread verifies its share too, and returns when every
+         *  signature was verified or one was found invalid.
+         *
+         *  @param[in] vTx The transactions to verify.
+         *
+         *  @return True if every signature is valid.
+         *
+         **/
+        bool VerifySignatures(const std::vector<const Transaction*>& vTx);
+
+    }
+}
+
+#endif
@@ -26,10 +26,14 @@ ________________________________________________________________________________
 #include <TAO/Ledger/include/constants.h>
 #include <TAO/Ledger/include/timelocks.h>
 #include <TAO/Ledger/include/chainstate.h>
+#include <TAO/Ledger/include/signatures.h>
+#include <TAO/Ledger/types/candidates.h>
 #include <TAO/Ledger/types/mempool.h>
 
 #include <TAO/Ledger/include/create.h>
 
+#include <algorithm>
+
 
 /* Global TAO namespace. */
 namespace TAO
@@ -49,8 +53,10 @@ namespace TAO
         , mapConflicts       ( )
         , mapOrphans         ( )
         , mapClaimed         ( )
+        , mapSigchains       ( )
         , mapInputs          ( )
         , setOrphansByIndex  ( )
+        , fProcessingOrphans (false)
         {
         }
 
@@ -70,11 +76,11 @@ namespace TAO
             RLOCK(MUTEX);
 
             /* Check the mempool. */
-            if(mapLedger.count(hashTx))
+            if(mapLedger.Has(hashTx))
                 return false;
 
             /* Add to the map. */
-            mapLedger[hashTx] = tx;
+            add_sigchain(tx, hashTx);
 
             return true;
         }
@@ -125,7 +131,7 @@ namespace TAO
                         " ORPHAN in ", std::dec, time.ElapsedMilliseconds(), " ms");
 
                     /* Push to orphan queue. */
-                    mapOrphans[tx.hashPrevTx] = tx;
+                    mapOrphans.Put(tx.hashPrevTx, tx);
                     setOrphansByIndex.insert(hashTx);
 
                     /* Increment consecutive orphans. */
@@ -140,11 +146,12 @@ namespace TAO
                 }
 
                 /* Check for conflicts. */
-                if(mapClaimed.count(tx.hashPrevTx) || mapConflicts.count(tx.hashPrevTx))
+                const bool fClaimed = mapClaimed.Has(tx.hashPrevTx);
+                if(fClaimed || mapConflicts.Has(tx.hashPrevTx))
                 {
                     /* Add to conflicts map. */
-                    debug::error(FUNCTION, "CONFLICT: prev tx ", (mapClaimed.count(tx.hashPrevTx) ? "CLAIMED " : "CONFLICTED "), tx.hashPrevTx.SubString());
-                    mapConflicts[hashTx] = tx;
+                    debug::error(FUNCTION, "CONFLICT: prev tx ", (fClaimed ? "CLAIMED " : "CONFLICTED "), tx.hashPrevTx.SubString());
+                    mapConflicts.Put(hashTx, tx);
 
                     return false;
                 }
@@ -159,7 +166,7 @@ namespace TAO
                 {
                     /* Add to conflicts map. */
                     debug::error(FUNCTION, "CONFLICT: hash last mismatch ", tx.hashPrevTx.SubString());
-                    mapConflicts[hashTx] = tx;
+                    mapConflicts.Put(hashTx, tx);
 
                     return false;
                 }
@@ -183,11 +190,14 @@ namespace TAO
             LLD::TxnCommit(FLAGS::MEMPOOL);
 
             /* Set the internal memory. */
-            mapLedger[hashTx] = tx;
+            add_sigchain(tx, hashTx);
+
+            /* Queue for the next block template. */
+            candidates.Queue(hashTx);
 
             /* Update map claimed if not first tx. */
             if(!tx.IsFirst())
-                mapClaimed[tx.hashPrevTx] = hashTx;
+                mapClaimed.Put(tx.hashPrevTx, hashTx);
 
             /* Debug output. */
             debug::log(3, FUNCTION, "tx ", hashTx.SubString(), " ACCEPTED in ", std::dec, time.ElapsedMilliseconds(), " ms");
@@ -220,13 +230,35 @@ namespace TAO
         {
             RLOCK(MUTEX);
 
+            /* Verify the signatures of the orphan chain together, unless accepting an orphan of the chain. */
+            if(!fProcessingOrphans)
+            {
+                /* Get the orphans that are waiting on each other. */
+                std::vector<TAO::Ledger::Transaction> vOrphans;
+                TAO::Ledger::Transaction txOrphan;
+                for(uint512_t hashPrev = hash; mapOrphans.Get(hashPrev, txOrphan); hashPrev = txOrphan.GetHash())
+                    vOrphans.push_back(txOrphan);
+
+                /* Verify across the verification threads, so accepting each hits the cache. */
+                if(vOrphans.size() > 1)
+                {
+                    std::vector<const TAO::Ledger::Transaction*> vVerify;
+                    for(const auto& tx : vOrphans)
+                        vVerify.push_back(&tx);
+
+                    VerifySignatures(vVerify);
+                }
+            }
+
+            /* Mark the chain as being processed. */
+            const bool fOuter = !fProcessingOrphans;
+            fProcessingOrphans = true;
+
             /* Check orphan queue. */
             uint512_t hashTx = hash;
-            while(mapOrphans.count(hashTx))
+            TAO::Ledger::Transaction tx;
+            while(mapOrphans.Get(hashTx, tx))
             {
-                /* Get the transaction from map. */
-                TAO::Ledger::Transaction& tx = mapOrphans[hashTx];
-
                 /* Get the previous hash. */
                 const uint512_t hashThis = tx.GetHash();
 
@@ -242,25 +274,26 @@ namespace TAO
                 }
 
                 /* Erase the transaction. */
-                mapOrphans.erase(hashTx);
+                mapOrphans.Remove(hashTx);
                 setOrphansByIndex.erase(hashThis);
 
                 /* Set the hashTx. */
                 hashTx = hashThis;
             }
+
+            /* Clear the flag once the whole chain is processed. */
+            if(fOuter)
+                fProcessingOrphans = false;
         }
 
 
         /* Gets a transaction from mempool */
         bool Mempool::Get(const uint512_t& hashTx, TAO::Ledger::Transaction &tx, bool &fConflicted) const
         {
-            RLOCK(MUTEX);
-
             /* Check in conflict memory. */
-            if(mapConflicts.count(hashTx))
+            if(mapConflicts.Get(hashTx, tx))
             {
-                /* Get from conflicts map. */
-                tx = mapConflicts.at(hashTx);
+                /* Set the conflicted flag. */
                 fConflicted = true;
 
                 debug::log(0, FUNCTION, "CONFLICTED TRANSACTION: ", hashTx.SubString());
@@ -269,54 +302,37 @@ namespace TAO
             }
 
             /* Check in ledger memory. */
-            if(mapLedger.count(hashTx))
-            {
-                tx = mapLedger.at(hashTx);
-
-                return true;
-            }
-
-            return false;
+            return mapLedger.Get(hashTx, tx);
         }
 
 
         /* Gets a transaction from mempool */
         bool Mempool::Get(const uint512_t& hashTx, TAO::Ledger::Transaction &tx) const
         {
-            RLOCK(MUTEX);
-
-            /* Check in ledger memory. */
-            if(mapLedger.count(hashTx))
-            {
-                tx = mapLedger.at(hashTx);
-
-                return true;
-            }
-
-            return false;
+            return mapLedger.Get(hashTx, tx);
         }
 
 
         /* Get by genesis. */
         bool Mempool::Get(const uint256_t& hashGenesis, std::vector<TAO::Ledger::Transaction> &vtx) const
         {
-            RLOCK(MUTEX);
-
-            /* Check through the ledger map for the genesis. */
-            for(const auto& tx : mapLedger)
+            /* Get the transactions of the signature chain in sequence order, holding the chain so none are added or removed meanwhile. */
+            mapSigchains.View(hashGenesis, [this, &vtx](const std::vector<std::pair<uint32_t, uint512_t>>& vChain)
             {
-                /* Check for non-conflicted genesis-id's. */
-                if(tx.second.hashGenesis == hashGenesis)
-                    vtx.push_back(tx.second);
-            }
+                for(const auto& entry : vChain)
+                {
+                    TAO::Ledger::Transaction tx;
+                    if(!mapLedger.Get(entry.second, tx))
+                        break;
+
+                    vtx.push_back(tx);
+                }
+            });
 
             /* Check that a transaction was found. */
             if(vtx.size() == 0)
                 return false;
 
-            /* Sort the list by sequence numbers. */
-            std::sort(vtx.begin(), vtx.end());
-
             /* Check that the mempool transactions are in correct order. */
             uint512_t hashLast = vtx[0].GetHash();
             for(uint32_t n = 1; n < vtx.size(); ++n)
@@ -358,23 +374,14 @@ namespace TAO
         /* Checks if a transaction exists. */
         bool Mempool::Has(const uint512_t& hashTx) const
         {
-            RLOCK(MUTEX);
-
-            return mapLedger.count(hashTx) || mapLegacy.count(hashTx) || mapConflicts.count(hashTx);
+            return mapLedger.Has(hashTx) || mapLegacy.Has(hashTx) || mapConflicts.Has(hashTx);
         }
 
 
         /* Checks if a genesis exists. */
         bool Mempool::Has(const uint256_t& hashGenesis) const
         {
-            RLOCK(MUTEX);
-
-            /* Check through the ledger map for the genesis. */
-            for(const auto& tx : mapLedger)
-                if(tx.second.hashGenesis == hashGenesis)
-                    return true;
-
-            return false;
+            return mapSigchains.Has(hashGenesis);
         }
 
 
@@ -384,42 +391,39 @@ namespace TAO
             RLOCK(MUTEX);
 
             /* Erase from conflicted memory. */
-            if(mapConflicts.count(hashTx))
-                mapConflicts.erase(hashTx);
+            mapConflicts.Remove(hashTx);
 
             /* Erase from legacy conflicted memory. */
-            if(mapLegacyConflicts.count(hashTx))
-                mapLegacyConflicts.erase(hashTx);
+            mapLegacyConflicts.Remove(hashTx);
 
             /* Erase from orphans memory. */
-            if(setOrphansByIndex.count(hashTx))
-                setOrphansByIndex.erase(hashTx);
+            setOrphansByIndex.erase(hashTx);
 
             /* Find the transaction in pool. */
-            if(mapLedger.count(hashTx))
+            TAO::Ledger::Transaction tx;
+            if(mapLedger.Get(hashTx, tx))
             {
-                /* Get a reference from the map. */
-                const TAO::Ledger::Transaction& tx = mapLedger[hashTx];
-
                 /* Erase from the memory map. */
-                mapClaimed.erase(tx.hashPrevTx);
-                mapOrphans.erase(tx.hashPrevTx);
-                mapLedger.erase(hashTx);
+                mapClaimed.Remove(tx.hashPrevTx);
+                mapOrphans.Remove(tx.hashPrevTx);
+                remove_sigchain(tx, hashTx);
+
+                /* Drop it from the block template candidates. */
+                candidates.Remove(hashTx);
 
                 return true;
             }
 
             /* Find the legacy transaction in pool. */
-            if(mapLegacy.count(hashTx))
+            Legacy::Transaction txLegacy;
+            if(mapLegacy.Get(hashTx, txLegacy))
             {
-                const Legacy::Transaction& tx = mapLegacy[hashTx];
-
                 /* Erase the claimed inputs */
-                uint32_t nSize = static_cast<uint32_t>(tx.vin.size());
+                uint32_t nSize = static_cast<uint32_t>(txLegacy.vin.size());
                 for(uint32_t i = 0; i < nSize; ++i)
-                    mapInputs.erase(tx.vin[i].prevout);
+                    mapInputs.erase(txLegacy.vin[i].prevout);
 
-                mapLegacy.erase(hashTx);
+                mapLegacy.Remove(hashTx);
             }
 
             return false;
@@ -433,31 +437,32 @@ namespace TAO
 
             //TODO: evict conflicted transctions from mempool
 
-            /* Create map of transactions by genesis. */
-            std::map<uint256_t, std::vector<TAO::Ledger::Transaction> > mapTransactions;
-
-            /* Loop through all the transactions. */
-            for(const auto& tx : mapLedger)
+            /* Get the signature chains in the pool. */
+            std::vector<uint256_t> vGenesis;
+            mapSigchains.ForEach([&vGenesis](const uint256_t& hashGenesis, const std::vector<std::pair<uint32_t, uint512_t>>& vChain)
             {
-                /* Cache the genesis. */
-                const uint256_t& hashGenesis = tx.second.hashGenesis;
-
-                /* Check in map for push back. */
-                if(!mapTransactions.count(hashGenesis))
-                    mapTransactions[hashGenesis] = std::vector<TAO::Ledger::Transaction>();
+                vGenesis.push_back(hashGenesis);
+            });
 
-                /* Push to back of map. */
-                mapTransactions[hashGenesis].push_back(tx.second);
-            }
-
-            /* Loop transctions map by genesis. */
-            for(auto& list : mapTransactions)
+            /* Loop transactions by genesis. */
+            for(const auto& hashGenesis : vGenesis)
             {
-                /* Get reference of the vector. */
-                std::vector<TAO::Ledger::Transaction>& vtx = list.second;
+                /* Get the transactions of the signature chain, already in sequence order. */
+                std::vector<std::pair<uint32_t, uint512_t>> vChain;
+                if(!mapSigchains.Get(hashGenesis, vChain))
+                    continue;
+
+                std::vector<TAO::Ledger::Transaction> vtx;
+                for(const auto& entry : vChain)
+                {
+                    TAO::Ledger::Transaction tx;
+                    if(mapLedger.Get(entry.second, tx))
+                        vtx.push_back(tx);
+                }
 
-                /* Sort the list by sequence numbers. */
-                std::sort(vtx.begin(), vtx.end());
+                /* Skip over chains with no transactions left. */
+                if(vtx.empty())
+                    continue;
 
                 /* Add the hashes into list. */
                 uint512_t hashLast = 0;
@@ -466,7 +471,7 @@ namespace TAO
                 if(!vtx[0].IsFirst())
                 {
                     /* Read last hash. */
-                    if(!LLD::Ledger->ReadLast(list.first, hashLast))
+                    if(!LLD::Ledger->ReadLast(hashGenesis, hashLast))
                         break;
 
                     /* Check the last hash. */
@@ -492,13 +497,14 @@ namespace TAO
                             }
 
                             /* Find the transaction in pool. */
-                            if(mapLedger.count(tx->GetHash()))
+                            const uint512_t hashTx = tx->GetHash();
+                            if(mapLedger.Has(hashTx))
                             {
-                                debug::log(0, "DELETED ", tx->GetHash().SubString());
+                                debug::log(0, "DELETED ", hashTx.SubString());
 
                                 /* Erase from the memory map. */
-                                mapClaimed.erase(tx->hashPrevTx);
-                                mapLedger.erase(tx->GetHash());
+                                mapClaimed.Remove(tx->hashPrevTx);
+                                remove_sigchain(*tx, hashTx);
                             }
                         }
 
@@ -515,10 +521,6 @@ namespace TAO
                 /* Loop through transaction by genesis. */
                 for(uint32_t n = 1; n < vtx.size(); ++n)
                 {
-                    /* Check for end of index. */
-                    if(n == vtx.size())
-                        break;
-
                     /* Check that transaction is in sequence. */
                     if(vtx[n].hashPrevTx != hashLast)
                     {
@@ -573,94 +575,69 @@ namespace TAO
         {
             RLOCK(MUTEX);
 
-            //TODO: need to check dependant transactions and sequence them properly otherwise this will fail
-
             /* If legacy flag set, skip over getting tritium transactions. */
             if(!fLegacy)
             {
-                /* Create map of transactions by genesis. */
-                std::map<uint256_t, std::vector<TAO::Ledger::Transaction> > mapTransactions;
-
-                /* Loop through all the transactions. */
-                for(const auto& tx : mapLedger)
+                /* Get the signature chains in the pool. */
+                std::vector<uint256_t> vGenesis;
+                mapSigchains.ForEach([&vGenesis](const uint256_t& hashGenesis, const std::vector<std::pair<uint32_t, uint512_t>>& vChain)
                 {
-                    /* Check that this transaction isn't conflicted. */
-                    //if(mapConflicts.count(tx.first))
-                    //    continue;
-
-                    /* Cache the genesis. */
-                    const uint256_t& hashGenesis = tx.second.hashGenesis;
-
-                    /* Check in map for push back. */
-                    if(!mapTransactions.count(hashGenesis))
-                        mapTransactions[hashGenesis] = std::vector<TAO::Ledger::Transaction>();
-
-                    /* Push to back of map. */
-                    mapTransactions[hashGenesis].push_back(tx.second);
-                }
+                    vGenesis.push_back(hashGenesis);
+                });
 
-                /* Loop transctions map by genesis. */
-                for(auto& list : mapTransactions)
+                /* Loop transactions by genesis. */
+                for(const auto& hashGenesis : vGenesis)
                 {
-                    /* Get reference of the vector. */
-                    std::vector<TAO::Ledger::Transaction>& vtx = list.second;
+                    /* Get the transactions of the signature chain, already in sequence order. */
+                    std::vector<std::pair<uint32_t, uint512_t>> vChain;
+                    if(!mapSigchains.Get(hashGenesis, vChain))
+                        continue;
 
-                    /* Sort the list by sequence numbers. */
-                    std::sort(vtx.begin(), vtx.end());
-
-                    /* Add the hashes into list. */
+                    /* Add the hashes in sequence, AddUnchecked and Remove can leave gaps in the chain. */
                     uint512_t hashLast = 0;
-
-                    /* Check last hash for valid transactions. */
-                    if(!vtx[0].IsFirst())
-                    {
-                        /* Read last index from disk. */
-                        if(!LLD::Ledger->ReadLast(list.first, hashLast))
-                            break; //NOTE: this may need an error
-
-                        /* Check the last hash. */
-                        if(vtx[0].hashPrevTx != hashLast)
-                            break;
-                    }
-
-                    /* Set last from next transaction. */
-                    hashLast = vtx[0].GetHash();
-
-                    /* Loop through transaction by genesis. */
-                    for(uint32_t n = 1; n <= vtx.size(); ++n)
+                    for(uint32_t n = 0; n < vChain.size(); ++n)
                     {
-                        /* Add to the output queue. */
-                        vHashes.push_back(hashLast);
+                        /* Check count. */
+                        if(nCount == 0)
+                            return true;
 
-                        /* Check for end of index. */
-                        if(n == vtx.size())
+                        TAO::Ledger::Transaction tx;
+                        if(!mapLedger.Get(vChain[n].second, tx))
                             break;
 
-                        /* Check count. */
-                        if(--nCount == 0)
-                            return true;
+                        /* Check that the first transaction connects to the last one on disk. */
+                        if(n == 0)
+                        {
+                            if(!tx.IsFirst() && (!LLD::Ledger->ReadLast(hashGenesis, hashLast) || tx.hashPrevTx != hashLast))
+                                break;
+                        }
 
                         /* Check that transaction is in sequence. */
-                        if(vtx[n].hashPrevTx != hashLast)
+                        else if(tx.hashPrevTx != hashLast)
                             break; //SKIP ANY ORPHANS FOUND
 
+                        /* Add to the output queue. */
+                        vHashes.push_back(vChain[n].second);
+                        --nCount;
+
                         /* Set last hash. */
-                        hashLast = vtx[n].GetHash();
+                        hashLast = vChain[n].second;
                     }
                 }
             }
             else
             {
-                /* Loop transctions map by genesis. */
-                for(const auto& list : mapLegacy)
+                /* Loop through the legacy transactions. */
+                mapLegacy.ForEach([&vHashes, &nCount](const uint512_t& hashTx, const Legacy::Transaction& tx)
                 {
-                    /* Push legacy transactions last. */
-                    vHashes.push_back(list.first);;
-
                     /* Check for end of line. */
-                    if(--nCount == 0)
-                        return true;
-                }
+                    if(nCount == 0)
+                        return;
+
+                    /* Push legacy transactions last. */
+                    vHashes.push_back(hashTx);
+                    --nCount;
+                });
             }
 
             return vHashes.size() > 0;
@@ -670,9 +647,53 @@ namespace TAO
         /* Gets the size of the memory pool. */
         uint32_t Mempool::Size()
         {
-            RLOCK(MUTEX);
+            return mapLedger.Size() + mapLegacy.Size();
+        }
+
+
+        /* Add a ledger transaction to the pool and to the list of its signature chain. */
+        void Mempool::add_sigchain(const TAO::Ledger::Transaction& tx, const uint512_t& hashTx)
+        {
+            /* Change the signature chain in place, adding the transaction while the chain is held. */
+            mapSigchains.Modify(tx.hashGenesis, [this, &tx, &hashTx](std::vector<std::pair<uint32_t, uint512_t>>& vChain)
+            {
+                mapLedger.Put(hashTx, tx);
+
+                /* Insert after the transactions up to the same sequence, which is the end unless added out of order. */
+                const auto it = std::upper_bound(vChain.begin(), vChain.end(), tx.nSequence,
+                    [](const uint32_t nSequence, const std::pair<uint32_t, uint512_t>& entry)
+                    {
+                        return nSequence < entry.first;
+                    });
+
+                vChain.insert(it, std::make_pair(tx.nSequence, hashTx));
+
+                return true;
+            });
+        }
+
+
+        /* Remove a ledger transaction from the pool and from the list of its signature chain. */
+        void Mempool::remove_sigchain(const TAO::Ledger::Transaction& tx, const uint512_t& hashTx)
+        {
+            /* Change the signature chain in place, removing the transaction while the chain is held. */
+            mapSigchains.Modify(tx.hashGenesis, [this, &hashTx](std::vector<std::pair<uint32_t, uint512_t>>& vChain)
+            {
+                mapLedger.Remove(hashTx);
+
+                /* Erase the transaction, which is usually the first as blocks are connected. */
+                for(auto it = vChain.begin(); it != vChain.end(); ++it)
+                {
+                    if(it->second == hashTx)
+                    {
+                        vChain.erase(it);
+                        break;
+                    }
+                }
 
-            return static_cast<uint32_t>(mapLedger.size() + mapLegacy.size());
+                /* Erase the signature chain once empty. */
+                return !vChain.empty();
+            });
         }
     }
 }
@@ -78,6 +78,7 @@ namespace TAO
         MerkleTx& MerkleTx::operator=(const MerkleTx& tx)
         {
             vContracts    = tx.vContracts;
+            cacheHash     = tx.cacheHash;
             nVersion      = tx.nVersion;
             nSequence     = tx.nSequence;
             nTimestamp    = tx.nTimestamp;
@@ -102,6 +103,7 @@ namespace TAO
         MerkleTx& MerkleTx::operator=(MerkleTx&& tx) noexcept
         {
             vContracts    = std::move(tx.vContracts);
+            cacheHash     = std::move(tx.cacheHash);
             nVersion      = std::move(tx.nVersion);
             nSequence     = std::move(tx.nSequence);
             nTimestamp    = std::move(tx.nTimestamp);
@@ -126,6 +128,7 @@ namespace TAO
         MerkleTx& MerkleTx::operator=(const Transaction& tx)
         {
             vContracts    = tx.vContracts;
+            cacheHash     = tx.cacheHash;
             nVersion      = tx.nVersion;
             nSequence     = tx.nSequence;
             nTimestamp    = tx.nTimestamp;
@@ -146,6 +149,7 @@ namespace TAO
         MerkleTx& MerkleTx::operator=(Transaction&& tx) noexcept
         {
             vContracts    = std::move(tx.vContracts);
+            cacheHash     = std::move(tx.cacheHash);
             nVersion      = std::move(tx.nVersion);
             nSequence     = std::move(tx.nSequence);
             nTimestamp    = std::move(tx.nTimestamp);
@@ -0,0 +1,243 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLC/hash/SK.h>
+#include <LLC/include/flkey.h>
+#include <LLC/include/eckey.h>
+
+#include <LLD/cache/template_lru.h>
+
+#include <TAO/Ledger/include/enum.h>
+#include <TAO/Ledger/include/signatures.h>
+#include <TAO/Ledger/types/transaction.h>
+
+#include <Util/include/args.h>
+#include <Util/include/debug.h>
+#include <Util/include/metrics.h>
+#include <Util/include/workers.h>
+
+#include <atomic>
+#include <thread>
+
+/* Global TAO namespace. */
+namespace TAO
+{
+
+    /* Ledger Layer namespace. */
+    namespace Ledger
+    {
+
+        /* The threads that verify transaction signatures and block pre-states, or nullptr to verify on the calling thread. */
+        WorkerPool* VERIFY_WORKERS = nullptr;
+
+
+        /* The verified signatures, by txid to the hash of the key type, public key and signature. */
+        static LLD::TemplateLRU<uint512_t, uint256_t>* pcacheVerified = nullptr;
+
+
+        /* Metrics of the signatures verified. */
+        static metrics::Counter& SIGNATURES_VERIFIED = metrics::GetCounter("nexus_ledger_signatures_total",
+            "Transaction signatures checked.", metrics::Label("result", "verified"));
+        static metrics::Counter& SIGNATURES_CACHED = metrics::GetCounter("nexus_ledger_signatures_total",
+            "Transaction signatures checked.", metrics::Label("result", "cached"));
+
+
+        /* Get the hash a verified signature is cached under. */
+        static uint256_t signature_hash(const Transaction& tx)
+        {
+            /* The key type, public key and signature together. */
+            std::vector<uint8_t> vData;
+            vData.reserve(1 + tx.vchPubKey.size() + tx.vchSig.size());
+            vData.push_back(tx.nKeyType);
+            vData.insert(vData.end(), tx.vchPubKey.begin(), tx.vchPubKey.end());
+            vData.insert(vData.end(), tx.vchSig.begin(), tx.vchSig.end());
+
+            return LLC::SK256(vData);
+        }
+
+
+        /* Check the cache for a verified signature. */
+        static bool is_verified(const uint512_t& hashTx, const uint256_t& hashSig)
+        {
+            /* Check there is a cache. */
+            if(!pcacheVerified)
+                return false;
+
+            /* A txid verified with another key or signature must be verified again. */
+            uint256_t hashCached = 0;
+            if(!pcacheVerified->Get(hashTx, hashCached) || hashCached != hashSig)
+                return false;
+
+            SIGNATURES_CACHED.Add();
+
+            return true;
+        }
+
+
+        /* Verify a signature on the calling thread, and cache it if valid. */
+        static bool verify_signature(const Transaction& tx, const uint512_t& hashTx, const uint256_t& hashSig)
+        {
+            /* Switch based on signature type. */
+            bool fValid = false;
+            switch(tx.nKeyType)
+            {
+                /* Support for the FALCON signature scheeme. */
+                case SIGNATURE::FALCON:
+                {
+                    /* Create the FL Key object. */
+                    LLC::FLKey key;
+
+                    /* Set the public key and verify. */
+                    key.SetPubKey(tx.vchPubKey);
+                    fValid = key.Verify(hashTx.GetBytes(), tx.vchSig);
+
+                    break;
+                }
+
+                /* Support for the BRAINPOOL signature scheme. */
+                case SIGNATURE::BRAINPOOL:
+                {
+                    /* Create EC Key object. */
+                    LLC::ECKey key = LLC::ECKey(LLC::BRAINPOOL_P512_T1, 64);
+
+                    /* Set the public key and verify. */
+                    key.SetPubKey(tx.vchPubKey);
+                    fValid = key.Verify(hashTx.GetBytes(), tx.vchSig);
+
+                    break;
+                }
+
+                default:
+                    return false;
+            }
+
+            SIGNATURES_VERIFIED.Add();
+
+            /* Cache the valid signature so the block holding it doesn't verify it again. */
+            if(fValid && pcacheVerified)
+                pcacheVerified->Put(hashTx, hashSig);
+
+            return fValid;
+        }
+
+
+        /* Start the verification threads and the cache of verified signatures. */
+        void InitializeSignatures()
+        {
+            /* Create the cache of verified signatures. */
+            const uint32_t nCacheSize = static_cast<uint32_t>(config::GetArg(std::string("-sigcachesize"), 100000));
+            if(nCacheSize > 0)
+                pcacheVerified = new LLD::TemplateLRU<uint512_t, uint256_t>(nCacheSize);
+
+            /* Create the verification threads. */
+            const uint32_t nThreads = static_cast<uint32_t>(config::GetArg(std::string("-verifythreads"), std::thread::hardware_concurrency()));
+            if(nThreads > 0)
+                VERIFY_WORKERS = new WorkerPool(nThreads);
+
+            debug::log(0, FUNCTION, "Verifying signatures on ", nThreads, " threads with ", nCacheSize, " cached");
+        }
+
+
+        /* Stop the verification threads and free the cache. */
+        void ShutdownSignatures()
+        {
+            /* Stop the verification threads. */
+            if(VERIFY_WORKERS)
+            {
+                VERIFY_WORKERS->Stop();
+
+                delete VERIFY_WORKERS;
+                VERIFY_WORKERS = nullptr;
+            }
+
+            /* Free the cache. */
+            if(pcacheVerified)
+            {
+                delete pcacheVerified;
+                pcacheVerified = nullptr;
+            }
+        }
+
+
+        /* Verify the signature of a transaction on the calling thread. */
+        bool VerifySignature(const Transaction& tx)
+        {
+            /* Get the hashes to check the cache with. */
+            const uint512_t hashTx  = tx.GetHash();
+            const uint256_t hashSig = signature_hash(tx);
+
+            /* Check for a signature verified already. */
+            if(is_verified(hashTx, hashSig))
+                return true;
+
+            return verify_signature(tx, hashTx, hashSig);
+        }
+
+
+        /* Verify the signatures of a batch of transactions, spread over the verification threads. */
+        bool VerifySignatures(const std::vector<const Transaction*>& vTx)
+        {
+            /* A signature still to verify. */
+            struct Pending
+            {
+                const Transaction* ptx;
+                uint512_t hashTx;
+                uint256_t hashSig;
+            };
+
+            /* Find the signatures not verified already. */
+            std::vector<Pending> vPending;
+            vPending.reserve(vTx.size());
+            for(const auto& ptx : vTx)
+            {
+                /* Get the hashes to check the cache with. */
+                const uint512_t hashTx  = ptx->GetHash();
+                const uint256_t hashSig = signature_hash(*ptx);
+
+                /* Skip over signatures verified already. */
+                if(is_verified(hashTx, hashSig))
+                    continue;
+
+                vPending.push_back({ptx, hashTx, hashSig});
+            }
+
+            /* Verify on the verification threads, stopping at the first invalid signature. */
+            std::atomic<uint32_t> nInvalid(static_cast<uint32_t>(vPending.size()));
+            const auto fnVerify = [&vPending, &nInvalid](const uint32_t n)
+            {
+                /* Skip the rest once one is invalid. */
+                if(nInvalid.load() != vPending.size())
+                    return;
+
+                const Pending& pending = vPending[n];
+                if(!verify_signature(*pending.ptx, pending.hashTx, pending.hashSig))
+                    nInvalid.store(n);
+            };
+
+            /* Verify on this thread when there are no verification threads. */
+            if(VERIFY_WORKERS)
+                VERIFY_WORKERS->ForEach(static_cast<uint32_t>(vPending.size()), fnVerify);
+            else
+            {
+                for(uint32_t n = 0; n < vPending.size(); ++n)
+                    fnVerify(n);
+            }
+
+            /* Check for an invalid signature. */
+            if(nInvalid.load() != vPending.size())
+                return debug::error(FUNCTION, "invalid transaction signature ", vPending[nInvalid.load()].hashTx.SubString());
+
+            return true;
+        }
+    }
+}
@@ -13,6 +13,8 @@ ________________________________________________________________________________
 
 #include <TAO/Ledger/types/state.h>
 
+#include <map>
+#include <set>
 #include <string>
 
 #include <LLD/include/global.h>
@@ -37,6 +39,7 @@ ________________________________________________________________________________
 #include <TAO/Ledger/include/dispatch.h>
 #include <TAO/Ledger/include/enum.h>
 #include <TAO/Ledger/include/prime.h>
+#include <TAO/Ledger/include/signatures.h>
 #include <TAO/Ledger/include/stake_change.h>
 #include <TAO/Ledger/include/supply.h>
 #include <TAO/Ledger/include/timelocks.h>
@@ -46,7 +49,9 @@ ________________________________________________________________________________
 #include <TAO/Ledger/types/mempool.h>
 #include <TAO/Ledger/types/client.h>
 
+#include <Util/include/metrics.h>
 #include <Util/include/string.h>
+#include <Util/include/workers.h>
 
 
 
@@ -818,6 +823,76 @@ namespace TAO
         static uint32_t nTotalInputs = 0;
         static runtime::stopwatch swScript;
 
+        /* Metrics of the blocks connected. */
+        static metrics::Counter& BLOCKS_CONNECTED = metrics::GetCounter("nexus_ledger_blocks_connected_total",
+            "Blocks connected to the chain.");
+        static metrics::Gauge& CHAIN_HEIGHT = metrics::GetGauge("nexus_ledger_height", "Height of the last block connected.");
+        static metrics::Histogram& TRITIUM_VERIFY = metrics::GetHistogram("nexus_ledger_tx_verify_microseconds",
+            "Time to verify a transaction of a block.", metrics::LATENCY_BOUNDS, metrics::Label("type", "tritium"));
+        static metrics::Histogram& LEGACY_VERIFY = metrics::GetHistogram("nexus_ledger_tx_verify_microseconds",
+            "Time to verify a transaction of a block.", metrics::LATENCY_BOUNDS, metrics::Label("type", "legacy"));
+        static metrics::Counter& PARALLEL_VERIFIED = metrics::GetCounter("nexus_ledger_tx_parallel_verified_total",
+            "Transactions of a block with pre-states verified in parallel.");
+
+        /* Verify the register pre-states of a block's transactions that don't depend on each other across the
+         * verification threads, before any of them is connected. A transaction is independent when no earlier
+         * transaction of the block touches its sigchain or any register its pre-states read, so the states it reads
+         * are the same before the block as at its turn to connect. */
+        static void verify_independent(const std::vector<TAO::Ledger::Transaction>& vTritium, std::vector<bool>& vVerified)
+        {
+            /* Transactions not verified here are verified in block order. */
+            vVerified.assign(vTritium.size(), false);
+            if(!VERIFY_WORKERS || vTritium.size() < 2)
+                return;
+
+            /* Verify every transaction against the states before the block, keeping the registers each reads. */
+            std::vector< std::vector<uint256_t> > vRegisters(vTritium.size());
+            std::vector<uint8_t> vValid(vTritium.size(), 0);
+            VERIFY_WORKERS->ForEach(static_cast<uint32_t>(vTritium.size()), [&vTritium, &vRegisters, &vValid](const uint32_t n)
+            {
+                /* Create a temporary map for pre-states. */
+                const TAO::Ledger::Transaction& tx = vTritium[n];
+                std::map<uint256_t, TAO::Register::State> mapStates;
+                for(uint32_t nContract = 0; nContract < tx.Size(); ++nContract)
+                {
+                    /* Verify the register pre-states, with the contract bound to its transaction. */
+                    if(!TAO::Register::Verify(tx[nContract], mapStates, FLAGS::BLOCK))
+                        return;
+                }
+
+                /* Keep the registers read, which are the registers the transaction writes. */
+                for(const auto& state : mapStates)
+                    vRegisters[n].push_back(state.first);
+
+                vValid[n] = 1;
+            });
+
+            /* Keep the results of independent transactions, in block order. */
+            std::set<uint256_t> setTouched;
+            for(uint32_t n = 0; n < vTritium.size(); ++n)
+            {
+                /* The registers of a failed transaction are unknown, so later results can't be trusted. */
+                if(!vValid[n])
+                    break;
+
+                /* Check for an earlier transaction on the same sigchain or registers. */
+                bool fIndependent = !setTouched.count(vTritium[n].hashGenesis);
+                for(const auto& hashRegister : vRegisters[n])
+                {
+                    if(setTouched.count(hashRegister))
+                        fIndependent = false;
+
+                    setTouched.insert(hashRegister);
+                }
+                setTouched.insert(vTritium[n].hashGenesis);
+
+                vVerified[n] = fIndependent;
+                if(fIndependent)
+                    PARALLEL_VERIFIED.Add();
+            }
+        }
+
+
         bool BlockState::SetBest()
         {
             /* Reset timers for meters. */
@@ -1055,7 +1130,24 @@ namespace TAO
 
             debug::log(3, "BLOCK BEGIN-------------------------------------");
 
+            /* Read the tritium transactions together, in the order they are on disk. */
+            std::vector<uint512_t> vHashes;
+            for(const auto& proof : vtx)
+            {
+                if(proof.first == TRANSACTION::TRITIUM)
+                    vHashes.push_back(proof.second);
+            }
+
+            std::vector<TAO::Ledger::Transaction> vTritium;
+            if(!LLD::Ledger->ReadTx(vHashes, vTritium))
+                return debug::error(FUNCTION, "transaction not on disk");
+
+            /* Verify the pre-states of independent transactions together. */
+            std::vector<bool> vVerified;
+            verify_independent(vTritium, vVerified);
+
             /* Check through all the transactions. */
+            uint32_t nTritium = 0;
             for(const auto& proof : vtx)
             {
                 /* Only work on tritium transactions for now. */
@@ -1071,10 +1163,9 @@ namespace TAO
                     if(LLD::Ledger->HasIndex(hash))
                         return debug::error(FUNCTION, "transaction overwrites not allowed");
 
-                    /* Make sure the transaction is on disk. */
-                    TAO::Ledger::Transaction tx;
-                    if(!LLD::Ledger->ReadTx(hash, tx))
-                        return debug::error(FUNCTION, "transaction not on disk");
+                    /* Get the transaction read from disk. */
+                    const bool fVerified = vVerified[nTritium];
+                    TAO::Ledger::Transaction& tx = vTritium[nTritium++];
 
                     if(config::nVerbose >= 3)
                         tx.print();
@@ -1092,9 +1183,16 @@ namespace TAO
                             return debug::error(FUNCTION, "last hash hash mismatch");
                     }
 
-                    /* Verify the Ledger Pre-States. */
-                    if(!tx.Verify(FLAGS::BLOCK)) //NOTE: double checking this for now in post-processing
-                        return false;
+                    /* Verify the Ledger Pre-States, unless verified with the independent transactions. */
+                    if(!fVerified)
+                    {
+                        runtime::timer timer;
+                        timer.Start();
+                        if(!tx.Verify(FLAGS::BLOCK)) //NOTE: double checking this for now in post-processing
+                            return false;
+
+                        TRITIUM_VERIFY.Observe(timer.ElapsedMicroseconds());
+                    }
 
                     /* Connect the transaction. */
                     if(!tx.Connect(FLAGS::BLOCK, this))
@@ -1166,10 +1264,14 @@ namespace TAO
                     if(!tx.FetchInputs(inputs))
                         return debug::error(FUNCTION, "failed to fetch the inputs");
 
-                    /* Connect the inputs. */
+                    /* Connect the inputs, verifying their scripts. */
+                    runtime::timer timer;
+                    timer.Start();
                     if(!tx.Connect(inputs, *this, FLAGS::BLOCK))
                         return debug::error(FUNCTION, "failed to connect inputs");
 
+                    LEGACY_VERIFY.Observe(timer.ElapsedMicroseconds());
+
                     /* Add legacy transactions to the wallet where appropriate */
                     #ifndef NO_WALLET
                     Legacy::Wallet::GetInstance().AddToWalletIfInvolvingMe(tx, *this, true);
@@ -1224,6 +1326,10 @@ namespace TAO
                     ChainState::stateGenesis = prev;
             }
 
+            /* Update the metrics. */
+            BLOCKS_CONNECTED.Add();
+            CHAIN_HEIGHT.Set(nHeight);
+
             return true;
         }
 
@@ -1231,19 +1337,27 @@ namespace TAO
         /** Disconnect a block state from the chain. **/
         bool BlockState::Disconnect()
         {
+            /* Read the tritium transactions together, in the order they are on disk. */
+            std::vector<uint512_t> vHashes;
+            for(const auto& proof : vtx)
+            {
+                if(proof.first == TRANSACTION::TRITIUM)
+                    vHashes.push_back(proof.second);
+            }
+
+            std::vector<TAO::Ledger::Transaction> vTritium;
+            if(!LLD::Ledger->ReadTx(vHashes, vTritium))
+                return debug::error(FUNCTION, "transaction is not on disk");
+
             /* Disconnect the transctions in reverse order to preserve sigchain ordering. */
+            uint32_t nTritium = static_cast<uint32_t>(vTritium.size());
             for(auto proof = vtx.rbegin(); proof != vtx.rend(); ++proof)
             {
                 /* Only work on tritium transactions for now. */
                 if(proof->first == TRANSACTION::TRITIUM)
                 {
-                    /* Get the transaction hash. */
-                    const uint512_t& hash = proof->second;
-
-                    /* Read from disk. */
-                    TAO::Ledger::Transaction tx;
-                    if(!LLD::Ledger->ReadTx(hash, tx))
-                        return debug::error(FUNCTION, "transaction is not on disk");
+                    /* Get the transaction read from disk. */
+                    TAO::Ledger::Transaction& tx = vTritium[--nTritium];
 
                     /* Disconnect the transaction. */
                     if(!tx.Disconnect())
@@ -1499,24 +1613,22 @@ namespace TAO
             /* Signature hash for version 7 blocks. */
             if(nVersion >= 7)
             {
-                /* Create a data stream to get the hash. */
-                DataStream ss(SER_GETHASH, LLP::PROTOCOL_VERSION);
-                ss.reserve(256);
+                /* Create a stream to get the hash. */
+                LLC::SK1024Stream ss(SER_GETHASH, LLP::PROTOCOL_VERSION);
 
                 /* Serialize the data to hash into a stream. */
                 ss << nVersion << hashPrevBlock << hashMerkleRoot << nChannel << nHeight << nBits << nNonce << nTime << vOffsets;
 
-                return LLC::SK1024(ss.begin(), ss.end());
+                return ss.GetHash();
             }
 
-            /* Create a data stream to get the hash. */
-            DataStream ss(SER_GETHASH, LLP::PROTOCOL_VERSION);
-            ss.reserve(256);
+            /* Create a stream to get the hash. */
+            LLC::SK1024Stream ss(SER_GETHASH, LLP::PROTOCOL_VERSION);
 
             /* Serialize the data to hash into a stream. */
             ss << nVersion << hashPrevBlock << hashMerkleRoot << nChannel << nHeight << nBits << nNonce << uint32_t(nTime);
 
-            return LLC::SK1024(ss.begin(), ss.end());
+            return ss.GetHash();
         }
 
 
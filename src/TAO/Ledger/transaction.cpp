@@ -43,6 +43,7 @@ ________________________________________________________________________________
 #include <TAO/Ledger/include/chainstate.h>
 #include <TAO/Ledger/include/dispatch.h>
 #include <TAO/Ledger/include/enum.h>
+#include <TAO/Ledger/include/signatures.h>
 #include <TAO/Ledger/include/stake.h>
 #include <TAO/Ledger/include/stake_change.h>
 #include <TAO/Ledger/include/timelocks.h>
@@ -50,6 +51,7 @@ ________________________________________________________________________________
 #include <TAO/Ledger/types/mempool.h>
 
 #include <Util/include/debug.h>
+#include <Util/include/mutex.h>
 #include <Util/include/runtime.h>
 
 /* Global TAO namespace. */
@@ -63,6 +65,7 @@ namespace TAO
         /* Default Constructor. */
         Transaction::Transaction()
         : vContracts   ( )
+        , cacheHash    ( )
         , nVersion     (TAO::Ledger::CurrentTransactionVersion())
         , nSequence    (0)
         , nTimestamp   (runtime::unifiedtimestamp())
@@ -81,6 +84,7 @@ namespace TAO
         /* Copy constructor. */
         Transaction::Transaction(const Transaction& tx)
         : vContracts   (tx.vContracts)
+        , cacheHash    (tx.cacheHash)
         , nVersion     (tx.nVersion)
         , nSequence    (tx.nSequence)
         , nTimestamp   (tx.nTimestamp)
@@ -99,6 +103,7 @@ namespace TAO
         /* Move constructor. */
         Transaction::Transaction(Transaction&& tx) noexcept
         : vContracts   (std::move(tx.vContracts))
+        , cacheHash    (std::move(tx.cacheHash))
         , nVersion     (std::move(tx.nVersion))
         , nSequence    (std::move(tx.nSequence))
         , nTimestamp   (std::move(tx.nTimestamp))
@@ -117,6 +122,7 @@ namespace TAO
         /* Copy constructor. */
         Transaction::Transaction(const MerkleTx& tx)
         : vContracts   (tx.vContracts)
+        , cacheHash    (tx.cacheHash)
         , nVersion     (tx.nVersion)
         , nSequence    (tx.nSequence)
         , nTimestamp   (tx.nTimestamp)
@@ -135,6 +141,7 @@ namespace TAO
         /* Move constructor. */
         Transaction::Transaction(MerkleTx&& tx) noexcept
         : vContracts   (std::move(tx.vContracts))
+        , cacheHash    (std::move(tx.cacheHash))
         , nVersion     (std::move(tx.nVersion))
         , nSequence    (std::move(tx.nSequence))
         , nTimestamp   (std::move(tx.nTimestamp))
@@ -154,6 +161,7 @@ namespace TAO
         Transaction& Transaction::operator=(const Transaction& tx)
         {
             vContracts   = tx.vContracts;
+            cacheHash    = tx.cacheHash;
             nVersion     = tx.nVersion;
             nSequence    = tx.nSequence;
             nTimestamp   = tx.nTimestamp;
@@ -174,6 +182,7 @@ namespace TAO
         Transaction& Transaction::operator=(Transaction&& tx) noexcept
         {
             vContracts   = std::move(tx.vContracts);
+            cacheHash    = std::move(tx.cacheHash);
             nVersion     = std::move(tx.nVersion);
             nSequence    = std::move(tx.nSequence);
             nTimestamp   = std::move(tx.nTimestamp);
@@ -194,6 +203,7 @@ namespace TAO
         Transaction& Transaction::operator=(const MerkleTx& tx)
         {
             vContracts   = tx.vContracts;
+            cacheHash    = tx.cacheHash;
             nVersion     = tx.nVersion;
             nSequence    = tx.nSequence;
             nTimestamp   = tx.nTimestamp;
@@ -214,6 +224,7 @@ namespace TAO
         Transaction& Transaction::operator=(MerkleTx&& tx) noexcept
         {
             vContracts   = std::move(tx.vContracts);
+            cacheHash    = std::move(tx.cacheHash);
             nVersion     = std::move(tx.nVersion);
             nSequence    = std::move(tx.nSequence);
             nTimestamp   = std::move(tx.nTimestamp);
@@ -442,44 +453,13 @@ namespace TAO
                     return debug::error(FUNCTION, "genesis transaction contains invalid contracts.");
             }
 
-            /* Verify the block signature (if not synchronizing) */
-            if(!TAO::Ledger::ChainState::Synchronizing())
-            {
-                /* Switch based on signature type. */
-                switch(nKeyType)
-                {
-                    /* Support for the FALCON signature scheeme. */
-                    case SIGNATURE::FALCON:
-                    {
-                        /* Create the FL Key object. */
-                        LLC::FLKey key;
+            /* Check the signature type. */
+            if(nKeyType != SIGNATURE::FALCON && nKeyType != SIGNATURE::BRAINPOOL)
+                return debug::error(FUNCTION, "unknown signature type");
 
-                        /* Set the public key and verify. */
-                        key.SetPubKey(vchPubKey);
-                        if(!key.Verify(GetHash().GetBytes(), vchSig))
-                            return debug::error(FUNCTION, "invalid transaction signature");
-
-                        break;
-                    }
-
-                    /* Support for the BRAINPOOL signature scheme. */
-                    case SIGNATURE::BRAINPOOL:
-                    {
-                        /* Create EC Key object. */
-                        LLC::ECKey key = LLC::ECKey(LLC::BRAINPOOL_P512_T1, 64);
-
-                        /* Set the public key and verify. */
-                        key.SetPubKey(vchPubKey);
-                        if(!key.Verify(GetHash().GetBytes(), vchSig))
-                            return debug::error(FUNCTION, "invalid transaction signature");
-
-                        break;
-                    }
-
-                    default:
-                        return debug::error(FUNCTION, "unknown signature type");
-                }
-            }
+            /* Verify the transaction signature, unless verified already. */
+            if(!VerifySignature(*this))
+                return debug::error(FUNCTION, "invalid transaction signature");
 
             return true;
         }
@@ -1148,15 +1128,58 @@ namespace TAO
         /* Gets the hash of the transaction object. */
         uint512_t Transaction::GetHash() const
         {
-            DataStream ss(SER_GETHASH, nVersion);
+            /* Total the writes to the contracts, they are only compared to the cached total. */
+            uint64_t nWrites = 0;
+            for(const auto& contract : vContracts)
+                nWrites += contract.Writes();
+
+            const uint32_t nContracts = static_cast<uint32_t>(vContracts.size());
+
+            /* Use the cached hash if the ledger fields and contracts haven't been written since. */
+            {
+                LOCK(cacheHash.MUTEX);
+                if(cacheHash.hash != 0
+                && cacheHash.nVersion     == nVersion
+                && cacheHash.nSequence    == nSequence
+                && cacheHash.nTimestamp   == nTimestamp
+                && cacheHash.hashNext     == hashNext
+                && cacheHash.hashRecovery == hashRecovery
+                && cacheHash.hashGenesis  == hashGenesis
+                && cacheHash.hashPrevTx   == hashPrevTx
+                && cacheHash.nKeyType     == nKeyType
+                && cacheHash.nNextType    == nNextType
+                && cacheHash.nContracts   == nContracts
+                && cacheHash.nWrites      == nWrites)
+                    return cacheHash.hash;
+            }
+
+            /* Serialize straight into the hash. */
+            LLC::SK512Stream ss(SER_GETHASH, nVersion);
             ss << *this;
 
             /* Get the hash. */
-            uint512_t hash = LLC::SK512(ss.begin(), ss.end());
+            uint512_t hash = ss.GetHash();
 
             /* Type of 0xff designates tritium tx. */
             hash.SetType(TAO::Ledger::TRITIUM);
 
+            /* Cache the hash with the fields it was taken over. */
+            {
+                LOCK(cacheHash.MUTEX);
+                cacheHash.hash         = hash;
+                cacheHash.nVersion     = nVersion;
+                cacheHash.nSequence    = nSequence;
+                cacheHash.nTimestamp   = nTimestamp;
+                cacheHash.hashNext     = hashNext;
+                cacheHash.hashRecovery = hashRecovery;
+                cacheHash.hashGenesis  = hashGenesis;
+                cacheHash.hashPrevTx   = hashPrevTx;
+                cacheHash.nKeyType     = nKeyType;
+                cacheHash.nNextType    = nNextType;
+                cacheHash.nContracts   = nContracts;
+                cacheHash.nWrites      = nWrites;
+            }
+
             return hash;
         }
 
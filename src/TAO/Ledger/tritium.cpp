@@ -32,6 +32,7 @@ ________________________________________________________________________________
 #include <TAO/Ledger/include/checkpoints.h>
 #include <TAO/Ledger/include/difficulty.h>
 #include <TAO/Ledger/include/retarget.h>
+#include <TAO/Ledger/include/signatures.h>
 #include <TAO/Ledger/include/stake.h>
 #include <TAO/Ledger/include/enum.h>
 #include <TAO/Ledger/include/supply.h>
@@ -426,6 +427,10 @@ namespace TAO
             /* Get list of producer transactions. */
             std::map<uint256_t, uint512_t> mapLast;
 
+            /* The tritium transactions to verify the signatures of. */
+            std::vector<TAO::Ledger::Transaction> vTritium;
+            vTritium.reserve(vtx.size());
+
             /* Get the signature operations for legacy tx's. */
             uint32_t nSize = (uint32_t)vtx.size();
             for(uint32_t i = 0; i < nSize; ++i)
@@ -483,6 +488,9 @@ namespace TAO
 
                     /* Set the last hash for given genesis. */
                     mapLast[tx.hashGenesis] = tx.GetHash();
+
+                    /* Keep the transaction to verify its signature with the others. */
+                    vTritium.push_back(std::move(tx));
                 }
                 else
                     return debug::error(FUNCTION, "unknown transaction type");
@@ -515,47 +523,53 @@ namespace TAO
             if(hashMerkleRoot != BuildMerkleTree(vHashes))
                 return debug::error(FUNCTION, "hashMerkleRoot mismatch");
 
-            /* Verify producer signature(s) (if not synchronizing) */
-            if(!TAO::Ledger::ChainState::Synchronizing())
+            /* Verify the transaction signatures across the verification threads. */
+            std::vector<const TAO::Ledger::Transaction*> vVerify;
+            vVerify.reserve(vTritium.size());
+            for(const auto& tx : vTritium)
+                vVerify.push_back(&tx);
+
+            /* Signatures accepted into the memory pool already are not verified again. */
+            if(!VerifySignatures(vVerify))
+                return debug::error(FUNCTION, "invalid transaction signature");
+
+            /* Verify the block signature with the producer's key. */
+            switch(producer.nKeyType)
             {
-                /* Switch based on signature type. */
-                switch(producer.nKeyType)
+                /* Support for the FALCON signature scheeme. */
+                case SIGNATURE::FALCON:
                 {
-                    /* Support for the FALCON signature scheeme. */
-                    case SIGNATURE::FALCON:
-                    {
-                        /* Create the FL Key object. */
-                        LLC::FLKey key;
-
-                        /* Set the public key and verify. */
-                        key.SetPubKey(producer.vchPubKey);
+                    /* Create the FL Key object. */
+                    LLC::FLKey key;
 
-                        /* Check the Block Signature. */
-                        if(!VerifySignature(key))
-                            return debug::error(FUNCTION, "bad block signature");
+                    /* Set the public key and verify. */
+                    key.SetPubKey(producer.vchPubKey);
 
-                        break;
-                    }
+                    /* Check the Block Signature. */
+                    if(!VerifySignature(key))
+                        return debug::error(FUNCTION, "bad block signature");
 
-                    /* Support for the BRAINPOOL signature scheme. */
-                    case SIGNATURE::BRAINPOOL:
-                    {
-                        /* Create EC Key object. */
-                        LLC::ECKey key = LLC::ECKey(LLC::BRAINPOOL_P512_T1, 64);
+                    break;
+                }
 
-                        /* Set the public key and verify. */
-                        key.SetPubKey(producer.vchPubKey);
+                /* Support for the BRAINPOOL signature scheme. */
+                case SIGNATURE::BRAINPOOL:
+                {
+                    /* Create EC Key object. */
+                    LLC::ECKey key = LLC::ECKey(LLC::BRAINPOOL_P512_T1, 64);
 
-                        /* Check the Block Signature. */
-                        if(!VerifySignature(key))
-                            return debug::error(FUNCTION, "bad block signature");
+                    /* Set the public key and verify. */
+                    key.SetPubKey(producer.vchPubKey);
 
-                        break;
-                    }
+                    /* Check the Block Signature. */
+                    if(!VerifySignature(key))
+                        return debug::error(FUNCTION, "bad block signature");
 
-                    default:
-                        return debug::error(FUNCTION, "unknown signature type");
+                    break;
                 }
+
+                default:
+                    return debug::error(FUNCTION, "unknown signature type");
             }
 
             return true;
@@ -673,7 +687,8 @@ namespace TAO
             }
 
             /* Commit the transaction to database. */
-            LLD::TxnCommit();
+            if(!LLD::TxnCommit())
+                return debug::error(FUNCTION, "failed to commit block to database");
 
             /* Check for best chain. */
             if(GetHash() == ChainState::hashBestChain.load())
@@ -834,14 +849,13 @@ namespace TAO
         /* Get the Signarture Hash of the block. Used to verify work claims. */
         uint1024_t TritiumBlock::SignatureHash() const
         {
-            /* Create a data stream to get the hash. */
-            DataStream ss(SER_GETHASH, LLP::PROTOCOL_VERSION);
-            ss.reserve(256);
+            /* Create a stream to get the hash. */
+            LLC::SK1024Stream ss(SER_GETHASH, LLP::PROTOCOL_VERSION);
 
             /* Serialize the data to hash into a stream. */
             ss << nVersion << hashPrevBlock << hashMerkleRoot << nChannel << nHeight << nBits << nNonce << nTime << vOffsets;
 
-            return LLC::SK1024(ss.begin(), ss.end());
+            return ss.GetHash();
         }
 
 
@@ -0,0 +1,169 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#pragma once
+#ifndef NEXUS_TAO_LEDGER_TYPES_CANDIDATES_H
+#define NEXUS_TAO_LEDGER_TYPES_CANDIDATES_H
+
+#include <LLC/types/uint1024.h>
+
+#include <mutex>
+#include <set>
+#include <vector>
+
+/* Global TAO namespace. */
+namespace TAO
+{
+
+    /* Ledger Layer namespace. */
+    namespace Ledger
+    {
+
+        /** Candidates
+         *
+         *  The tritium transactions from the memory pool that connect on top of the best chain,
+         *  in the order they are to be added to a new block.
+         *
+         *  New transactions are verified and connected into the miner memory states once, when
+         *  the next block template is requested after they were accepted. A new block made of the
+         *  first candidates in order only drops them from the list, since the miner memory states
+         *  already hold what it connected. The whole list is rebuilt on a reorg, for any other
+         *  block, or when a candidate leaves the memory pool without being connected.
+         *
+         **/
+        class Candidates
+        {
+            /** Mutex for the candidate list and the miner memory states. **/
+            std::mutex MUTEX;
+
+
+            /** Mutex for the queue of transactions accepted since the last template. **/
+            std::mutex QUEUE_MUTEX;
+
+
+            /** The transactions accepted into the memory pool since the last template. **/
+            std::vector<uint512_t> vQueued;
+
+
+            /** The transactions removed from the memory pool since the last template. **/
+            std::vector<uint512_t> vRemoved;
+
+
+            /** The best chain the list was built on top of. **/
+            uint1024_t hashBest;
+
+
+            /** The transactions to add to a new block, in block order. **/
+            std::vector<std::pair<uint8_t, uint512_t>> vCandidates;
+
+
+            /** The transactions in the candidate list. **/
+            std::set<uint512_t> setCandidates;
+
+
+            /** The transactions that failed to connect, and their dependents. **/
+            std::set<uint512_t> setRejected;
+
+
+            /** The serialized size of the candidate list entries. **/
+            uint64_t nSize;
+
+        public:
+
+            /** Default Constructor. **/
+            Candidates();
+
+
+            /** Default Destructor. **/
+            ~Candidates();
+
+
+            /** Queue
+             *
+             *  Queue a transaction accepted into the memory pool, to be connected with the next template.
+             *  Only takes the queue lock, so it is safe to call while holding the memory pool lock.
+             *
+             *  @param[in] hashTx The transaction accepted.
+             *
+             **/
+            void Queue(const uint512_t& hashTx);
+
+
+            /** Remove
+             *
+             *  Queue a transaction removed from the memory pool, to be dropped from the list with the next
+             *  template. Only takes the queue lock, so it is safe to call while holding the memory pool lock.
+             *
+             *  @param[in] hashTx The transaction removed.
+             *
+             **/
+            void Remove(const uint512_t& hashTx);
+
+
+            /** List
+             *
+             *  Connect the queued transactions, and add the candidates to a block in order.
+             *
+             *  @param[out] vtx The block transactions to add the candidates to.
+             *  @param[in] nMaxSize The serialized size the added entries must stay under.
+             *
+             **/
+            void List(std::vector<std::pair<uint8_t, uint512_t>>& vtx, const uint64_t nMaxSize);
+
+
+            /** Size
+             *
+             *  Gets the number of transactions in the candidate list.
+             *
+             **/
+            uint32_t Size();
+
+
+        private:
+
+            /** rebuild
+             *
+             *  Rebuild the candidate list from the memory pool on top of the best chain.
+             *
+             **/
+            void rebuild();
+
+
+            /** connect
+             *
+             *  Drop the candidates connected by a new best block, if it holds the first candidates in
+             *  order so the miner memory states are still on top of it.
+             *
+             *  @param[in] vRemove The transactions removed from the memory pool since the last template.
+             *
+             *  @return True if the list is still on top of the best chain, false if it must be rebuilt.
+             *
+             **/
+            bool connect(const std::vector<uint512_t>& vRemove);
+
+
+            /** add
+             *
+             *  Connect a memory pool transaction into the miner memory states and add it to the list.
+             *
+             *  @param[in] hashTx The transaction to add.
+             *
+             **/
+            void add(const uint512_t& hashTx);
+        };
+
+        extern Candidates candidates;
+    }
+}
+
+#endif
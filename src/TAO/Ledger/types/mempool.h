@@ -25,6 +25,7 @@ ________________________________________________________________________________
 #include <Legacy/types/outpoint.h>
 
 #include <Util/include/mutex.h>
+#include <Util/templates/hashindex.h>
 
 namespace LLP
 {
@@ -49,33 +50,40 @@ namespace TAO
         {
         public:
 
-            /* Mutex to local access to the mempool */
+            /* Mutex to serialize changes to the mempool and its memory states. Get, Has and Size don't take it.
+               Ledger transactions are added to and removed from mapLedger while their signature chain is held
+               in mapSigchains, so Get by genesis sees each chain and its transactions as one unit. List takes
+               the mutex as it has to match the chains to disk. */
             mutable std::recursive_mutex MUTEX;
 
         private:
 
             /** The transactions in the ledger memory pool. **/
-            std::map<uint512_t, Legacy::Transaction> mapLegacy;
+            HashIndex<uint512_t, Legacy::Transaction> mapLegacy;
 
 
             /** The transactions in conflicted legacy memory pool. */
-            std::map<uint512_t, Legacy::Transaction> mapLegacyConflicts;
+            HashIndex<uint512_t, Legacy::Transaction> mapLegacyConflicts;
 
 
             /** The transactions in the ledger memory pool. **/
-            std::map<uint512_t, TAO::Ledger::Transaction> mapLedger;
+            HashIndex<uint512_t, TAO::Ledger::Transaction> mapLedger;
 
 
             /** The transactions in the conflicted ledger memory pool. **/
-            std::map<uint512_t, TAO::Ledger::Transaction> mapConflicts;
+            HashIndex<uint512_t, TAO::Ledger::Transaction> mapConflicts;
 
 
             /** Oprhan transactions in queue. **/
-            std::map<uint512_t, TAO::Ledger::Transaction> mapOrphans;
+            HashIndex<uint512_t, TAO::Ledger::Transaction> mapOrphans;
 
 
             /** Record of conflicted transactions in mempool. **/
-            std::map<uint512_t, uint512_t> mapClaimed;
+            HashIndex<uint512_t, uint512_t> mapClaimed;
+
+
+            /** The sequence numbers and hashes of the ledger transactions by genesis, in sequence order. **/
+            HashIndex<uint256_t, std::vector<std::pair<uint32_t, uint512_t>>> mapSigchains;
 
 
             /** Record of legacy inputs in the mempool. **/
@@ -85,6 +93,32 @@ namespace TAO
             /** Set to keep track of duplicate orphans by index. **/
             std::set<uint512_t> setOrphansByIndex;
 
+
+            /** Flag set while a chain of orphans is accepted, so its signatures are verified together once. **/
+            bool fProcessingOrphans;
+
+
+            /** add_sigchain
+             *
+             *  Add a ledger transaction to the pool and to the list of its signature chain, as one unit.
+             *
+             *  @param[in] tx The transaction to add.
+             *  @param[in] hashTx The hash of the transaction.
+             *
+             **/
+            void add_sigchain(const TAO::Ledger::Transaction& tx, const uint512_t& hashTx);
+
+
+            /** remove_sigchain
+             *
+             *  Remove a ledger transaction from the pool and from the list of its signature chain, as one unit.
+             *
+             *  @param[in] tx The transaction to remove.
+             *  @param[in] hashTx The hash of the transaction.
+             *
+             **/
+            void remove_sigchain(const TAO::Ledger::Transaction& tx, const uint512_t& hashTx);
+
         public:
 
             /** Default Constructor. **/
@@ -301,7 +335,8 @@ namespace TAO
 
             /** List
              *
-             *  List transactions in memory pool.
+             *  List transactions in memory pool. Each signature chain is listed up to the
+             *  first transaction that doesn't connect to the one before it, or to disk.
              *
              *  @param[out] vHashes List of transaction hashes.
              *  @param[in] nCount The total transactions to get.
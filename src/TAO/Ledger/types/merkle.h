@@ -94,6 +94,10 @@ namespace TAO
             /* serialization macros */
             IMPLEMENT_SERIALIZE
             (
+                /* Clear the cached hash when reading new contracts. */
+                if(fRead)
+                    cacheHash.Clear();
+
                 /* Contracts layers. */
                 READWRITE(vContracts);
 
@@ -19,6 +19,9 @@ ________________________________________________________________________________
 
 #include <TAO/Ledger/include/enum.h>
 
+#include <Util/include/mutex.h>
+
+#include <mutex>
 #include <vector>
 
 /* Global TAO namespace. */
@@ -47,6 +50,115 @@ namespace TAO
             /** For disk indexing on contract. **/
             std::vector<TAO::Operation::Contract> vContracts;
 
+
+            /** HashCache
+             *
+             *  The last hash of a transaction, with the ledger fields it was taken over.
+             *  The ledger fields are public and written directly, so GetHash compares them
+             *  before using the hash. The contracts are compared by their count and total
+             *  writes, which every write to a contract raises, even through a kept reference.
+             *
+             *  GetHash is const and may be called from several threads at once, so the
+             *  cache is only read and written holding its mutex.
+             *
+             **/
+            struct HashCache
+            {
+                /** Mutex for the cached hash and fields. **/
+                mutable std::mutex MUTEX;
+
+
+                /** The hash, or zero when there is none. **/
+                uint512_t hash;
+
+
+                /** The ledger fields the hash was taken over. **/
+                uint32_t  nVersion;
+                uint32_t  nSequence;
+                uint64_t  nTimestamp;
+                uint256_t hashNext;
+                uint256_t hashRecovery;
+                uint256_t hashGenesis;
+                uint512_t hashPrevTx;
+                uint8_t   nKeyType;
+                uint8_t   nNextType;
+
+
+                /** The contracts and their total writes when the hash was taken. **/
+                uint32_t  nContracts;
+                uint64_t  nWrites;
+
+
+                /** Default Constructor. **/
+                HashCache()
+                : MUTEX        ( )
+                , hash         (0)
+                , nVersion     (0)
+                , nSequence    (0)
+                , nTimestamp   (0)
+                , hashNext     (0)
+                , hashRecovery (0)
+                , hashGenesis  (0)
+                , hashPrevTx   (0)
+                , nKeyType     (0)
+                , nNextType    (0)
+                , nContracts   (0)
+                , nWrites      (0)
+                {
+                }
+
+
+                /** Copy Constructor. **/
+                HashCache(const HashCache& cache)
+                : HashCache()
+                {
+                    *this = cache;
+                }
+
+
+                /** Copy Assignment Operator. **/
+                HashCache& operator=(const HashCache& cache)
+                {
+                    if(this == &cache)
+                        return *this;
+
+                    std::lock(MUTEX, cache.MUTEX);
+                    std::lock_guard<std::mutex> lockThis(MUTEX, std::adopt_lock);
+                    std::lock_guard<std::mutex> lockCache(cache.MUTEX, std::adopt_lock);
+
+                    hash         = cache.hash;
+                    nVersion     = cache.nVersion;
+                    nSequence    = cache.nSequence;
+                    nTimestamp   = cache.nTimestamp;
+                    hashNext     = cache.hashNext;
+                    hashRecovery = cache.hashRecovery;
+                    hashGenesis  = cache.hashGenesis;
+                    hashPrevTx   = cache.hashPrevTx;
+                    nKeyType     = cache.nKeyType;
+                    nNextType    = cache.nNextType;
+                    nContracts   = cache.nContracts;
+                    nWrites      = cache.nWrites;
+
+                    return *this;
+                }
+
+
+                /** Clear
+                 *
+                 *  Forget the cached hash so the next GetHash hashes again.
+                 *
+                 **/
+                void Clear()
+                {
+                    LOCK(MUTEX);
+                    hash = 0;
+                }
+            };
+
+
+            /** Memory only, the cached hash of this transaction. **/
+            mutable HashCache cacheHash;
+
         public:
 
             /** The transaction version. **/
@@ -93,6 +205,10 @@ namespace TAO
             /* serialization macros */
             IMPLEMENT_SERIALIZE
             (
+                /* Clear the cached hash when reading new contracts. */
+                if(fRead)
+                    cacheHash.Clear();
+
                 /* Contracts layers. */
                 READWRITE(vContracts);
 
@@ -351,6 +467,7 @@ namespace TAO
             /** GetHash
              *
              *  Gets the hash of the transaction object.
+             *  The hash is kept, and used again while the transaction is unchanged.
              *
              *  @return 512-bit unsigned integer of hash.
              *
@@ -19,6 +19,8 @@ ________________________________________________________________________________
 #include <TAO/Ledger/types/transaction.h>
 #include <TAO/Ledger/include/timelocks.h>
 
+#include <algorithm>
+
 /* Global TAO namespace. */
 namespace TAO
 {
@@ -36,6 +38,7 @@ namespace TAO
         , nTimestamp  (0)
         , hashTx      (0)
         , nVersion    (TAO::Ledger::CurrentTransactionVersion())
+        , nWrites     (0)
         {
         }
 
@@ -49,6 +52,7 @@ namespace TAO
         , nTimestamp  (contract.nTimestamp)
         , hashTx      (contract.hashTx)
         , nVersion    (contract.nVersion)
+        , nWrites     (contract.nWrites)
         {
         }
 
@@ -62,6 +66,7 @@ namespace TAO
         , nTimestamp  (std::move(contract.nTimestamp))
         , hashTx      (std::move(contract.hashTx))
         , nVersion    (std::move(contract.nVersion))
+        , nWrites     (contract.nWrites)
         {
         }
 
@@ -77,6 +82,9 @@ namespace TAO
             hashTx      = contract.hashTx;
             nVersion    = contract.nVersion;
 
+            /* Count the assignment as a write, past the writes of both contracts. */
+            nWrites     = std::max(nWrites, contract.nWrites) + 1;
+
             return *this;
         }
 
@@ -92,6 +100,9 @@ namespace TAO
             hashTx      = std::move(contract.hashTx);
             nVersion    = std::move(contract.nVersion);
 
+            /* Count the assignment as a write, past the writes of both contracts. */
+            nWrites     = std::max(nWrites, contract.nWrites) + 1;
+
             return *this;
         }
 
@@ -148,6 +159,13 @@ namespace TAO
         }
 
 
+        /* Get the number of writes to the streams. */
+        uint64_t Contract::Writes() const
+        {
+            return nWrites;
+        }
+
+
         /* Move the internal operation stream pointer to the position of the primitive operation byte.
         *  If the stream starts with a CONDITION or VALIDATE byte then the pointer is moved forward to skip these bytes */
         void Contract::SeekToPrimitive() const
@@ -533,6 +551,8 @@ namespace TAO
             /* Check the operations. */
             if(nFlags & REGISTERS)
                 ssRegister.SetNull();
+
+            ++nWrites;
         }
 
 
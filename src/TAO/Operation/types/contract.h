@@ -75,6 +75,10 @@ namespace TAO
             mutable uint32_t nVersion;
 
 
+            /** MEMORY ONLY: the writes to the streams, so a transaction can tell its cached hash is stale. **/
+            uint64_t nWrites;
+
+
         public:
 
             /** Enumeration to handle setting aspects of the contract. */
@@ -152,6 +156,17 @@ namespace TAO
             void Bind(const uint64_t nTimestampIn, const uint256_t& hashCallerIn) const;
 
 
+            /** Writes
+             *
+             *  Get the number of writes to the streams. It only grows, so a change of the
+             *  total over a transaction's contracts means they were written.
+             *
+             *  @return The writes to the streams.
+             *
+             **/
+            uint64_t Writes() const;
+
+
             /** Primitive
              *
              *  Get the primitive operation.
@@ -378,6 +393,7 @@ namespace TAO
             {
                 /* Serialize to the stream. */
                 ssOperation << obj;
+                ++nWrites;
 
                 return (*this);
             }
@@ -412,6 +428,7 @@ namespace TAO
             {
                 /* Serialize to the stream. */
                 ssCondition << obj;
+                ++nWrites;
 
                 return (*this);
             }
@@ -446,6 +463,7 @@ namespace TAO
             {
                 /* Serialize to the stream. */
                 ssRegister << obj;
+                ++nWrites;
 
                 return (*this);
             }
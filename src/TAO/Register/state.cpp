@@ -210,10 +210,10 @@ namespace TAO
         /* Get the hash of the current state. */
         uint64_t State::GetHash() const
         {
-            DataStream ss(SER_GETHASH, nVersion);
+            LLC::SK64Stream ss(SER_GETHASH, nVersion);
             ss << *this;
 
-            return LLC::SK64(ss.begin(), ss.end());
+            return ss.GetHash();
         }
 
 
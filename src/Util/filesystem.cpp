@@ -162,6 +162,26 @@ namespace filesystem
     }
 
 
+    /* Flush the written data of a file from the operating system to disk. */
+    bool sync(const std::string &path)
+    {
+#ifndef WIN32
+        int fd = open(path.c_str(), O_RDONLY);
+        if(fd < 0)
+            return false;
+
+        /* Data written through any descriptor of the file is flushed. */
+        int nRet = fdatasync(fd);
+        close(fd);
+
+        return nRet == 0;
+#else
+        /* No descriptor level sync on windows, rely on the stream flushes. */
+        return exists(path);
+#endif
+    }
+
+
     /* Determines if the file or folder from the specified path exists. */
     bool exists(const std::string &path)
     {
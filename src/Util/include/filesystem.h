@@ -65,6 +65,18 @@ namespace filesystem
     bool rename(const std::string &pathOld, const std::string &pathNew); 
 
 
+    /** sync
+     *
+     *  Flush the written data of a file from the operating system to disk.
+     *
+     *  @param[in] path The path of the file to sync.
+     *
+     *  @return Returns true if the file was synced, false otherwise.
+     *
+     **/
+    bool sync(const std::string &path);
+
+
     /** exists
      *
      *  Determines if the file or folder from the specified path exists.
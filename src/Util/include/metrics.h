@@ -0,0 +1,314 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#pragma once
+#ifndef NEXUS_UTIL_INCLUDE_METRICS_H
+#define NEXUS_UTIL_INCLUDE_METRICS_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace metrics
+{
+
+    /** Counter
+     *
+     *  A count that only goes up, such as records read or packets received.
+     *
+     **/
+    class Counter
+    {
+        /* The current count. */
+        std::atomic<uint64_t> nValue;
+
+    public:
+
+        /** Default Constructor. **/
+        Counter();
+
+
+        /** Copy Constructor. **/
+        Counter(const Counter& counter)            = delete;
+
+
+        /** Copy assignment. **/
+        Counter& operator=(const Counter& counter) = delete;
+
+
+        /** Add
+         *
+         *  Add to the count.
+         *
+         *  @param[in] nAmount The amount to add.
+         *
+         **/
+        void Add(const uint64_t nAmount = 1)
+        {
+            nValue.fetch_add(nAmount, std::memory_order_relaxed);
+        }
+
+
+        /** Get
+         *
+         *  Get the current count.
+         *
+         **/
+        uint64_t Get() const;
+    };
+
+
+    /** Gauge
+     *
+     *  A value that goes up and down, such as the size of a queue.
+     *
+     **/
+    class Gauge
+    {
+        /* The current value. */
+        std::atomic<int64_t> nValue;
+
+    public:
+
+        /** Default Constructor. **/
+        Gauge();
+
+
+        /** Copy Constructor. **/
+        Gauge(const Gauge& gauge)            = delete;
+
+
+        /** Copy assignment. **/
+        Gauge& operator=(const Gauge& gauge) = delete;
+
+
+        /** Set
+         *
+         *  Set the current value.
+         *
+         *  @param[in] nValueIn The value to set.
+         *
+         **/
+        void Set(const int64_t nValueIn)
+        {
+            nValue.store(nValueIn, std::memory_order_relaxed);
+        }
+
+
+        /** Add
+         *
+         *  Add to the current value, which may be negative.
+         *
+         *  @param[in] nAmount The amount to add.
+         *
+         **/
+        void Add(const int64_t nAmount)
+        {
+            nValue.fetch_add(nAmount, std::memory_order_relaxed);
+        }
+
+
+        /** Get
+         *
+         *  Get the current value.
+         *
+         **/
+        int64_t Get() const;
+    };
+
+
+    /** Histogram
+     *
+     *  A count of observed values in buckets of fixed upper bounds, such as latencies.
+     *  Each value is counted in the first bucket it fits in, and in an overflow bucket
+     *  if it is above every bound. Observing is lock-free.
+     *
+     **/
+    class Histogram
+    {
+        /* The upper bounds of the buckets, in increasing order. */
+        std::vector<uint64_t> vBounds;
+
+
+        /* The count of each bucket, with the overflow bucket last. */
+        std::unique_ptr<std::atomic<uint64_t>[]> pCounts;
+
+
+        /* The sum of the observed values. */
+        std::atomic<uint64_t> nSum;
+
+    public:
+
+        /** Default Constructor. **/
+        Histogram()                                      = delete;
+
+
+        /** Copy Constructor. **/
+        Histogram(const Histogram& histogram)            = delete;
+
+
+        /** Copy assignment. **/
+        Histogram& operator=(const Histogram& histogram) = delete;
+
+
+        /** Bounds Constructor
+         *
+         *  @param[in] vBoundsIn The upper bounds of the buckets, sorted if they aren't.
+         *
+         **/
+        Histogram(const std::vector<uint64_t>& vBoundsIn);
+
+
+        /** Observe
+         *
+         *  Count a value in its bucket.
+         *
+         *  @param[in] nValue The value to count.
+         *
+         **/
+        void Observe(const uint64_t nValue);
+
+
+        /** Bounds
+         *
+         *  Get the upper bounds of the buckets.
+         *
+         **/
+        const std::vector<uint64_t>& Bounds() const;
+
+
+        /** Read
+         *
+         *  Read the counts of the histogram.
+         *
+         *  @param[out] vCounts The count of each bucket, with the overflow bucket last.
+         *  @param[out] nSumOut The sum of the observed values.
+         *  @param[out] nCountOut The number of observed values.
+         *
+         **/
+        void Read(std::vector<uint64_t>& vCounts, uint64_t& nSumOut, uint64_t& nCountOut) const;
+    };
+
+
+    /** Label
+     *
+     *  Format a label for the labels of a metric, escaping its value.
+     *  Labels are joined with commas, such as Label("db", "_LEDGER") + "," + Label("type", "read").
+     *
+     *  @param[in] strName The name of the label.
+     *  @param[in] strValue The value of the label.
+     *
+     *  @return The formatted label.
+     *
+     **/
+    std::string Label(const std::string& strName, const std::string& strValue);
+
+
+    /** GetCounter
+     *
+     *  Get a counter by name and labels, registering it the first time it is used.
+     *  Metrics are never unregistered, so the reference stays valid.
+     *
+     *  @param[in] strName The name of the metric.
+     *  @param[in] strHelp The description of the metric.
+     *  @param[in] strLabels The labels of the metric.
+     *
+     *  @return The counter.
+     *
+     **/
+    Counter& GetCounter(const std::string& strName, const std::string& strHelp, const std::string& strLabels = "");
+
+
+    /** GetGauge
+     *
+     *  Get a gauge by name and labels, registering it the first time it is used.
+     *  Metrics are never unregistered, so the reference stays valid.
+     *
+     *  @param[in] strName The name of the metric.
+     *  @param[in] strHelp The description of the metric.
+     *  @param[in] strLabels The labels of the metric.
+     *
+     *  @return The gauge.
+     *
+     **/
+    Gauge& GetGauge(const std::string& strName, const std::string& strHelp, const std::string& strLabels = "");
+
+
+    /** GetHistogram
+     *
+     *  Get a histogram by name and labels, registering it the first time it is used.
+     *  Metrics are never unregistered, so the reference stays valid.
+     *
+     *  @param[in] strName The name of the metric.
+     *  @param[in] strHelp The description of the metric.
+     *  @param[in] vBounds The upper bounds of the buckets, used when the histogram is registered.
+     *  @param[in] strLabels The labels of the metric.
+     *
+     *  @return The histogram.
+     *
+     **/
+    Histogram& GetHistogram(const std::string& strName, const std::string& strHelp,
+                            const std::vector<uint64_t>& vBounds, const std::string& strLabels = "");
+
+
+    /** Watch
+     *
+     *  Register a value that is read when the metrics are exported, for values that are
+     *  already kept elsewhere such as cache statistics or the number of connections.
+     *  The function is called holding the registry lock, so it must not use the registry.
+     *
+     *  @param[in] strName The name of the metric.
+     *  @param[in] strHelp The description of the metric.
+     *  @param[in] fCounter True if the value only goes up, false if it is a gauge.
+     *  @param[in] strLabels The labels of the metric.
+     *  @param[in] fnValue The function to read the value.
+     *
+     *  @return The id of the watch, to remove it with Unwatch.
+     *
+     **/
+    uint64_t Watch(const std::string& strName, const std::string& strHelp, const bool fCounter,
+                   const std::string& strLabels, const std::function<double()>& fnValue);
+
+
+    /** Unwatch
+     *
+     *  Remove a watched value. Must be called before the objects it reads are destroyed.
+     *
+     *  @param[in] nId The id of the watch.
+     *
+     **/
+    void Unwatch(const uint64_t nId);
+
+
+    /** Export
+     *
+     *  Get every metric in the Prometheus text format.
+     *
+     *  @return The metrics, one sample per line.
+     *
+     **/
+    std::string Export();
+
+
+    /** Latency bounds in microseconds, from 10 us to 10 s. **/
+    const std::vector<uint64_t> LATENCY_BOUNDS =
+    {
+        10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000,
+        100000, 250000, 500000, 1000000, 2500000, 5000000, 10000000
+    };
+}
+
+#endif
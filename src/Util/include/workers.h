@@ -0,0 +1,198 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#pragma once
+#ifndef NEXUS_UTIL_INCLUDE_WORKERS_H
+#define NEXUS_UTIL_INCLUDE_WORKERS_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+/** WorkerPool
+ *
+ *  A fixed number of threads that run submitted tasks.
+ *
+ *  Each worker has its own queue. Tasks submitted from outside the pool are spread
+ *  over the queues in turn, and tasks submitted by a worker go to its own queue. A
+ *  worker runs its own tasks oldest first, and when it runs out it steals the newest
+ *  task of another worker, so a worker held up by a slow task doesn't hold up the
+ *  tasks queued behind it.
+ *
+ *  The number of queued tasks can be bounded, so callers can turn work away when the
+ *  pool falls behind instead of queuing it without limit.
+ *
+ **/
+class WorkerPool
+{
+    /* The queue of one worker. */
+    struct Queue
+    {
+        /* Mutex to protect the tasks. */
+        std::mutex MUTEX;
+
+
+        /* The tasks, oldest first. */
+        std::deque< std::function<void()> > qTasks;
+    };
+
+
+    /* The queue of each worker. */
+    std::vector< std::unique_ptr<Queue> > vQueues;
+
+
+    /* Mutex for the condition. */
+    std::mutex MUTEX;
+
+
+    /* The condition for workers to wait for tasks. */
+    std::condition_variable CONDITION;
+
+
+    /* The number of tasks waiting in the queues. */
+    std::atomic<uint64_t> nQueued;
+
+
+    /* The most tasks that can wait in the queues, or 0 for no limit. */
+    const uint64_t nMaxQueued;
+
+
+    /* The queue the next task from outside the pool goes to. */
+    std::atomic<uint32_t> nNext;
+
+
+    /* Flag to stop the workers. */
+    std::atomic<bool> fStop;
+
+
+    /* The worker threads. */
+    std::vector<std::thread> vThreads;
+
+
+public:
+
+    /** Default Constructor. **/
+    WorkerPool()                                       = delete;
+
+
+    /** Copy Constructor. **/
+    WorkerPool(const WorkerPool& pool)                 = delete;
+
+
+    /** Copy assignment. **/
+    WorkerPool& operator=(const WorkerPool& pool)      = delete;
+
+
+    /** Thread Constructor
+     *
+     *  @param[in] nThreads The number of worker threads, at least one.
+     *  @param[in] nMaxQueuedIn The most tasks that can wait in the queues, or 0 for no limit.
+     *
+     **/
+    WorkerPool(const uint32_t nThreads, const uint64_t nMaxQueuedIn = 0);
+
+
+    /** Default Destructor
+     *
+     *  Stops the pool if it wasn't stopped already.
+     *
+     **/
+    ~WorkerPool();
+
+
+    /** Stop
+     *
+     *  Turn away new tasks from outside the pool, run the tasks still queued and the
+     *  tasks they submit, then stop the workers.
+     *  Must not be called from a worker.
+     *
+     **/
+    void Stop();
+
+
+    /** Submit
+     *
+     *  Queue a task to be run by a worker.
+     *
+     *  @param[in] fnTask The task to run. Exceptions it throws are logged.
+     *
+     *  @return True if the task was queued, false if the queues are full or the pool is stopped.
+     *
+     **/
+    bool Submit(const std::function<void()>& fnTask);
+
+
+    /** ForEach
+     *
+     *  Run a task once for each index, spread over the workers and the calling thread,
+     *  and return once every index was run. Indexes the workers can't take because the
+     *  queues are full are run by the calling thread.
+     *  Must not be called from a worker.
+     *
+     *  @param[in] nCount The number of indexes to run.
+     *  @param[in] fnTask The task to run for an index. An exception it throws is rethrown
+     *                    once the indexes being run have finished.
+     *
+     **/
+    void ForEach(const uint32_t nCount, const std::function<void(const uint32_t)>& fnTask);
+
+
+    /** Queued
+     *
+     *  Get the number of tasks waiting for a worker.
+     *
+     **/
+    uint64_t Queued() const;
+
+
+    /** Size
+     *
+     *  Get the number of worker threads.
+     *
+     **/
+    uint32_t Size() const;
+
+
+private:
+
+    /** worker
+     *
+     *  The thread of a worker.
+     *
+     *  @param[in] nWorker The index of the worker.
+     *
+     **/
+    void worker(const uint32_t nWorker);
+
+
+    /** take
+     *
+     *  Take the oldest task of a worker's queue, or the newest task of another worker's.
+     *
+     *  @param[in] nWorker The index of the worker.
+     *  @param[out] fnTask The task that was taken.
+     *
+     *  @return True if a task was taken.
+     *
+     **/
+    bool take(const uint32_t nWorker, std::function<void()>& fnTask);
+};
+
+#endif
@@ -0,0 +1,351 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <Util/include/metrics.h>
+#include <Util/include/mutex.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <mutex>
+
+namespace metrics
+{
+
+    /* The metrics of one name, by their labels. */
+    struct Family
+    {
+        /* The description of the metric. */
+        std::string strHelp;
+
+
+        /* The Prometheus type of the metric, set by the first metric of the name. */
+        std::string strType;
+
+
+        /* The counters by labels. */
+        std::map<std::string, std::unique_ptr<Counter>> mapCounters;
+
+
+        /* The gauges by labels. */
+        std::map<std::string, std::unique_ptr<Gauge>> mapGauges;
+
+
+        /* The histograms by labels. */
+        std::map<std::string, std::unique_ptr<Histogram>> mapHistograms;
+
+
+        /* The watched values by id, with their labels. */
+        std::map<uint64_t, std::pair<std::string, std::function<double()>>> mapWatches;
+    };
+
+
+    /* The registry of every metric by name. */
+    struct Registry
+    {
+        /* Mutex to protect the registry. */
+        std::mutex MUTEX;
+
+
+        /* The metrics by name. */
+        std::map<std::string, Family> mapFamilies;
+
+
+        /* The name of each watched value by id. */
+        std::map<uint64_t, std::string> mapWatched;
+
+
+        /* The id of the next watched value. */
+        uint64_t nNextWatch;
+
+
+        /* Default Constructor. */
+        Registry()
+        : MUTEX       ( )
+        , mapFamilies ( )
+        , mapWatched  ( )
+        , nNextWatch  (1)
+        {
+        }
+    };
+
+
+    /* Get the registry, created on first use so metrics can be registered from static objects. */
+    static Registry& registry()
+    {
+        static Registry REGISTRY;
+
+        return REGISTRY;
+    }
+
+
+    /* Get the family of a name, setting its help and type if it is new. Must be called holding the registry lock. */
+    static Family& family(Registry& reg, const std::string& strName, const std::string& strHelp, const std::string& strType)
+    {
+        Family& fam = reg.mapFamilies[strName];
+        if(fam.strType.empty())
+        {
+            fam.strHelp = strHelp;
+            fam.strType = strType;
+        }
+
+        return fam;
+    }
+
+
+    /* Get the name and labels of a sample. */
+    static std::string sample(const std::string& strName, const std::string& strLabels)
+    {
+        if(strLabels.empty())
+            return strName;
+
+        return strName + "{" + strLabels + "}";
+    }
+
+
+    /* Format a watched value, without a fraction if it is whole. */
+    static std::string value(const double dValue)
+    {
+        char chBuffer[64];
+        if(std::floor(dValue) == dValue && std::fabs(dValue) < 1e15)
+            std::snprintf(chBuffer, sizeof(chBuffer), "%lld", static_cast<long long>(dValue));
+        else
+            std::snprintf(chBuffer, sizeof(chBuffer), "%.17g", dValue);
+
+        return std::string(chBuffer);
+    }
+
+
+    /* Default Constructor */
+    Counter::Counter()
+    : nValue (0)
+    {
+    }
+
+
+    /* Get the current count. */
+    uint64_t Counter::Get() const
+    {
+        return nValue.load(std::memory_order_relaxed);
+    }
+
+
+    /* Default Constructor */
+    Gauge::Gauge()
+    : nValue (0)
+    {
+    }
+
+
+    /* Get the current value. */
+    int64_t Gauge::Get() const
+    {
+        return nValue.load(std::memory_order_relaxed);
+    }
+
+
+    /* Bounds Constructor */
+    Histogram::Histogram(const std::vector<uint64_t>& vBoundsIn)
+    : vBounds (vBoundsIn)
+    , pCounts (new std::atomic<uint64_t>[vBoundsIn.size() + 1])
+    , nSum    (0)
+    {
+        std::sort(vBounds.begin(), vBounds.end());
+        for(uint32_t n = 0; n <= vBounds.size(); ++n)
+            pCounts[n].store(0);
+    }
+
+
+    /* Count a value in its bucket. */
+    void Histogram::Observe(const uint64_t nValue)
+    {
+        const uint32_t nBucket = static_cast<uint32_t>(std::lower_bound(vBounds.begin(), vBounds.end(), nValue) - vBounds.begin());
+
+        pCounts[nBucket].fetch_add(1, std::memory_order_relaxed);
+        nSum.fetch_add(nValue, std::memory_order_relaxed);
+    }
+
+
+    /* Get the upper bounds of the buckets. */
+    const std::vector<uint64_t>& Histogram::Bounds() const
+    {
+        return vBounds;
+    }
+
+
+    /* Read the counts of the histogram. */
+    void Histogram::Read(std::vector<uint64_t>& vCounts, uint64_t& nSumOut, uint64_t& nCountOut) const
+    {
+        /* The count is the total of the buckets, so it always matches them. */
+        nCountOut = 0;
+        vCounts.resize(vBounds.size() + 1);
+        for(uint32_t n = 0; n <= vBounds.size(); ++n)
+        {
+            vCounts[n]  = pCounts[n].load(std::memory_order_relaxed);
+            nCountOut  += vCounts[n];
+        }
+
+        nSumOut = nSum.load(std::memory_order_relaxed);
+    }
+
+
+    /* Format a label for the labels of a metric, escaping its value. */
+    std::string Label(const std::string& strName, const std::string& strValue)
+    {
+        std::string strLabel = strName + "=\"";
+        for(const char& ch : strValue)
+        {
+            if(ch == '\\' || ch == '"')
+                strLabel += '\\';
+
+            if(ch == '\n')
+                strLabel += "\\n";
+            else
+                strLabel += ch;
+        }
+
+        return strLabel + "\"";
+    }
+
+
+    /* Get a counter by name and labels, registering it the first time it is used. */
+    Counter& GetCounter(const std::string& strName, const std::string& strHelp, const std::string& strLabels)
+    {
+        Registry& reg = registry();
+        LOCK(reg.MUTEX);
+
+        std::unique_ptr<Counter>& pCounter = family(reg, strName, strHelp, "counter").mapCounters[strLabels];
+        if(!pCounter)
+            pCounter.reset(new Counter());
+
+        return *pCounter;
+    }
+
+
+    /* Get a gauge by name and labels, registering it the first time it is used. */
+    Gauge& GetGauge(const std::string& strName, const std::string& strHelp, const std::string& strLabels)
+    {
+        Registry& reg = registry();
+        LOCK(reg.MUTEX);
+
+        std::unique_ptr<Gauge>& pGauge = family(reg, strName, strHelp, "gauge").mapGauges[strLabels];
+        if(!pGauge)
+            pGauge.reset(new Gauge());
+
+        return *pGauge;
+    }
+
+
+    /* Get a histogram by name and labels, registering it the first time it is used. */
+    Histogram& GetHistogram(const std::string& strName, const std::string& strHelp,
+                            const std::vector<uint64_t>& vBounds, const std::string& strLabels)
+    {
+        Registry& reg = registry();
+        LOCK(reg.MUTEX);
+
+        std::unique_ptr<Histogram>& pHistogram = family(reg, strName, strHelp, "histogram").mapHistograms[strLabels];
+        if(!pHistogram)
+            pHistogram.reset(new Histogram(vBounds));
+
+        return *pHistogram;
+    }
+
+
+    /* Register a value that is read when the metrics are exported. */
+    uint64_t Watch(const std::string& strName, const std::string& strHelp, const bool fCounter,
+                   const std::string& strLabels, const std::function<double()>& fnValue)
+    {
+        Registry& reg = registry();
+        LOCK(reg.MUTEX);
+
+        const uint64_t nId = reg.nNextWatch++;
+        family(reg, strName, strHelp, fCounter ? "counter" : "gauge").mapWatches[nId] = std::make_pair(strLabels, fnValue);
+        reg.mapWatched[nId] = strName;
+
+        return nId;
+    }
+
+
+    /* Remove a watched value. */
+    void Unwatch(const uint64_t nId)
+    {
+        Registry& reg = registry();
+        LOCK(reg.MUTEX);
+
+        auto it = reg.mapWatched.find(nId);
+        if(it == reg.mapWatched.end())
+            return;
+
+        reg.mapFamilies[it->second].mapWatches.erase(nId);
+        reg.mapWatched.erase(it);
+    }
+
+
+    /* Get every metric in the Prometheus text format. */
+    std::string Export()
+    {
+        Registry& reg = registry();
+        LOCK(reg.MUTEX);
+
+        std::string strOut;
+        for(const auto& entry : reg.mapFamilies)
+        {
+            const std::string& strName = entry.first;
+            const Family& fam = entry.second;
+
+            /* Skip names whose watched values were all removed. */
+            if(fam.mapCounters.empty() && fam.mapGauges.empty() && fam.mapHistograms.empty() && fam.mapWatches.empty())
+                continue;
+
+            strOut += "# HELP " + strName + " " + fam.strHelp + "\n";
+            strOut += "# TYPE " + strName + " " + fam.strType + "\n";
+
+            for(const auto& counter : fam.mapCounters)
+                strOut += sample(strName, counter.first) + " " + std::to_string(counter.second->Get()) + "\n";
+
+            for(const auto& gauge : fam.mapGauges)
+                strOut += sample(strName, gauge.first) + " " + std::to_string(gauge.second->Get()) + "\n";
+
+            for(const auto& watch : fam.mapWatches)
+                strOut += sample(strName, watch.second.first) + " " + value(watch.second.second()) + "\n";
+
+            /* Histograms are exported as cumulative buckets with their sum and count. */
+            for(const auto& histogram : fam.mapHistograms)
+            {
+                const std::string& strLabels = histogram.first;
+                const std::string strPrefix  = strLabels.empty() ? "" : strLabels + ",";
+
+                std::vector<uint64_t> vCounts;
+                uint64_t nSum = 0, nCount = 0;
+                histogram.second->Read(vCounts, nSum, nCount);
+
+                const std::vector<uint64_t>& vBounds = histogram.second->Bounds();
+
+                uint64_t nCumulative = 0;
+                for(uint32_t n = 0; n < vBounds.size(); ++n)
+                {
+                    nCumulative += vCounts[n];
+                    strOut += sample(strName + "_bucket", strPrefix + Label("le", std::to_string(vBounds[n])))
+                        + " " + std::to_string(nCumulative) + "\n";
+                }
+
+                strOut += sample(strName + "_bucket", strPrefix + Label("le", "+Inf")) + " " + std::to_string(nCount) + "\n";
+                strOut += sample(strName + "_sum", strLabels)   + " " + std::to_string(nSum) + "\n";
+                strOut += sample(strName + "_count", strLabels) + " " + std::to_string(nCount) + "\n";
+            }
+        }
+
+        return strOut;
+    }
+}
@@ -0,0 +1,455 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#pragma once
+#ifndef NEXUS_UTIL_TEMPLATES_HASHINDEX_H
+#define NEXUS_UTIL_TEMPLATES_HASHINDEX_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+
+/** HashIndex
+ *
+ *  Hash table for keys that are already random, such as txids and genesis hashes.
+ *  The low 64 bits of the key pick one of the shards and the home slot within it,
+ *  so keys are never hashed again. Each shard is an open addressed table with linear
+ *  probing and its own lock, so lookups only wait on writers to the same shard.
+ *
+ *  KeyType must provide Get64(), as the base_uint types do.
+ *
+ **/
+template<typename KeyType, typename ValueType>
+class HashIndex
+{
+    /** The number of shards, a power of two. **/
+    static const uint32_t SHARDS = 64;
+
+
+    /** The slots a shard starts with, a power of two. **/
+    static const uint32_t MIN_SLOTS = 16;
+
+
+    /** Shard
+     *
+     *  An open addressed table of the keys with the same low bits.
+     *
+     **/
+    struct Shard
+    {
+        /** Mutex for the slots. **/
+        mutable std::mutex MUTEX;
+
+
+        /** Flags for the slots in use. **/
+        std::vector<uint8_t> vUsed;
+
+
+        /** The keys and values. **/
+        std::vector<std::pair<KeyType, ValueType>> vSlots;
+
+
+        /** The slots in use. **/
+        uint32_t nCount;
+
+
+        /** Default Constructor. **/
+        Shard()
+        : MUTEX  ( )
+        , vUsed  ( )
+        , vSlots ( )
+        , nCount (0)
+        {
+        }
+    };
+
+
+    /** The shards of the table. **/
+    Shard shards[SHARDS];
+
+
+    /** The total keys in the table. **/
+    std::atomic<uint32_t> nSize;
+
+
+    /** hash
+     *
+     *  Get the bits of a key used to place it.
+     *
+     **/
+    static uint64_t hash(const KeyType& key)
+    {
+        return key.Get64(0);
+    }
+
+
+    /** get_shard
+     *
+     *  Get the shard a key is kept in.
+     *
+     **/
+    Shard& get_shard(const KeyType& key)
+    {
+        return shards[hash(key) & (SHARDS - 1)];
+    }
+
+
+    /** get_shard
+     *
+     *  Get the shard a key is kept in.
+     *
+     **/
+    const Shard& get_shard(const KeyType& key) const
+    {
+        return shards[hash(key) & (SHARDS - 1)];
+    }
+
+
+    /** home
+     *
+     *  Get the slot a key is placed at when there are no collisions.
+     *
+     **/
+    static uint32_t home(const Shard& shard, const KeyType& key)
+    {
+        return static_cast<uint32_t>(hash(key) / SHARDS) & (static_cast<uint32_t>(shard.vSlots.size()) - 1);
+    }
+
+
+    /** find
+     *
+     *  Find the slot of a key, or the size of the shard if it is not found.
+     *
+     **/
+    static uint32_t find(const Shard& shard, const KeyType& key)
+    {
+        const uint32_t nSlots = static_cast<uint32_t>(shard.vSlots.size());
+        if(nSlots == 0)
+            return 0;
+
+        /* Probe from the home slot until an empty slot. */
+        for(uint32_t n = home(shard, key); shard.vUsed[n]; n = (n + 1) & (nSlots - 1))
+        {
+            if(shard.vSlots[n].first == key)
+                return n;
+        }
+
+        return nSlots;
+    }
+
+
+    /** resize
+     *
+     *  Place the keys of a shard into a new number of slots.
+     *
+     **/
+    static void resize(Shard& shard, const uint32_t nSlots)
+    {
+        std::vector<uint8_t> vUsed(nSlots, 0);
+        std::vector<std::pair<KeyType, ValueType>> vSlots(nSlots);
+
+        /* Swap in the new slots, then place the old keys. */
+        vUsed.swap(shard.vUsed);
+        vSlots.swap(shard.vSlots);
+        for(uint32_t n = 0; n < vSlots.size(); ++n)
+        {
+            if(!vUsed[n])
+                continue;
+
+            uint32_t nSlot = home(shard, vSlots[n].first);
+            while(shard.vUsed[nSlot])
+                nSlot = (nSlot + 1) & (nSlots - 1);
+
+            shard.vSlots[nSlot] = std::move(vSlots[n]);
+            shard.vUsed[nSlot]  = 1;
+        }
+    }
+
+
+    /** insert
+     *
+     *  Place a key that is not in a shard, growing it if needed.
+     *
+     *  @return The slot of the key.
+     *
+     **/
+    uint32_t insert(Shard& shard, const KeyType& key, const ValueType& value)
+    {
+        /* Keep the shard at most three quarters full. */
+        if((shard.nCount + 1) * 4 > shard.vSlots.size() * 3)
+            resize(shard, shard.vSlots.empty() ? MIN_SLOTS : static_cast<uint32_t>(shard.vSlots.size()) * 2);
+
+        /* Place in the first empty slot from home. */
+        const uint32_t nSlots = static_cast<uint32_t>(shard.vSlots.size());
+
+        uint32_t nSlot = home(shard, key);
+        while(shard.vUsed[nSlot])
+            nSlot = (nSlot + 1) & (nSlots - 1);
+
+        shard.vSlots[nSlot] = std::make_pair(key, value);
+        shard.vUsed[nSlot]  = 1;
+
+        ++shard.nCount;
+        ++nSize;
+
+        return nSlot;
+    }
+
+
+    /** erase
+     *
+     *  Remove the key in a slot of a shard.
+     *
+     **/
+    void erase(Shard& shard, uint32_t nEmpty)
+    {
+        /* Shift back the keys probed past the removed slot, so no probe ends early. */
+        const uint32_t nSlots = static_cast<uint32_t>(shard.vSlots.size());
+        for(uint32_t nNext = (nEmpty + 1) & (nSlots - 1); shard.vUsed[nNext]; nNext = (nNext + 1) & (nSlots - 1))
+        {
+            /* Keys with a home between the empty slot and their slot stay put. */
+            const uint32_t nHome = home(shard, shard.vSlots[nNext].first);
+            if(nEmpty <= nNext ? (nEmpty < nHome && nHome <= nNext) : (nEmpty < nHome || nHome <= nNext))
+                continue;
+
+            shard.vSlots[nEmpty] = std::move(shard.vSlots[nNext]);
+            nEmpty = nNext;
+        }
+
+        /* Free the value of the last slot moved. */
+        shard.vSlots[nEmpty] = std::pair<KeyType, ValueType>();
+        shard.vUsed[nEmpty]  = 0;
+
+        --shard.nCount;
+        --nSize;
+    }
+
+public:
+
+    /** Default Constructor. **/
+    HashIndex()
+    : shards ( )
+    , nSize  (0)
+    {
+    }
+
+
+    /** Has
+     *
+     *  Check if a key is in the table.
+     *
+     *  @param[in] key The key to check for.
+     *
+     *  @return True if the key is in the table.
+     *
+     **/
+    bool Has(const KeyType& key) const
+    {
+        const Shard& shard = get_shard(key);
+        std::unique_lock<std::mutex> lk(shard.MUTEX);
+
+        return find(shard, key) != shard.vSlots.size();
+    }
+
+
+    /** Get
+     *
+     *  Copy the value of a key.
+     *
+     *  @param[in] key The key to get.
+     *  @param[out] value The value of the key.
+     *
+     *  @return True if the key is in the table.
+     *
+     **/
+    bool Get(const KeyType& key, ValueType& value) const
+    {
+        const Shard& shard = get_shard(key);
+        std::unique_lock<std::mutex> lk(shard.MUTEX);
+
+        /* Check for the key. */
+        const uint32_t nSlot = find(shard, key);
+        if(nSlot == shard.vSlots.size())
+            return false;
+
+        value = shard.vSlots[nSlot].second;
+
+        return true;
+    }
+
+
+    /** Put
+     *
+     *  Add a key to the table, or replace its value.
+     *
+     *  @param[in] key The key to add.
+     *  @param[in] value The value of the key.
+     *
+     **/
+    void Put(const KeyType& key, const ValueType& value)
+    {
+        Shard& shard = get_shard(key);
+        std::unique_lock<std::mutex> lk(shard.MUTEX);
+
+        /* Replace the value of a key in the table. */
+        const uint32_t nSlot = find(shard, key);
+        if(nSlot != shard.vSlots.size())
+        {
+            shard.vSlots[nSlot].second = value;
+            return;
+        }
+
+        insert(shard, key, value);
+    }
+
+
+    /** Remove
+     *
+     *  Remove a key from the table.
+     *
+     *  @param[in] key The key to remove.
+     *
+     *  @return True if the key was in the table.
+     *
+     **/
+    bool Remove(const KeyType& key)
+    {
+        Shard& shard = get_shard(key);
+        std::unique_lock<std::mutex> lk(shard.MUTEX);
+
+        /* Check for the key. */
+        const uint32_t nSlot = find(shard, key);
+        if(nSlot == shard.vSlots.size())
+            return false;
+
+        erase(shard, nSlot);
+
+        return true;
+    }
+
+
+    /** View
+     *
+     *  Call a function with the value of a key while its shard is locked, so the function
+     *  can read other tables as one unit with it. The function must not use this table.
+     *
+     *  @param[in] key The key to view.
+     *  @param[in] fn The function to call with the value.
+     *
+     *  @return True if the key is in the table.
+     *
+     **/
+    template<typename Function>
+    bool View(const KeyType& key, const Function& fn) const
+    {
+        const Shard& shard = get_shard(key);
+        std::unique_lock<std::mutex> lk(shard.MUTEX);
+
+        /* Check for the key. */
+        const uint32_t nSlot = find(shard, key);
+        if(nSlot == shard.vSlots.size())
+            return false;
+
+        fn(shard.vSlots[nSlot].second);
+
+        return true;
+    }
+
+
+    /** Modify
+     *
+     *  Change the value of a key in place while its shard is locked, adding the key with
+     *  a default value if it is missing. The key is removed if the function returns false.
+     *  The function must not use this table.
+     *
+     *  @param[in] key The key to modify.
+     *  @param[in] fn The function to call with the value, returning false to remove the key.
+     *
+     **/
+    template<typename Function>
+    void Modify(const KeyType& key, const Function& fn)
+    {
+        Shard& shard = get_shard(key);
+        std::unique_lock<std::mutex> lk(shard.MUTEX);
+
+        /* Find the key, or add it. */
+        uint32_t nSlot = find(shard, key);
+        if(nSlot == shard.vSlots.size())
+            nSlot = insert(shard, key, ValueType());
+
+        if(!fn(shard.vSlots[nSlot].second))
+            erase(shard, nSlot);
+    }
+
+
+    /** ForEach
+     *
+     *  Call a function with each key and value, one shard locked at a time.
+     *  The function must not use the table.
+     *
+     *  @param[in] fn The function to call with the key and value.
+     *
+     **/
+    template<typename Function>
+    void ForEach(const Function& fn) const
+    {
+        for(uint32_t nShard = 0; nShard < SHARDS; ++nShard)
+        {
+            const Shard& shard = shards[nShard];
+            std::unique_lock<std::mutex> lk(shard.MUTEX);
+
+            for(uint32_t n = 0; n < shard.vSlots.size(); ++n)
+            {
+                if(shard.vUsed[n])
+                    fn(shard.vSlots[n].first, shard.vSlots[n].second);
+            }
+        }
+    }
+
+
+    /** Size
+     *
+     *  Get the total keys in the table.
+     *
+     **/
+    uint32_t Size() const
+    {
+        return nSize.load();
+    }
+
+
+    /** Clear
+     *
+     *  Remove every key from the table.
+     *
+     **/
+    void Clear()
+    {
+        for(uint32_t nShard = 0; nShard < SHARDS; ++nShard)
+        {
+            Shard& shard = shards[nShard];
+            std::unique_lock<std::mutex> lk(shard.MUTEX);
+
+            nSize -= shard.nCount;
+
+            shard.vUsed.clear();
+            shard.vSlots.clear();
+            shard.nCount = 0;
+        }
+    }
+};
+
+#endif
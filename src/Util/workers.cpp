@@ -0,0 +1,248 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <Util/include/workers.h>
+#include <Util/include/debug.h>
+#include <Util/include/mutex.h>
+
+#include <algorithm>
+#include <exception>
+
+
+/* The pool and index of the worker running on this thread, if any. */
+static thread_local const WorkerPool* pCurrentPool = nullptr;
+static thread_local uint32_t nCurrentWorker = 0;
+
+
+/* Thread Constructor */
+WorkerPool::WorkerPool(const uint32_t nThreads, const uint64_t nMaxQueuedIn)
+: vQueues    ( )
+, MUTEX      ( )
+, CONDITION  ( )
+, nQueued    (0)
+, nMaxQueued (nMaxQueuedIn)
+, nNext      (0)
+, fStop      (false)
+, vThreads   ( )
+{
+    const uint32_t nWorkers = std::max(nThreads, 1u);
+    for(uint32_t n = 0; n < nWorkers; ++n)
+        vQueues.emplace_back(new Queue());
+
+    /* Start the workers once every queue exists, as they steal from each other. */
+    for(uint32_t n = 0; n < nWorkers; ++n)
+        vThreads.emplace_back(std::bind(&WorkerPool::worker, this, n));
+}
+
+
+/* Stops the pool if it wasn't stopped already. */
+WorkerPool::~WorkerPool()
+{
+    Stop();
+}
+
+
+/* Turn away new tasks from outside the pool, run the tasks still queued, then stop the workers. */
+void WorkerPool::Stop()
+{
+    {
+        LOCK(MUTEX);
+        fStop = true;
+    }
+    CONDITION.notify_all();
+
+    for(auto& thread : vThreads)
+    {
+        if(thread.joinable())
+            thread.join();
+    }
+}
+
+
+/* Queue a task to be run by a worker. */
+bool WorkerPool::Submit(const std::function<void()>& fnTask)
+{
+    /* Once stopped, only the workers can add to the tasks they are finishing. */
+    if(fStop.load() && pCurrentPool != this)
+        return false;
+
+    /* Reserve a place in the queues, giving it back if they are full. */
+    if(nQueued.fetch_add(1) >= nMaxQueued && nMaxQueued > 0)
+    {
+        --nQueued;
+        return false;
+    }
+
+    /* Workers queue their own tasks, other threads spread them over the workers. */
+    const uint32_t nQueue = (pCurrentPool == this) ? nCurrentWorker : (nNext.fetch_add(1) % vQueues.size());
+    {
+        LOCK(vQueues[nQueue]->MUTEX);
+        vQueues[nQueue]->qTasks.push_back(fnTask);
+    }
+
+    /* Wake a worker, holding the lock so it can't miss the task between checking and waiting. */
+    {
+        LOCK(MUTEX);
+    }
+    CONDITION.notify_one();
+
+    return true;
+}
+
+
+/* Run a task once for each index, spread over the workers and the calling thread. */
+void WorkerPool::ForEach(const uint32_t nCount, const std::function<void(const uint32_t)>& fnTask)
+{
+    /* The next index to run, and the first exception thrown. */
+    std::atomic<uint32_t> nIndex(0);
+    std::exception_ptr pException;
+
+    /* The shares still running on the workers. */
+    std::mutex SHARES_MUTEX;
+    std::condition_variable SHARES_CONDITION;
+    uint32_t nShares = 0;
+
+    /* Run indexes until there are none left, stopping at the first exception. */
+    const auto fnShare = [&]()
+    {
+        try
+        {
+            for(uint32_t n = nIndex++; n < nCount; n = nIndex++)
+                fnTask(n);
+        }
+        catch(...)
+        {
+            nIndex = nCount;
+
+            LOCK(SHARES_MUTEX);
+            if(!pException)
+                pException = std::current_exception();
+        }
+    };
+
+    /* Hand a share to each worker, keeping one for this thread. */
+    const uint32_t nWorkers = std::min(Size(), nCount > 0 ? nCount - 1 : 0);
+    for(uint32_t n = 0; n < nWorkers; ++n)
+    {
+        {
+            LOCK(SHARES_MUTEX);
+            ++nShares;
+        }
+
+        /* The calling thread runs the indexes of shares that are turned away. */
+        const bool fSubmitted = Submit([&]()
+        {
+            fnShare();
+
+            LOCK(SHARES_MUTEX);
+            if(--nShares == 0)
+                SHARES_CONDITION.notify_all();
+        });
+
+        if(!fSubmitted)
+        {
+            LOCK(SHARES_MUTEX);
+            --nShares;
+
+            break;
+        }
+    }
+
+    /* Run a share on this thread, then wait for the workers' shares. */
+    fnShare();
+    {
+        LOCK(SHARES_MUTEX);
+        SHARES_CONDITION.wait(lk, [&nShares]{ return nShares == 0; });
+    }
+
+    /* Rethrow the first exception on the calling thread. */
+    if(pException)
+        std::rethrow_exception(pException);
+}
+
+
+/* Get the number of tasks waiting for a worker. */
+uint64_t WorkerPool::Queued() const
+{
+    return nQueued.load();
+}
+
+
+/* Get the number of worker threads. */
+uint32_t WorkerPool::Size() const
+{
+    return static_cast<uint32_t>(vThreads.size());
+}
+
+
+/* The thread of a worker. */
+void WorkerPool::worker(const uint32_t nWorker)
+{
+    pCurrentPool   = this;
+    nCurrentWorker = nWorker;
+
+    while(true)
+    {
+        /* Run tasks while there are any to take. */
+        std::function<void()> fnTask;
+        if(take(nWorker, fnTask))
+        {
+            try { fnTask(); }
+            catch(const std::exception& e)
+            {
+                debug::error(FUNCTION, "worker task failed: ", e.what());
+            }
+
+            continue;
+        }
+
+        /* Wait for a task, or stop once none are left. */
+        std::unique_lock<std::mutex> CONDITION_LOCK(MUTEX);
+        if(fStop.load() && nQueued.load() == 0)
+            return;
+
+        CONDITION.wait(CONDITION_LOCK, [this]{ return fStop.load() || nQueued.load() > 0; });
+    }
+}
+
+
+/* Take the oldest task of a worker's queue, or the newest task of another worker's. */
+bool WorkerPool::take(const uint32_t nWorker, std::function<void()>& fnTask)
+{
+    const uint32_t nQueues = static_cast<uint32_t>(vQueues.size());
+    for(uint32_t n = 0; n < nQueues; ++n)
+    {
+        Queue& queue = *vQueues[(nWorker + n) % nQueues];
+
+        LOCK(queue.MUTEX);
+        if(queue.qTasks.empty())
+            continue;
+
+        /* Take our own oldest task, or steal from the other end so the owner keeps its order. */
+        if(n == 0)
+        {
+            fnTask = std::move(queue.qTasks.front());
+            queue.qTasks.pop_front();
+        }
+        else
+        {
+            fnTask = std::move(queue.qTasks.back());
+            queue.qTasks.pop_back();
+        }
+
+        --nQueued;
+        return true;
+    }
+
+    return false;
+}
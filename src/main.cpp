@@ -28,6 +28,7 @@ ________________________________________________________________________________
 #include <TAO/Ledger/include/create.h>
 #include <TAO/Ledger/include/chainstate.h>
 #include <TAO/Ledger/include/dispatch.h>
+#include <TAO/Ledger/include/signatures.h>
 #include <TAO/Ledger/types/stake_minter.h>
 #include <TAO/Ledger/include/timelocks.h>
 
@@ -146,6 +147,10 @@ int main(int argc, char** argv)
         LLD::Initialize();
 
 
+        /* Initialize the signature verification threads. */
+        TAO::Ledger::InitializeSignatures();
+
+
         /* Initialize ChainState. */
         TAO::Ledger::ChainState::Initialize();
 
@@ -314,6 +319,9 @@ int main(int argc, char** argv)
     /* Shutdown the API. */
     TAO::API::Shutdown();
 
+    /* Shutdown the signature verification threads. */
+    TAO::Ledger::ShutdownSignatures();
+
     /* Shutdown database instances. */
     LLD::Shutdown();
 
@@ -0,0 +1,133 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLC/hash/SK.h>
+#include <LLC/include/random.h>
+
+#include <TAO/Ledger/types/transaction.h>
+
+#include <Util/include/debug.h>
+#include <Util/include/runtime.h>
+#include <Util/templates/datastream.h>
+
+#include <unit/catch2/catch.hpp>
+
+
+TEST_CASE( "SK Hash Benchmarks", "[LLC]")
+{
+    debug::log(0, "===== Begin SK Hash Benchmarks =====");
+
+    /* A transaction with a contract the size of a transfer. */
+    TAO::Ledger::Transaction tx;
+    tx.hashGenesis = LLC::GetRand256();
+    tx.hashPrevTx  = LLC::GetRand512();
+    tx.hashNext    = LLC::GetRand256();
+    tx[0] << uint8_t(1) << LLC::GetRand256() << LLC::GetRand256() << uint64_t(1000) << uint64_t(0);
+
+    DataStream ssTx(SER_GETHASH, tx.nVersion);
+    ssTx << tx;
+
+    const uint32_t nHashes = 100000;
+
+    /* All runs are on one thread, so the rates are per core. */
+    {
+        runtime::timer timer;
+        timer.Start();
+
+        uint512_t hash = 0;
+        for(uint32_t n = 0; n < nHashes; ++n)
+            hash ^= LLC::SK512(ssTx.begin(), ssTx.end());
+
+        const uint64_t nTime = timer.ElapsedMicroseconds();
+        debug::log(0, ANSI_COLOR_BRIGHT_CYAN, "SK512::", ANSI_COLOR_RESET, nHashes * 1000.0 / nTime, " thousand hashes / second of ",
+            ssTx.size(), " bytes ", hash.SubString());
+    }
+
+    {
+        runtime::timer timer;
+        timer.Start();
+
+        uint1024_t hash = 0;
+        for(uint32_t n = 0; n < nHashes; ++n)
+            hash ^= LLC::SK1024(ssTx.begin(), ssTx.end());
+
+        const uint64_t nTime = timer.ElapsedMicroseconds();
+        debug::log(0, ANSI_COLOR_BRIGHT_CYAN, "SK1024::", ANSI_COLOR_RESET, nHashes * 1000.0 / nTime, " thousand hashes / second of ",
+            ssTx.size(), " bytes ", hash.SubString());
+    }
+
+    {
+        runtime::timer timer;
+        timer.Start();
+
+        /* Hash as the transaction hash was taken before, serializing into a buffer first. */
+        uint512_t hash = 0;
+        for(uint32_t n = 0; n < nHashes; ++n)
+        {
+            DataStream ss(SER_GETHASH, tx.nVersion);
+            ss << tx;
+
+            hash ^= LLC::SK512(ss.begin(), ss.end());
+        }
+
+        const uint64_t nTime = timer.ElapsedMicroseconds();
+        debug::log(0, ANSI_COLOR_BRIGHT_CYAN, "DataStream + SK512::", ANSI_COLOR_RESET, nHashes * 1000.0 / nTime, " thousand tx / second ", hash.SubString());
+    }
+
+    {
+        runtime::timer timer;
+        timer.Start();
+
+        uint512_t hash = 0;
+        for(uint32_t n = 0; n < nHashes; ++n)
+        {
+            LLC::SK512Stream ss(SER_GETHASH, tx.nVersion);
+            ss << tx;
+
+            hash ^= ss.GetHash();
+        }
+
+        const uint64_t nTime = timer.ElapsedMicroseconds();
+        debug::log(0, ANSI_COLOR_BRIGHT_CYAN, "SK512Stream::", ANSI_COLOR_RESET, nHashes * 1000.0 / nTime, " thousand tx / second ", hash.SubString());
+    }
+
+    {
+        runtime::timer timer;
+        timer.Start();
+
+        /* Change the sequence each time so the hash is taken again. */
+        uint512_t hash = 0;
+        for(uint32_t n = 0; n < nHashes; ++n)
+        {
+            tx.nSequence = n;
+            hash ^= tx.GetHash();
+        }
+
+        const uint64_t nTime = timer.ElapsedMicroseconds();
+        debug::log(0, ANSI_COLOR_BRIGHT_CYAN, "GetHash::", ANSI_COLOR_RESET, nHashes * 1000.0 / nTime, " thousand tx / second ", hash.SubString());
+    }
+
+    {
+        runtime::timer timer;
+        timer.Start();
+
+        uint512_t hash = 0;
+        for(uint32_t n = 0; n < nHashes * 10; ++n)
+            hash ^= tx.GetHash();
+
+        const uint64_t nTime = timer.ElapsedMicroseconds();
+        debug::log(0, ANSI_COLOR_BRIGHT_CYAN, "GetHash(cached)::", ANSI_COLOR_RESET, nHashes * 10.0 / nTime, " million tx / second ", hash.SubString());
+    }
+
+    debug::log(0, "===== End SK Hash Benchmarks =====\n");
+}
@@ -0,0 +1,76 @@
+#include <Util/include/runtime.h>
+
+#include <LLC/include/random.h>
+
+#include <LLD/include/enum.h>
+#include <LLD/templates/sector.h>
+#include <LLD/keychain/hashmap.h>
+#include <LLD/cache/binary_2q.h>
+
+#include <unit/catch2/catch.hpp>
+
+
+TEST_CASE( "Batch Read Benchmarks", "[LLD]")
+{
+    debug::log(0, "===== Begin Batch Read Benchmarks =====");
+
+    LLD::SectorDatabase<LLD::BinaryHashMap, LLD::Binary2Q>* db =
+        new LLD::SectorDatabase<LLD::BinaryHashMap, LLD::Binary2Q>("_BENCH_BATCH", LLD::FLAGS::CREATE | LLD::FLAGS::FORCE, 77773, 1024);
+
+    /* Write blocks with transaction index records between them, the way the ledger is laid out. */
+    const uint32_t nBlocks = 20000;
+    const uint32_t nTxPerBlock = 8;
+    uint256_t hashBlock = LLC::GetRand256();
+    uint256_t hashTx    = LLC::GetRand256();
+    {
+        runtime::timer timer;
+        timer.Start();
+
+        for(uint32_t i = 0; i < nBlocks; ++i)
+        {
+            std::vector<uint8_t> vBlock(512, static_cast<uint8_t>(i));
+            vBlock[0] = static_cast<uint8_t>(i);
+            vBlock[1] = static_cast<uint8_t>(i >> 8);
+            vBlock[2] = static_cast<uint8_t>(i >> 16);
+            db->Write(hashBlock + i, vBlock, "block");
+
+            for(uint32_t n = 0; n < nTxPerBlock; ++n)
+                db->Write(hashTx + (i * nTxPerBlock + n), uint1024_t(i), "tx");
+        }
+
+        uint64_t nTime = timer.ElapsedMilliseconds();
+        debug::log(0, ANSI_COLOR_BRIGHT_CYAN, "Put::", ANSI_COLOR_RESET, nBlocks * (nTxPerBlock + 1), " records in ", nTime, "ms");
+    }
+
+
+    /* Serve the blocks in batches the way ACTION::LIST does for syncing peers. */
+    for(uint32_t nPass = 0; nPass < 2; ++nPass)
+    {
+        runtime::timer timer;
+        timer.Start();
+
+        uint32_t nRead = 0;
+        std::vector< std::vector<uint8_t> > vBlocks;
+        db->BatchRead("block", vBlocks, 3000);
+        while(!vBlocks.empty())
+        {
+            nRead += vBlocks.size();
+
+            /* Continue from the last block read. */
+            const std::vector<uint8_t>& vLast = vBlocks.back();
+            const uint32_t nLast = vLast[0] | (vLast[1] << 8) | (vLast[2] << 16);
+            if(!db->BatchRead(hashBlock + nLast, "block", vBlocks, 3000, true))
+                break;
+        }
+
+        uint64_t nTime = timer.ElapsedMicroseconds();
+        debug::log(0, ANSI_COLOR_BRIGHT_CYAN, "BatchRead::", ANSI_COLOR_RESET, nPass == 0 ? "cold " : "warm ", nRead, " blocks in ",
+            nTime / 1000, "ms (", (uint64_t(nRead) * 1000000) / (nTime + 1), ") blocks/s");
+
+        REQUIRE(nRead == nBlocks);
+    }
+
+    delete db;
+
+    debug::log(0, "===== End Batch Read Benchmarks =====\n");
+}
@@ -0,0 +1,129 @@
+#include <Util/include/runtime.h>
+
+#include <LLC/include/random.h>
+
+#include <LLD/cache/binary_lru.h>
+#include <LLD/cache/binary_2q.h>
+#include <LLD/templates/key.h>
+
+#include <LLD/include/enum.h>
+#include <LLD/include/version.h>
+
+#include <Util/templates/datastream.h>
+
+#include <unit/catch2/catch.hpp>
+
+#include <thread>
+
+
+/* Get the binary key of a benchmark record. */
+std::vector<uint8_t> CacheKey(const uint256_t& hash)
+{
+    DataStream ssKey(SER_LLD, LLD::DATABASE_VERSION);
+    ssKey << std::make_pair(std::string("data"), hash);
+
+    return ssKey.Bytes();
+}
+
+
+/* Read a record the way the sector database does, adding it to the cache on a miss. */
+template<typename CacheType>
+bool CacheRead(CacheType* cache, const std::vector<uint8_t>& vKey, const std::vector<uint8_t>& vData, const uint32_t nStart)
+{
+    std::vector<uint8_t> vBytes;
+    if(cache->Get(vKey, vBytes))
+        return true;
+
+    LLD::SectorKey cKey(LLD::STATE::READY, vKey, 0, nStart, vData.size());
+    cache->Put(cKey, vKey, vData);
+
+    return false;
+}
+
+
+/* Log the concurrent lookup rate and scan resistance of a cache. */
+template<typename CacheType>
+void CacheBenchmark(const std::string& strName, const uint256_t& hash, const std::vector<uint8_t>& vData)
+{
+    /* Look up cached records with an increasing number of threads. */
+    {
+        const uint32_t nRecords = 100000;
+
+        std::vector< std::vector<uint8_t> > vKeys;
+        for(uint32_t i = 0; i < nRecords; ++i)
+            vKeys.push_back(CacheKey(hash + i));
+
+        CacheType* cache = new CacheType(1024 * 1024 * 256);
+        for(uint32_t i = 0; i < nRecords; ++i)
+            CacheRead(cache, vKeys[i], vData, i);
+
+        for(uint32_t nThreads = 1; nThreads <= 16; nThreads *= 2)
+        {
+            const uint32_t nReads = 1000000;
+
+            runtime::timer timer;
+            timer.Start();
+
+            std::vector<std::thread> vThreads;
+            for(uint32_t n = 0; n < nThreads; ++n)
+            {
+                vThreads.push_back(std::thread([&, n]()
+                {
+                    std::vector<uint8_t> vBytes;
+                    for(uint32_t i = 0; i < nReads / nThreads; ++i)
+                        cache->Get(vKeys[(i * 7919 + n) % nRecords], vBytes);
+                }));
+            }
+
+            for(auto& thread : vThreads)
+                thread.join();
+
+            uint64_t nTime = timer.ElapsedMicroseconds();
+            debug::log(0, ANSI_COLOR_BRIGHT_CYAN, strName, " Get::", ANSI_COLOR_RESET, nThreads, " threads ", double(nReads) / nTime, " million records / second");
+        }
+
+        delete cache;
+    }
+
+
+    /* Read a working set between scans of records that are only read once. */
+    {
+        const uint32_t nWorking = 8000;
+        const uint32_t nScan    = 16000;
+        const uint32_t nRounds  = 10;
+
+        CacheType* cache = new CacheType(1024 * 1024 * 4);
+
+        uint32_t nHits = 0;
+        uint32_t nScanned = 0;
+        for(uint32_t nRound = 0; nRound < nRounds; ++nRound)
+        {
+            for(uint32_t i = 0; i < nWorking; ++i)
+                if(CacheRead(cache, CacheKey(hash + i), vData, i) && nRound >= 2)
+                    ++nHits;
+
+            for(uint32_t i = 0; i < nScan; ++i, ++nScanned)
+                CacheRead(cache, CacheKey(hash + nWorking + nScanned), vData, nWorking + nScanned);
+        }
+
+        delete cache;
+
+        debug::log(0, ANSI_COLOR_BRIGHT_CYAN, strName, " Scan::", ANSI_COLOR_RESET, (nHits * 100.0) / (nWorking * (nRounds - 2)),
+            " % working set hits with ", nScan, " records scanned between reads");
+    }
+}
+
+
+TEST_CASE( "Binary 2Q Benchmarks", "[LLD]")
+{
+    debug::log(0, "===== Begin Binary 2Q Benchmarks =====");
+
+    DataStream ssData(SER_LLD, LLD::DATABASE_VERSION);
+    ssData << uint1024_t(4934943);
+
+    uint256_t hash = LLC::GetRand256();
+    CacheBenchmark<LLD::BinaryLRU>("BinaryLRU", hash, ssData.Bytes());
+    CacheBenchmark<LLD::Binary2Q> ("Binary2Q",  hash, ssData.Bytes());
+
+    debug::log(0, "===== End Binary 2Q Benchmarks =====\n");
+}
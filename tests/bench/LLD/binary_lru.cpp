@@ -3,7 +3,9 @@
 #include <LLC/include/random.h>
 
 #include <LLD/cache/binary_lru.h>
+#include <LLD/templates/key.h>
 
+#include <LLD/include/enum.h>
 #include <LLD/include/version.h>
 
 #include <Util/templates/datastream.h>
@@ -16,7 +18,7 @@ TEST_CASE( "Binary LRU Benchmarks", "[LLD]")
     debug::log(0, "===== Begin Binary LRU Benchmarks =====");
 
     //benchmarks
-    LLD::BinaryLRU* cache = new LLD::BinaryLRU();
+    LLD::BinaryLRU* cache = new LLD::BinaryLRU(1024 * 1024 * 256);
     uint256_t hash = LLC::GetRand256();
     {
         runtime::timer timer;
@@ -30,7 +32,8 @@ TEST_CASE( "Binary LRU Benchmarks", "[LLD]")
             DataStream ssData(SER_LLD, LLD::DATABASE_VERSION);
             ssData << uint1024_t(4934943);
 
-            cache->Put(ssKey.Bytes(), ssData.Bytes());
+            LLD::SectorKey cKey(LLD::STATE::READY, ssKey.Bytes(), 0, i, ssData.size());
+            cache->Put(cKey, ssKey.Bytes(), ssData.Bytes());
         }
 
         uint64_t nTime = timer.ElapsedMicroseconds();
@@ -57,5 +60,7 @@ TEST_CASE( "Binary LRU Benchmarks", "[LLD]")
     }
 
 
+    delete cache;
+
     debug::log(0, "===== End Binary LRU Benchmarks =====\n");
 }
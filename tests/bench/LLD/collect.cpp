@@ -0,0 +1,95 @@
+#include <Util/include/runtime.h>
+#include <Util/include/filesystem.h>
+#include <Util/include/args.h>
+
+#include <LLC/include/random.h>
+
+#include <LLD/include/enum.h>
+#include <LLD/templates/sector.h>
+#include <LLD/keychain/hashmap.h>
+#include <LLD/cache/binary_2q.h>
+
+#include <unit/catch2/catch.hpp>
+
+#include <fstream>
+
+
+TEST_CASE( "Sector Garbage Collection Benchmarks", "[LLD]")
+{
+    debug::log(0, "===== Begin Sector Garbage Collection Benchmarks =====");
+
+    typedef LLD::SectorDatabase<LLD::BinaryHashMap, LLD::Binary2Q> CollectDB;
+
+    const std::string strPath = config::GetDataDir() + "_BENCH_COLLECT/datachain/";
+    filesystem::remove_directories(config::GetDataDir() + "_BENCH_COLLECT/");
+
+    /* Write the records, then erase three in four of them. */
+    const uint32_t nRecords = 40000;
+    uint256_t hash = LLC::GetRand256();
+    {
+        CollectDB* db = new CollectDB("_BENCH_COLLECT", LLD::FLAGS::CREATE | LLD::FLAGS::FORCE, 77773, 1024);
+        for(uint32_t i = 0; i < nRecords; ++i)
+            REQUIRE(db->Write(std::make_pair(std::string("data"), hash + i), std::vector<uint8_t>(256, static_cast<uint8_t>(i)), "data"));
+
+        for(uint32_t i = 0; i < nRecords; ++i)
+        {
+            if(i % 4 != 0)
+                REQUIRE(db->Erase(std::make_pair(std::string("data"), hash + i)));
+        }
+
+        delete db;
+    }
+
+    /* Start a new sector file, the file still being written is never collected. */
+    std::ofstream(strPath + "_block.00001", std::ios::out | std::ios::binary | std::ios::trunc).close();
+
+    std::ifstream file(strPath + "_block.00000", std::ios::in | std::ios::binary | std::ios::ate);
+    const uint64_t nBefore = static_cast<uint64_t>(file.tellg());
+    file.close();
+
+    REQUIRE(nBefore > 0);
+
+    /* Copy the live records out of the first file, then truncate it on the next pass. */
+    {
+        CollectDB* db = new CollectDB("_BENCH_COLLECT", LLD::FLAGS::CREATE | LLD::FLAGS::FORCE | LLD::FLAGS::COLLECT, 77773, 1024);
+
+        runtime::timer timer;
+        timer.Start();
+
+        REQUIRE(db->Collect(uint64_t(1024) * 1024 * 1024));
+
+        uint64_t nTime = timer.ElapsedMilliseconds();
+        debug::log(0, ANSI_COLOR_BRIGHT_CYAN, "Collect::", ANSI_COLOR_RESET, nRecords / 4, " live records of ", nBefore, " bytes in ", nTime, "ms");
+
+        REQUIRE(db->Collect(uint64_t(1024) * 1024 * 1024));
+
+        delete db;
+    }
+
+    file.open(strPath + "_block.00000", std::ios::in | std::ios::binary | std::ios::ate);
+    REQUIRE(file.tellg() == 0);
+    file.close();
+
+    /* Every live record reads back from its copy, from disk rather than the cache. */
+    {
+        CollectDB* db = new CollectDB("_BENCH_COLLECT", LLD::FLAGS::CREATE | LLD::FLAGS::FORCE, 77773, 1024);
+        for(uint32_t i = 0; i < nRecords; ++i)
+        {
+            std::vector<uint8_t> vData;
+            if(i % 4 != 0)
+            {
+                REQUIRE_FALSE(db->Read(std::make_pair(std::string("data"), hash + i), vData));
+                continue;
+            }
+
+            REQUIRE(db->Read(std::make_pair(std::string("data"), hash + i), vData));
+            REQUIRE(vData == std::vector<uint8_t>(256, static_cast<uint8_t>(i)));
+        }
+
+        delete db;
+    }
+
+    filesystem::remove_directories(config::GetDataDir() + "_BENCH_COLLECT/");
+
+    debug::log(0, "===== End Sector Garbage Collection Benchmarks =====\n");
+}
@@ -0,0 +1,98 @@
+#include <Util/include/runtime.h>
+#include <Util/include/filesystem.h>
+#include <Util/include/args.h>
+
+#include <LLC/include/random.h>
+
+#include <LLD/include/enum.h>
+#include <LLD/templates/sector.h>
+#include <LLD/keychain/hashmap.h>
+#include <LLD/cache/binary_2q.h>
+
+#include <unit/catch2/catch.hpp>
+
+#include <fstream>
+
+
+TEST_CASE( "Sector Compression Benchmarks", "[LLD]")
+{
+    debug::log(0, "===== Begin Sector Compression Benchmarks =====");
+
+    typedef LLD::SectorDatabase<LLD::BinaryHashMap, LLD::Binary2Q> CompressDB;
+
+    const std::string strPath = config::GetDataDir() + "_BENCH_COMPRESS/datachain/";
+    filesystem::remove_directories(config::GetDataDir() + "_BENCH_COMPRESS/");
+
+    /* Records large enough to compress, filled with a repeating pattern. */
+    const uint32_t nRecords = 10000;
+    std::vector<uint8_t> vRecord(1024);
+    for(uint32_t i = 0; i < vRecord.size(); ++i)
+        vRecord[i] = static_cast<uint8_t>(i % 16);
+
+    uint256_t hash = LLC::GetRand256();
+
+    /* Write an old record before compression was turned on. */
+    {
+        CompressDB* db = new CompressDB("_BENCH_COMPRESS", LLD::FLAGS::CREATE | LLD::FLAGS::FORCE, 77773, 1024);
+        REQUIRE(db->Write(std::make_pair(std::string("old"), hash), vRecord, "data"));
+
+        delete db;
+    }
+
+    std::ifstream file(strPath + "_block.00000", std::ios::in | std::ios::binary | std::ios::ate);
+    const uint64_t nOld = static_cast<uint64_t>(file.tellg());
+    file.close();
+
+    REQUIRE(nOld > vRecord.size());
+
+    /* Write the rest with compression on. */
+    {
+        CompressDB* db = new CompressDB("_BENCH_COMPRESS", LLD::FLAGS::CREATE | LLD::FLAGS::FORCE | LLD::FLAGS::COMPRESS, 77773, 1024);
+
+        runtime::timer timer;
+        timer.Start();
+
+        for(uint32_t i = 0; i < nRecords; ++i)
+            REQUIRE(db->Write(std::make_pair(std::string("new"), hash + i), vRecord, "data"));
+
+        uint64_t nTime = timer.ElapsedMilliseconds();
+        debug::log(0, ANSI_COLOR_BRIGHT_CYAN, "Compress::", ANSI_COLOR_RESET, nRecords, " records of ", vRecord.size(), " bytes in ", nTime, "ms");
+
+        delete db;
+    }
+
+    file.open(strPath + "_block.00000", std::ios::in | std::ios::binary | std::ios::ate);
+    const uint64_t nNew = static_cast<uint64_t>(file.tellg()) - nOld;
+    file.close();
+
+    debug::log(0, ANSI_COLOR_BRIGHT_CYAN, "Compress::", ANSI_COLOR_RESET, nRecords * vRecord.size(), " bytes stored in ", nNew, " bytes");
+    REQUIRE(nNew < nRecords * vRecord.size());
+
+    /* Both the old and the compressed records read back, from disk rather than the cache. */
+    {
+        CompressDB* db = new CompressDB("_BENCH_COMPRESS", LLD::FLAGS::CREATE | LLD::FLAGS::FORCE | LLD::FLAGS::COMPRESS, 77773, 1024);
+
+        std::vector<uint8_t> vData;
+        REQUIRE(db->Read(std::make_pair(std::string("old"), hash), vData));
+        REQUIRE(vData == vRecord);
+
+        runtime::timer timer;
+        timer.Start();
+
+        for(uint32_t i = 0; i < nRecords; ++i)
+        {
+            vData.clear();
+            REQUIRE(db->Read(std::make_pair(std::string("new"), hash + i), vData));
+            REQUIRE(vData == vRecord);
+        }
+
+        uint64_t nTime = timer.ElapsedMilliseconds();
+        debug::log(0, ANSI_COLOR_BRIGHT_CYAN, "Decompress::", ANSI_COLOR_RESET, nRecords, " records in ", nTime, "ms");
+
+        delete db;
+    }
+
+    filesystem::remove_directories(config::GetDataDir() + "_BENCH_COMPRESS/");
+
+    debug::log(0, "===== End Sector Compression Benchmarks =====\n");
+}
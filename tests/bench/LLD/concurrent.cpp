@@ -0,0 +1,66 @@
+#include <Util/include/runtime.h>
+
+#include <LLC/include/random.h>
+
+#include <LLD/templates/sector.h>
+#include <LLD/keychain/hashmap.h>
+#include <LLD/cache/binary_lru.h>
+
+#include <unit/catch2/catch.hpp>
+
+#include <thread>
+
+
+TEST_CASE( "Concurrent Read Benchmarks", "[LLD]")
+{
+    debug::log(0, "===== Begin Concurrent Read Benchmarks =====");
+
+    /* Use a tiny cache so that reads hit the keychain and sector files. */
+    LLD::SectorDatabase<LLD::BinaryHashMap, LLD::BinaryLRU>* db =
+        new LLD::SectorDatabase<LLD::BinaryHashMap, LLD::BinaryLRU>("_BENCH_CONCURRENT", LLD::FLAGS::CREATE | LLD::FLAGS::FORCE, 77773, 1024);
+
+    //benchmarks
+    const uint32_t nRecords = 100000;
+    uint256_t hash = LLC::GetRand256();
+    {
+        runtime::timer timer;
+        timer.Start();
+
+        for(uint32_t i = 0; i < nRecords; i++)
+            db->Write(hash + i, uint1024_t(i));
+
+        uint64_t nTime = timer.ElapsedMilliseconds();
+        debug::log(0, ANSI_COLOR_BRIGHT_CYAN, "Put::", ANSI_COLOR_RESET, nRecords, " records in ", nTime, "ms (", (nRecords * 1000) / (nTime + 1), ") per/s");
+    }
+
+
+    /* Read random records with an increasing number of threads. */
+    for(uint32_t nThreads = 1; nThreads <= 16; nThreads *= 2)
+    {
+        runtime::timer timer;
+        timer.Start();
+
+        std::vector<std::thread> vThreads;
+        for(uint32_t n = 0; n < nThreads; ++n)
+        {
+            vThreads.push_back(std::thread([&, n]()
+            {
+                for(uint32_t i = 0; i < nRecords / nThreads; ++i)
+                {
+                    uint1024_t nValue;
+                    db->Read(hash + ((i * 7919 + n) % nRecords), nValue);
+                }
+            }));
+        }
+
+        for(auto& thread : vThreads)
+            thread.join();
+
+        uint64_t nTime = timer.ElapsedMilliseconds();
+        debug::log(0, ANSI_COLOR_BRIGHT_CYAN, "Get::", ANSI_COLOR_RESET, nThreads, " threads ", nRecords, " records in ", nTime, "ms (", (nRecords * 1000) / (nTime + 1), ") per/s");
+    }
+
+    delete db;
+
+    debug::log(0, "===== End Concurrent Read Benchmarks =====\n");
+}
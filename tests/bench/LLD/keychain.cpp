@@ -0,0 +1,104 @@
+#include <Util/include/runtime.h>
+#include <Util/include/filesystem.h>
+#include <Util/include/args.h>
+
+#include <LLC/include/random.h>
+
+#include <LLD/keychain/hashmap.h>
+#include <LLD/keychain/shard_hashmap.h>
+#include <LLD/include/version.h>
+
+#include <Util/templates/datastream.h>
+
+#include <unit/catch2/catch.hpp>
+
+
+/* Write and look up keys in a keychain, logging the average latency of each operation. */
+void KeychainBenchmark(const std::string& strName, LLD::Keychain* pKeychain, const uint256_t& hash, const uint32_t nRecords)
+{
+    {
+        runtime::timer timer;
+        timer.Start();
+
+        for(uint32_t i = 0; i < nRecords; ++i)
+        {
+            DataStream ssKey(SER_LLD, LLD::DATABASE_VERSION);
+            ssKey << std::make_pair(std::string("data"), hash + i);
+
+            LLD::SectorKey cKey(LLD::STATE::READY, ssKey.Bytes(), 0, i, 144);
+            pKeychain->Put(cKey);
+        }
+
+        uint64_t nTime = timer.ElapsedMicroseconds();
+        debug::log(0, ANSI_COLOR_BRIGHT_CYAN, strName, " Put::", ANSI_COLOR_RESET, double(nTime) / nRecords, " us per key");
+    }
+
+
+    {
+        runtime::timer timer;
+        timer.Start();
+
+        for(uint32_t i = 0; i < nRecords; ++i)
+        {
+            DataStream ssKey(SER_LLD, LLD::DATABASE_VERSION);
+            ssKey << std::make_pair(std::string("data"), hash + i);
+
+            LLD::SectorKey cKey;
+            REQUIRE(pKeychain->Get(ssKey.Bytes(), cKey));
+        }
+
+        uint64_t nTime = timer.ElapsedMicroseconds();
+        debug::log(0, ANSI_COLOR_BRIGHT_CYAN, strName, " Get Hit::", ANSI_COLOR_RESET, double(nTime) / nRecords, " us per key");
+    }
+
+
+    {
+        runtime::timer timer;
+        timer.Start();
+
+        for(uint32_t i = 0; i < nRecords; ++i)
+        {
+            DataStream ssKey(SER_LLD, LLD::DATABASE_VERSION);
+            ssKey << std::make_pair(std::string("miss"), hash + i);
+
+            LLD::SectorKey cKey;
+            REQUIRE(!pKeychain->Get(ssKey.Bytes(), cKey));
+        }
+
+        uint64_t nTime = timer.ElapsedMicroseconds();
+        debug::log(0, ANSI_COLOR_BRIGHT_CYAN, strName, " Get Miss::", ANSI_COLOR_RESET, double(nTime) / nRecords, " us per key");
+    }
+}
+
+
+TEST_CASE( "Keychain Lookup Benchmarks", "[LLD]")
+{
+    debug::log(0, "===== Begin Keychain Lookup Benchmarks =====");
+
+    /* Use few buckets for the records so that keys collide into several hashmap files. */
+    const uint32_t nRecords = 200000;
+    const uint32_t nBuckets = 65536;
+
+    uint256_t hash = LLC::GetRand256();
+
+    std::string strPath = config::GetDataDir() + "_BENCH_KEYCHAIN/";
+    filesystem::remove_directories(strPath);
+
+    {
+        LLD::BinaryHashMap* pKeychain = new LLD::BinaryHashMap(strPath + "hashmap/", LLD::FLAGS::APPEND, nBuckets);
+        KeychainBenchmark("BinaryHashMap", pKeychain, hash, nRecords);
+
+        delete pKeychain;
+    }
+
+    {
+        LLD::ShardHashMap* pKeychain = new LLD::ShardHashMap(strPath + "shard/", LLD::FLAGS::APPEND, nBuckets, 16);
+        KeychainBenchmark("ShardHashMap", pKeychain, hash, nRecords);
+
+        delete pKeychain;
+    }
+
+    filesystem::remove_directories(strPath);
+
+    debug::log(0, "===== End Keychain Lookup Benchmarks =====\n");
+}
@@ -0,0 +1,101 @@
+#include <Util/include/runtime.h>
+
+#include <LLC/include/random.h>
+
+#include <LLD/include/enum.h>
+#include <LLD/templates/sector.h>
+#include <LLD/keychain/hashmap.h>
+#include <LLD/cache/binary_2q.h>
+
+#include <unit/catch2/catch.hpp>
+
+#include <algorithm>
+
+
+TEST_CASE( "Multi Read Benchmarks", "[LLD]")
+{
+    debug::log(0, "===== Begin Multi Read Benchmarks =====");
+
+    LLD::SectorDatabase<LLD::BinaryHashMap, LLD::Binary2Q>* db =
+        new LLD::SectorDatabase<LLD::BinaryHashMap, LLD::Binary2Q>("_BENCH_MULTIREAD", LLD::FLAGS::CREATE | LLD::FLAGS::FORCE, 77773, 1024);
+
+    /* Write transactions of about the size of a tritium transaction. */
+    const uint32_t nTotal = 100000;
+    uint256_t hashTx = LLC::GetRand256();
+    {
+        runtime::timer timer;
+        timer.Start();
+
+        for(uint32_t i = 0; i < nTotal; ++i)
+        {
+            std::vector<uint8_t> vTx(400, static_cast<uint8_t>(i));
+            db->Write(hashTx + i, vTx, "tx");
+        }
+
+        uint64_t nTime = timer.ElapsedMilliseconds();
+        debug::log(0, ANSI_COLOR_BRIGHT_CYAN, "Put::", ANSI_COLOR_RESET, nTotal, " records in ", nTime, "ms");
+    }
+
+
+    /* Read blocks of transactions written close together, in the shuffled order of a block. */
+    const uint32_t nBlocks  = 200;
+    const uint32_t nPerBlock = 500;
+    std::vector< std::vector<uint256_t> > vBlocks(nBlocks);
+    for(uint32_t i = 0; i < nBlocks; ++i)
+    {
+        const uint32_t nFirst = LLC::GetRandInt(nTotal - nPerBlock * 2);
+        for(uint32_t n = 0; n < nPerBlock * 2; n += 2)
+            vBlocks[i].push_back(hashTx + (nFirst + n));
+
+        std::random_shuffle(vBlocks[i].begin(), vBlocks[i].end());
+    }
+
+
+    /* Read the transactions one at a time. */
+    {
+        runtime::timer timer;
+        timer.Start();
+
+        uint32_t nRead = 0;
+        for(const auto& vKeys : vBlocks)
+        {
+            for(const auto& hash : vKeys)
+            {
+                std::vector<uint8_t> vTx;
+                if(db->Read(hash, vTx))
+                    ++nRead;
+            }
+        }
+
+        uint64_t nTime = timer.ElapsedMicroseconds();
+        debug::log(0, ANSI_COLOR_BRIGHT_CYAN, "Read::", ANSI_COLOR_RESET, nRead, " records in ",
+            nTime / 1000, "ms (", (uint64_t(nRead) * 1000000) / (nTime + 1), ") reads/s");
+
+        REQUIRE(nRead == nBlocks * nPerBlock);
+    }
+
+
+    /* Read the transactions of each block together. */
+    {
+        runtime::timer timer;
+        timer.Start();
+
+        uint32_t nRead = 0;
+        for(const auto& vKeys : vBlocks)
+        {
+            std::vector< std::vector<uint8_t> > vTx;
+            if(db->MultiRead(vKeys, vTx))
+                nRead += vTx.size();
+        }
+
+        uint64_t nTime = timer.ElapsedMicroseconds();
+        debug::log(0, ANSI_COLOR_BRIGHT_CYAN, "MultiRead::", ANSI_COLOR_RESET, nRead, " records in ",
+            nTime / 1000, "ms (", (uint64_t(nRead) * 1000000) / (nTime + 1), ") reads/s");
+
+        REQUIRE(nRead == nBlocks * nPerBlock);
+    }
+
+    delete db;
+
+    debug::log(0, "===== End Multi Read Benchmarks =====\n");
+}
@@ -0,0 +1,114 @@
+#include <Util/include/runtime.h>
+
+#include <LLC/include/random.h>
+
+#include <LLD/include/enum.h>
+#include <LLD/templates/sector.h>
+#include <LLD/keychain/hashmap.h>
+#include <LLD/cache/binary_2q.h>
+
+#include <unit/catch2/catch.hpp>
+
+
+TEST_CASE( "Ordered Range Read Benchmarks", "[LLD]")
+{
+    debug::log(0, "===== Begin Ordered Range Read Benchmarks =====");
+
+    LLD::SectorDatabase<LLD::BinaryHashMap, LLD::Binary2Q>* db =
+        new LLD::SectorDatabase<LLD::BinaryHashMap, LLD::Binary2Q>("_BENCH_ORDERED", LLD::FLAGS::CREATE | LLD::FLAGS::FORCE, 77773, 1024);
+
+    /* Write events the way the ledger does, a transaction indexed by address and sequence. */
+    const uint32_t nAddresses = 100;
+    const uint32_t nEvents    = 500;
+    uint256_t hashAddress = LLC::GetRand256();
+    uint512_t hashTx      = LLC::GetRand512();
+    {
+        runtime::timer timer;
+        timer.Start();
+
+        for(uint32_t nSequence = 0; nSequence < nEvents; ++nSequence)
+        {
+            for(uint32_t n = 0; n < nAddresses; ++n)
+            {
+                const uint512_t hashThis = hashTx + (nSequence * nAddresses + n);
+                db->Write(hashThis, uint1024_t(nSequence), "tx");
+                db->Index(std::make_pair(hashAddress + n, nSequence), hashThis);
+                db->WriteOrdered(std::make_pair(std::string("event"), hashAddress + n), nSequence, hashThis);
+            }
+        }
+
+        uint64_t nTime = timer.ElapsedMilliseconds();
+        debug::log(0, ANSI_COLOR_BRIGHT_CYAN, "Put::", ANSI_COLOR_RESET, nAddresses * nEvents, " events in ", nTime, "ms");
+    }
+
+
+    /* Read every event by sequence until a read fails. */
+    {
+        runtime::timer timer;
+        timer.Start();
+
+        uint32_t nRead = 0;
+        for(uint32_t n = 0; n < nAddresses; ++n)
+        {
+            uint1024_t nValue;
+            for(uint32_t nSequence = 0; db->Read(std::make_pair(hashAddress + n, nSequence), nValue); ++nSequence)
+                ++nRead;
+        }
+
+        uint64_t nTime = timer.ElapsedMicroseconds();
+        debug::log(0, ANSI_COLOR_BRIGHT_CYAN, "Read::", ANSI_COLOR_RESET, nRead, " events by sequence in ", nTime / 1000, "ms (", (uint64_t(nRead) * 1000000) / (nTime + 1), ") per/s");
+
+        REQUIRE(nRead == nAddresses * nEvents);
+    }
+
+
+    /* Read the transaction hashes of every event by range. */
+    {
+        runtime::timer timer;
+        timer.Start();
+
+        uint32_t nRead = 0;
+        for(uint32_t n = 0; n < nAddresses; ++n)
+        {
+            std::vector< std::pair<uint64_t, uint512_t> > vEvents;
+            for(uint32_t nSequence = 0; db->ReadRange(std::make_pair(std::string("event"), hashAddress + n), nSequence, 1000, vEvents); nSequence += vEvents.size())
+                nRead += vEvents.size();
+        }
+
+        uint64_t nTime = timer.ElapsedMicroseconds();
+        debug::log(0, ANSI_COLOR_BRIGHT_CYAN, "ReadRange::", ANSI_COLOR_RESET, nRead, " event hashes by range in ", nTime / 1000, "ms (", (uint64_t(nRead) * 1000000) / (nTime + 1), ") per/s");
+
+        REQUIRE(nRead == nAddresses * nEvents);
+    }
+
+
+    /* Read the transactions of every event by range. */
+    {
+        runtime::timer timer;
+        timer.Start();
+
+        uint32_t nRead = 0;
+        for(uint32_t n = 0; n < nAddresses; ++n)
+        {
+            std::vector< std::pair<uint64_t, uint512_t> > vEvents;
+            for(uint32_t nSequence = 0; db->ReadRange(std::make_pair(std::string("event"), hashAddress + n), nSequence, 1000, vEvents); nSequence += vEvents.size())
+            {
+                for(const auto& event : vEvents)
+                {
+                    uint1024_t nValue;
+                    if(db->Read(event.second, nValue))
+                        ++nRead;
+                }
+            }
+        }
+
+        uint64_t nTime = timer.ElapsedMicroseconds();
+        debug::log(0, ANSI_COLOR_BRIGHT_CYAN, "ReadRange::", ANSI_COLOR_RESET, nRead, " events by range in ", nTime / 1000, "ms (", (uint64_t(nRead) * 1000000) / (nTime + 1), ") per/s");
+
+        REQUIRE(nRead == nAddresses * nEvents);
+    }
+
+    delete db;
+
+    debug::log(0, "===== End Ordered Range Read Benchmarks =====\n");
+}
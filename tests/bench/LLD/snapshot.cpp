@@ -0,0 +1,88 @@
+#include <Util/include/runtime.h>
+#include <Util/include/filesystem.h>
+#include <Util/include/args.h>
+
+#include <LLC/include/random.h>
+
+#include <LLD/include/enum.h>
+#include <LLD/templates/sector.h>
+#include <LLD/keychain/hashmap.h>
+#include <LLD/cache/binary_2q.h>
+
+#include <unit/catch2/catch.hpp>
+
+
+TEST_CASE( "Sector Snapshot Benchmarks", "[LLD]")
+{
+    debug::log(0, "===== Begin Sector Snapshot Benchmarks =====");
+
+    typedef LLD::SectorDatabase<LLD::BinaryHashMap, LLD::Binary2Q> SnapshotDB;
+
+    filesystem::remove_directories(config::GetDataDir() + "_BENCH_SNAPSHOT/");
+
+    SnapshotDB* db = new SnapshotDB("_BENCH_SNAPSHOT", LLD::FLAGS::CREATE | LLD::FLAGS::FORCE, 77773, 1024);
+
+    const uint32_t nRecords = 10000;
+    uint256_t hash = LLC::GetRand256();
+
+    for(uint32_t i = 0; i < nRecords; ++i)
+        REQUIRE(db->Write(std::make_pair(std::string("data"), hash + i), uint64_t(i)));
+
+    {
+        LLD::Snapshot snapshot = db->OpenSnapshot();
+
+        /* Overwrite every record, and erase one that the snapshot still has. */
+        runtime::timer timer;
+        timer.Start();
+
+        for(uint32_t i = 0; i < nRecords; ++i)
+            REQUIRE(db->Write(std::make_pair(std::string("data"), hash + i), uint64_t(i) + nRecords));
+
+        uint64_t nTime = timer.ElapsedMilliseconds();
+        debug::log(0, ANSI_COLOR_BRIGHT_CYAN, "Snapshot::", ANSI_COLOR_RESET, nRecords, " overwrites in ", nTime, "ms");
+
+        REQUIRE(db->Erase(std::make_pair(std::string("data"), hash)));
+
+        /* The snapshot reads the old values, while plain reads see the new ones. */
+        timer.Reset();
+        for(uint32_t i = 0; i < nRecords; ++i)
+        {
+            uint64_t nValue = 0;
+            REQUIRE(db->ReadSnapshot(std::make_pair(std::string("data"), hash + i), nValue, snapshot));
+            REQUIRE(nValue == i);
+
+            if(i == 0)
+            {
+                REQUIRE_FALSE(db->Read(std::make_pair(std::string("data"), hash + i), nValue));
+                continue;
+            }
+
+            REQUIRE(db->Read(std::make_pair(std::string("data"), hash + i), nValue));
+            REQUIRE(nValue == i + nRecords);
+        }
+
+        nTime = timer.ElapsedMilliseconds();
+        debug::log(0, ANSI_COLOR_BRIGHT_CYAN, "Snapshot::", ANSI_COLOR_RESET, nRecords, " snapshot reads in ", nTime, "ms");
+
+        /* Records written after the snapshot was opened are not seen by it. */
+        REQUIRE(db->Write(std::make_pair(std::string("late"), hash), uint64_t(1)));
+
+        uint64_t nValue = 0;
+        REQUIRE_FALSE(db->ReadSnapshot(std::make_pair(std::string("late"), hash), nValue, snapshot));
+        REQUIRE(db->Read(std::make_pair(std::string("late"), hash), nValue));
+    }
+
+    /* A snapshot opened now sees the latest values. */
+    {
+        LLD::Snapshot snapshot = db->OpenSnapshot();
+
+        uint64_t nValue = 0;
+        REQUIRE(db->ReadSnapshot(std::make_pair(std::string("data"), hash + 1), nValue, snapshot));
+        REQUIRE(nValue == 1 + nRecords);
+    }
+
+    delete db;
+    filesystem::remove_directories(config::GetDataDir() + "_BENCH_SNAPSHOT/");
+
+    debug::log(0, "===== End Sector Snapshot Benchmarks =====\n");
+}
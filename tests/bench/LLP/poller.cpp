@@ -0,0 +1,124 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <Util/include/debug.h>
+#include <Util/include/runtime.h>
+
+#include <LLP/templates/poller.h>
+#include <LLP/templates/wheel.h>
+
+#include <unit/catch2/catch.hpp>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+
+/* Wait for one busy socket among idle ones, as a data thread does with one active peer. */
+static void wait_busy(const uint32_t nIdle, const bool fPortable)
+{
+    LLP::Poller poller(fPortable);
+
+    /* The busy pair is first, then a pair for each idle connection. */
+    std::vector<int> vSockets;
+    for(uint32_t n = 0; n <= nIdle; ++n)
+    {
+        int fds[2];
+        REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+
+        vSockets.push_back(fds[0]);
+        vSockets.push_back(fds[1]);
+
+        REQUIRE(poller.Add(fds[0], n));
+    }
+
+    /* Send a byte to the busy socket, wait for it and read it. */
+    const uint32_t nTotal = 10000;
+    std::vector<LLP::PollEvent> vEvents;
+    uint8_t nByte = 0;
+
+    runtime::timer timer;
+    timer.Start();
+
+    uint32_t nReceived = 0;
+    for(uint32_t n = 0; n < nTotal; ++n)
+    {
+        REQUIRE(write(vSockets[1], &nByte, 1) == 1);
+
+        poller.Wait(vEvents, 100);
+        for(const auto& event : vEvents)
+        {
+            if(event.nIndex == 0 && read(vSockets[0], &nByte, 1) == 1)
+                ++nReceived;
+        }
+    }
+
+    uint64_t nTime = timer.ElapsedMicroseconds();
+    debug::log(0, ANSI_COLOR_BRIGHT_CYAN, fPortable ? "Poll::" : "Epoll::", ANSI_COLOR_RESET, nIdle, " idle sockets: ",
+        nTotal, " waits in ", nTime / 1000, "ms (", (uint64_t(nTotal) * 1000000) / (nTime + 1), ") waits/s");
+
+    REQUIRE(nReceived == nTotal);
+
+    for(const int& fd : vSockets)
+        close(fd);
+}
+
+
+TEST_CASE( "Poller Benchmarks", "[LLP]")
+{
+    debug::log(0, "===== Begin Poller Benchmarks =====");
+
+    /* Compare the cost of a wait as the idle connections grow. */
+    for(const uint32_t nIdle : {10u, 100u, 1000u, 4000u})
+    {
+        wait_busy(nIdle, true);
+
+    #ifdef __linux__
+        wait_busy(nIdle, false);
+    #endif
+    }
+
+
+    /* Check the connections on their timers, as a data thread does every 100 ms. */
+    {
+        const uint32_t nConnections = 10000;
+        const uint32_t nPasses      = 100;
+
+        uint64_t nNow = 0;
+        LLP::TimerWheel wheel(10, 256, nNow);
+        for(uint32_t n = 0; n < nConnections; ++n)
+            wheel.Schedule(n, n % 100, nNow);
+
+        runtime::timer timer;
+        timer.Start();
+
+        uint64_t nChecks = 0;
+        std::vector< std::pair<uint32_t, uint64_t> > vExpired;
+        for(uint32_t n = 0; n < nPasses * 10; ++n)
+        {
+            nNow += 10;
+            wheel.Expire(nNow, vExpired);
+
+            for(const auto& expired : vExpired)
+                wheel.Schedule(expired.first, 100, nNow);
+
+            nChecks += vExpired.size();
+        }
+
+        uint64_t nTime = timer.ElapsedMicroseconds();
+        debug::log(0, ANSI_COLOR_BRIGHT_CYAN, "Wheel::", ANSI_COLOR_RESET, nChecks, " checks of ", nConnections,
+            " connections in ", nTime / 1000, "ms (", (nChecks * 1000000) / (nTime + 1), ") checks/s");
+
+        REQUIRE(nChecks == uint64_t(nConnections) * nPasses);
+        REQUIRE(wheel.Size() == nConnections);
+    }
+}
@@ -0,0 +1,155 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLC/include/random.h>
+
+#include <TAO/Ledger/types/mempool.h>
+#include <TAO/Ledger/types/transaction.h>
+
+#include <Util/include/debug.h>
+#include <Util/include/runtime.h>
+
+#include <unit/catch2/catch.hpp>
+
+#include <atomic>
+#include <thread>
+
+TEST_CASE( "Mempool Benchmarks", "[ledger]")
+{
+    debug::log(0, "===== Begin Mempool Benchmarks =====");
+
+    /* Build 100k transactions over 1000 signature chains. */
+    const uint32_t nChains = 1000;
+    const uint32_t nSequences = 100;
+
+    std::vector<TAO::Ledger::Transaction> vtx;
+    std::vector<uint512_t> vHashes;
+    std::vector<uint256_t> vGenesis;
+    vtx.reserve(nChains * nSequences);
+    vHashes.reserve(nChains * nSequences);
+    for(uint32_t nChain = 0; nChain < nChains; ++nChain)
+    {
+        uint256_t hashGenesis = LLC::GetRand256();
+        hashGenesis.SetType(0xa1);
+        vGenesis.push_back(hashGenesis);
+
+        uint512_t hashPrevTx = 0;
+        for(uint32_t nSequence = 0; nSequence < nSequences; ++nSequence)
+        {
+            TAO::Ledger::Transaction tx;
+            tx.hashGenesis = hashGenesis;
+            tx.nSequence   = nSequence;
+            tx.hashPrevTx  = hashPrevTx;
+            tx.nTimestamp  = runtime::unifiedtimestamp();
+
+            hashPrevTx = tx.GetHash();
+
+            vtx.push_back(tx);
+            vHashes.push_back(hashPrevTx);
+        }
+    }
+
+    /* Readers look up random transactions while the pool is filled. */
+    std::atomic<bool> fStop(false);
+    std::atomic<uint64_t> nReads(0);
+    std::vector<std::thread> vReaders;
+    for(uint32_t nThread = 0; nThread < 4; ++nThread)
+    {
+        vReaders.emplace_back([&]()
+        {
+            TAO::Ledger::Transaction tx;
+            for(uint64_t n = LLC::GetRand(); !fStop.load(); ++n)
+            {
+                TAO::Ledger::mempool.Get(vHashes[n % vHashes.size()], tx);
+                ++nReads;
+            }
+        });
+    }
+
+    {
+        runtime::timer timer;
+        timer.Start();
+
+        /* Add a transaction of each chain in turn, as they arrive from many users. */
+        for(uint32_t nSequence = 0; nSequence < nSequences; ++nSequence)
+            for(uint32_t nChain = 0; nChain < nChains; ++nChain)
+                REQUIRE(TAO::Ledger::mempool.AddUnchecked(vtx[nChain * nSequences + nSequence]));
+
+        const uint64_t nTime = timer.ElapsedMicroseconds();
+        fStop.store(true);
+        for(auto& thread : vReaders)
+            thread.join();
+
+        debug::log(0, ANSI_COLOR_BRIGHT_CYAN, "AddUnchecked::", ANSI_COLOR_RESET, vtx.size() * 1.0 / nTime, " million tx / second with ",
+            nReads.load() * 1.0 / nTime, " million concurrent Get / second");
+    }
+
+    REQUIRE(TAO::Ledger::mempool.Size() == vtx.size());
+
+    {
+        runtime::timer timer;
+        timer.Start();
+
+        TAO::Ledger::Transaction tx;
+        for(const auto& hash : vHashes)
+            REQUIRE(TAO::Ledger::mempool.Get(hash, tx));
+
+        const uint64_t nTime = timer.ElapsedMicroseconds();
+        debug::log(0, ANSI_COLOR_BRIGHT_CYAN, "Get::", ANSI_COLOR_RESET, vHashes.size() * 1.0 / nTime, " million tx / second");
+    }
+
+    {
+        runtime::timer timer;
+        timer.Start();
+
+        std::vector<uint512_t> vList;
+        REQUIRE(TAO::Ledger::mempool.List(vList));
+        REQUIRE(vList.size() == vtx.size());
+
+        const uint64_t nTime = timer.ElapsedMicroseconds();
+        debug::log(0, ANSI_COLOR_BRIGHT_CYAN, "List::", ANSI_COLOR_RESET, vList.size(), " tx in ", nTime / 1000.0, " ms");
+    }
+
+    {
+        runtime::timer timer;
+        timer.Start();
+
+        std::vector<TAO::Ledger::Transaction> vChain;
+        for(const auto& hashGenesis : vGenesis)
+        {
+            vChain.clear();
+            REQUIRE(TAO::Ledger::mempool.Get(hashGenesis, vChain));
+            REQUIRE(vChain.size() == nSequences);
+        }
+
+        const uint64_t nTime = timer.ElapsedMicroseconds();
+        debug::log(0, ANSI_COLOR_BRIGHT_CYAN, "Get(genesis)::", ANSI_COLOR_RESET, vGenesis.size() * 1000000.0 / nTime, " chains / second");
+    }
+
+    {
+        runtime::timer timer;
+        timer.Start();
+
+        /* Remove in chain order, as blocks are connected. */
+        for(uint32_t nSequence = 0; nSequence < nSequences; ++nSequence)
+            for(uint32_t nChain = 0; nChain < nChains; ++nChain)
+                REQUIRE(TAO::Ledger::mempool.Remove(vHashes[nChain * nSequences + nSequence]));
+
+        const uint64_t nTime = timer.ElapsedMicroseconds();
+        debug::log(0, ANSI_COLOR_BRIGHT_CYAN, "Remove::", ANSI_COLOR_RESET, vHashes.size() * 1.0 / nTime, " million tx / second");
+    }
+
+    REQUIRE(TAO::Ledger::mempool.Size() == 0);
+
+    debug::log(0, "===== End Mempool Benchmarks =====\n");
+}
@@ -0,0 +1,62 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLC/hash/SK.h>
+#include <LLC/include/random.h>
+
+#include <Util/templates/datastream.h>
+
+#include <unit/catch2/catch.hpp>
+
+
+TEST_CASE( "SK Stream Tests", "[LLC]")
+{
+    for(uint32_t nSize = 0; nSize < 600; nSize += 7)
+    {
+        /* Serialize some random values of this size. */
+        std::vector<uint8_t> vData(nSize);
+        for(auto& ch : vData)
+            ch = static_cast<uint8_t>(LLC::GetRand());
+
+        const uint512_t hashRand = LLC::GetRand512();
+
+        DataStream ss(SER_GETHASH, 1);
+        ss << vData << hashRand << nSize;
+
+        /* Hash the same values in pieces as they are serialized. */
+        LLC::SK64Stream ss64(SER_GETHASH, 1);
+        ss64 << vData << hashRand << nSize;
+        REQUIRE(ss64.GetHash() == LLC::SK64(ss.begin(), ss.end()));
+
+        LLC::SK256Stream ss256(SER_GETHASH, 1);
+        ss256 << vData << hashRand << nSize;
+        REQUIRE(ss256.GetHash() == LLC::SK256(ss.begin(), ss.end()));
+
+        LLC::SK512Stream ss512(SER_GETHASH, 1);
+        ss512 << vData << hashRand << nSize;
+        REQUIRE(ss512.GetHash() == LLC::SK512(ss.begin(), ss.end()));
+
+        LLC::SK1024Stream ss1024(SER_GETHASH, 1);
+        ss1024 << vData << hashRand << nSize;
+        REQUIRE(ss1024.GetHash() == LLC::SK1024(ss.begin(), ss.end()));
+
+        /* The vector forms hash the same bytes. */
+        REQUIRE(LLC::SK256(ss.Bytes()) == LLC::SK256(ss.begin(), ss.end()));
+        REQUIRE(LLC::SK512(ss.Bytes()) == LLC::SK512(ss.begin(), ss.end()));
+    }
+
+    /* An empty stream hashes like an empty span. */
+    std::vector<uint8_t> vEmpty;
+    REQUIRE(LLC::SK512Stream(SER_GETHASH, 1).GetHash() == LLC::SK512(vEmpty.begin(), vEmpty.end()));
+    REQUIRE(LLC::SK512(vEmpty) == LLC::SK512(vEmpty.begin(), vEmpty.end()));
+}
@@ -0,0 +1,173 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLD/include/enum.h>
+#include <LLD/include/version.h>
+#include <LLD/templates/journal.h>
+#include <LLD/templates/sector.h>
+#include <LLD/keychain/hashmap.h>
+#include <LLD/cache/binary_lru.h>
+
+#include <Util/include/args.h>
+#include <Util/include/filesystem.h>
+#include <Util/templates/datastream.h>
+
+#include <unit/catch2/catch.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <thread>
+
+#include <unistd.h>
+
+typedef LLD::SectorDatabase<LLD::BinaryHashMap, LLD::BinaryLRU> JournalTestDB;
+
+
+/* Get the size of a file on disk. */
+static uint64_t FileSize(const std::string& strFile)
+{
+    std::ifstream file(strFile, std::ios::in | std::ios::binary | std::ios::ate);
+    return static_cast<uint64_t>(file.tellg());
+}
+
+
+/* Commit one record holding the journal of a transaction writing a single key, without applying it. */
+static void JournalWrite(JournalTestDB* db, LLD::Journal& journal, const uint32_t nKey)
+{
+    db->TxnBegin();
+    REQUIRE(db->Write(std::make_pair(std::string("journal"), nKey), nKey));
+
+    DataStream ssJournal(SER_LLD, LLD::DATABASE_VERSION);
+    REQUIRE(db->TxnCheckpoint(ssJournal));
+    REQUIRE(journal.Commit(ssJournal.Bytes()));
+
+    db->TxnRelease();
+}
+
+
+TEST_CASE( "LLD write-ahead log tests", "[LLD]")
+{
+    const std::string strLog = config::GetDataDir() + "_UNIT_JOURNAL.wal";
+    filesystem::remove(strLog);
+
+    JournalTestDB* db = new JournalTestDB("_UNIT_JOURNAL", LLD::FLAGS::CREATE | LLD::FLAGS::FORCE, 1024, 1024);
+
+    /* A record torn by a crash is discarded, with every complete record before it replayed. */
+    {
+        uint64_t nComplete = 0;
+        {
+            LLD::Journal journal(strLog, 64 * 1024 * 1024, []{ return true; });
+            for(uint32_t nKey = 0; nKey < 9; ++nKey)
+                JournalWrite(db, journal, nKey);
+
+            nComplete = journal.Size();
+
+            JournalWrite(db, journal, 9);
+            REQUIRE(journal.Size() > nComplete);
+        }
+
+        /* Cut the last record in half. */
+        REQUIRE(truncate(strLog.c_str(), (nComplete + FileSize(strLog)) / 2) == 0);
+
+        std::vector< std::vector<uint8_t> > vRecords;
+        REQUIRE(LLD::Journal::Read(strLog, vRecords));
+        REQUIRE(vRecords.size() == 9);
+
+        /* Replay each record the way recovery does. */
+        for(const auto& vRecord : vRecords)
+        {
+            const DataStream ssRecord(vRecord, SER_LLD, LLD::DATABASE_VERSION);
+
+            std::string strName;
+            std::vector<uint8_t> vJournal;
+            ssRecord >> strName >> vJournal;
+
+            REQUIRE(ssRecord.End());
+            REQUIRE(db->TxnRecovery(vJournal));
+            REQUIRE(db->TxnCommit());
+            db->TxnRelease();
+        }
+
+        for(uint32_t nKey = 0; nKey < 9; ++nKey)
+        {
+            uint32_t nValue = 0;
+            REQUIRE(db->Read(std::make_pair(std::string("journal"), nKey), nValue));
+            REQUIRE(nValue == nKey);
+        }
+
+        REQUIRE_FALSE(db->Exists(std::make_pair(std::string("journal"), uint32_t(9))));
+    }
+
+
+    /* Records appended after reopening a log follow its last complete record. */
+    {
+        REQUIRE(truncate(strLog.c_str(), 0) == 0);
+        {
+            LLD::Journal journal(strLog, 64 * 1024 * 1024, []{ return true; });
+            JournalWrite(db, journal, 10);
+        }
+        {
+            LLD::Journal journal(strLog, 64 * 1024 * 1024, []{ return true; });
+            REQUIRE(journal.Size() == FileSize(strLog));
+
+            JournalWrite(db, journal, 11);
+        }
+
+        std::vector< std::vector<uint8_t> > vRecords;
+        REQUIRE(LLD::Journal::Read(strLog, vRecords));
+        REQUIRE(vRecords.size() == 2);
+    }
+
+
+    /* A checkpoint runs once the log passes its size, syncing the database and clearing the log. */
+    {
+        REQUIRE(truncate(strLog.c_str(), 0) == 0);
+
+        std::atomic<uint32_t> nCheckpoints(0);
+        LLD::Journal* pJournal = nullptr;
+        {
+            LLD::Journal journal(strLog, 1024, [&]
+            {
+                if(!db->Sync() || !pJournal->Clear())
+                    return false;
+
+                ++nCheckpoints;
+                return true;
+            });
+            pJournal = &journal;
+
+            /* Write until the log passes its checkpoint size, every record is the same size. */
+            JournalWrite(db, journal, 20);
+
+            const uint64_t nRecord = journal.Size();
+            for(uint32_t nKey = 21; (nKey - 20) * nRecord < 1024; ++nKey)
+                JournalWrite(db, journal, nKey);
+
+            for(uint32_t n = 0; n < 500 && nCheckpoints.load() == 0; ++n)
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+            REQUIRE(nCheckpoints.load() == 1);
+            REQUIRE(journal.Size() == 0);
+        }
+
+        REQUIRE(FileSize(strLog) == 0);
+
+        std::vector< std::vector<uint8_t> > vRecords;
+        REQUIRE(LLD::Journal::Read(strLog, vRecords));
+        REQUIRE(vRecords.empty());
+    }
+
+    delete db;
+    filesystem::remove(strLog);
+}
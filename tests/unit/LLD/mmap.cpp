@@ -0,0 +1,108 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLD/templates/mmap.h>
+
+#include <Util/include/args.h>
+#include <Util/include/config.h>
+#include <Util/include/filesystem.h>
+
+#include <unit/catch2/catch.hpp>
+
+#include <atomic>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+
+/* Append a block of bytes of the same value to a file. */
+static void MapAppend(const std::string& strFile, const uint8_t nValue)
+{
+    std::vector<uint8_t> vData(4096, nValue);
+
+    std::ofstream stream(strFile, std::ios::out | std::ios::binary | std::ios::app);
+    stream.write((char*)&vData[0], vData.size());
+}
+
+
+TEST_CASE( "LLD memory map tests", "[LLD]")
+{
+    const std::string strPrefix = config::GetDataDir() + "_UNIT_MMAP.";
+    const std::string strFile   = strPrefix + "00000";
+    filesystem::remove(strFile);
+
+    if(!LLD::MemoryMap::Supported())
+        return;
+
+    LLD::MemoryMap map(strPrefix);
+
+    /* A file that isn't on disk isn't mapped. */
+    {
+        uint8_t nByte = 0;
+        REQUIRE_FALSE(map.Read(0, 0, &nByte, 1));
+    }
+
+    /* Readers keep copying while the file grows and its mapping is replaced. */
+    {
+        MapAppend(strFile, 0);
+
+        std::atomic<bool> fStop(false);
+        std::atomic<uint32_t> nErrors(0);
+
+        std::vector<std::thread> vThreads;
+        for(uint32_t n = 0; n < 4; ++n)
+        {
+            vThreads.push_back(std::thread([&]
+            {
+                std::vector<uint8_t> vData(4096);
+                while(!fStop.load())
+                {
+                    if(!map.Read(0, 0, &vData[0], vData.size()) || vData != std::vector<uint8_t>(4096, 0))
+                        ++nErrors;
+                }
+            }));
+        }
+
+        for(uint32_t n = 1; n < 64; ++n)
+        {
+            MapAppend(strFile, static_cast<uint8_t>(n));
+
+            /* Reading past the old mapping remaps the file. */
+            std::vector<uint8_t> vData(4096);
+            REQUIRE(map.Read(0, n * 4096, &vData[0], vData.size()));
+            REQUIRE(vData == std::vector<uint8_t>(4096, static_cast<uint8_t>(n)));
+
+            if(n % 8 == 0)
+                map.Release(0);
+        }
+
+        fStop = true;
+        for(auto& thread : vThreads)
+            thread.join();
+
+        REQUIRE(nErrors.load() == 0);
+    }
+
+    /* A truncated file is empty and no longer read through its mapping. */
+    {
+        REQUIRE(map.Truncate(0));
+
+        std::ifstream stream(strFile, std::ios::in | std::ios::binary | std::ios::ate);
+        REQUIRE(stream.tellg() == 0);
+
+        uint8_t nByte = 0;
+        REQUIRE_FALSE(map.Read(0, 0, &nByte, 1));
+    }
+
+    filesystem::remove(strFile);
+}
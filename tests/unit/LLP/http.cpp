@@ -0,0 +1,86 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <unit/catch2/catch.hpp>
+
+#include <LLP/packets/http.h>
+
+#include <cstring>
+#include <string>
+
+TEST_CASE("HTTP header tests", "[http]")
+{
+    LLP::HTTPHeaders HEADERS;
+    REQUIRE(HEADERS.Empty());
+
+    /* Fields are parsed from lines and matched without regard to case. */
+    const char* pLine = "Content-Type:  application/json \t";
+    REQUIRE(HEADERS.Parse(pLine, std::strlen(pLine)));
+    REQUIRE_FALSE(HEADERS.Parse("no delimiter", 12));
+
+    REQUIRE(HEADERS.Has("content-type"));
+    REQUIRE(HEADERS.Get("CONTENT-TYPE") == "application/json");
+    REQUIRE(HEADERS.Matches("content-type", "Application/JSON"));
+    REQUIRE_FALSE(HEADERS.Has("content-length"));
+    REQUIRE(HEADERS.Get("content-length") == "");
+
+    /* Setting a field replaces its value. */
+    HEADERS.Set("Connection", "close");
+    HEADERS.Set("connection", "keep-alive");
+    REQUIRE(HEADERS.Get("Connection") == "keep-alive");
+
+    std::string strOut;
+    HEADERS.Write(strOut);
+    REQUIRE(strOut == "Content-Type: application/json\r\nConnection: keep-alive\r\n");
+
+    HEADERS.Clear();
+    REQUIRE(HEADERS.Empty());
+}
+
+
+TEST_CASE("HTTP packet tests", "[http]")
+{
+    /* HTTP/1.1 connections stay open unless closed, HTTP/1.0 only when asked. */
+    {
+        LLP::HTTPPacket REQUEST;
+        REQUEST.strVersion = "HTTP/1.1";
+        REQUIRE(REQUEST.KeepAlive());
+
+        REQUEST.HEADERS.Set("connection", "Close");
+        REQUIRE_FALSE(REQUEST.KeepAlive());
+
+        REQUEST.strVersion = "HTTP/1.0";
+        REQUIRE_FALSE(REQUEST.KeepAlive());
+
+        REQUEST.HEADERS.Set("connection", "keep-alive");
+        REQUIRE(REQUEST.KeepAlive());
+    }
+
+    /* Chunks carry the content with their sizes, and end with an empty chunk. */
+    {
+        LLP::HTTPPacket RESPONSE(200);
+        RESPONSE.strContent = std::string(40, 'a');
+
+        auto vChunks = RESPONSE.GetChunks(16);
+        REQUIRE(vChunks.size() == 5);
+
+        const std::string strHeader(vChunks[0]->begin(), vChunks[0]->end());
+        REQUIRE(strHeader.find("Transfer-Encoding: chunked\r\n") != std::string::npos);
+        REQUIRE(strHeader.find("Content-Length") == std::string::npos);
+        REQUIRE(strHeader.substr(strHeader.size() - 4) == "\r\n\r\n");
+
+        REQUIRE(std::string(vChunks[1]->begin(), vChunks[1]->end()) == "10\r\n" + std::string(16, 'a') + "\r\n");
+        REQUIRE(std::string(vChunks[3]->begin(), vChunks[3]->end()) == "8\r\n" + std::string(8, 'a') + "\r\n");
+        REQUIRE(std::string(vChunks[4]->begin(), vChunks[4]->end()) == "0\r\n\r\n");
+    }
+}
@@ -0,0 +1,73 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <unit/catch2/catch.hpp>
+
+#include <LLP/include/base_address.h>
+#include <LLP/templates/socket.h>
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <vector>
+
+TEST_CASE("LLP socket send queue tests", "[LLP]")
+{
+    /* Connect a pair of sockets with a small send buffer so writes are queued. */
+    int fds[2];
+    REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+
+    int nSendBuffer = 4096;
+    setsockopt(fds[0], SOL_SOCKET, SO_SNDBUF, &nSendBuffer, sizeof(nSendBuffer));
+    fcntl(fds[1], F_SETFL, O_NONBLOCK);
+
+    LLP::Socket socket(fds[0], LLP::BaseAddress());
+
+    /* Write copied and shared buffers of different sizes without reading the other end. */
+    std::vector<uint8_t> vExpected;
+    uint32_t nByte = 0;
+    for(uint32_t n = 0; n < 500; ++n)
+    {
+        std::vector<uint8_t> vData(1 + (n * 37) % 3000);
+        for(auto& ch : vData)
+            ch = static_cast<uint8_t>(nByte++ * 7);
+
+        vExpected.insert(vExpected.end(), vData.begin(), vData.end());
+        if(n % 2 == 0)
+            socket.Write(vData, vData.size());
+        else
+            socket.Write(std::make_shared<const std::vector<uint8_t>>(vData));
+    }
+
+    /* Whatever the socket didn't take is queued. */
+    REQUIRE(socket.Buffered() > 0);
+    REQUIRE(socket.Buffered() < vExpected.size());
+
+    /* Flushing sends the queue in the order it was written. */
+    std::vector<uint8_t> vReceived;
+    uint8_t pBuffer[65536];
+    for(uint32_t n = 0; n < 1000000 && vReceived.size() < vExpected.size(); ++n)
+    {
+        socket.Flush();
+
+        const ssize_t nRead = read(fds[1], pBuffer, sizeof(pBuffer));
+        if(nRead > 0)
+            vReceived.insert(vReceived.end(), pBuffer, pBuffer + nRead);
+    }
+
+    REQUIRE(vReceived == vExpected);
+    REQUIRE(socket.Buffered() == 0);
+
+    close(fds[1]);
+}
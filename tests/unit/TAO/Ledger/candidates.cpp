@@ -0,0 +1,102 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLC/include/random.h>
+
+#include <TAO/Operation/include/enum.h>
+
+#include <TAO/Register/include/create.h>
+#include <TAO/Register/types/address.h>
+
+#include <TAO/Ledger/include/constants.h>
+#include <TAO/Ledger/include/enum.h>
+#include <TAO/Ledger/types/candidates.h>
+#include <TAO/Ledger/types/mempool.h>
+#include <TAO/Ledger/types/sigchain.h>
+
+#include <unit/catch2/catch.hpp>
+
+/* Create a token on a new signature chain, and accept it into the memory pool. */
+static uint512_t accept_token(const SecureString& strUser)
+{
+    using namespace TAO::Register;
+    using namespace TAO::Operation;
+
+    //create the transaction object
+    TAO::Ledger::Transaction tx;
+    tx.hashGenesis = TAO::Ledger::SignatureChain::Genesis(strUser);
+    tx.nSequence   = 0;
+    tx.nTimestamp  = runtime::timestamp();
+    tx.nKeyType    = TAO::Ledger::SIGNATURE::BRAINPOOL;
+    tx.nNextType   = TAO::Ledger::SIGNATURE::BRAINPOOL;
+    tx.NextHash(LLC::GetRand512(), TAO::Ledger::SIGNATURE::BRAINPOOL);
+
+    //payload
+    Address hashToken = Address(Address::TOKEN);
+    tx[0] << uint8_t(OP::CREATE) << hashToken << uint8_t(REGISTER::OBJECT) << CreateToken(hashToken, 1000, 100).GetState();
+
+    //generate the prestates and poststates
+    REQUIRE(tx.Build());
+    REQUIRE(tx.Sign(LLC::GetRand512()));
+
+    //accept into the memory pool
+    REQUIRE(TAO::Ledger::mempool.Accept(tx));
+
+    return tx.GetHash();
+}
+
+
+TEST_CASE( "Block template candidates", "[ledger]" )
+{
+    /* Start with an empty memory pool. */
+    std::vector<uint512_t> vExistingHashes;
+    TAO::Ledger::mempool.List(vExistingHashes);
+    for(const auto& hash : vExistingHashes)
+        TAO::Ledger::mempool.Remove(hash);
+
+    std::vector<std::pair<uint8_t, uint512_t>> vtx;
+    TAO::Ledger::candidates.List(vtx, TAO::Ledger::MAX_BLOCK_SIZE);
+    REQUIRE(vtx.empty());
+
+    //queued transactions are added in the order they were accepted
+    const uint512_t hashFirst  = accept_token("candidates1");
+    const uint512_t hashSecond = accept_token("candidates2");
+
+    vtx.clear();
+    TAO::Ledger::candidates.List(vtx, TAO::Ledger::MAX_BLOCK_SIZE);
+    REQUIRE(vtx.size() == 2);
+    REQUIRE(vtx[0] == std::make_pair(uint8_t(TAO::Ledger::TRANSACTION::TRITIUM), hashFirst));
+    REQUIRE(vtx[1] == std::make_pair(uint8_t(TAO::Ledger::TRANSACTION::TRITIUM), hashSecond));
+
+    //the same list is handed out again
+    vtx.clear();
+    TAO::Ledger::candidates.List(vtx, TAO::Ledger::MAX_BLOCK_SIZE);
+    REQUIRE(vtx.size() == 2);
+    REQUIRE(TAO::Ledger::candidates.Size() == 2);
+
+    //only the entries that fit are added
+    vtx.clear();
+    TAO::Ledger::candidates.List(vtx, 100);
+    REQUIRE(vtx.size() == 1);
+    REQUIRE(vtx[0].second == hashFirst);
+
+    //the list is rebuilt without transactions leaving the memory pool
+    REQUIRE(TAO::Ledger::mempool.Remove(hashFirst));
+
+    vtx.clear();
+    TAO::Ledger::candidates.List(vtx, TAO::Ledger::MAX_BLOCK_SIZE);
+    REQUIRE(vtx.size() == 1);
+    REQUIRE(vtx[0].second == hashSecond);
+
+    REQUIRE(TAO::Ledger::mempool.Remove(hashSecond));
+}
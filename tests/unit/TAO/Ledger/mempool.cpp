@@ -1608,6 +1608,10 @@ TEST_CASE( "Mempool and memory sequencing tests", "[mempool]")
         }
 
 
+        //last transaction that connects
+        const uint512_t hashConnected = hashPrevTx;
+
+
         {
             //set private keys
             hashPrivKey1 = hashPrivKey2;
@@ -1640,6 +1644,19 @@ TEST_CASE( "Mempool and memory sequencing tests", "[mempool]")
         }
 
 
+        //orphan added without checks
+        const uint512_t hashOrphan = hashPrevTx;
+
+        //list stops the signature chain at the orphan
+        {
+            std::vector<uint512_t> vHashes;
+            REQUIRE(TAO::Ledger::mempool.List(vHashes));
+
+            REQUIRE(std::find(vHashes.begin(), vHashes.end(), hashConnected) != vHashes.end());
+            REQUIRE(std::find(vHashes.begin(), vHashes.end(), hashOrphan)    == vHashes.end());
+        }
+
+
         {
             //set private keys
             hashPrivKey1 = hashPrivKey2;
@@ -0,0 +1,90 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLC/include/random.h>
+
+#include <TAO/Ledger/include/enum.h>
+#include <TAO/Ledger/include/signatures.h>
+#include <TAO/Ledger/types/transaction.h>
+
+#include <Util/include/workers.h>
+
+#include <unit/catch2/catch.hpp>
+
+TEST_CASE( "Signature verification batches", "[ledger]" )
+{
+    /* Sign transactions with both signature schemes. */
+    std::vector<TAO::Ledger::Transaction> vtx(16);
+    for(uint32_t n = 0; n < vtx.size(); ++n)
+    {
+        vtx[n].nSequence   = n;
+        vtx[n].hashGenesis = LLC::GetRand256();
+        vtx[n].nKeyType    = (n % 2 == 0 ? TAO::Ledger::SIGNATURE::FALCON : TAO::Ledger::SIGNATURE::BRAINPOOL);
+
+        REQUIRE(vtx[n].Sign(LLC::GetRand512()));
+    }
+
+    std::vector<const TAO::Ledger::Transaction*> vVerify;
+    for(const auto& tx : vtx)
+        vVerify.push_back(&tx);
+
+    //verify on the calling thread
+    REQUIRE(TAO::Ledger::VerifySignatures(vVerify));
+
+    //verify across the verification threads
+    TAO::Ledger::VERIFY_WORKERS = new WorkerPool(4);
+    REQUIRE(TAO::Ledger::VerifySignatures(vVerify));
+
+    //a bad signature fails the batch
+    vtx[7].vchSig[0] ^= 0x01;
+    REQUIRE_FALSE(TAO::Ledger::VerifySignatures(vVerify));
+    REQUIRE_FALSE(TAO::Ledger::VerifySignature(vtx[7]));
+
+    //a bad public key fails the batch
+    vtx[7].vchSig[0] ^= 0x01;
+    vtx[8].vchPubKey = vtx[10].vchPubKey;
+    REQUIRE_FALSE(TAO::Ledger::VerifySignatures(vVerify));
+
+    //only the valid signatures remain
+    vVerify.erase(vVerify.begin() + 8);
+    REQUIRE(TAO::Ledger::VerifySignatures(vVerify));
+    REQUIRE(TAO::Ledger::VerifySignature(vtx[7]));
+
+    TAO::Ledger::ShutdownSignatures();
+    REQUIRE(TAO::Ledger::VERIFY_WORKERS == nullptr);
+}
+
+
+TEST_CASE( "Signature verification cache", "[ledger]" )
+{
+    TAO::Ledger::InitializeSignatures();
+
+    TAO::Ledger::Transaction tx;
+    tx.hashGenesis = LLC::GetRand256();
+    tx.nKeyType    = TAO::Ledger::SIGNATURE::FALCON;
+    REQUIRE(tx.Sign(LLC::GetRand512()));
+
+    //verified and cached
+    REQUIRE(TAO::Ledger::VerifySignature(tx));
+    REQUIRE(TAO::Ledger::VerifySignature(tx));
+
+    //a cached txid with another signature is verified again
+    std::vector<uint8_t> vchSig = tx.vchSig;
+    tx.vchSig[10] ^= 0x01;
+    REQUIRE_FALSE(TAO::Ledger::VerifySignature(tx));
+
+    tx.vchSig = vchSig;
+    REQUIRE(TAO::Ledger::VerifySignatures({ &tx }));
+
+    TAO::Ledger::ShutdownSignatures();
+}
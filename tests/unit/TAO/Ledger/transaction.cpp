@@ -11,10 +11,33 @@
 
 ____________________________________________________________________________________________*/
 
+#include <LLC/hash/SK.h>
+#include <LLC/include/random.h>
+
+#include <TAO/Ledger/include/enum.h>
 #include <TAO/Ledger/types/transaction.h>
 
+#include <Util/templates/datastream.h>
+
 #include <unit/catch2/catch.hpp>
 
+#include <thread>
+#include <vector>
+
+
+/* Hash a transaction from a serialized copy, without the cached hash. */
+static uint512_t serialized_hash(const TAO::Ledger::Transaction& tx)
+{
+    DataStream ss(SER_GETHASH, tx.nVersion);
+    ss << tx;
+
+    uint512_t hash = LLC::SK512(ss.begin(), ss.end());
+    hash.SetType(TAO::Ledger::TRITIUM);
+
+    return hash;
+}
+
+
 //test greater than operator
 TEST_CASE( "Transaction::operator>", "[ledger]" )
 {
@@ -39,3 +62,96 @@ TEST_CASE( "Transaction::operator<", "[ledger]" )
     REQUIRE(tx1 < tx2);
     REQUIRE_FALSE(tx2 < tx1);
 }
+
+
+//test the cached hash follows changes to the transaction
+TEST_CASE( "Transaction::GetHash", "[ledger]" )
+{
+    TAO::Ledger::Transaction tx;
+    tx.hashGenesis = LLC::GetRand256();
+    tx.nSequence   = 5;
+    tx[0] << uint8_t(1) << LLC::GetRand256();
+
+    const uint512_t hash = tx.GetHash();
+    REQUIRE(hash == serialized_hash(tx));
+    REQUIRE(tx.GetHash() == hash);
+
+    //copies keep the same hash
+    TAO::Ledger::Transaction txCopy = tx;
+    REQUIRE(txCopy.GetHash() == hash);
+
+    //writing a ledger field changes the hash
+    tx.nTimestamp += 1;
+    REQUIRE(tx.GetHash() != hash);
+    REQUIRE(tx.GetHash() == serialized_hash(tx));
+
+    //setting it back gives the first hash
+    tx.nTimestamp -= 1;
+    REQUIRE(tx.GetHash() == hash);
+
+    //writing a contract changes the hash
+    tx[0] << uint64_t(42);
+    REQUIRE(tx.GetHash() != hash);
+    REQUIRE(tx.GetHash() == serialized_hash(tx));
+
+    //writing through a reference kept from before the hash changes it too
+    TAO::Operation::Contract& contract = tx[0];
+
+    const uint512_t hashContract = tx.GetHash();
+    contract <<= uint8_t(7);
+    REQUIRE(tx.GetHash() != hashContract);
+    REQUIRE(tx.GetHash() == serialized_hash(tx));
+
+    //reading another transaction over it gives that transaction's hash
+    txCopy.GetHash();
+
+    DataStream ss(SER_DISK, 1);
+    ss << tx;
+    ss >> txCopy;
+    REQUIRE(txCopy.GetHash() == tx.GetHash());
+}
+
+
+//test the cached hash is shared safely between threads
+TEST_CASE( "Transaction::GetHash threads", "[ledger]" )
+{
+    TAO::Ledger::Transaction tx;
+    tx.hashGenesis = LLC::GetRand256();
+    tx[0] << uint8_t(1) << LLC::GetRand256();
+
+    const uint512_t hash = serialized_hash(tx);
+
+    //hash, copy and clear the same transaction from several threads at once
+    std::vector<std::thread> vThreads;
+    std::vector<uint32_t> vMismatch(4, 0);
+    for(uint32_t n = 0; n < vMismatch.size(); ++n)
+    {
+        vThreads.emplace_back([&tx, &hash, &vMismatch, n]
+        {
+            const TAO::Ledger::Transaction& txConst = tx;
+            for(uint32_t i = 0; i < 2000; ++i)
+            {
+                TAO::Ledger::Transaction txCopy = txConst;
+                if(txConst.GetHash() != hash || txCopy.GetHash() != hash)
+                    ++vMismatch[n];
+
+                //reading the same contents again clears the cache
+                if(i % 100 == 0)
+                {
+                    DataStream ss(SER_DISK, 1);
+                    ss << txCopy;
+                    ss >> txCopy;
+
+                    if(txCopy.GetHash() != hash)
+                        ++vMismatch[n];
+                }
+            }
+        });
+    }
+
+    for(auto& thread : vThreads)
+        thread.join();
+
+    for(const auto& nMismatch : vMismatch)
+        REQUIRE(nMismatch == 0);
+}
@@ -0,0 +1,101 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLC/include/random.h>
+#include <LLC/types/uint1024.h>
+
+#include <Util/templates/hashindex.h>
+
+#include <unit/catch2/catch.hpp>
+
+#include <map>
+
+TEST_CASE( "HashIndex keys", "[util]" )
+{
+    HashIndex<uint512_t, uint32_t> index;
+    std::map<uint512_t, uint32_t> mapExpected;
+
+    //random keys, and keys with the same low bits that all probe from the same slot
+    for(uint32_t n = 0; n < 5000; ++n)
+    {
+        uint512_t hash = LLC::GetRand512();
+        if(n % 5 == 0)
+            hash = (hash << 64) + 12345;
+
+        index.Put(hash, n);
+        mapExpected[hash] = n;
+    }
+
+    REQUIRE(index.Size() == mapExpected.size());
+
+    //replacing a value keeps the size
+    index.Put(mapExpected.begin()->first, 99999);
+    mapExpected.begin()->second = 99999;
+    REQUIRE(index.Size() == mapExpected.size());
+
+    //remove every other key, including keys in the middle of a probe sequence
+    uint32_t nCount = 0;
+    for(auto it = mapExpected.begin(); it != mapExpected.end(); )
+    {
+        if(++nCount % 2 == 0)
+        {
+            REQUIRE(index.Remove(it->first));
+            REQUIRE_FALSE(index.Remove(it->first));
+
+            it = mapExpected.erase(it);
+        }
+        else
+            ++it;
+    }
+
+    REQUIRE(index.Size() == mapExpected.size());
+
+    //the remaining keys are all found with their values
+    for(const auto& entry : mapExpected)
+    {
+        uint32_t nValue = 0;
+        REQUIRE(index.Get(entry.first, nValue));
+        REQUIRE(nValue == entry.second);
+    }
+
+    //every key is visited once
+    uint32_t nVisited = 0;
+    index.ForEach([&](const uint512_t& hash, const uint32_t nValue)
+    {
+        REQUIRE(mapExpected.at(hash) == nValue);
+        ++nVisited;
+    });
+    REQUIRE(nVisited == mapExpected.size());
+
+    //values are changed in place, and keys are added or removed by the change
+    const uint512_t hashModify = LLC::GetRand512();
+    index.Modify(hashModify, [](uint32_t& nValue){ nValue += 7; return true; });
+    index.Modify(hashModify, [](uint32_t& nValue){ nValue += 7; return true; });
+    REQUIRE(index.Size() == mapExpected.size() + 1);
+
+    uint32_t nViewed = 0;
+    REQUIRE(index.View(hashModify, [&nViewed](const uint32_t nValue){ nViewed = nValue; }));
+    REQUIRE(nViewed == 14);
+
+    index.Modify(hashModify, [](uint32_t& nValue){ return false; });
+    REQUIRE(index.Size() == mapExpected.size());
+    REQUIRE_FALSE(index.View(hashModify, [](const uint32_t nValue){ }));
+
+    //missing keys are not found
+    REQUIRE_FALSE(index.Has(LLC::GetRand512()));
+    REQUIRE_FALSE(index.Has((LLC::GetRand512() << 64) + 12345));
+
+    index.Clear();
+    REQUIRE(index.Size() == 0);
+    REQUIRE_FALSE(index.Has(mapExpected.begin()->first));
+}
@@ -0,0 +1,53 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <Util/include/metrics.h>
+#include <unit/catch2/catch.hpp>
+
+TEST_CASE("Util metrics tests", "[metrics]")
+{
+    /* Counters of the same name and labels are the same counter. */
+    metrics::Counter& counter = metrics::GetCounter("test_records_total", "Test records.", metrics::Label("db", "_TEST"));
+    counter.Add();
+    counter.Add(2);
+    REQUIRE(&metrics::GetCounter("test_records_total", "Test records.", metrics::Label("db", "_TEST")) == &counter);
+    REQUIRE(counter.Get() == 3);
+
+    /* Values are counted in the first bucket they fit in. */
+    metrics::Histogram& histogram = metrics::GetHistogram("test_latency_microseconds", "Test latency.", {10, 100});
+    histogram.Observe(5);
+    histogram.Observe(10);
+    histogram.Observe(50);
+    histogram.Observe(500);
+
+    std::vector<uint64_t> vCounts;
+    uint64_t nSum = 0, nCount = 0;
+    histogram.Read(vCounts, nSum, nCount);
+    REQUIRE(vCounts == std::vector<uint64_t>({2, 1, 1}));
+    REQUIRE(nSum == 565);
+    REQUIRE(nCount == 4);
+
+    /* Watched values are read on export until they are removed. */
+    uint64_t nId = metrics::Watch("test_queue_depth", "Test queue.", false, "", []{ return 7.0; });
+
+    std::string strMetrics = metrics::Export();
+    REQUIRE(strMetrics.find("# TYPE test_records_total counter\n") != std::string::npos);
+    REQUIRE(strMetrics.find("test_records_total{db=\"_TEST\"} 3\n") != std::string::npos);
+    REQUIRE(strMetrics.find("test_latency_microseconds_bucket{le=\"100\"} 3\n") != std::string::npos);
+    REQUIRE(strMetrics.find("test_latency_microseconds_bucket{le=\"+Inf\"} 4\n") != std::string::npos);
+    REQUIRE(strMetrics.find("test_latency_microseconds_count 4\n") != std::string::npos);
+    REQUIRE(strMetrics.find("test_queue_depth 7\n") != std::string::npos);
+
+    metrics::Unwatch(nId);
+    REQUIRE(metrics::Export().find("test_queue_depth") == std::string::npos);
+}
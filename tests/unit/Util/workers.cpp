@@ -0,0 +1,109 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <Util/include/workers.h>
+#include <unit/catch2/catch.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+TEST_CASE("Util worker pool tests", "[workers]")
+{
+    /* Every task runs, including the tasks workers submit. */
+    {
+        std::atomic<uint32_t> nRan(0);
+        {
+            WorkerPool pool(4);
+            REQUIRE(pool.Size() == 4);
+
+            for(uint32_t n = 0; n < 1000; ++n)
+            {
+                REQUIRE(pool.Submit([&pool, &nRan]
+                {
+                    ++nRan;
+                    pool.Submit([&nRan]{ ++nRan; });
+                }));
+            }
+        }
+
+        REQUIRE(nRan.load() == 2000);
+    }
+
+    /* Tasks are turned away while the queue is full, and after the pool is stopped. */
+    {
+        std::mutex MUTEX;
+        std::condition_variable CONDITION;
+        bool fStarted = false, fRelease = false;
+
+        WorkerPool pool(1, 2);
+        REQUIRE(pool.Submit([&]
+        {
+            std::unique_lock<std::mutex> lock(MUTEX);
+            fStarted = true;
+            CONDITION.notify_all();
+            CONDITION.wait(lock, [&]{ return fRelease; });
+        }));
+
+        /* Wait for the worker to hold the first task. */
+        {
+            std::unique_lock<std::mutex> lock(MUTEX);
+            CONDITION.wait(lock, [&]{ return fStarted; });
+        }
+
+        REQUIRE(pool.Submit([]{}));
+        REQUIRE(pool.Submit([]{}));
+        REQUIRE(pool.Queued() == 2);
+        REQUIRE_FALSE(pool.Submit([]{}));
+
+        {
+            std::unique_lock<std::mutex> lock(MUTEX);
+            fRelease = true;
+            CONDITION.notify_all();
+        }
+
+        pool.Stop();
+        REQUIRE(pool.Queued() == 0);
+        REQUIRE_FALSE(pool.Submit([]{}));
+    }
+
+    /* Every index runs once, and the first exception is rethrown. */
+    {
+        WorkerPool pool(4);
+
+        std::vector< std::atomic<uint32_t> > vRan(1000);
+        for(auto& nRan : vRan)
+            nRan = 0;
+
+        pool.ForEach(1000, [&vRan](const uint32_t n){ ++vRan[n]; });
+        for(const auto& nRan : vRan)
+            REQUIRE(nRan.load() == 1);
+
+        pool.ForEach(0, [](const uint32_t n){ FAIL("no index to run"); });
+
+        REQUIRE_THROWS(pool.ForEach(1000, [](const uint32_t n)
+        {
+            if(n == 500)
+                throw std::runtime_error("index failed");
+        }));
+
+        /* The calling thread runs every index once the pool is stopped. */
+        pool.Stop();
+
+        uint32_t nRan = 0;
+        pool.ForEach(10, [&nRan](const uint32_t n){ ++nRan; });
+        REQUIRE(nRan == 10);
+    }
+}